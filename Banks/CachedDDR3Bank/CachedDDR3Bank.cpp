@@ -36,6 +36,7 @@
 #include "Banks/CachedDDR3Bank/CachedDDR3Bank.h"
 #include "include/NVMHelpers.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <cassert>
 
@@ -45,13 +46,23 @@ using namespace NVM;
 CachedDDR3Bank::CachedDDR3Bank( )
 {
     cachedRowBuffer = NULL;
+    bufferKeys = NULL;
     readOnlyBuffers = true;
+    partialFill = false;
     rowBufferSize = 32;
     rowBufferCount = 4;
+    sectorSize = 1;
+    sectorCount = 0;
+    sectorWords = 0;
+    replacement = RDB_REPLACE_LRU;
+    useCounter = 0;
     
     inRDBCount = 0;
     RDBAllocations = 0;
     writebackCount = 0;
+    writebackSectors = 0;
+    cleanSectorsSkipped = 0;
+    sectorFills = 0;
     RDBReads = 0;
     RDBWrites = 0;
     allocationReadsHisto = "";
@@ -61,16 +72,8 @@ CachedDDR3Bank::CachedDDR3Bank( )
 
 CachedDDR3Bank::~CachedDDR3Bank( )
 {
-    if( cachedRowBuffer )
-    {
-        for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
-        {
-            delete cachedRowBuffer[bufferIdx]->dirty;
-            delete cachedRowBuffer[bufferIdx];
-        }
-
-        delete [] cachedRowBuffer;
-    }
+    delete [] cachedRowBuffer;
+    delete [] bufferKeys;
 }
 
 
@@ -80,109 +83,256 @@ void CachedDDR3Bank::SetConfig( Config *config, bool createChildren )
     config->GetValueUL( "COLS", rowBufferSize );
 
     config->GetBool( "CachedRowsReadOnly", readOnlyBuffers );
+    config->GetBool( "CachedRowPartialFill", partialFill );
     config->GetValueUL( "CachedRowSize", rowBufferSize );
     config->GetValueUL( "CachedRowCount", rowBufferCount );
+    config->GetValueUL( "CachedRowSectorSize", sectorSize );
+
+    if( rowBufferSize == 0 )
+        rowBufferSize = 1;
+    if( rowBufferCount == 0 )
+        rowBufferCount = 1;
+
+    if( sectorSize == 0 || rowBufferSize % sectorSize != 0 )
+    {
+        std::cout << "[+] " << StatName( ) << ": CachedRowSectorSize " << sectorSize
+                  << " does not divide CachedRowSize, using 1." << std::endl;
+        sectorSize = 1;
+    }
+
+    if( config->KeyExists( "CachedRowReplacement" ) )
+    {
+        std::string policy = config->GetString( "CachedRowReplacement" );
+
+        if( policy == "LRU" )
+            replacement = RDB_REPLACE_LRU;
+        else if( policy == "FIFO" )
+            replacement = RDB_REPLACE_FIFO;
+        else if( policy == "Random" )
+            replacement = RDB_REPLACE_RANDOM;
+        else
+            std::cout << "[+] " << StatName( ) << ": Unknown CachedRowReplacement "
+                      << policy << ", using LRU." << std::endl;
+    }
+
+    uint64_t seed = 1;
+    config->GetValueUL( "RandomSeed", seed );
+    replacementRng.Seed( seed, StatName( ) + ".rdb" );
+
+    sectorCount = rowBufferSize / sectorSize;
+    sectorWords = ( sectorCount + 63 ) / 64;
 
     /* Initialize row buffers. */
-    cachedRowBuffer = new CachedRowBuffer*[rowBufferCount];
+    delete [] cachedRowBuffer;
+    delete [] bufferKeys;
+
+    cachedRowBuffer = new CachedRowBuffer[rowBufferCount];
+    bufferKeys = new uint64_t[rowBufferCount];
     for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
     {
-        cachedRowBuffer[bufferIdx] = new CachedRowBuffer;
-        cachedRowBuffer[bufferIdx]->used = false;
-        cachedRowBuffer[bufferIdx]->dirty = new bool[rowBufferSize];
-        for( ncounter_t dirtyIdx = 0; dirtyIdx < rowBufferSize; dirtyIdx++ )
-        {
-            cachedRowBuffer[bufferIdx]->dirty[dirtyIdx] = false;
-        }
+        cachedRowBuffer[bufferIdx].used = false;
+        cachedRowBuffer[bufferIdx].colStart = 0;
+        cachedRowBuffer[bufferIdx].colEnd = 0;
+        cachedRowBuffer[bufferIdx].reads = 0;
+        cachedRowBuffer[bufferIdx].writes = 0;
+        cachedRowBuffer[bufferIdx].lastUse = 0;
+        cachedRowBuffer[bufferIdx].allocated = 0;
+        bufferKeys[bufferIdx] = invalidKey;
     }
 
+    validSectors.assign( rowBufferCount * sectorWords, 0 );
+    dirtySectors.assign( rowBufferCount * sectorWords, 0 );
+
     DDR3Bank::SetConfig( config, createChildren );
 }
 
 
-bool CachedDDR3Bank::Activate( NVMainRequest *request )
+uint64_t CachedDDR3Bank::BufferKey( NVMAddress& address )
 {
-    bool foundRDB = false;
+    return ( address.GetRow( ) << 32 ) | ( address.GetCol( ) / rowBufferSize );
+}
 
-    assert( nextActivate <= GetEventQueue()->GetCurrentCycle() );
 
-    /* See if there is an available row buffer. */
+/* Returns the buffer caching this row region, or rowBufferCount. */
+ncounter_t CachedDDR3Bank::FindBuffer( NVMAddress& address )
+{
+    uint64_t key = BufferKey( address );
+
     for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
     {
-        /* Check if this row is already active. For read-only, we must activate to allow for write-through to bank. */
-        if( cachedRowBuffer[bufferIdx]->used && 
-            request->address.GetRow( ) == cachedRowBuffer[bufferIdx]->address.GetRow( ) )
-        {
-            foundRDB = true;
-            break;
-        }
+        if( bufferKeys[bufferIdx] == key )
+            return bufferIdx;
+    }
+
+    return rowBufferCount;
+}
+
+
+ncounter_t CachedDDR3Bank::Sector( ncounter_t bufferIdx, NVMAddress& address )
+{
+    return ( address.GetCol( ) - cachedRowBuffer[bufferIdx].colStart ) / sectorSize;
+}
+
+
+bool CachedDDR3Bank::SectorValid( ncounter_t bufferIdx, NVMAddress& address )
+{
+    ncounter_t sector = Sector( bufferIdx, address );
+
+    return ( ( validSectors[bufferIdx * sectorWords + sector / 64] >> ( sector % 64 ) ) & 1 ) != 0;
+}
+
+
+/* Returns the buffer holding the requested sector, or rowBufferCount. */
+ncounter_t CachedDDR3Bank::InRDB( NVMainRequest *request )
+{
+    ncounter_t bufferIdx = FindBuffer( request->address );
 
-        /* Look for unused buffers. Don't break so the assertion is checked. */
-        if( !cachedRowBuffer[bufferIdx]->used && !foundRDB )
+    if( bufferIdx != rowBufferCount && !SectorValid( bufferIdx, request->address ) )
+        bufferIdx = rowBufferCount;
+
+    return bufferIdx;
+}
+
+
+void CachedDDR3Bank::Touch( ncounter_t bufferIdx )
+{
+    cachedRowBuffer[bufferIdx].lastUse = ++useCounter;
+}
+
+
+/*
+ *  Unused buffers are taken first. Otherwise LRU evicts the buffer with
+ *  the oldest access, where an allocation counts as an access, and FIFO
+ *  the oldest allocation.
+ */
+ncounter_t CachedDDR3Bank::ChooseVictim( )
+{
+    ncounter_t victim = 0;
+
+    for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
+    {
+        if( !cachedRowBuffer[bufferIdx].used )
+            return bufferIdx;
+    }
+
+    if( replacement == RDB_REPLACE_RANDOM )
+        return static_cast<ncounter_t>( replacementRng.NextBelow( rowBufferCount ) );
+
+    for( ncounter_t bufferIdx = 1; bufferIdx < rowBufferCount; bufferIdx++ )
+    {
+        if( replacement == RDB_REPLACE_FIFO 
+            ? cachedRowBuffer[bufferIdx].allocated < cachedRowBuffer[victim].allocated
+            : cachedRowBuffer[bufferIdx].lastUse < cachedRowBuffer[victim].lastUse )
         {
-            foundRDB = true;
-            cachedRowBuffer[bufferIdx]->used = true;
-            cachedRowBuffer[bufferIdx]->address = request->address;
-            cachedRowBuffer[bufferIdx]->colStart = request->address.GetCol() 
-                                                 - (request->address.GetCol() % rowBufferSize);
-            cachedRowBuffer[bufferIdx]->colEnd = cachedRowBuffer[bufferIdx]->colStart + rowBufferSize;
-            cachedRowBuffer[bufferIdx]->reads = 0;
-            cachedRowBuffer[bufferIdx]->writes = 0;
-
-            RDBAllocations++;
-
-            //std::cout << "[+]" << statName << ": Buffer " << bufferIdx << " bound to address 0x" << std::hex
-            //          << request->address.GetPhysicalAddress( ) << std::dec << " from col "
-            //          << cachedRowBuffer[bufferIdx]->colStart << " to col "
-            //          << cachedRowBuffer[bufferIdx]->colEnd << std::endl;
-
-            break;
+            victim = bufferIdx;
         }
     }
 
-    /* If we haven't found an RDB, evict the LRU row. */
+    return victim;
+}
+
+
+/*
+ *  Frees a buffer and returns the number of columns which must be written
+ *  back, i.e. the columns of its dirty sectors.
+ */
+ncounter_t CachedDDR3Bank::Release( ncounter_t bufferIdx )
+{
+    CachedRowBuffer& buffer = cachedRowBuffer[bufferIdx];
     ncounter_t dirtyCount = 0;
+    ncounter_t cleanCount = 0;
+
+    if( allocationReads.size( ) <= buffer.reads )
+        allocationReads.resize( buffer.reads + 1, 0 );
+    allocationReads[buffer.reads]++;
 
-    if( !foundRDB )
+    if( allocationWrites.size( ) <= buffer.writes )
+        allocationWrites.resize( buffer.writes + 1, 0 );
+    allocationWrites[buffer.writes]++;
+
+    for( ncounter_t word = bufferIdx * sectorWords; word < ( bufferIdx + 1 ) * sectorWords; word++ )
     {
-        ncounter_t bufferIdx = rowBufferCount - 1;
+        dirtyCount += PopCount64( dirtySectors[word] );
+        cleanCount += PopCount64( validSectors[word] & ~dirtySectors[word] );
 
-        if( allocationReadsMap.count( cachedRowBuffer[bufferIdx]->reads ) )
-            allocationReadsMap[ cachedRowBuffer[bufferIdx]->reads ]++;
-        else
-            allocationReadsMap[ cachedRowBuffer[bufferIdx]->reads ] = 1;
+        validSectors[word] = 0;
+        dirtySectors[word] = 0;
+    }
 
-        if( allocationWritesMap.count( cachedRowBuffer[bufferIdx]->writes ) )
-            allocationWritesMap[ cachedRowBuffer[bufferIdx]->writes ]++;
-        else
-            allocationWritesMap[ cachedRowBuffer[bufferIdx]->writes ] = 1;
+    writebackSectors += dirtyCount;
+    cleanSectorsSkipped += cleanCount;
+
+    buffer.used = false;
+    bufferKeys[bufferIdx] = invalidKey;
 
-        cachedRowBuffer[bufferIdx]->used = true;
-        cachedRowBuffer[bufferIdx]->address = request->address;
-        cachedRowBuffer[bufferIdx]->colStart = request->address.GetCol() 
-                                             - (request->address.GetCol() % rowBufferSize);
-        cachedRowBuffer[bufferIdx]->colEnd = cachedRowBuffer[bufferIdx]->colStart + rowBufferSize;
-        cachedRowBuffer[bufferIdx]->reads = 0;
-        cachedRowBuffer[bufferIdx]->writes = 0;
+    return dirtyCount * sectorSize;
+}
+
+
+bool CachedDDR3Bank::Activate( NVMainRequest *request )
+{
+    assert( nextActivate <= GetEventQueue()->GetCurrentCycle() );
+
+    /* Check if this row is already cached. For read-only, we must activate to allow for write-through to bank. */
+    ncounter_t bufferIdx = FindBuffer( request->address );
+    ncounter_t dirtyCount = 0;
+
+    /* Otherwise take an unused buffer or evict one, writing back its dirty sectors. */
+    if( bufferIdx == rowBufferCount )
+    {
+        bufferIdx = ChooseVictim( );
+
+        if( cachedRowBuffer[bufferIdx].used )
+            dirtyCount = Release( bufferIdx );
+
+        CachedRowBuffer& buffer = cachedRowBuffer[bufferIdx];
+
+        buffer.used = true;
+        buffer.address = request->address;
+        buffer.colStart = request->address.GetCol() 
+                        - (request->address.GetCol() % rowBufferSize);
+        buffer.colEnd = buffer.colStart + rowBufferSize;
+        buffer.reads = 0;
+        buffer.writes = 0;
+        /* A new buffer starts as the most recently used one. */
+        buffer.allocated = ++useCounter;
+        buffer.lastUse = buffer.allocated;
+        bufferKeys[bufferIdx] = BufferKey( request->address );
+
+        /* Without partial fills the whole region is read into the buffer. */
+        if( !partialFill )
+        {
+            for( ncounter_t sector = 0; sector < sectorCount; sector++ )
+                validSectors[bufferIdx * sectorWords + sector / 64] |= 1ULL << ( sector % 64 );
+
+            sectorFills += sectorCount;
+        }
 
         RDBAllocations++;
 
         //std::cout << "[+]" << statName << ": Buffer " << bufferIdx << " bound to address 0x" << std::hex
         //          << request->address.GetPhysicalAddress( ) << std::dec << " from col "
-        //          << cachedRowBuffer[bufferIdx]->colStart << " to col "
-        //          << cachedRowBuffer[bufferIdx]->colEnd << std::endl;
+        //          << buffer.colStart << " to col " << buffer.colEnd << std::endl;
+    }
 
-        for( ncounter_t dirtyIdx = 0; dirtyIdx < rowBufferSize; dirtyIdx++ )
-        {
-            if( cachedRowBuffer[bufferIdx]->dirty[dirtyIdx] )
-                dirtyCount++;
+    /* Partial fills only bring in the requested sector. */
+    ncounter_t fillSize = rowBufferSize;
+
+    if( partialFill )
+    {
+        ncounter_t sector = Sector( bufferIdx, request->address );
 
-            cachedRowBuffer[bufferIdx]->dirty[dirtyIdx] = false;
+        if( !SectorValid( bufferIdx, request->address ) )
+        {
+            validSectors[bufferIdx * sectorWords + sector / 64] |= 1ULL << ( sector % 64 );
+            sectorFills++;
         }
 
-        writebackCount += dirtyCount;
+        fillSize = sectorSize;
     }
 
+    writebackCount += dirtyCount;
+
     assert( !(readOnlyBuffers && dirtyCount > 0) );
 
     ncycle_t activateTimer = 0;
@@ -202,7 +352,7 @@ bool CachedDDR3Bank::Activate( NVMainRequest *request )
     }
 
     activateTimer += p->tRCD;                       /* The activate issued to this method. */
-    activateTimer += rowBufferSize * p->tCCD;       /* The time to read the selected row region. */
+    activateTimer += fillSize * p->tCCD;            /* The time to read the selected row region. */
 
     /* 
      * Update timing constraints.
@@ -210,8 +360,8 @@ bool CachedDDR3Bank::Activate( NVMainRequest *request )
      * Assume we can write immediately after activate, and can read after one burst (Assumes 
      * trigger request is prioritized...) 
      */
-    nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + activateTimer - p->tAL - rowBufferSize * p->tCCD + p->tCCD );
-    nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + activateTimer - p->tAL - rowBufferSize * p->tCCD );
+    nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + activateTimer - p->tAL - fillSize * p->tCCD + p->tCCD );
+    nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + activateTimer - p->tAL - fillSize * p->tCCD );
     /* Don't allow closing the row until the RDB is full. */
     nextPrecharge = MAX( nextPrecharge, GetEventQueue()->GetCurrentCycle() + MAX(activateTimer, p->tRAS) );
     nextPowerDown = MAX( nextPowerDown, GetEventQueue()->GetCurrentCycle() + MAX(activateTimer, p->tRAS) );
@@ -228,7 +378,7 @@ bool CachedDDR3Bank::Activate( NVMainRequest *request )
     {
         /* bank-level update */
         openRow = activateRow;
-        state = DDR3BANK_OPEN;
+        SetState( DDR3BANK_OPEN );
         activeSubArrayQueue.push_front( activateSubArray );
         activates++;
     }
@@ -244,152 +394,96 @@ bool CachedDDR3Bank::Activate( NVMainRequest *request )
 
 bool CachedDDR3Bank::Read( NVMainRequest *request )
 {
-    bool rv = false;
-
     /* Check if this is in the RDB. */
-    for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
-    {
-        if( cachedRowBuffer[bufferIdx]->address.GetRow( ) == request->address.GetRow( )
-            && request->address.GetCol( ) >= cachedRowBuffer[bufferIdx]->colStart
-            && request->address.GetCol( ) <  cachedRowBuffer[bufferIdx]->colEnd )
-        {
-            rv = true;
-
-            /* Only update read and write based on RDB timings; other commands will bypass RDB. */
-            nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
-            nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) + p->tRTRS );
-
-            /* Assume the data is placed on the bus immediately after the command. */
-            NVMainRequest *busReq = new NVMainRequest( );
-            *busReq = *request;
-            busReq->type = BUS_READ;
-            busReq->owner = this;
+    ncounter_t bufferIdx = InRDB( request );
 
-            GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
-                    GetEventQueue()->GetCurrentCycle() + 1 );
+    if( bufferIdx == rowBufferCount )
+        return DDR3Bank::Read( request );
 
-            /* Notify owner of read completion as well */
-            GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-                    GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
+    /* Only update read and write based on RDB timings; other commands will bypass RDB. */
+    nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
+    nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) + p->tRTRS );
 
-            /* Swap the cached status back to normal. */
-            request->type = (request->type == CACHED_READ ? READ : request->type);
+    /* Assume the data is placed on the bus immediately after the command. */
+    NVMainRequest *busReq = new NVMainRequest( );
+    *busReq = *request;
+    busReq->type = BUS_READ;
+    busReq->owner = this;
 
-            //std::cout << "[+]" << GetEventQueue()->GetCurrentCycle() << " " << statName 
-            //          << ": Served read request 0x" << std::hex
-            //          << request->address.GetPhysicalAddress() << std::dec << std::endl;
-            
-            RDBReads++;
-            cachedRowBuffer[bufferIdx]->reads++;
+    GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
+            GetEventQueue()->GetCurrentCycle() + 1 );
 
-            /* Move this buffer to LRU. */
-            CachedRowBuffer *tempBuffer = cachedRowBuffer[bufferIdx];
+    /* Notify owner of read completion as well */
+    GetEventQueue( )->InsertEvent( EventResponse, this, request, 
+            GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
 
-            for( uint64_t j = bufferIdx; j > 0; j-- )
-            {
-                cachedRowBuffer[j] = cachedRowBuffer[j-1];
-            }
+    /* Swap the cached status back to normal. */
+    request->type = (request->type == CACHED_READ ? READ : request->type);
 
-            cachedRowBuffer[0] = tempBuffer;
-
-            break;
-        }
-    }
+    //std::cout << "[+]" << GetEventQueue()->GetCurrentCycle() << " " << statName 
+    //          << ": Served read request 0x" << std::hex
+    //          << request->address.GetPhysicalAddress() << std::dec << std::endl;
+    
+    RDBReads++;
+    cachedRowBuffer[bufferIdx].reads++;
 
-    if( !rv )
-    {
-        rv = DDR3Bank::Read( request );
-    }
+    Touch( bufferIdx );
 
-    return rv;
+    return true;
 }
 
 
 bool CachedDDR3Bank::Write( NVMainRequest *request )
 {
-    bool rv = false;
-
     /* Check if this is in the RDB. */
-    if( !readOnlyBuffers )
-    {
-        for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
-        {
-            if( cachedRowBuffer[bufferIdx]->address.GetRow( ) == request->address.GetRow( )
-                && request->address.GetCol( ) >= cachedRowBuffer[bufferIdx]->colStart
-                && request->address.GetCol( ) <  cachedRowBuffer[bufferIdx]->colEnd )
-            {
-                rv = true;
-
-                /* Only update read and write based on RDB timings; other commands will bypass RDB. */
-                nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) + p->tRTRS );
-                nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
+    ncounter_t bufferIdx = ( readOnlyBuffers ? rowBufferCount : InRDB( request ) );
 
-                /* Set this word to be dirty. */
-                cachedRowBuffer[bufferIdx]->dirty[request->address.GetCol( )] = true;
+    if( bufferIdx == rowBufferCount )
+        return DDR3Bank::Write( request );
 
-                /* Assume the data is placed on the bus immediately after the command. */
-                NVMainRequest *busReq = new NVMainRequest( );
-                *busReq = *request;
-                busReq->type = BUS_WRITE;
-                busReq->owner = this;
+    /* Only update read and write based on RDB timings; other commands will bypass RDB. */
+    nextRead = MAX( nextRead, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) + p->tRTRS );
+    nextWrite = MAX( nextWrite, GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
 
-                GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
-                        GetEventQueue()->GetCurrentCycle() + 1 );
+    /* Set this sector to be dirty. */
+    ncounter_t sector = Sector( bufferIdx, request->address );
+    dirtySectors[bufferIdx * sectorWords + sector / 64] |= 1ULL << ( sector % 64 );
 
-                /* Notify owner of read completion as well */
-                GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-                        GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
+    /* Assume the data is placed on the bus immediately after the command. */
+    NVMainRequest *busReq = new NVMainRequest( );
+    *busReq = *request;
+    busReq->type = BUS_WRITE;
+    busReq->owner = this;
 
-                /* Swap the cached status back to normal. */
-                request->type = (request->type == CACHED_WRITE ? WRITE : request->type);
+    GetEventQueue( )->InsertEvent( EventResponse, this, busReq, 
+            GetEventQueue()->GetCurrentCycle() + 1 );
 
-                //std::cout << "[+]" << GetEventQueue()->GetCurrentCycle() << " " << statName 
-                //          << ": Served write request 0x" << std::hex
-                //          << request->address.GetPhysicalAddress() << std::dec << std::endl;
+    /* Notify owner of read completion as well */
+    GetEventQueue( )->InsertEvent( EventResponse, this, request, 
+            GetEventQueue()->GetCurrentCycle() + MAX( p->tBURST, p->tRDB ) );
 
-                RDBWrites++;
-                cachedRowBuffer[bufferIdx]->writes++;
+    /* Swap the cached status back to normal. */
+    request->type = (request->type == CACHED_WRITE ? WRITE : request->type);
 
-                /* Move this buffer to LRU. */
-                CachedRowBuffer *tempBuffer = cachedRowBuffer[bufferIdx];
+    //std::cout << "[+]" << GetEventQueue()->GetCurrentCycle() << " " << statName 
+    //          << ": Served write request 0x" << std::hex
+    //          << request->address.GetPhysicalAddress() << std::dec << std::endl;
 
-                for( uint64_t j = bufferIdx; j > 0; j-- )
-                {
-                    cachedRowBuffer[j] = cachedRowBuffer[j-1];
-                }
+    RDBWrites++;
+    cachedRowBuffer[bufferIdx].writes++;
 
-                cachedRowBuffer[0] = tempBuffer;
+    Touch( bufferIdx );
 
-                break;
-            }
-        }
-    }
-
-    if( !rv )
-    {
-        rv = DDR3Bank::Write( request );
-    }
-
-    return rv;
+    return true;
 }
 
 
 bool CachedDDR3Bank::IsIssuable( NVMainRequest *request, FailReason *reason )
 {
     bool rv = false; 
-    bool inRDB = false;
+    bool inRDB = ( InRDB( request ) != rowBufferCount );
     bool cacheableRequest = false;
 
-    for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
-    {
-        if( cachedRowBuffer[bufferIdx]->address.GetRow( ) == request->address.GetRow( )
-            && request->address.GetCol( ) >= cachedRowBuffer[bufferIdx]->colStart
-            && request->address.GetCol( ) <  cachedRowBuffer[bufferIdx]->colEnd )
-        {
-            inRDB = true;
-        }
-    }
-
     if( request->type == READ || request->type == READ_PRECHARGE || request->type == CACHED_READ ||
         ( !readOnlyBuffers && (request->type == WRITE || request->type == WRITE_PRECHARGE 
                                || request->type == CACHED_WRITE )
@@ -427,17 +521,142 @@ void CachedDDR3Bank::RegisterStats( )
     AddStat(inRDBCount);
     AddStat(RDBAllocations);
     AddStat(writebackCount);
+    AddStat(writebackSectors);
+    AddStat(cleanSectorsSkipped);
+    AddStat(sectorFills);
     AddStat(RDBReads);
     AddStat(RDBWrites);
     AddStat(allocationReadsHisto);
     AddStat(allocationWritesHisto);
+
+    /* The rank sums the bank energy and request stats. */
+    DDR3Bank::RegisterStats( );
 }
 
 void CachedDDR3Bank::CalculateStats( )
 {
+    std::map<uint64_t, uint64_t> allocationReadsMap, allocationWritesMap;
+
+    for( uint64_t count = 0; count < allocationReads.size( ); count++ )
+    {
+        if( allocationReads[count] != 0 )
+            allocationReadsMap[count] = allocationReads[count];
+    }
+
+    for( uint64_t count = 0; count < allocationWrites.size( ); count++ )
+    {
+        if( allocationWrites[count] != 0 )
+            allocationWritesMap[count] = allocationWrites[count];
+    }
+
     allocationReadsHisto = PyDictHistogram<uint64_t, uint64_t>( allocationReadsMap );
     allocationWritesHisto = PyDictHistogram<uint64_t, uint64_t>( allocationWritesMap );
+
+    DDR3Bank::CalculateStats( );
+}
+
+/*
+ *  The row buffers are saved next to the bank state. The buffers of a
+ *  checkpoint with a different buffer geometry are left empty.
+ */
+void CachedDDR3Bank::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ) + ".rowBuffers", 1 );
+
+    if( cpt.IsOpen( ) )
+    {
+        cpt.Write( rowBufferCount );
+        cpt.Write( sectorWords );
+        cpt.Write( useCounter );
+
+        for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
+        {
+            CachedRowBuffer& buffer = cachedRowBuffer[bufferIdx];
+
+            cpt.Write( buffer.used );
+            cpt.WriteAddress( buffer.address );
+            cpt.Write( buffer.colStart );
+            cpt.Write( buffer.colEnd );
+            cpt.Write( buffer.reads );
+            cpt.Write( buffer.writes );
+            cpt.Write( buffer.lastUse );
+            cpt.Write( buffer.allocated );
+            cpt.Write( bufferKeys[bufferIdx] );
+        }
+
+        for( size_t word = 0; word < validSectors.size( ); word++ )
+        {
+            cpt.Write( validSectors[word] );
+            cpt.Write( dirtySectors[word] );
+        }
+
+        cpt.Write( allocationReads.size( ) );
+        for( size_t count = 0; count < allocationReads.size( ); count++ )
+            cpt.Write( allocationReads[count] );
+
+        cpt.Write( allocationWrites.size( ) );
+        for( size_t count = 0; count < allocationWrites.size( ); count++ )
+            cpt.Write( allocationWrites[count] );
+
+        replacementRng.WriteCheckpoint( cpt );
+    }
+
+    DDR3Bank::CreateCheckpoint( dir );
 }
 
+void CachedDDR3Bank::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ) + ".rowBuffers", 1 );
+
+    if( cpt.IsOpen( ) )
+    {
+        ncounter_t savedBuffers = cpt.Read( );
+        ncounter_t savedWords = cpt.Read( );
 
+        if( savedBuffers != rowBufferCount || savedWords != sectorWords )
+        {
+            std::cout << "[+] " << StatName( ) << ": Warning: Row buffer checkpoint "
+                      << "differs from the configuration. Skipping restore." << std::endl;
+        }
+        else
+        {
+            useCounter = cpt.Read( );
+
+            for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
+            {
+                CachedRowBuffer& buffer = cachedRowBuffer[bufferIdx];
+
+                buffer.used = ( cpt.Read( ) != 0 );
+                cpt.ReadAddress( buffer.address );
+                buffer.colStart = cpt.Read( );
+                buffer.colEnd = cpt.Read( );
+                buffer.reads = cpt.Read( );
+                buffer.writes = cpt.Read( );
+                buffer.lastUse = cpt.Read( );
+                buffer.allocated = cpt.Read( );
+                bufferKeys[bufferIdx] = cpt.Read( );
+            }
 
+            for( size_t word = 0; word < validSectors.size( ); word++ )
+            {
+                validSectors[word] = cpt.Read( );
+                dirtySectors[word] = cpt.Read( );
+            }
+
+            allocationReads.resize( cpt.Read( ) );
+            for( size_t count = 0; count < allocationReads.size( ) && cpt.Good( ); count++ )
+                allocationReads[count] = cpt.Read( );
+
+            allocationWrites.resize( cpt.Read( ) );
+            for( size_t count = 0; count < allocationWrites.size( ) && cpt.Good( ); count++ )
+                allocationWrites[count] = cpt.Read( );
+
+            replacementRng.ReadCheckpoint( cpt );
+
+            if( !cpt.Good( ) )
+                std::cout << "[+] " << StatName( ) << ": Warning: Checkpoint is truncated." << std::endl;
+        }
+    }
+
+    DDR3Bank::RestoreCheckpoint( dir );
+}
@@ -37,19 +37,31 @@
 #define __CACHEDDDR3BANK_H__
 
 #include "Banks/DDR3Bank/DDR3Bank.h"
+#include "include/NVMRandom.h"
+
+#include <vector>
 
 namespace NVM {
 
 
+enum RowBufferReplacement { RDB_REPLACE_LRU, RDB_REPLACE_FIFO, RDB_REPLACE_RANDOM };
+
+
+/*
+ *  A cached row region is split into sectors of CachedRowSectorSize
+ *  columns. Valid and dirty state is kept as one bit per sector in the
+ *  bank's bitmap arrays, so write backs only touch the dirty sectors.
+ */
 struct CachedRowBuffer
 {
     bool used;
     NVMAddress address;
-    bool *dirty;
     ncounter_t colStart;
     ncounter_t colEnd;
     ncounter_t reads;
     ncounter_t writes;
+    ncounter_t lastUse;
+    ncounter_t allocated;
 };
 
 
@@ -70,20 +82,49 @@ class CachedDDR3Bank : public DDR3Bank
     virtual void RegisterStats( );
     virtual void CalculateStats( );
 
+    virtual void CreateCheckpoint( std::string dir );
+    virtual void RestoreCheckpoint( std::string dir );
+
   private:
-    CachedRowBuffer **cachedRowBuffer;
+    CachedRowBuffer *cachedRowBuffer;
     bool readOnlyBuffers;
+    bool partialFill;
     ncounter_t rowBufferSize;
     ncounter_t rowBufferCount;
+    ncounter_t sectorSize, sectorCount, sectorWords;
+    RowBufferReplacement replacement;
+    RandomGenerator replacementRng;
+    ncounter_t useCounter;
+
+    /*
+     *  Tag CAM: one key (row and region of the row) per buffer, searched
+     *  in one pass. Unused buffers hold invalidKey.
+     */
+    static const uint64_t invalidKey = ~0ULL;
+    uint64_t *bufferKeys;
+
+    std::vector<uint64_t> validSectors;
+    std::vector<uint64_t> dirtySectors;
+
     ncounter_t inRDBCount;
     ncounter_t RDBAllocations;
     ncounter_t writebackCount;
+    ncounter_t writebackSectors, cleanSectorsSkipped;
+    ncounter_t sectorFills;
     ncounter_t RDBReads, RDBWrites;
-    std::map<uint64_t, uint64_t> allocationReadsMap; // Number of reads in an allocation, Count
-    std::map<uint64_t, uint64_t> allocationWritesMap;
+    std::vector<uint64_t> allocationReads; // Count of allocations, indexed by reads in the allocation
+    std::vector<uint64_t> allocationWrites;
     std::string allocationReadsHisto;
     std::string allocationWritesHisto;
 
+    uint64_t BufferKey( NVMAddress& address );
+    ncounter_t FindBuffer( NVMAddress& address );
+    ncounter_t ChooseVictim( );
+    ncounter_t Sector( ncounter_t bufferIdx, NVMAddress& address );
+    bool SectorValid( ncounter_t bufferIdx, NVMAddress& address );
+    ncounter_t InRDB( NVMainRequest *request );
+    void Touch( ncounter_t bufferIdx );
+    ncounter_t Release( ncounter_t bufferIdx );
 };
 
 
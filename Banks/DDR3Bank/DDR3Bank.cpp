@@ -36,6 +36,7 @@
 #include "Banks/DDR3Bank/DDR3Bank.h"
 #include "src/MemoryController.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <signal.h>
 #include <cassert>
@@ -68,6 +69,7 @@ DDR3Bank::DDR3Bank( )
     MATHeight = 512;
 
     state = DDR3BANK_CLOSED;
+    stateSettledCycle = 0;
     lastActivate = 0;
     openRow = 0;
 
@@ -166,7 +168,7 @@ void DDR3Bank::SetConfig( Config *config, bool createChildren )
 
 void DDR3Bank::RegisterStats( )
 {
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         AddUnitStat(bankEnergy, "mA*t");
         AddUnitStat(activeEnergy, "mA*t");
@@ -233,7 +235,7 @@ bool DDR3Bank::PowerDown( NVMainRequest *request )
         if( state == DDR3BANK_OPEN )
         {
             assert( request->type == POWERDOWN_PDA );
-            state = DDR3BANK_PDA;
+            SetState( DDR3BANK_PDA );
         }
         else if( state == DDR3BANK_CLOSED )
         {
@@ -241,15 +243,15 @@ bool DDR3Bank::PowerDown( NVMainRequest *request )
             {
                 case POWERDOWN_PDA:
                 case POWERDOWN_PDPF:
-                    state = DDR3BANK_PDPF;
+                    SetState( DDR3BANK_PDPF );
                     break;
 
                 case POWERDOWN_PDPS:
-                    state = DDR3BANK_PDPS;
+                    SetState( DDR3BANK_PDPS );
                     break;
 
                 default:
-                    state = DDR3BANK_PDPF;
+                    SetState( DDR3BANK_PDPF );
                     break;
             }
         }
@@ -298,9 +300,9 @@ bool DDR3Bank::PowerUp( NVMainRequest * /*request*/ )
          */
 
         if( state == DDR3BANK_PDA )
-            state = DDR3BANK_OPEN;
+            SetState( DDR3BANK_OPEN );
         else
-            state = DDR3BANK_CLOSED;
+            SetState( DDR3BANK_CLOSED );
 
         returnValue = true;
     }
@@ -351,7 +353,7 @@ bool DDR3Bank::Activate( NVMainRequest *request )
     {
         /* bank-level update */
         openRow = activateRow;
-        state = DDR3BANK_OPEN;
+        SetState( DDR3BANK_OPEN );
         activeSubArrayQueue.push_front( activateSubArray );
         activates++;
     }
@@ -433,7 +435,7 @@ bool DDR3Bank::Read( NVMainRequest *request )
             }
 
             if( activeSubArrayQueue.empty() )
-                state = DDR3BANK_CLOSED;
+                SetState( DDR3BANK_CLOSED );
         } // if( request->type == READ_PRECHARGE )
 
         dataCycles += p->tBURST;
@@ -525,7 +527,7 @@ bool DDR3Bank::Write( NVMainRequest *request )
             }
 
             if( activeSubArrayQueue.empty( ) )
-                state = DDR3BANK_CLOSED;
+                SetState( DDR3BANK_CLOSED );
         }
     }
     else
@@ -594,7 +596,7 @@ bool DDR3Bank::LoadWeight( NVMainRequest *request )
         }
 
         if( activeSubArrayQueue.empty() )
-            state = DDR3BANK_CLOSED;
+            SetState( DDR3BANK_CLOSED );
     } // if( request->type == READ_PRECHARGE )
 
     //dataCycles += p->tBURST; 
@@ -660,7 +662,7 @@ bool DDR3Bank::Transfer( NVMainRequest *request )
         }
 
         if( activeSubArrayQueue.empty() )
-            state = DDR3BANK_CLOSED;
+            SetState( DDR3BANK_CLOSED );
     } // if( request->type == READ_PRECHARGE )
 
     //dataCycles += p->tBURST; 
@@ -726,7 +728,7 @@ bool DDR3Bank::ReadCycle( NVMainRequest *request )
         }
 
         if( activeSubArrayQueue.empty() )
-            state = DDR3BANK_CLOSED;
+            SetState( DDR3BANK_CLOSED );
     } // if( request->type == READ_PRECHARGE )
 
     //dataCycles += p->tBURST; 
@@ -848,7 +850,7 @@ bool DDR3Bank::WriteCycle( NVMainRequest *request )
         }
 
         if( activeSubArrayQueue.empty() )
-            state = DDR3BANK_CLOSED;
+            SetState( DDR3BANK_CLOSED );
     } // if( request->type == READ_PRECHARGE )
 
     //dataCycles += p->tBURST; 
@@ -963,7 +965,7 @@ bool DDR3Bank::Precharge( NVMainRequest *request )
     } 
 
     if( activeSubArrayQueue.empty( ) )
-        state = DDR3BANK_CLOSED;
+        SetState( DDR3BANK_CLOSED );
 
     precharges++;
 
@@ -1276,6 +1278,11 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
     return rv;
 }
 
+bool DDR3Bank::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 /*
  * IssueCommand() issue the command so that bank status will be updated
  */
@@ -1378,7 +1385,7 @@ void DDR3Bank::CalculatePower( )
         return;
     }
 
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         bankPower = ( bankEnergy * p->Voltage ) / (double)simulationTime / 1000.0f; 
         activePower = ( activeEnergy * p->Voltage ) / (double)simulationTime / 1000.0f; 
@@ -1430,6 +1437,8 @@ void DDR3Bank::CalculateStats( )
 {
     NVMObject::CalculateStats( );
 
+    SettleStateCycles( );
+
     double idealBandwidth;
 
     idealBandwidth = (double)(p->CLK * p->RATE * p->BusWidth);
@@ -1476,6 +1485,73 @@ void DDR3Bank::CalculateStats( )
     averageEndurance /= GetChildCount( );
 }
 
+void DDR3Bank::CreateCheckpoint( std::string dir )
+{
+    /* The residency counters are saved with the stats. */
+    SettleStateCycles( );
+
+    CheckpointWriter cpt( dir, StatName( ), 1 );
+
+    if( cpt.IsOpen( ) )
+    {
+        cpt.Write( state );
+        cpt.Write( openRow );
+        cpt.Write( lastActivate );
+        cpt.Write( nextActivate );
+        cpt.Write( nextPrecharge );
+        cpt.Write( nextRead );
+        cpt.Write( nextWrite );
+        cpt.Write( nextRefresh );
+        cpt.Write( nextRefreshDone );
+        cpt.Write( nextPowerDown );
+        cpt.Write( nextPowerDownDone );
+        cpt.Write( nextPowerUp );
+        cpt.Write( writeCycle );
+        cpt.Write( idleTimer );
+
+        cpt.Write( activeSubArrayQueue.size( ) );
+        for( size_t i = 0; i < activeSubArrayQueue.size( ); i++ )
+            cpt.Write( activeSubArrayQueue[i] );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void DDR3Bank::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ), 1 );
+
+    if( cpt.IsOpen( ) )
+    {
+        state = static_cast<DDR3BankState>( cpt.Read( ) );
+        openRow = cpt.Read( );
+        lastActivate = cpt.Read( );
+        nextActivate = cpt.Read( );
+        nextPrecharge = cpt.Read( );
+        nextRead = cpt.Read( );
+        nextWrite = cpt.Read( );
+        nextRefresh = cpt.Read( );
+        nextRefreshDone = cpt.Read( );
+        nextPowerDown = cpt.Read( );
+        nextPowerDownDone = cpt.Read( );
+        nextPowerUp = cpt.Read( );
+        writeCycle = ( cpt.Read( ) != 0 );
+        idleTimer = cpt.Read( );
+
+        uint64_t activeCount = cpt.Read( );
+
+        activeSubArrayQueue.clear( );
+        for( uint64_t i = 0; i < activeCount && cpt.Good( ); i++ )
+            activeSubArrayQueue.push_back( cpt.Read( ) );
+
+        if( !cpt.Good( ) )
+            std::cout << "[+] " << StatName( ) << ": Warning: Checkpoint is truncated." << std::endl;
+    }
+
+    stateSettledCycle = GetEventQueue( )->GetCurrentCycle( );
+
+    NVMObject::RestoreCheckpoint( dir );
+}
 
 bool DDR3Bank::Idle( )
 {
@@ -1492,8 +1568,27 @@ bool DDR3Bank::Idle( )
     return bankIdle;
 }
 
-void DDR3Bank::Cycle( ncycle_t steps )
+/*
+ *  State residency is counted when the state changes and when stats are
+ *  calculated, so the bank has nothing to do on wake ups.
+ */
+void DDR3Bank::Cycle( ncycle_t /*steps*/ )
+{
+}
+
+void DDR3Bank::SetState( DDR3BankState newState )
+{
+    SettleStateCycles( );
+    state = newState;
+}
+
+void DDR3Bank::SettleStateCycles( )
 {
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+    ncycle_t steps = now - stateSettledCycle;
+
+    stateSettledCycle = now;
+
     /* Count cycle numbers for each state */
     /* Number of fast exit prechage standbys */
     if( state == DDR3BANK_PDPF )
@@ -82,6 +82,7 @@ class DDR3Bank : public Bank
 
     virtual bool IsIssuable( NVMainRequest *req, FailReason *reason = NULL );
     virtual bool IssueCommand( NVMainRequest *req );
+    virtual bool IssueAtomic( NVMainRequest *req );
     virtual ncycle_t NextIssuable( NVMainRequest *request );
 
     virtual void SetConfig( Config *c, bool createChildren = true );
@@ -102,6 +103,9 @@ class DDR3Bank : public Bank
     virtual void RegisterStats( );
     virtual void CalculateStats( );
 
+    virtual void CreateCheckpoint( std::string dir );
+    virtual void RestoreCheckpoint( std::string dir );
+
     virtual ncounter_t GetId( );
     virtual std::string GetName( );
 
@@ -125,6 +129,9 @@ class DDR3Bank : public Bank
     ncounter_t slowExitPrechargeCycles;
     ncounter_t powerCycles;
 
+    /* Cycles in the current state up to here are already counted. */
+    ncycle_t stateSettledCycle;
+
     ncycle_t lastActivate;
     ncycle_t nextActivate;
     ncycle_t nextPrecharge;
@@ -179,6 +186,9 @@ class DDR3Bank : public Bank
     virtual bool PostRead( NVMainRequest *request );
     virtual bool WriteCycle( NVMainRequest *request );
     //virtual bool Compute( NVMainRequest *request );
+
+    void SetState( DDR3BankState newState );
+    void SettleStateCycles( );
 };
 
 };
@@ -32,6 +32,8 @@
 *******************************************************************************/
 
 #include "DataEncoders/FlipNWrite/FlipNWrite.h"
+#include "include/NVMHelpers.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
 
@@ -131,8 +133,8 @@ ncycle_t FlipNWrite::Write( NVMainRequest *request )
     NVMAddress address = request->address;
 
     /*
-     *  The default life map is an stl map< uint64_t, uint64_t >. 
-     *  You may map row and col to this map_key however you want.
+     *  The default life table is indexed by a uint64_t key. You
+     *  may map row and col to this map_key however you want.
      *  It is up to you to ensure there are no collisions here.
      */
     uint64_t row;
@@ -142,14 +144,13 @@ ncycle_t FlipNWrite::Write( NVMainRequest *request )
     request->address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
 
     /*
-     *  If using the default life map, we can call the DecrementLife
+     *  If using the default life table, we can call the DecrementLife
      *  function which will check if the map_key already exists. If so,
      *  the life value is decremented (write count incremented). Otherwise 
      *  the map_key is inserted with a write count of 1.
      */
     uint64_t rowSize;
     uint64_t wordSize;
-    uint64_t currentBit;
     uint64_t flipPartitions;
     uint64_t rowPartitions;
     int *modifyCount;
@@ -163,16 +164,11 @@ ncycle_t FlipNWrite::Write( NVMainRequest *request )
     
     flipPartitions = ( wordSize * 8 ) / fpSize; 
 
-    modifyCount = new int[ flipPartitions ];
-
     /*
      *  Count the number of bits that are modified. If it is more than
      *  half, then we will invert the data then write.
      */
-    for( uint64_t i = 0; i < flipPartitions; i++ )
-        modifyCount[i] = 0;
-
-    currentBit = 0;
+    modifyCount = new int[ flipPartitions ];
 
     /* Get what is currently in the memory (i.e., if it was previously flipped, get the flipped data. */
     for( uint64_t i = 0; i < flipPartitions; i++ )
@@ -185,42 +181,11 @@ ncycle_t FlipNWrite::Write( NVMainRequest *request )
         }
     }
 
-    /* Check each byte to see if it was modified */
-    for( uint64_t i = 0; i < wordSize; ++i )
+    /* Count the modified bits in each partition, a word at a time. */
+    for( uint64_t i = 0; i < flipPartitions; i++ )
     {
-        /*
-         *  If no bytes have changed we can just continue. Yes, I know this
-         *  will check the byte 8 times, but i'd rather not change the iter.
-         */
-        uint8_t oldByte, newByte;
-
-        oldByte = oldData.GetByte( i );
-        newByte = newData.GetByte( i );
-
-        if( oldByte == newByte )
-        {
-            currentBit += 8;
-            continue;
-        }
-
-        /*
-         *  If the bytes are different, then at least one bit has changed.
-         *  check each bit individually.
-         */
-        for( int j = 0; j < 8; j++ )
-        {
-            uint8_t oldBit, newBit;
-
-            oldBit = ( oldByte >> j ) & 0x1;
-            newBit = ( newByte >> j ) & 0x1;
-
-            if( oldBit != newBit )
-            {
-                modifyCount[(int)(currentBit/fpSize)]++;
-            }
-
-            currentBit++;
-        }
+        modifyCount[i] = static_cast<int>( CountBitFlips( newData, oldData, 
+                                           i*fpSize, (i+1)*fpSize ) );
     }
 
     /*
@@ -262,7 +227,7 @@ ncycle_t FlipNWrite::Write( NVMainRequest *request )
         }
     }
 
-    delete modifyCount;
+    delete [] modifyCount;
     
     return rv;
 }
@@ -274,3 +239,23 @@ void FlipNWrite::CalculateStats( )
     else
         flipNWriteReduction = 100.0;
 }
+
+void FlipNWrite::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ), 1 );
+
+    if( cpt.IsOpen( ) )
+        cpt.WriteSet( flippedAddresses );
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void FlipNWrite::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ), 1 );
+
+    if( cpt.IsOpen( ) )
+        cpt.ReadSet( flippedAddresses );
+
+    NVMObject::RestoreCheckpoint( dir );
+}
@@ -53,6 +53,9 @@ class FlipNWrite : public DataEncoder
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private:
     std::set< uint64_t > flippedAddresses;
   
@@ -32,6 +32,7 @@
 *******************************************************************************/
 
 #include "Decoders/Migrator/Migrator.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
 #include <sstream>
@@ -46,9 +47,16 @@ Migrator::Migrator( )
     outputPage = 0;
     
     migratedAccesses = 0;
+    remapTableFull = 0;
+    remapOccupancy = 0.0;
 
-    migrationMap.clear( );
-    migrationState.clear( );
+    remapMask = 0;
+    remapCapacity = 0;
+    remapEntries = 0;
+    lookupLatency = 0;
+
+    /* 64 KiB of SRAM with 8 byte entries unless configured. */
+    SetRemapCapacity( 8192 );
 }
 
 
@@ -69,12 +77,124 @@ void Migrator::SetConfig( Config *config, bool /*createChildren*/ )
     numBanks = config->GetValue( "BANKS" );
     numRanks = config->GetValue( "RANKS" );
     numSubarrays = config->GetValue( "ROWS" ) / config->GetValue( "MATHeight" );
+
+    /* The remap table holds as many entries as fit in the SRAM budget. */
+    uint64_t sramBytes = 65536;
+    uint64_t entryBytes = 8;
+    ncounter_t capacity;
+
+    config->GetValueUL( "MigratorSRAMBytes", sramBytes );
+    config->GetValueUL( "MigratorRemapEntryBytes", entryBytes );
+
+    if( entryBytes == 0 )
+        entryBytes = 8;
+
+    capacity = sramBytes / entryBytes;
+    config->GetValueUL( "MigratorRemapEntries", capacity );
+
+    SetRemapCapacity( capacity );
+
+    /* SRAM lookup on every request before it reaches a channel. */
+    config->GetValueUL( "MigratorLookupLatency", lookupLatency );
 }
 
 
 void Migrator::RegisterStats( )
 {
     AddStat(migratedAccesses);
+    AddStat(remapEntries);
+    AddStat(remapCapacity);
+    AddStat(remapOccupancy);
+    AddStat(remapTableFull);
+}
+
+
+void Migrator::CalculateStats( )
+{
+    remapOccupancy = 0.0;
+    if( remapCapacity > 0 )
+        remapOccupancy = static_cast<double>(remapEntries) / static_cast<double>(remapCapacity);
+}
+
+
+/*
+ *  The hash table has at least twice as many slots as the capacity so the
+ *  linear probes stay short when the table is full. Every level of the
+ *  memory hierarchy gets a decoder, but only the one doing migrations ever
+ *  inserts, so the slots are allocated on first use.
+ */
+void Migrator::SetRemapCapacity( ncounter_t capacity )
+{
+    uint64_t slots = 1;
+
+    if( capacity == 0 )
+        capacity = 1;
+
+    while( slots < capacity * 2 )
+        slots <<= 1;
+
+    remapTable.clear( );
+    remapMask = slots - 1;
+    remapCapacity = capacity;
+    remapEntries = 0;
+}
+
+
+RemapEntry *Migrator::FindEntry( uint64_t key )
+{
+    if( remapTable.empty( ) )
+        return NULL;
+
+    uint64_t slot = ( ( key * 0x9E3779B97F4A7C15ULL ) >> 17 ) & remapMask;
+
+    while( remapTable[slot].key != emptyKey )
+    {
+        if( remapTable[slot].key == key )
+            return &remapTable[slot];
+
+        slot = ( slot + 1 ) & remapMask;
+    }
+
+    return NULL;
+}
+
+
+/* Returns the entry for key, claiming a new one if needed. */
+RemapEntry *Migrator::InsertEntry( uint64_t key )
+{
+    if( remapTable.empty( ) )
+    {
+        RemapEntry empty;
+
+        empty.key = emptyKey;
+        empty.channel = 0;
+        empty.state = MIGRATION_UNKNOWN;
+
+        remapTable.assign( remapMask + 1, empty );
+    }
+
+    uint64_t slot = ( ( key * 0x9E3779B97F4A7C15ULL ) >> 17 ) & remapMask;
+
+    while( remapTable[slot].key != emptyKey )
+    {
+        if( remapTable[slot].key == key )
+            return &remapTable[slot];
+
+        slot = ( slot + 1 ) & remapMask;
+    }
+
+    assert( remapEntries < remapCapacity );
+
+    remapTable[slot].key = key;
+    remapEntries++;
+
+    return &remapTable[slot];
+}
+
+
+ncycle_t Migrator::GetLookupLatency( )
+{
+    return lookupLatency;
 }
 
 
@@ -122,10 +242,13 @@ void Migrator::StartMigration( NVMAddress& promotee, NVMAddress& demotee )
      *  Set the new channel decodings immediately, but mark the migration
      *  as being in progress.
      */
-    migrationMap[promokey] = promoChannel;
-    migrationMap[demokey] = demoChannel;
-    migrationState[promokey] = MIGRATION_READING;
-    migrationState[demokey] = MIGRATION_READING;
+    RemapEntry *promoEntry = InsertEntry( promokey );
+    RemapEntry *demoEntry = InsertEntry( demokey );
+
+    promoEntry->channel = promoChannel;
+    promoEntry->state = MIGRATION_READING;
+    demoEntry->channel = demoChannel;
+    demoEntry->state = MIGRATION_READING;
 
     /*
      *  Only one migration is allowed at a time; These values hold the
@@ -140,16 +263,16 @@ void Migrator::StartMigration( NVMAddress& promotee, NVMAddress& demotee )
 void Migrator::SetMigrationState( NVMAddress& address, MigratorState newState )
 {
     /* Get the key and set the new state; Ensure the state is really new. */
-    uint64_t key = GetAddressKey( address );
+    RemapEntry *entry = FindEntry( GetAddressKey( address ) );
 
-    assert( migrationState.count( key ) != 0 );
-    assert( migrationState[key] != newState );
+    assert( entry != NULL );
+    assert( entry->state != newState );
 
-    migrationState[key] = newState;
+    entry->state = newState;
 
     /* If migration is done we can handle another migration */
-    if( migrationState[inputPage] == MIGRATION_DONE &&
-        migrationState[outputPage] == MIGRATION_DONE )
+    if( FindEntry( inputPage )->state == MIGRATION_DONE &&
+        FindEntry( outputPage )->state == MIGRATION_DONE )
     {
         migrating = false;
     }
@@ -168,16 +291,9 @@ bool Migrator::Migrating( )
  */
 bool Migrator::IsMigrated( NVMAddress& address )
 {
-    uint64_t key = GetAddressKey( address );
-    bool rv = false;
+    RemapEntry *entry = FindEntry( GetAddressKey( address ) );
 
-    if( migrationMap.count( key ) != 0 && migrationState.count( key ) != 0
-        && migrationState[key] == MIGRATION_DONE )
-    {
-        rv = true;
-    }
-
-    return rv;
+    return ( entry != NULL && entry->state == MIGRATION_DONE );
 }
 
 
@@ -188,16 +304,33 @@ bool Migrator::IsMigrated( NVMAddress& address )
  */
 bool Migrator::IsBuffered( NVMAddress& address )
 {
-    uint64_t key = GetAddressKey( address );
-    bool rv = false;
+    RemapEntry *entry = FindEntry( GetAddressKey( address ) );
+
+    return ( entry != NULL 
+             && ( entry->state == MIGRATION_BUFFERED || entry->state == MIGRATION_WRITING ) );
+}
+
 
-    if( migrationMap.count( key ) != 0 && migrationState.count( key ) != 0
-        && (migrationState[key] == MIGRATION_BUFFERED || migrationState[key] == MIGRATION_WRITING ) )
+/*
+ *  A migration needs a remap entry for both pages. Pages are never removed
+ *  from the table, so once it is full only remapped pages can move again.
+ */
+bool Migrator::CanRemap( NVMAddress& promotee, NVMAddress& demotee )
+{
+    ncounter_t needed = 0;
+
+    if( FindEntry( GetAddressKey( promotee ) ) == NULL )
+        needed++;
+    if( FindEntry( GetAddressKey( demotee ) ) == NULL )
+        needed++;
+
+    if( remapEntries + needed > remapCapacity )
     {
-        rv = true;
+        remapTableFull++;
+        return false;
     }
 
-    return rv;
+    return true;
 }
 
 
@@ -215,116 +348,70 @@ void Migrator::Translate( uint64_t address, uint64_t *row, uint64_t *col, uint64
     uint64_t key = GetAddressKey( keyAddress );
 
     /* Check if the page was migrated and migration is complete. */
-    if( migrationMap.count( key ) != 0 )
+    RemapEntry *entry = FindEntry( key );
+
+    if( entry != NULL && entry->state == MIGRATION_DONE )
     {
-        if( migrationState[key] == MIGRATION_DONE )
-        {
-            *channel = migrationMap[key];
+        *channel = entry->channel;
 
-            migratedAccesses++;
-        }
+        migratedAccesses++;
     }
 }
 
 
 void Migrator::CreateCheckpoint( std::string dir )
 {
-    std::stringstream cpt_file;
-    cpt_file.str("");
-    cpt_file << dir << "/" << StatName( );
+    CheckpointWriter cpt( dir, StatName( ), 2 );
 
-    std::ofstream cpt_handle;
+    if( !cpt.IsOpen( ) )
+        return;
 
-    cpt_handle.open( cpt_file.str().c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
+    /* 
+     *  In-flight requests are not checkpointed (i.e., migrations). 
+     *  Therefore, we assume requests have completed (i.e., there is some 
+     *  draining process) and only checkpoint addresses and not state.
+     */
+    cpt.Write( remapEntries );
 
-    if( !cpt_handle.is_open() )
+    for( uint64_t slot = 0; slot < remapTable.size( ); slot++ )
     {
-        std::cout << "[+]" << StatName( ) << ": Warning: Could not open checkpoint file: "
-                  << cpt_file.str() << std::endl;
-    }
-    else
-    {
-        /* 
-         *  In-flight requests are not checkpointed (i.e., migrations). 
-         *  Therefore, we assume requests have completed (i.e., there is some 
-         *  draining process) and only checkpoint addresses and not state.
-         */
-        std::map<uint64_t, uint64_t>::iterator it;
-        for( it = migrationMap.begin(); it != migrationMap.end(); it++ )
-        {
-            cpt_handle.write( (const char*)&(it->first), sizeof(uint64_t) );
-            cpt_handle.write( (const char*)&(it->second), sizeof(uint64_t) );
-        }
-
-        cpt_handle.close( );
-
-        /* Write checkpoint information. */
-        /* Note: For future compatability only at the memory. This is not read during restoration. */
-        std::string cpt_info = cpt_file.str() + ".json";
-
-        cpt_handle.open( cpt_info.c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
+        if( remapTable[slot].key == emptyKey )
+            continue;
 
-        if( !cpt_handle.is_open() )
-        {
-            std::cout << "[+]" << StatName( ) << ": Warning: Could not open checkpoint " 
-                      << "info file: " << cpt_info << std::endl;
-        }
-        else
-        {
-            std::string cpt_info_str = "{\n\t\"Version\": 1\n}";
-            cpt_handle.write( cpt_info_str.c_str(), cpt_info_str.length() ); 
-
-            cpt_handle.close();
-        }
+        cpt.Write( remapTable[slot].key );
+        cpt.Write( remapTable[slot].channel );
     }
 }
 
 
 void Migrator::RestoreCheckpoint( std::string dir )
 {
-    std::stringstream cpt_file;
-    cpt_file.str("");
-    cpt_file << dir << "/" << StatName( );
+    CheckpointReader cpt( dir, StatName( ), 2 );
 
-    std::ifstream cpt_handle;
+    if( !cpt.IsOpen( ) )
+        return;
 
-    cpt_handle.open( cpt_file.str().c_str(), std::ifstream::ate | std::ofstream::binary );
-
-    if( !cpt_handle.is_open() )
-    {
-        std::cout << "[+]" << StatName( ) << ": Warning: Could not open checkpoint file: "
-                  << cpt_file.str() << std::endl;
-    }
-    else
+    /*
+     *  Checkpoint is assumed to only have addresses and channel mappings.
+     */
+    uint64_t addressMappings = cpt.Read( );
+    for( uint64_t mapping = 0; mapping < addressMappings && cpt.Good( ); mapping++ )
     {
-        std::streampos cpt_size = cpt_handle.tellg( );
+        uint64_t address = cpt.Read( );
+        uint64_t channel = cpt.Read( );
 
-        if( cpt_size % (sizeof(uint64_t)*2) != 0 )
+        if( FindEntry( address ) == NULL && remapEntries == remapCapacity )
         {
-            std::cout << "[+]" << StatName( ) << ": Warning: Excepted checkpoint size to be "
-                      << "a multiple of " << (sizeof(uint64_t)*2) << std::endl;
+            std::cout << "[+]" << StatName( ) << ": Warning: Remap table is too small "
+                      << "for the checkpoint, dropping mapping." << std::endl;
+            continue;
         }
 
-        cpt_handle.close( );
-
-        cpt_handle.open( cpt_file.str().c_str(), std::ifstream::in | std::ifstream::binary );
-
-        /*
-         *  Checkpoint is assumed to only have addresses and channel mappings.
-         */
-        uint64_t addressMappings = static_cast<uint64_t>(cpt_size / (sizeof(uint64_t)*2));
-        for( uint64_t mapping = 0; mapping < addressMappings; mapping++ )
-        {
-            uint64_t address, channel;
-
-            cpt_handle.read( (char*)(&address), sizeof(uint64_t) );
-            cpt_handle.read( (char*)(&channel), sizeof(uint64_t) );
-
-            std::pair<uint64_t, uint64_t> migration( address, channel );
-            migrationMap.insert( migration );
-        }
+        /* Checkpointed migrations were complete when written. */
+        RemapEntry *entry = InsertEntry( address );
 
-        cpt_handle.close( );
+        entry->channel = channel;
+        entry->state = MIGRATION_DONE;
     }
 }
 
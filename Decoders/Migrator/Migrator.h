@@ -38,6 +38,8 @@
 #include "src/Config.h"
 #include "include/NVMAddress.h"
 
+#include <vector>
+
 namespace NVM
 {
 
@@ -52,6 +54,18 @@ enum MigratorState
 };
 
 
+/*
+ *  One remapped page. The remap table is a fixed number of these held in an
+ *  open-addressed hash table, modelling an on-chip SRAM of MigratorSRAMBytes.
+ */
+struct RemapEntry
+{
+    uint64_t key;
+    uint64_t channel;
+    MigratorState state;
+};
+
+
 class Migrator : public AddressTranslator
 {
   public:
@@ -69,15 +83,25 @@ class Migrator : public AddressTranslator
     bool Migrating( );
     bool IsBuffered( NVMAddress& address );
     bool IsMigrated( NVMAddress& address );
+    bool CanRemap( NVMAddress& promotee, NVMAddress& demotee );
+
+    uint64_t GetAddressKey( NVMAddress& address );
+    ncycle_t GetLookupLatency( );
 
     void RegisterStats( );
+    void CalculateStats( );
 
     void CreateCheckpoint( std::string dir );
     void RestoreCheckpoint( std::string dir );
 
   private:
-    std::map<uint64_t, uint64_t> migrationMap;
-    std::map<uint64_t, MigratorState> migrationState;
+    static const uint64_t emptyKey = ~0ULL;
+
+    std::vector<RemapEntry> remapTable;
+    uint64_t remapMask;
+    ncounter_t remapCapacity;
+    ncounter_t remapEntries;
+    ncycle_t lookupLatency;
 
     uint64_t numChannels, numBanks, numRanks, numSubarrays;
 
@@ -86,8 +110,12 @@ class Migrator : public AddressTranslator
     uint64_t inputPage, outputPage;
 
     ncounter_t migratedAccesses;
+    ncounter_t remapTableFull;
+    double remapOccupancy;
 
-    uint64_t GetAddressKey( NVMAddress& address );
+    void SetRemapCapacity( ncounter_t capacity );
+    RemapEntry *FindEntry( uint64_t key );
+    RemapEntry *InsertEntry( uint64_t key );
 
 };
 
@@ -0,0 +1,135 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Decoders/SecurityRefresh/SecurityRefresh.h"
+
+using namespace NVM;
+
+SecurityRefresh::SecurityRefresh( )
+{
+    remapRows = 0;
+}
+
+SecurityRefresh::~SecurityRefresh( )
+{
+}
+
+/*
+ *  Start at the identity mapping (previous key 0, nothing refreshed) with a
+ *  random key for the first round.
+ */
+void SecurityRefresh::InitRegions( uint64_t regions )
+{
+    remapRows = 1;
+    while( remapRows * 2 <= rowsPerRegion )
+        remapRows *= 2;
+
+    previousKey.assign( regions, 0 );
+    currentKey.resize( regions );
+    refreshPointer.assign( regions, 0 );
+
+    for( uint64_t region = 0; region < regions; region++ )
+        currentKey[region] = NewKey( );
+}
+
+uint64_t SecurityRefresh::NewKey( )
+{
+    return rng.NextBelow( remapRows );
+}
+
+/*
+ *  A row has been moved to its current key location once the refresh pointer
+ *  passed either it or the row it was swapped with.
+ */
+bool SecurityRefresh::Refreshed( uint64_t region, uint64_t row )
+{
+    uint64_t partner = row ^ previousKey[region] ^ currentKey[region];
+
+    return ( row < refreshPointer[region] || partner < refreshPointer[region] );
+}
+
+uint64_t SecurityRefresh::RemapRow( uint64_t region, uint64_t row )
+{
+    if( row >= remapRows )
+        return row;
+
+    if( Refreshed( region, row ) )
+        return row ^ currentKey[region];
+
+    return row ^ previousKey[region];
+}
+
+uint64_t SecurityRefresh::UnmapRow( uint64_t region, uint64_t row )
+{
+    if( row >= remapRows )
+        return row;
+
+    uint64_t refreshedRow = row ^ currentKey[region];
+
+    if( Refreshed( region, refreshedRow ) )
+        return refreshedRow;
+
+    return row ^ previousKey[region];
+}
+
+void SecurityRefresh::GetMoves( uint64_t region, std::vector<RowMove>& moves )
+{
+    uint64_t row = refreshPointer[region];
+    uint64_t partner = row ^ previousKey[region] ^ currentKey[region];
+
+    /* Rows whose partner was already refreshed were swapped with it. */
+    if( partner > row )
+    {
+        RowMove move;
+
+        move.source = row ^ previousKey[region];
+        move.destination = row ^ currentKey[region];
+        moves.push_back( move );
+
+        move.source = row ^ currentKey[region];
+        move.destination = row ^ previousKey[region];
+        moves.push_back( move );
+    }
+}
+
+void SecurityRefresh::Advance( uint64_t region )
+{
+    refreshPointer[region]++;
+
+    if( refreshPointer[region] == remapRows )
+    {
+        previousKey[region] = currentKey[region];
+        currentKey[region] = NewKey( );
+        refreshPointer[region] = 0;
+    }
+}
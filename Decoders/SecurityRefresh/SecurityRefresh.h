@@ -0,0 +1,75 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_SECURITYREFRESH_H__
+#define __NVMAIN_SECURITYREFRESH_H__
+
+#include "Decoders/WearLeveler/WearLeveler.h"
+
+namespace NVM {
+
+/*
+ *  Security Refresh wear leveling (Seong et al., ISCA 2010). Each region maps
+ *  logical row r to r XOR key. A refresh round walks a pointer over all rows
+ *  and, one remap step at a time, swaps each pair of rows from the previous
+ *  key's location to the current key's location. When the round completes,
+ *  a new random key is chosen.
+ *
+ *  Only the largest power of two rows of a region are remapped.
+ */
+class SecurityRefresh : public WearLeveler
+{
+  public:
+    SecurityRefresh( );
+    ~SecurityRefresh( );
+
+  protected:
+    void InitRegions( uint64_t regions );
+    uint64_t RemapRow( uint64_t region, uint64_t row );
+    uint64_t UnmapRow( uint64_t region, uint64_t row );
+    void GetMoves( uint64_t region, std::vector<RowMove>& moves );
+    void Advance( uint64_t region );
+
+  private:
+    uint64_t remapRows;
+    std::vector<uint64_t> previousKey;
+    std::vector<uint64_t> currentKey;
+    std::vector<uint64_t> refreshPointer;
+
+    bool Refreshed( uint64_t region, uint64_t row );
+    uint64_t NewKey( );
+};
+
+};
+
+#endif
@@ -0,0 +1,115 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Decoders/StartGap/StartGap.h"
+
+using namespace NVM;
+
+StartGap::StartGap( )
+{
+}
+
+StartGap::~StartGap( )
+{
+}
+
+/*
+ *  Start at the identity mapping: the gap is the top row, which is where the
+ *  sacrificed logical row lives.
+ */
+void StartGap::InitRegions( uint64_t regions )
+{
+    start.assign( regions, 0 );
+    gap.assign( regions, rowsPerRegion - 1 );
+}
+
+uint64_t StartGap::RemapRow( uint64_t region, uint64_t row )
+{
+    uint64_t lines = rowsPerRegion - 1;
+    uint64_t physicalRow;
+
+    if( row >= lines )
+        return gap[region];
+
+    physicalRow = ( row + start[region] ) % lines;
+
+    if( physicalRow >= gap[region] )
+        physicalRow++;
+
+    return physicalRow;
+}
+
+uint64_t StartGap::UnmapRow( uint64_t region, uint64_t row )
+{
+    uint64_t lines = rowsPerRegion - 1;
+
+    if( row == gap[region] || row >= rowsPerRegion )
+        return lines;
+
+    if( row > gap[region] )
+        row--;
+
+    return ( row + lines - start[region] ) % lines;
+}
+
+void StartGap::GetMoves( uint64_t region, std::vector<RowMove>& moves )
+{
+    RowMove move;
+
+    /* When the gap wraps, the top row moves to row 0. */
+    if( gap[region] == 0 )
+    {
+        move.source = rowsPerRegion - 1;
+        move.destination = 0;
+    }
+    else
+    {
+        move.source = gap[region] - 1;
+        move.destination = gap[region];
+    }
+
+    moves.push_back( move );
+}
+
+void StartGap::Advance( uint64_t region )
+{
+    if( gap[region] == 0 )
+    {
+        gap[region] = rowsPerRegion - 1;
+        start[region] = ( start[region] + 1 ) % ( rowsPerRegion - 1 );
+    }
+    else
+    {
+        gap[region]--;
+    }
+}
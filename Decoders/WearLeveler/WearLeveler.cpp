@@ -0,0 +1,213 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Decoders/WearLeveler/WearLeveler.h"
+#include "src/TranslationMethod.h"
+
+#include <iostream>
+#include <cassert>
+
+using namespace NVM;
+
+WearLeveler::WearLeveler( )
+{
+    rowsPerRegion = 0;
+    remapInterval = 100;
+    seed = 1;
+
+    numRanks = numBanks = numSubarrays = numChannels = 0;
+    remapping = false;
+
+    demandWrites = 0;
+    remapSteps = 0;
+    remapMoves = 0;
+    deferredRemaps = 0;
+    remapOverhead = 0.0;
+}
+
+WearLeveler::~WearLeveler( )
+{
+}
+
+void WearLeveler::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    /* Number of writes to a region between remap steps. */
+    config->GetValueUL( "WearLevelInterval", remapInterval );
+
+    if( remapInterval == 0 )
+        remapInterval = 1;
+
+    /* Seed for translators with random keys. WearLevelSeed overrides RandomSeed. */
+    config->GetValueUL( "RandomSeed", seed );
+    config->GetValueUL( "WearLevelSeed", seed );
+}
+
+void WearLeveler::RegisterStats( )
+{
+    AddStat(demandWrites);
+    AddStat(remapSteps);
+    AddStat(remapMoves);
+    AddStat(deferredRemaps);
+    AddUnitStat(remapOverhead, "%");
+}
+
+void WearLeveler::CalculateStats( )
+{
+    /* Each row move is one extra read and one extra write. */
+    if( demandWrites != 0 )
+        remapOverhead = static_cast<double>(remapMoves) * 100.0
+                      / static_cast<double>(demandWrites);
+    else
+        remapOverhead = 0.0;
+}
+
+/*
+ *  The translation method is set after SetConfig, so the regions are sized
+ *  the first time they are needed.
+ */
+bool WearLeveler::CheckRegions( )
+{
+    if( rowsPerRegion == 0 && GetTranslationMethod( ) != NULL )
+    {
+        uint64_t rows, cols;
+
+        GetTranslationMethod( )->GetCount( &rows, &cols, &numBanks, &numRanks, 
+                                           &numChannels, &numSubarrays );
+
+        rowsPerRegion = rows;
+        regionWrites.assign( numChannels * numRanks * numBanks * numSubarrays, 0 );
+
+        /* The stat name is only known once the decoder is attached. */
+        rng.Seed( seed, StatName( ) );
+        InitRegions( regionWrites.size( ) );
+    }
+
+    return ( rowsPerRegion > 1 );
+}
+
+uint64_t WearLeveler::GetRegion( uint64_t bank, uint64_t rank, uint64_t channel, 
+                                 uint64_t subarray )
+{
+    /* The memory controller's translator only sees a single channel. */
+    channel = ( numChannels > 1 ) ? channel : 0;
+
+    return ((channel * numRanks + rank) * numBanks + bank) * numSubarrays + subarray;
+}
+
+void WearLeveler::Translate( uint64_t address, uint64_t *row, uint64_t *col, uint64_t *bank,
+                             uint64_t *rank, uint64_t *channel, uint64_t *subarray )
+{
+    AddressTranslator::Translate( address, row, col, bank, rank, channel, subarray );
+
+    if( CheckRegions( ) )
+        *row = RemapRow( GetRegion( *bank, *rank, *channel, *subarray ), *row );
+}
+
+/*
+ *  Returns the logical address currently stored at the given physical row.
+ */
+uint64_t WearLeveler::ReverseTranslate( const uint64_t& row, const uint64_t& col, 
+                                        const uint64_t& bank, const uint64_t& rank, 
+                                        const uint64_t& channel, const uint64_t& subarray )
+{
+    uint64_t logicalRow = row;
+
+    if( CheckRegions( ) )
+        logicalRow = UnmapRow( GetRegion( bank, rank, channel, subarray ), row );
+
+    return AddressTranslator::ReverseTranslate( logicalRow, col, bank, rank, 
+                                                channel, subarray );
+}
+
+/*
+ *  Counts a write to the region of the (translated) address. Returns true
+ *  if the region is due for a remap step and no other step is in progress.
+ */
+bool WearLeveler::RecordWrite( NVMAddress& address )
+{
+    if( !CheckRegions( ) )
+        return false;
+
+    uint64_t region = GetRegion( address.GetBank( ), address.GetRank( ),
+                                 address.GetChannel( ), address.GetSubArray( ) );
+
+    demandWrites++;
+    regionWrites[region]++;
+
+    return ( !remapping && regionWrites[region] >= remapInterval );
+}
+
+void WearLeveler::GetRemapMoves( NVMAddress& address, std::vector<RowMove>& moves )
+{
+    uint64_t region = GetRegion( address.GetBank( ), address.GetRank( ),
+                                 address.GetChannel( ), address.GetSubArray( ) );
+
+    moves.clear( );
+    GetMoves( region, moves );
+}
+
+/*
+ *  Advances the mapping of the address' region. Reads of the rows being moved
+ *  must already be queued, since they are translated with the old mapping.
+ */
+void WearLeveler::StartRemap( NVMAddress& address )
+{
+    uint64_t region = GetRegion( address.GetBank( ), address.GetRank( ),
+                                 address.GetChannel( ), address.GetSubArray( ) );
+    std::vector<RowMove> moves;
+
+    assert( !remapping );
+
+    GetMoves( region, moves );
+    Advance( region );
+
+    regionWrites[region] -= remapInterval;
+    remapSteps++;
+    remapMoves += moves.size( );
+    remapping = !moves.empty( );
+}
+
+void WearLeveler::DeferRemap( )
+{
+    deferredRemaps++;
+}
+
+void WearLeveler::FinishRemap( )
+{
+    remapping = false;
+}
+
+bool WearLeveler::Remapping( )
+{
+    return remapping;
+}
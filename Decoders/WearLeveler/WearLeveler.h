@@ -0,0 +1,121 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_WEARLEVELER_H__
+#define __NVMAIN_WEARLEVELER_H__
+
+#include "src/AddressTranslator.h"
+#include "src/Config.h"
+#include "include/NVMAddress.h"
+#include "include/NVMRandom.h"
+
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  A row that must be copied to complete a remap step. Both rows are physical
+ *  rows in the same region.
+ */
+struct RowMove
+{
+    uint64_t source;
+    uint64_t destination;
+};
+
+/*
+ *  Base class for algebraic wear leveling translators. The rows of each
+ *  subarray (or bank, without MATHeight) form a region whose logical rows are
+ *  remapped to physical rows. Every WearLevelInterval writes to a region the
+ *  mapping is advanced by one step, which requires the rows returned by
+ *  GetRemapMoves to be copied. The WearLevelMover hook reads the source rows
+ *  under the old mapping, calls StartRemap and then writes the destination
+ *  rows under the new mapping.
+ */
+class WearLeveler : public AddressTranslator
+{
+  public:
+    WearLeveler( );
+    virtual ~WearLeveler( );
+
+    virtual void SetConfig( Config *config, bool createChildren = true );
+
+    virtual void Translate( uint64_t address, uint64_t *row, uint64_t *col, uint64_t *bank, 
+                            uint64_t *rank, uint64_t *channel, uint64_t *subarray );
+    using AddressTranslator::Translate;
+
+    virtual uint64_t ReverseTranslate( const uint64_t& row, const uint64_t& col, 
+                                       const uint64_t& bank, const uint64_t& rank, 
+                                       const uint64_t& channel, const uint64_t& subarray );
+
+    bool RecordWrite( NVMAddress& address );
+    void GetRemapMoves( NVMAddress& address, std::vector<RowMove>& moves );
+    void StartRemap( NVMAddress& address );
+    void DeferRemap( );
+    void FinishRemap( );
+    bool Remapping( );
+
+    void RegisterStats( );
+    void CalculateStats( );
+
+  protected:
+    uint64_t rowsPerRegion;
+    ncounter_t remapInterval;
+    uint64_t seed;
+    RandomGenerator rng;
+
+    /* Region state is allocated once the translation method is known. */
+    virtual void InitRegions( uint64_t regions ) = 0;
+    virtual uint64_t RemapRow( uint64_t region, uint64_t row ) = 0;
+    virtual uint64_t UnmapRow( uint64_t region, uint64_t row ) = 0;
+    virtual void GetMoves( uint64_t region, std::vector<RowMove>& moves ) = 0;
+    virtual void Advance( uint64_t region ) = 0;
+
+  private:
+    uint64_t numRanks, numBanks, numSubarrays, numChannels;
+    std::vector<ncounter_t> regionWrites;
+    bool remapping;
+
+    ncounter_t demandWrites;
+    ncounter_t remapSteps;
+    ncounter_t remapMoves;
+    ncounter_t deferredRemaps;
+    double remapOverhead;
+
+    bool CheckRegions( );
+    uint64_t GetRegion( uint64_t bank, uint64_t rank, uint64_t channel, uint64_t subarray );
+};
+
+};
+
+#endif
@@ -39,12 +39,12 @@ using namespace NVM;
 BitModel::BitModel( )
 {
     /*
-     *  Clear the life map, which will hold all of the endurance
+     *  Clear the life table, which will hold all of the endurance
      *  values for each of our rows. Do this to ensure it didn't
      *  happen to be allocated somewhere that thinks it contains 
      *  values.
      */
-    life.clear( );
+    life.Clear( );
 
     SetGranularity( 1 );
 }
@@ -118,8 +118,8 @@ ncycles_t BitModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
     NVMAddress& address = request->address;
 
     /*
-     *  The default life map is an stl map< uint64_t, uint64_t >. 
-     *  You may map row and col to this map_key however you want.
+     *  The default life table is indexed by a uint64_t key. You
+     *  may map row and col to this map_key however you want.
      *  It is up to you to ensure there are no collisions here.
      */
     uint64_t row;
@@ -129,7 +129,7 @@ ncycles_t BitModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
     address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
     
     /*
-     *  If using the default life map, we can call the DecrementLife
+     *  If using the default life table, we can call the DecrementLife
      *  function which will check if the map_key already exists. If so,
      *  the life value is decremented (write count incremented). Otherwise 
      *  the map_key is inserted with a write count of 1.
@@ -145,53 +145,26 @@ ncycles_t BitModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
 
     rowSize = p->COLS * wordSize; 
 
-    /* Check each byte to see if it was modified */
-    for( uint64_t i = 0; i < wordSize; ++i )
-    {
-        /*
-         *  If no bytes have changed we can just continue. Yes, I know this
-         *  will check the byte 8 times, but i'd rather not change the iter.
-         */
-        uint8_t oldByte, newByte;
-
-        oldByte = oldData.GetByte( i );
-        newByte = newData.GetByte( i );
-
-        if( oldByte == newByte ) 
-            continue;
-
-        /*
-         *  If the bytes are different, then at least one bit has changed.
-         *  check each bit individually.
-         */
-        for( int j = 0; j < 8; j++ )
-        {
-            uint8_t oldBit, newBit;
-
-            oldBit = ( oldByte >> j ) & 0x1;
-            newBit = ( newByte >> j ) & 0x1;
-
-            if( oldBit == newBit )
-                continue;
+    /*
+     *  Think of each row being partitioned into 1-bit divisions. 
+     *  Each row has rowSize * 8 paritions. For the key we will use:
+     *
+     *  row * number of partitions + partition in this row
+     */
+    partitionCount = rowSize * 8;
 
-            //std::cout << "[+] Bit " << j << " changed in byte " << i << std::endl;
+    /* Compare 64 bits at a time and update the life of each changed bit. */
+    for( uint64_t i = 0; i * 8 < wordSize; ++i )
+    {
+        uint64_t changedBits = newData.GetWord( i ) ^ oldData.GetWord( i );
 
-            /*
-             *  Think of each row being partitioned into 1-bit divisions. 
-             *  Each row has rowSize * 8 paritions. For the key we will use:
-             *
-             *  row * number of partitions + partition in this row
-             */
-            partitionCount = rowSize * 8;
-            
-            wordkey = row * partitionCount 
-                             + (col * wordSize * 8) + i * 8 + j;
+        if( wordSize - i * 8 < 8 )
+            changedBits &= ( 1ULL << ( ( wordSize - i * 8 ) * 8 ) ) - 1;
 
-            //std::cout << "[+] Key is " << wordkey << std::endl;
+        wordkey = row * partitionCount + (col * wordSize * 8) + i * 64;
 
-            if( !DecrementLife( wordkey ) )
-                rv = -1;
-        }
+        if( !DecrementLifeRange( wordkey, changedBits ) )
+            rv = -1;
     }
 
     return rv;
@@ -32,6 +32,7 @@
 *******************************************************************************/
 
 #include "Endurance/ByteModel/ByteModel.h"
+#include "include/NVMHelpers.h"
 #include <iostream>
 
 using namespace NVM;
@@ -39,12 +40,12 @@ using namespace NVM;
 ByteModel::ByteModel( )
 {
     /*
-     *  Clear the life map, which will hold all of the endurance
+     *  Clear the life table, which will hold all of the endurance
      *  values for each of our rows. Do this to ensure it didn't
      *  happen to be allocated somewhere that thinks it contains 
      *  values.
      */
-    life.clear( );
+    life.Clear( );
 
     SetGranularity( 8 );
 }
@@ -118,8 +119,8 @@ ncycles_t ByteModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
     NVMAddress address = request->address;
 
     /*
-     *  The default life map is an stl map< uint64_t, uint64_t >. 
-     *  You may map row and col to this map_key however you want.
+     *  The default life table is indexed by a uint64_t key. You
+     *  may map row and col to this map_key however you want.
      *  It is up to you to ensure there are no collisions here.
      */
     uint64_t row;
@@ -132,7 +133,7 @@ ncycles_t ByteModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
     address.GetTranslatedAddress( &row, &col, NULL, NULL, NULL, NULL );
     
     /*
-     *  If using the default life map, we can call the DecrementLife
+     *  If using the default life table, we can call the DecrementLife
      *  function which will check if the map_key already exists. If so,
      *  the life value is decremented (write count incremented). Otherwise 
      *  the map_key is inserted with a write count of 1.
@@ -153,28 +154,26 @@ ncycles_t ByteModel::Write( NVMainRequest *request, NVMDataBlock& oldData )
     /* Size of a row in bytes */
     rowSize = p->COLS * wordSize;
 
-    /* Check each byte to see if it was modified */
-    for( int i = (int)wordSize - 1; i >= 0; --i )
-    {
-        uint8_t oldByte, newByte;
+    /*
+     *  Think of each row being partitioned into 8-bit divisions. Each 
+     *  row has rowSize / 8 paritions. For the key we will use:
+     *
+     *  row * number of partitions + partition in this row
+     */
+    partitionCount = ( rowSize / 8 );
 
-        oldByte = oldData.GetByte( i );
-        newByte = newData.GetByte( i );
+    /* Compare 8 bytes at a time and update the life of each changed byte. */
+    for( uint64_t i = 0; i * 8 < wordSize; ++i )
+    {
+        uint64_t changedBytes = NonZeroBytes64( newData.GetWord( i ) 
+                                                ^ oldData.GetWord( i ) );
 
-        if( oldByte == newByte ) 
-            continue;
+        if( wordSize - i * 8 < 8 )
+            changedBytes &= ( 1ULL << ( wordSize - i * 8 ) ) - 1;
 
-        /*
-         *  Think of each row being partitioned into 8-bit divisions. Each 
-         *  row has rowSize / 8 paritions. For the key we will use:
-         *
-         *  row * number of partitions + partition in this row
-         */
-        partitionCount = ( rowSize / 8 );
-
-        wordkey = row * partitionCount + col * wordSize + i;
+        wordkey = row * partitionCount + col * wordSize + i * 8;
       
-        if( !DecrementLife( wordkey ) )
+        if( !DecrementLifeRange( wordkey, changedBytes ) )
             rv = -1;  
     }
 
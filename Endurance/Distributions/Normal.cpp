@@ -32,15 +32,15 @@
 *******************************************************************************/
 
 #include "Endurance/Distributions/Normal.h"
-#include <cmath>
-#include <cstdlib>
 #include <iostream>
 
 using namespace NVM;
 
 NormalDistribution::NormalDistribution( )
 {
-    nextEndurance = 0.0f;
+    config = NULL;
+    mean = 0;
+    variance = 0;
 }
 
 NormalDistribution::NormalDistribution( Config *conf )
@@ -70,46 +70,28 @@ NormalDistribution::NormalDistribution( Config *conf )
         variance = conf->GetValue( "EnduranceDistVariance" );
     }
 
-    nextEndurance = 0.0f;
+    uint64_t seed = 1;
+    conf->GetValueUL( "RandomSeed", seed );
+    rng.Seed( seed );
 }
 
-uint64_t NormalDistribution::GetEndurance( )
+/*
+ *  With 53-bit uniform samples, Box-Muller never strays more than about
+ *  8.6 standard deviations from the mean.
+ */
+uint64_t NormalDistribution::GetMaxEndurance( )
 {
-    double x1, x2;
-    double y1, y2;
-    double w;
-
-    /*
-     *  This method will generate two results at the same time. Instead of
-     *  throwing one of the results out, store it and return it here. Once
-     *  returned, reset the result to 0.
-     */
-    if( nextEndurance != 0.0f )
-    {
-        w = nextEndurance;
-        nextEndurance = 0.0f;
-
-        return (uint64_t)w;
-    }
+    return mean + 9 * variance;
+}
 
-    /*
-     *  rand() is a uniform distribution. Use the Box-Muller method to
-     *  convert the output from rand() to a normal distribution.
-     */
-    w = 2.0f;
-    while( w >= 1.0f )
-    {
-        x1 = 2.0 * ( (double)(rand( ) % 1000000) / 1000000.0f ) - 1.0f;
-        x2 = 2.0 * ( (double)(rand( ) % 1000000) / 1000000.0f ) - 1.0f;
-        w = x1 * x1 + x2 * x2;
-    }
+uint64_t NormalDistribution::GetEndurance( )
+{
+    /* The mean may change between calls, so only standard normals are cached. */
+    double endurance = static_cast<double>(mean) 
+                     + rng.NextNormal( ) * static_cast<double>(variance);
 
-    w = sqrt( ( -2.0f * log( w ) ) / w );
-    y1 = x1 * w;
-    y2 = x2 * w;
+    if( endurance <= 0.0 )
+        return 0;
 
-    nextEndurance = static_cast<double>(mean) + y2 
-                        * static_cast<double>(variance);
-    
-    return mean + static_cast<uint64_t>(y1 * static_cast<double>(variance));
+    return static_cast<uint64_t>(endurance);
 }
@@ -46,6 +46,7 @@ class NormalDistribution : public EnduranceDistribution
     ~NormalDistribution( ) { }
 
     uint64_t GetEndurance( );
+    uint64_t GetMaxEndurance( );
 
     void SetMean( uint64_t m ) { mean = m; }
     void SetVariance( uint64_t var ) { variance = var; }
@@ -58,7 +59,6 @@ class NormalDistribution : public EnduranceDistribution
 
     uint64_t mean;
     uint64_t variance;
-    double nextEndurance;
 };
 
 };
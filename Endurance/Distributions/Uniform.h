@@ -45,6 +45,7 @@ class UniformDistribution : public EnduranceDistribution
     ~UniformDistribution( ) { }
 
     uint64_t GetEndurance( );
+    uint64_t GetMaxEndurance( ) { return mean; }
 
   private:
     Config *config;
@@ -38,12 +38,12 @@ using namespace NVM;
 RowModel::RowModel( )
 {
     /*
-     *  Clear the life map, which will hold all of the endurance
+     *  Clear the life table, which will hold all of the endurance
      *  values for each of our rows. Do this to ensure it didn't
      *  happen to be allocated somewhere that thinks it contains 
      *  values.
      */
-    life.clear( );
+    life.Clear( );
 }
 
 RowModel::~RowModel( )
@@ -88,8 +88,8 @@ ncycles_t RowModel::Write( NVMainRequest *request, NVMDataBlock& /*oldData*/ )
     NVMAddress address = request->address;
 
     /*
-     *  The default life map is an stl map< uint64_t, uint64_t >. 
-     *  You may map row and col to this map_key however you want.
+     *  The default life table is indexed by a uint64_t key. You
+     *  may map row and col to this map_key however you want.
      *  It is up to you to ensure there are no collisions here.
      */
     uint64_t row;
@@ -101,7 +101,7 @@ ncycles_t RowModel::Write( NVMainRequest *request, NVMDataBlock& /*oldData*/ )
     address.GetTranslatedAddress( &row, NULL, NULL, NULL, NULL, NULL );
     
     /*
-     *  If using the default life map, we can call the DecrementLife
+     *  If using the default life table, we can call the DecrementLife
      *  function which will check if the map_key already exists. If so,
      *  the life value is decremented (write count incremented). Otherwise 
      *  the map_key is inserted with a write count of 1.
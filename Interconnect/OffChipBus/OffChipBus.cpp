@@ -157,6 +157,11 @@ bool OffChipBus::IssueCommand( NVMainRequest *req )
     return success;
 }
 
+bool OffChipBus::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 bool OffChipBus::IsIssuable( NVMainRequest *req, FailReason *reason )
 {
     return GetChild( req )->IsIssuable( req, reason );
@@ -49,6 +49,7 @@ class OffChipBus : public Interconnect
     void SetConfig( Config *c, bool createChildren = true );
 
     bool IssueCommand( NVMainRequest *req );
+    bool IssueAtomic( NVMainRequest *req );
     bool IsIssuable( NVMainRequest *req, FailReason *reason = NULL );
     bool RequestComplete( NVMainRequest *request );
 
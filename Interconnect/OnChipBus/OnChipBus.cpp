@@ -121,6 +121,11 @@ bool OnChipBus::IssueCommand( NVMainRequest *req )
     return success;
 }
 
+bool OnChipBus::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 bool OnChipBus::IsIssuable( NVMainRequest *req, FailReason *reason )
 {
     return GetChild( req )->IsIssuable( req, reason );
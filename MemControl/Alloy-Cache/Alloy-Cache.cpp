@@ -0,0 +1,408 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "MemControl/Alloy-Cache/Alloy-Cache.h"
+#include "NVM/nvmain.h"
+#include "src/EventQueue.h"
+
+#include <iostream>
+
+
+using namespace NVM;
+
+
+Alloy_Cache::Alloy_Cache( )
+{
+    std::cout << "[+] Created an Alloy Cache!" << std::endl;
+
+    predictorType = ALLOY_PREDICT_MAPI;
+    predictorEntries = 256;
+    predictorCores = 1;
+    predictorTable = NULL;
+
+    alloyProbeTag = alloyMemReadTag = 0;
+
+    /* One 64 byte line and its 8 byte tag are streamed in the same burst. */
+    lineBytes = 64;
+    tadBytes = 72;
+
+    demand_reads = 0;
+    demand_writes = 0;
+    predicted_hits = 0;
+    predicted_misses = 0;
+    correct_predictions = 0;
+    serial_memory_reads = 0;
+    parallel_memory_reads = 0;
+    wasted_memory_reads = 0;
+    drc_bytes = 0;
+    memory_bytes = 0;
+    hit_latency = 0;
+    miss_latency = 0;
+
+    prediction_accuracy = 0.0;
+    bandwidth_bloat = 0.0;
+    average_hit_latency = 0.0;
+    average_miss_latency = 0.0;
+    average_read_latency = 0.0;
+}
+
+Alloy_Cache::~Alloy_Cache( )
+{
+    delete [] predictorTable;
+}
+
+void Alloy_Cache::SetConfig( Config *conf, bool createChildren )
+{
+    LO_Cache::SetConfig( conf, createChildren );
+
+    alloyProbeTag = tagGen->CreateTag( "ALLOY_PROBE" );
+    alloyMemReadTag = tagGen->CreateTag( "ALLOY_MEMREAD" );
+
+    if( conf->KeyExists( "AlloyPredictor" ) )
+    {
+        std::string predictor = conf->GetString( "AlloyPredictor" );
+
+        if( predictor == "SAM" )
+            predictorType = ALLOY_PREDICT_SAM;
+        else if( predictor == "PAM" )
+            predictorType = ALLOY_PREDICT_PAM;
+        else if( predictor == "MAP-I" || predictor == "MAPI" )
+            predictorType = ALLOY_PREDICT_MAPI;
+        else
+            std::cout << "[+] Alloy_Cache: Unknown AlloyPredictor " << predictor
+                      << ", using MAP-I." << std::endl;
+    }
+
+    conf->GetValueUL( "AlloyPredictorEntries", predictorEntries );
+    conf->GetValueUL( "AlloyPredictorCores", predictorCores );
+
+    if( predictorEntries == 0 )
+        predictorEntries = 1;
+    if( predictorCores == 0 )
+        predictorCores = 1;
+
+    /* 3-bit counters, starting one step below predicting a miss. */
+    delete [] predictorTable;
+    predictorTable = new uint8_t[predictorEntries * predictorCores];
+    for( ncounter_t i = 0; i < predictorEntries * predictorCores; i++ )
+        predictorTable[i] = 3;
+
+    SetDebugName( "Alloy-Cache", conf );
+}
+
+void Alloy_Cache::RegisterStats( )
+{
+    LO_Cache::RegisterStats( );
+
+    AddStat(demand_reads);
+    AddStat(demand_writes);
+    AddStat(predicted_hits);
+    AddStat(predicted_misses);
+    AddStat(prediction_accuracy);
+    AddStat(serial_memory_reads);
+    AddStat(parallel_memory_reads);
+    AddStat(wasted_memory_reads);
+    AddUnitStat(drc_bytes, "B");
+    AddUnitStat(memory_bytes, "B");
+    AddStat(bandwidth_bloat);
+    AddUnitStat(average_hit_latency, "cycles");
+    AddUnitStat(average_miss_latency, "cycles");
+    AddUnitStat(average_read_latency, "cycles");
+}
+
+/*
+ *  MAP-I keeps a table of counters per core indexed by the instruction that
+ *  caused the miss. Requests without a program counter all share one entry,
+ *  which makes the predictor a global (MAP-G) history per core.
+ */
+uint8_t *Alloy_Cache::PredictorEntry( NVMainRequest *req )
+{
+    uint64_t pc = req->programCounter;
+    uint64_t index = ( pc ^ ( pc >> 8 ) ^ ( pc >> 16 ) ) % predictorEntries;
+    uint64_t core = static_cast<uint64_t>( req->threadId ) % predictorCores;
+
+    return &predictorTable[core * predictorEntries + index];
+}
+
+bool Alloy_Cache::PredictMiss( NVMainRequest *req )
+{
+    if( predictorType == ALLOY_PREDICT_SAM )
+        return false;
+    else if( predictorType == ALLOY_PREDICT_PAM )
+        return true;
+
+    return ( *PredictorEntry( req ) >= 4 );
+}
+
+void Alloy_Cache::TrainPredictor( NVMainRequest *req, bool hit )
+{
+    if( predictorType != ALLOY_PREDICT_MAPI )
+        return;
+
+    uint8_t *counter = PredictorEntry( req );
+
+    if( hit && *counter > 0 )
+        (*counter)--;
+    else if( !hit && *counter < 7 )
+        (*counter)++;
+}
+
+void Alloy_Cache::IssueToMainMemory( NVMainRequest *memReq )
+{
+    if( mainMemory->IsIssuable( memReq, NULL ) )
+    {
+        mainMemory->IssueCommand( memReq );
+    }
+    else
+    {
+        /* Hold the request until a main memory request completes so it is not lost. */
+        mainMemory->EnqueuePendingMemoryRequests( memReq );
+    }
+}
+
+bool Alloy_Cache::IssueCommand( NVMainRequest *req )
+{
+    /* Fills, probes and write backs created by the cache need no prediction. */
+    if( req->owner == this )
+        return LO_Cache::IssueCommand( req );
+
+    req->arrivalCycle = GetEventQueue()->GetCurrentCycle();
+
+    if( req->type == READ || req->type == READ_PRECHARGE )
+    {
+        demand_reads++;
+
+        if( PredictMiss( req ) )
+        {
+            /* Start the main memory read while the TAD probe is queued. */
+            AlloyRead *pending = new AlloyRead;
+            NVMainRequest *memReq = new NVMainRequest( );
+            NVMainRequest *probeReq = new NVMainRequest( );
+
+            *memReq = *req;
+            memReq->owner = this;
+            memReq->tag = alloyMemReadTag;
+            memReq->type = READ;
+            memReq->reqInfo = static_cast<void *>( pending );
+
+            *probeReq = *req;
+            probeReq->owner = this;
+            probeReq->tag = alloyProbeTag;
+            probeReq->reqInfo = static_cast<void *>( pending );
+
+            pending->originalReq = req;
+            pending->memReq = memReq;
+            pending->probed = false;
+            pending->fetched = false;
+
+            IssueToMainMemory( memReq );
+
+            predicted_misses++;
+            parallel_memory_reads++;
+
+            return LO_Cache::IssueCommand( probeReq );
+        }
+
+        predicted_hits++;
+    }
+    else if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+    {
+        demand_writes++;
+    }
+
+    return LO_Cache::IssueCommand( req );
+}
+
+/*
+ *  Hands the parallel read to the LO-Cache miss path, which fills the line
+ *  and returns the original request.
+ */
+bool Alloy_Cache::CompleteParallelMiss( AlloyRead *pending )
+{
+    NVMainRequest *memReq = pending->memReq;
+
+    miss_latency += GetEventQueue()->GetCurrentCycle() - pending->originalReq->arrivalCycle;
+
+    memReq->tag = drcMemReadTag;
+    memReq->reqInfo = static_cast<void *>( pending->originalReq );
+
+    delete pending;
+
+    return LO_Cache::RequestComplete( memReq );
+}
+
+bool Alloy_Cache::RequestComplete( NVMainRequest *req )
+{
+    ncycle_t currentCycle = GetEventQueue()->GetCurrentCycle();
+
+    if( req->type == REFRESH )
+    {
+        return LO_Cache::RequestComplete( req );
+    }
+    else if( req->owner == this && req->tag == alloyMemReadTag )
+    {
+        AlloyRead *pending = static_cast<AlloyRead *>( req->reqInfo );
+
+        /* The probe hit, so the parallel read was not needed. */
+        if( pending->originalReq == NULL )
+        {
+            delete pending;
+            delete req;
+        }
+        /* Keep the data until the probe tells us whether it is needed. */
+        else if( !pending->probed )
+        {
+            pending->fetched = true;
+        }
+        else
+        {
+            (void)CompleteParallelMiss( pending );
+        }
+
+        return true;
+    }
+    else if( req->owner == this && req->tag == alloyProbeTag )
+    {
+        AlloyRead *pending = static_cast<AlloyRead *>( req->reqInfo );
+        uint64_t rank, bank;
+
+        req->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
+
+        bool hit = functionalCache[rank][bank]->Present( req->address );
+
+        TrainPredictor( req, hit );
+
+        if( hit )
+        {
+            NVMainRequest *originalReq = pending->originalReq;
+
+            if( pending->fetched )
+            {
+                delete pending->memReq;
+                delete pending;
+            }
+            else
+            {
+                pending->originalReq = NULL;
+            }
+
+            wasted_memory_reads++;
+            drc_hits++;
+            hit_latency += currentCycle - originalReq->arrivalCycle;
+
+            GetParent( )->RequestComplete( originalReq );
+        }
+        else
+        {
+            correct_predictions++;
+            drc_miss++;
+
+            if( pending->fetched )
+                (void)CompleteParallelMiss( pending );
+            else
+                pending->probed = true;
+        }
+
+        delete req;
+
+        return true;
+    }
+    else if( req->owner == this && req->tag == drcMemReadTag )
+    {
+        NVMainRequest *originalReq = static_cast<NVMainRequest *>( req->reqInfo );
+
+        miss_latency += currentCycle - originalReq->arrivalCycle;
+    }
+    else if( req->owner != this && ( req->type == READ || req->type == READ_PRECHARGE ) )
+    {
+        /* Reads predicted to hit probe with the original request. */
+        uint64_t rank, bank;
+
+        req->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
+
+        bool hit = functionalCache[rank][bank]->Present( req->address );
+
+        TrainPredictor( req, hit );
+
+        if( hit )
+        {
+            correct_predictions++;
+            drc_hits++;
+            hit_latency += currentCycle - req->arrivalCycle;
+
+            GetParent( )->RequestComplete( req );
+
+            return false;
+        }
+
+        /* Fall back to a serial main memory read. */
+        serial_memory_reads++;
+    }
+
+    return LO_Cache::RequestComplete( req );
+}
+
+void Alloy_Cache::CalculateStats( )
+{
+    ncounter_t demandBytes = ( demand_reads + demand_writes ) * lineBytes;
+    ncounter_t reads = drc_hits + drc_miss;
+
+    drc_bytes = ( demand_reads + demand_writes + drc_fills ) * tadBytes;
+    memory_bytes = ( serial_memory_reads + parallel_memory_reads 
+                   + drc_dirty_evicts ) * lineBytes;
+
+    prediction_accuracy = 0.0;
+    if( predicted_hits + predicted_misses > 0 )
+        prediction_accuracy = static_cast<double>(correct_predictions)
+                            / static_cast<double>(predicted_hits + predicted_misses);
+
+    bandwidth_bloat = 0.0;
+    if( demandBytes > 0 )
+        bandwidth_bloat = static_cast<double>(drc_bytes + memory_bytes)
+                        / static_cast<double>(demandBytes);
+
+    average_hit_latency = 0.0;
+    if( drc_hits > 0 )
+        average_hit_latency = static_cast<double>(hit_latency) / static_cast<double>(drc_hits);
+
+    average_miss_latency = 0.0;
+    if( drc_miss > 0 )
+        average_miss_latency = static_cast<double>(miss_latency) / static_cast<double>(drc_miss);
+
+    average_read_latency = 0.0;
+    if( reads > 0 )
+        average_read_latency = static_cast<double>(hit_latency + miss_latency) 
+                             / static_cast<double>(reads);
+
+    LO_Cache::CalculateStats( );
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __MEMCONTROL_ALLOYCACHE_H__
+#define __MEMCONTROL_ALLOYCACHE_H__
+
+
+#include "MemControl/LO-Cache/LO-Cache.h"
+
+
+namespace NVM {
+
+
+/*
+ *  How reads decide between a serial and a parallel main memory access.
+ *  SAM always waits for the tag-and-data probe, PAM always reads main memory
+ *  in parallel and MAP-I predicts per instruction.
+ */
+enum AlloyPredictorType { ALLOY_PREDICT_SAM, ALLOY_PREDICT_PAM, ALLOY_PREDICT_MAPI };
+
+
+/*
+ *  Alloy Cache: A direct mapped DRAM cache which streams the tag along with
+ *  the data (TAD) in a single burst, as in the LO-Cache. Reads which are
+ *  predicted to miss are sent to main memory while the probe is in flight.
+ */
+class Alloy_Cache : public LO_Cache
+{
+  public:
+    Alloy_Cache( );
+    virtual ~Alloy_Cache( );
+
+    void SetConfig( Config *conf, bool createChildren = true );
+
+    bool IssueCommand( NVMainRequest *req );
+    bool RequestComplete( NVMainRequest *req );
+
+    void RegisterStats( );
+    void CalculateStats( );
+
+  private:
+    /*
+     *  A read predicted to miss sends its own probe to the DRAM cache and a
+     *  read to main memory. Both point to this through reqInfo.
+     */
+    struct AlloyRead
+    {
+        NVMainRequest *originalReq;  //< NULL once the probe hit
+        NVMainRequest *memReq;       //< Parallel main memory read
+        bool probed;                 //< The probe missed and waits for memReq
+        bool fetched;                //< memReq returned before the probe
+    };
+
+    AlloyPredictorType predictorType;
+    ncounter_t predictorEntries, predictorCores;
+    uint8_t *predictorTable;
+
+    int alloyProbeTag, alloyMemReadTag;
+
+    ncounter_t tadBytes, lineBytes;
+
+    ncounter_t demand_reads, demand_writes;
+    ncounter_t predicted_hits, predicted_misses;
+    ncounter_t correct_predictions;
+    ncounter_t serial_memory_reads, parallel_memory_reads;
+    ncounter_t wasted_memory_reads;
+    ncounter_t drc_bytes, memory_bytes;
+    ncycle_t hit_latency, miss_latency;
+
+    double prediction_accuracy, bandwidth_bloat;
+    double average_hit_latency, average_miss_latency, average_read_latency;
+
+    uint8_t *PredictorEntry( NVMainRequest *req );
+    bool PredictMiss( NVMainRequest *req );
+    void TrainPredictor( NVMainRequest *req, bool hit );
+    void IssueToMainMemory( NVMainRequest *memReq );
+    bool CompleteParallelMiss( AlloyRead *pending );
+};
+
+
+};
+
+
+#endif
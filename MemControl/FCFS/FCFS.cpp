@@ -140,10 +140,14 @@ bool FCFS::RequestComplete( NVMainRequest * request )
     return MemoryController::RequestComplete( request );
 }
 
-bool FCFS::IsIssuable( NVMainRequest * /*request*/, FailReason * /*fail*/ )
+bool FCFS::IsIssuable( NVMainRequest *request, FailReason * /*fail*/ )
 {
     bool rv = true;
 
+    /* The prefetch queue makes room for itself. */
+    if( DefersPrefetch( request ) )
+        return true;
+
     /* Allow up to 16 read/writes outstanding. */
     if( transactionQueues[0].size( ) >= queueSize )
         rv = false;
@@ -241,6 +241,10 @@ bool FRFCFS_WQF::IsIssuable( NVMainRequest *request, FailReason * /*fail*/ )
 {
     bool rv = true;
 
+    /* The prefetch queue makes room for itself. */
+    if( DefersPrefetch( request ) )
+        return true;
+
     //std::cout << "[+] hapi" << std::endl;
     /* during a write drain, no write can enqueue */
     if( (request->type == READ  && readQueue->size()  >= readQueueSize) 
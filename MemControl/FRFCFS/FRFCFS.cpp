@@ -123,10 +123,14 @@ void FRFCFS::RegisterStats( )
     MemoryController::RegisterStats( );
 }
 
-bool FRFCFS::IsIssuable( NVMainRequest * /*request*/, FailReason * /*fail*/ )
+bool FRFCFS::IsIssuable( NVMainRequest *request, FailReason * /*fail*/ )
 {
     bool rv = true;
 
+    /* The prefetch queue makes room for itself. */
+    if( DefersPrefetch( request ) )
+        return true;
+
     /*
      *  Limit the number of commands in the queue. This will stall the caches/CPU.
      */ 
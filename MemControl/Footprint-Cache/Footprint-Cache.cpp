@@ -0,0 +1,819 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "MemControl/Footprint-Cache/Footprint-Cache.h"
+#include "include/NVMHelpers.h"
+#include "NVM/nvmain.h"
+#include "src/EventQueue.h"
+#include "src/Checkpoint.h"
+
+#include <iostream>
+#include <cassert>
+
+
+using namespace NVM;
+
+
+Footprint_Cache::Footprint_Cache( )
+{
+    std::cout << "[+] Created a Footprint DRAM Cache!" << std::endl;
+
+    drcQueueSize = 32;
+    starvationThreshold = 4;
+
+    mainMemory = NULL;
+    pageCache = NULL;
+
+    pageSize = 2048;
+    lineBytes = 64;
+    pageBlocks = pageSize / lineBytes;
+    pageSets = 1;
+    assoc = 4;
+    pageMask = 0;
+
+    historyEntries = 4096;
+    historyKeys = NULL;
+    historyFootprints = NULL;
+    pages = NULL;
+
+    drcMemReadTag = drcFillTag = drcEvictTag = 0;
+
+    drc_hits = 0;
+    drc_miss = 0;
+    page_misses = 0;
+    block_misses = 0;
+    drc_fills = 0;
+    drc_evicts = 0;
+    drc_dirty_evicts = 0;
+    fht_hits = 0;
+    fht_misses = 0;
+    fetched_blocks = 0;
+    unused_blocks = 0;
+    demand_reads = 0;
+    demand_writes = 0;
+    drc_bytes = 0;
+    memory_bytes = 0;
+    hit_latency = 0;
+    miss_latency = 0;
+
+    rb_hits = 0;
+    rb_miss = 0;
+    starvation_precharges = 0;
+
+    drc_hitrate = 0.0;
+    bandwidth_bloat = 0.0;
+    average_hit_latency = 0.0;
+    average_miss_latency = 0.0;
+    average_read_latency = 0.0;
+
+    psInterval = 0;
+
+    InitQueues( 1 );
+
+    drcQueue = &(transactionQueues[0]);
+}
+
+Footprint_Cache::~Footprint_Cache( )
+{
+    delete pageCache;
+    delete [] historyKeys;
+    delete [] historyFootprints;
+    delete [] pages;
+}
+
+void Footprint_Cache::SetConfig( Config *conf, bool createChildren )
+{
+    ncounter_t ranks, banks, rows, cols, word_size, totalPages;
+
+    if( conf->KeyExists( "StarvationThreshold" ) )
+        starvationThreshold = static_cast<ncounter_t>( conf->GetValue( "StarvationThreshold" ) );
+    if( conf->KeyExists( "DRCQueueSize" ) )
+        drcQueueSize = static_cast<ncounter_t>( conf->GetValue( "DRCQueueSize" ) );
+
+    drcMemReadTag = tagGen->CreateTag( "DRC_MEMREAD" );
+    drcFillTag = tagGen->CreateTag( "DRC_FILL" );
+    drcEvictTag = tagGen->CreateTag( "DRC_EVICT" );
+
+    conf->GetValueUL( "DRCPageSize", pageSize );
+    conf->GetValueUL( "DRCAssoc", assoc );
+    conf->GetValueUL( "FootprintHistoryEntries", historyEntries );
+
+    /* Footprints are kept as one bit per block in a 64-bit word. */
+    if( pageSize < lineBytes || pageSize % lineBytes != 0 || pageSize / lineBytes > 64 )
+    {
+        std::cout << "[+] Footprint_Cache: DRCPageSize " << pageSize << " must be a multiple of "
+                  << lineBytes << " up to " << lineBytes * 64 << " bytes, using 2048." << std::endl;
+        pageSize = 2048;
+    }
+
+    if( assoc == 0 )
+        assoc = 1;
+    if( historyEntries == 0 )
+        historyEntries = 1;
+
+    pageBlocks = pageSize / lineBytes;
+    pageMask = ( pageBlocks == 64 ) ? ~0ULL : ( ( 1ULL << pageBlocks ) - 1 );
+
+    ranks = static_cast<ncounter_t>( conf->GetValue( "RANKS" ) );
+    banks = static_cast<ncounter_t>( conf->GetValue( "BANKS" ) );
+    rows  = static_cast<ncounter_t>( conf->GetValue( "ROWS" ) );
+    cols  = static_cast<ncounter_t>( conf->GetValue( "COLS" ) );
+
+    /* Memory word size under the default burst length, see LO-Cache. */
+    word_size = static_cast<ncounter_t>( conf->GetValue( "BusWidth" ) )
+              * static_cast<ncounter_t>( conf->GetValue( "RATE" ) )
+              * static_cast<ncounter_t>( conf->GetValue( "tBURST" ) );
+    word_size /= 8;
+
+    /*
+     *  Each page keeps one cache line worth of tag, footprint and dirty
+     *  bits in the same row as its data.
+     */
+    totalPages = ( ranks * banks * rows * cols * word_size ) / ( pageSize + lineBytes );
+    pageSets = totalPages / assoc;
+    if( pageSets == 0 )
+        pageSets = 1;
+
+    std::string replacement = "LRU";
+    uint64_t seed = 1;
+
+    if( conf->KeyExists( "DRCReplacement" ) )
+        replacement = conf->GetString( "DRCReplacement" );
+    conf->GetValueUL( "RandomSeed", seed );
+
+    pageCache = new CacheBank( 1, pageSets, assoc, pageSize, false );
+    pageCache->SetDecodeFunction( this, 
+            static_cast<CacheSetDecoder>(&NVM::Footprint_Cache::PageSet) );
+
+    if( !pageCache->SetReplacementPolicy( replacement, seed ) )
+    {
+        std::cout << "[+] Footprint_Cache: Unknown DRCReplacement " << replacement
+                  << ", using LRU." << std::endl;
+    }
+
+    pages = new FootprintPage[pageCache->GetEntryCount( )]( );
+
+    historyKeys = new uint64_t[historyEntries];
+    historyFootprints = new uint64_t[historyEntries];
+
+    for( ncounter_t i = 0; i < historyEntries; i++ )
+    {
+        historyKeys[i] = ~0ULL;
+        historyFootprints[i] = 0;
+    }
+
+    MemoryController::SetConfig( conf, createChildren );
+
+    SetDebugName( "Footprint-Cache", conf );
+}
+
+void Footprint_Cache::RegisterStats( )
+{
+    AddStat(drc_hits);
+    AddStat(drc_miss);
+    AddStat(drc_hitrate);
+    AddStat(page_misses);
+    AddStat(block_misses);
+    AddStat(drc_fills);
+    AddStat(drc_evicts);
+    AddStat(drc_dirty_evicts);
+    AddStat(fht_hits);
+    AddStat(fht_misses);
+    AddStat(fetched_blocks);
+    AddStat(unused_blocks);
+    AddStat(demand_reads);
+    AddStat(demand_writes);
+    AddUnitStat(drc_bytes, "B");
+    AddUnitStat(memory_bytes, "B");
+    AddStat(bandwidth_bloat);
+    AddUnitStat(average_hit_latency, "cycles");
+    AddUnitStat(average_miss_latency, "cycles");
+    AddUnitStat(average_read_latency, "cycles");
+    AddStat(rb_hits);
+    AddStat(rb_miss);
+    AddStat(starvation_precharges);
+
+    MemoryController::RegisterStats( );
+}
+
+void Footprint_Cache::SetMainMemory( NVMain *mm )
+{
+    mainMemory = mm;
+}
+
+/*
+ *  Pages are tagged by their base address, so the set is simply the page
+ *  number modulo the number of sets.
+ */
+uint64_t Footprint_Cache::PageSet( NVMAddress& addr )
+{
+    return ( addr.GetPhysicalAddress( ) / pageSize ) % pageSets;
+}
+
+NVMAddress Footprint_Cache::PageAddress( NVMAddress& addr, uint64_t *block )
+{
+    NVMAddress pageAddr;
+    uint64_t offset = addr.GetPhysicalAddress( ) % pageSize;
+
+    pageAddr.SetPhysicalAddress( addr.GetPhysicalAddress( ) - offset );
+
+    if( block != NULL )
+        *block = offset / lineBytes;
+
+    return pageAddr;
+}
+
+/*
+ *  The DRC decoder may interleave the blocks of a page across channels. Only
+ *  the blocks which map to this channel are cached by this controller.
+ */
+uint64_t Footprint_Cache::ChannelBlocks( uint64_t pageBase, uint64_t channel )
+{
+    AddressTranslator *drcDecoder = GetParent( )->GetTrampoline( )->GetDecoder( );
+    uint64_t blocks = 0;
+
+    for( ncounter_t block = 0; block < pageBlocks; block++ )
+    {
+        uint64_t row, col, bank, rank, blockChannel, subarray;
+
+        drcDecoder->Translate( pageBase + block * lineBytes, &row, &col, &bank, 
+                               &rank, &blockChannel, &subarray );
+
+        if( blockChannel == channel )
+            blocks |= ( 1ULL << block );
+    }
+
+    return blocks;
+}
+
+/* Footprints are learned per trigger instruction and block offset. */
+uint64_t Footprint_Cache::HistoryKey( NVMainRequest *req, uint64_t block )
+{
+    return ( req->programCounter << 6 ) | block;
+}
+
+/* Returns the footprint of a resident page, or NULL if it is not cached. */
+Footprint_Cache::FootprintPage *Footprint_Cache::FindPage( NVMAddress& pageAddr )
+{
+    uint64_t entry = pageCache->GetEntryIndex( pageAddr );
+
+    return ( entry != pageCache->GetEntryCount( ) ) ? &pages[entry] : NULL;
+}
+
+/*
+ *  Installs the page, evicting another page if needed, and returns the
+ *  blocks that should be fetched for it.
+ */
+uint64_t Footprint_Cache::AllocatePage( NVMainRequest *req, NVMAddress& pageAddr, uint64_t block )
+{
+    NVMDataBlock dummy;
+
+    if( pageCache->SetFull( pageAddr ) )
+    {
+        NVMAddress victim;
+
+        (void)pageCache->ChooseVictim( pageAddr, &victim );
+
+        EvictPage( victim );
+    }
+
+    (void)pageCache->Install( pageAddr, dummy );
+
+    FootprintPage& page = *FindPage( pageAddr );
+
+    page.present = 0;
+    page.used = ( 1ULL << block );
+    page.dirty = 0;
+    page.historyKey = HistoryKey( req, block );
+
+    /* Without any history for the trigger, fetch the whole page. */
+    uint64_t footprint = pageMask;
+    uint64_t historyIdx = ( page.historyKey ^ ( page.historyKey >> 17 ) ) % historyEntries;
+
+    if( historyKeys[historyIdx] == page.historyKey )
+    {
+        footprint = historyFootprints[historyIdx];
+        fht_hits++;
+    }
+    else
+    {
+        fht_misses++;
+    }
+
+    return footprint | page.used;
+}
+
+void Footprint_Cache::EvictPage( NVMAddress& victim )
+{
+    uint64_t pageBase = victim.GetPhysicalAddress( );
+    FootprintPage *found = FindPage( victim );
+    NVMDataBlock dummy;
+
+    assert( found != NULL );
+
+    FootprintPage& page = *found;
+
+    /* Remember which blocks this trigger actually touched. */
+    uint64_t historyIdx = ( page.historyKey ^ ( page.historyKey >> 17 ) ) % historyEntries;
+
+    historyKeys[historyIdx] = page.historyKey;
+    historyFootprints[historyIdx] = page.used;
+
+    unused_blocks += PopCount64( page.present & ~page.used );
+
+    /* Dirty blocks are assumed to be read out along with the victim tag. */
+    uint64_t dirtyBlocks = page.dirty;
+
+    while( dirtyBlocks != 0 )
+    {
+        uint64_t block = CountTrailingZeros64( dirtyBlocks );
+        NVMainRequest *memReq = new NVMainRequest( );
+
+        dirtyBlocks &= dirtyBlocks - 1;
+
+        memReq->address.SetPhysicalAddress( pageBase + block * lineBytes );
+        memReq->owner = this;
+        memReq->tag = drcEvictTag;
+        memReq->type = WRITE;
+        memReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
+
+        IssueToMainMemory( memReq );
+
+        drc_dirty_evicts++;
+    }
+
+    (void)pageCache->Evict( victim, &dummy );
+
+    /* A resident page always has its triggering block marked used. */
+    page = FootprintPage( );
+
+    drc_evicts++;
+}
+
+/*
+ *  Reads one block from main memory. The demanded block carries the original
+ *  request so it can be returned to the requestor when the data arrives.
+ */
+void Footprint_Cache::FetchBlock( NVMainRequest *req, uint64_t pageBase, uint64_t block )
+{
+    NVMainRequest *memReq = new NVMainRequest( );
+    NVMainRequest *originalReq = NULL;
+    uint64_t address = pageBase + block * lineBytes;
+
+    if( req->address.GetPhysicalAddress( ) - req->address.GetPhysicalAddress( ) % lineBytes == address )
+    {
+        *memReq = *req;
+        originalReq = req;
+    }
+    else
+    {
+        uint64_t row, col, bank, rank, channel, subarray;
+
+        GetParent( )->GetTrampoline( )->GetDecoder( )->Translate( address, &row, &col, 
+                                        &bank, &rank, &channel, &subarray );
+
+        memReq->address.SetPhysicalAddress( address );
+        memReq->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+        memReq->threadId = req->threadId;
+        memReq->programCounter = req->programCounter;
+    }
+
+    memReq->owner = this;
+    memReq->tag = drcMemReadTag;
+    memReq->type = READ;
+    memReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
+    memReq->reqInfo = static_cast<void *>( originalReq );
+
+    IssueToMainMemory( memReq );
+
+    fetched_blocks++;
+}
+
+void Footprint_Cache::IssueToMainMemory( NVMainRequest *memReq )
+{
+    if( mainMemory->IsIssuable( memReq, NULL ) )
+    {
+        mainMemory->IssueCommand( memReq );
+    }
+    else
+    {
+        /* Hold the request until a main memory request completes so it is not lost. */
+        mainMemory->EnqueuePendingMemoryRequests( memReq );
+    }
+}
+
+bool Footprint_Cache::IssueAtomic( NVMainRequest *req )
+{
+    uint64_t block;
+    NVMAddress pageAddr = PageAddress( req->address, &block );
+    FootprintPage *page = FindPage( pageAddr );
+
+    if( page != NULL && 
+        ( req->type == WRITE || req->type == WRITE_PRECHARGE || ( page->present & ( 1ULL << block ) ) ) )
+    {
+        drc_hits++;
+    }
+    else
+    {
+        /* Install the predicted footprint without any timing. */
+        uint64_t channelBlocks = ChannelBlocks( pageAddr.GetPhysicalAddress( ), 
+                                                req->address.GetChannel( ) );
+
+        if( page == NULL )
+        {
+            uint64_t footprint = AllocatePage( req, pageAddr, block ) & channelBlocks;
+
+            page = FindPage( pageAddr );
+            page->present = footprint | ( 1ULL << block );
+            fetched_blocks += PopCount64( footprint | ( 1ULL << block ) );
+            page_misses++;
+        }
+        else
+        {
+            page->present |= ( 1ULL << block );
+            fetched_blocks++;
+            block_misses++;
+        }
+
+        drc_miss++;
+    }
+
+    page->used |= ( 1ULL << block );
+    if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+    {
+        page->present |= ( 1ULL << block );
+        page->dirty |= ( 1ULL << block );
+    }
+
+    return true;
+}
+
+bool Footprint_Cache::IssueFunctional( NVMainRequest *req )
+{
+    /* Write always hits. */
+    if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+        return true;
+
+    /* Reads hit if the block was fetched into a cached page. */
+    uint64_t block;
+    NVMAddress pageAddr = PageAddress( req->address, &block );
+    FootprintPage *page = FindPage( pageAddr );
+
+    return ( page != NULL && ( page->present & ( 1ULL << block ) ) );
+}
+
+bool Footprint_Cache::IsIssuable( NVMainRequest * /*request*/, FailReason * /*fail*/ )
+{
+    bool rv = true;
+
+    /*
+     *  Limit the number of commands in the queue. This will stall the caches/CPU.
+     */ 
+    if( drcQueue->size( ) >= drcQueueSize )
+    {
+        rv = false;
+    }
+
+    return rv;
+}
+
+bool Footprint_Cache::IssueCommand( NVMainRequest *req )
+{
+    req->arrivalCycle = GetEventQueue()->GetCurrentCycle();
+
+    if( req->type == READ || req->type == READ_PRECHARGE )
+        demand_reads++;
+    else if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+        demand_writes++;
+
+    /* Every access probes the tags stored with the data first. */
+    Enqueue( 0, req );
+
+    return true;
+}
+
+bool Footprint_Cache::RequestComplete( NVMainRequest *req )
+{
+    bool rv = false;
+    ncycle_t currentCycle = GetEventQueue()->GetCurrentCycle();
+
+    if( req->type == REFRESH )
+    {
+        ProcessRefreshPulse( req );
+    }
+    else if( req->owner == this )
+    {
+        if( req->tag == drcMemReadTag )
+        {
+            NVMainRequest *originalReq = static_cast<NVMainRequest *>( req->reqInfo );
+
+            uint64_t block;
+            NVMAddress pageAddr = PageAddress( req->address, &block );
+            FootprintPage *page = FindPage( pageAddr );
+
+            /* Blocks of a page evicted while they were in flight are dropped. */
+            if( page != NULL )
+            {
+                NVMainRequest *fillReq = new NVMainRequest( );
+
+                *fillReq = *req;
+                fillReq->owner = this;
+                fillReq->tag = drcFillTag;
+                fillReq->type = WRITE;
+                fillReq->arrivalCycle = currentCycle;
+
+                page->present |= ( 1ULL << block );
+
+                Enqueue( 0, fillReq );
+
+                drc_fills++;
+            }
+
+            if( originalReq != NULL )
+            {
+                miss_latency += currentCycle - originalReq->arrivalCycle;
+
+                GetParent( )->RequestComplete( originalReq );
+            }
+        }
+
+        /* All other tag types (e.g., DRC_FILL) only need to free memory
+         * used for the request and nothing else.
+         */
+        delete req;
+        rv = true;
+    }
+    /*
+     *  The probe for a read or write from a parent module returned.
+     */
+    else
+    {
+        uint64_t block;
+        NVMAddress pageAddr = PageAddress( req->address, &block );
+        uint64_t pageBase = pageAddr.GetPhysicalAddress( );
+        uint64_t blockBit = ( 1ULL << block );
+        FootprintPage *page = FindPage( pageAddr );
+        NVMDataBlock dummy;
+
+        if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+        {
+            /* Write allocate the page without fetching the rest of it. */
+            if( page == NULL )
+            {
+                (void)AllocatePage( req, pageAddr, block );
+                page = FindPage( pageAddr );
+            }
+            else
+            {
+                (void)pageCache->Read( pageAddr, &dummy );
+            }
+
+            page->present |= blockBit;
+            page->used |= blockBit;
+            page->dirty |= blockBit;
+
+            /* Send back to requestor. */
+            GetParent( )->RequestComplete( req );
+        }
+        else if( req->type == READ || req->type == READ_PRECHARGE )
+        {
+            if( page != NULL && ( page->present & blockBit ) )
+            {
+                page->used |= blockBit;
+                (void)pageCache->Read( pageAddr, &dummy );
+
+                drc_hits++;
+                hit_latency += currentCycle - req->arrivalCycle;
+
+                /* Send back to requestor. */
+                GetParent( )->RequestComplete( req );
+            }
+            else if( page != NULL )
+            {
+                /* The page is cached but this block was not in its footprint. */
+                page->used |= blockBit;
+                (void)pageCache->Read( pageAddr, &dummy );
+
+                FetchBlock( req, pageBase, block );
+
+                drc_miss++;
+                block_misses++;
+            }
+            else
+            {
+                uint64_t footprint = AllocatePage( req, pageAddr, block )
+                                   & ChannelBlocks( pageBase, req->address.GetChannel( ) );
+
+                /* Fetch the demanded block first. */
+                FetchBlock( req, pageBase, block );
+                footprint &= ~blockBit;
+
+                while( footprint != 0 )
+                {
+                    FetchBlock( req, pageBase, CountTrailingZeros64( footprint ) );
+                    footprint &= footprint - 1;
+                }
+
+                drc_miss++;
+                page_misses++;
+            }
+        }
+    }
+
+    return rv;
+}
+
+void Footprint_Cache::Cycle( ncycle_t steps )
+{
+    NVMainRequest *nextRequest = NULL;
+
+    /* Check for starved requests BEFORE row buffer hits. */
+    if( FindStarvedRequest( *drcQueue, &nextRequest ) )
+    {
+        rb_miss++;
+        starvation_precharges++;
+    }
+    /* Check for row buffer hits. */
+    else if( FindRowBufferHit( *drcQueue, &nextRequest) )
+    {
+        rb_hits++;
+    }
+    /* Find the oldest request that can be issued. */
+    else if( FindOldestReadyRequest( *drcQueue, &nextRequest ) )
+    {
+        rb_miss++;
+    }
+    /* Find requests to a bank that is closed. */
+    else if( FindClosedBankRequest( *drcQueue, &nextRequest ) )
+    {
+        rb_miss++;
+    }
+    else
+    {
+        nextRequest = NULL;
+    }
+
+    /* Issue the commands for this transaction. */
+    if( nextRequest != NULL )
+    {
+        IssueMemoryCommands( nextRequest );
+    }
+
+    /* Issue any commands in the command queues. */
+    CycleCommandQueues( );
+
+    MemoryController::Cycle( steps );
+}
+
+void Footprint_Cache::CalculateStats( )
+{
+    ncounter_t demandBytes = ( demand_reads + demand_writes ) * lineBytes;
+    ncounter_t reads = drc_hits + drc_miss;
+
+    drc_bytes = ( demand_reads + demand_writes + drc_fills ) * lineBytes;
+    memory_bytes = ( fetched_blocks + drc_dirty_evicts ) * lineBytes;
+
+    drc_hitrate = 0.0;
+    if( reads > 0 )
+        drc_hitrate = static_cast<double>(drc_hits) / static_cast<double>(reads);
+
+    bandwidth_bloat = 0.0;
+    if( demandBytes > 0 )
+        bandwidth_bloat = static_cast<double>(drc_bytes + memory_bytes)
+                        / static_cast<double>(demandBytes);
+
+    average_hit_latency = 0.0;
+    if( drc_hits > 0 )
+        average_hit_latency = static_cast<double>(hit_latency) / static_cast<double>(drc_hits);
+
+    average_miss_latency = 0.0;
+    if( drc_miss > 0 )
+        average_miss_latency = static_cast<double>(miss_latency) / static_cast<double>(drc_miss);
+
+    average_read_latency = 0.0;
+    if( reads > 0 )
+        average_read_latency = static_cast<double>(hit_latency + miss_latency) 
+                             / static_cast<double>(reads);
+
+    MemoryController::CalculateStats( );
+}
+
+/* Saves the page tags, the footprints of the resident pages and the history table. */
+void Footprint_Cache::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ) + ".pages", 2 );
+
+    if( cpt.IsOpen( ) )
+    {
+        uint64_t entries = pageCache->GetEntryCount( );
+        uint64_t resident = 0;
+
+        pageCache->WriteCheckpoint( cpt );
+
+        for( uint64_t entry = 0; entry < entries; entry++ )
+        {
+            if( pages[entry].used != 0 )
+                resident++;
+        }
+
+        cpt.Write( resident );
+        for( uint64_t entry = 0; entry < entries; entry++ )
+        {
+            if( pages[entry].used == 0 )
+                continue;
+
+            cpt.Write( entry );
+            cpt.Write( pages[entry].present );
+            cpt.Write( pages[entry].used );
+            cpt.Write( pages[entry].dirty );
+            cpt.Write( pages[entry].historyKey );
+        }
+
+        cpt.Write( historyEntries );
+        for( ncounter_t i = 0; i < historyEntries; i++ )
+        {
+            cpt.Write( historyKeys[i] );
+            cpt.Write( historyFootprints[i] );
+        }
+    }
+
+    MemoryController::CreateCheckpoint( dir );
+}
+
+void Footprint_Cache::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ) + ".pages", 2 );
+
+    if( cpt.IsOpen( ) )
+    {
+        if( !pageCache->ReadCheckpoint( cpt ) )
+        {
+            std::cout << "[+] Footprint_Cache: Warning: Checkpoint differs from DRAM "
+                      << "cache configuration. Skipping restore." << std::endl;
+        }
+        else
+        {
+            uint64_t entries = pageCache->GetEntryCount( );
+            uint64_t resident = cpt.Read( );
+
+            for( uint64_t entry = 0; entry < entries; entry++ )
+                pages[entry] = FootprintPage( );
+
+            for( uint64_t i = 0; i < resident && cpt.Good( ); i++ )
+            {
+                uint64_t entry = cpt.Read( );
+                FootprintPage page;
+
+                page.present = cpt.Read( );
+                page.used = cpt.Read( );
+                page.dirty = cpt.Read( );
+                page.historyKey = cpt.Read( );
+
+                if( entry < entries )
+                    pages[entry] = page;
+            }
+
+            /* A differently sized history table starts out empty. */
+            if( cpt.Read( ) == historyEntries )
+            {
+                for( ncounter_t i = 0; i < historyEntries; i++ )
+                {
+                    historyKeys[i] = cpt.Read( );
+                    historyFootprints[i] = cpt.Read( );
+                }
+            }
+        }
+    }
+
+    MemoryController::RestoreCheckpoint( dir );
+}
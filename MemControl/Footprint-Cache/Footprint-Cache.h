@@ -0,0 +1,142 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __MEMCONTROL_FOOTPRINTCACHE_H__
+#define __MEMCONTROL_FOOTPRINTCACHE_H__
+
+
+#include "Utils/Caches/CacheBank.h"
+#include "MemControl/DRAMCache/AbstractDRAMCache.h"
+
+
+
+
+namespace NVM {
+
+
+class NVMain;
+
+
+/*
+ *  Footprint Cache: A page-based DRAM cache which allocates whole pages but
+ *  only fetches the blocks predicted to be touched. As in the Unison Cache,
+ *  tags and footprint bits are kept in the DRAM rows with the data, so every
+ *  access probes the DRAM cache and the hit is known when the probe returns.
+ *
+ *  The footprint of a page is predicted by the instruction and block offset
+ *  of the access which allocated it. When a page is evicted the blocks that
+ *  were touched are written back to the footprint history table.
+ */
+class Footprint_Cache : public AbstractDRAMCache
+{
+  public:
+    Footprint_Cache( );
+    virtual ~Footprint_Cache( );
+
+    void SetConfig( Config *conf, bool createChildren = true );
+    void SetMainMemory( NVMain *mm );
+
+    bool IssueAtomic( NVMainRequest *req );
+    bool IsIssuable( NVMainRequest *request, FailReason *reason = NULL );
+    bool IssueCommand( NVMainRequest *req );
+    bool IssueFunctional( NVMainRequest *req );
+    bool RequestComplete( NVMainRequest *req );
+
+    void Cycle( ncycle_t );
+
+    void RegisterStats( );
+    void CalculateStats( );
+
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
+    uint64_t PageSet( NVMAddress& addr );
+
+  private:
+    struct FootprintPage
+    {
+        uint64_t present;     //< Blocks fetched into the DRAM cache
+        uint64_t used;        //< Blocks touched since the page was allocated
+        uint64_t dirty;       //< Blocks written since the page was allocated
+        uint64_t historyKey;  //< Trigger instruction and offset
+    };
+
+    NVMTransactionQueue *drcQueue;
+    NVMain *mainMemory;
+    CacheBank *pageCache;
+
+    ncounter_t starvationThreshold;
+    ncounter_t drcQueueSize;
+    ncounter_t pageSize, pageBlocks, lineBytes;
+    ncounter_t pageSets, assoc;
+    uint64_t pageMask;
+
+    ncounter_t historyEntries;
+    uint64_t *historyKeys;
+    uint64_t *historyFootprints;
+
+    /* Footprints of the resident pages, indexed by their entry in pageCache. */
+    FootprintPage *pages;
+
+    int drcMemReadTag, drcFillTag, drcEvictTag;
+
+    ncounter_t drc_hits, drc_miss;
+    ncounter_t page_misses, block_misses;
+    ncounter_t drc_evicts, drc_fills;
+    ncounter_t drc_dirty_evicts;
+    ncounter_t fht_hits, fht_misses;
+    ncounter_t fetched_blocks, unused_blocks;
+    ncounter_t demand_reads, demand_writes;
+    ncounter_t drc_bytes, memory_bytes;
+    ncounter_t rb_hits, rb_miss;
+    ncounter_t starvation_precharges;
+    ncycle_t hit_latency, miss_latency;
+
+    double drc_hitrate, bandwidth_bloat;
+    double average_hit_latency, average_miss_latency, average_read_latency;
+
+    NVMAddress PageAddress( NVMAddress& addr, uint64_t *block );
+    uint64_t ChannelBlocks( uint64_t pageBase, uint64_t channel );
+    uint64_t HistoryKey( NVMainRequest *req, uint64_t block );
+    uint64_t AllocatePage( NVMainRequest *req, NVMAddress& pageAddr, uint64_t block );
+    FootprintPage *FindPage( NVMAddress& pageAddr );
+    void EvictPage( NVMAddress& victim );
+    void FetchBlock( NVMainRequest *req, uint64_t pageBase, uint64_t block );
+    void IssueToMainMemory( NVMainRequest *memReq );
+};
+
+
+};
+
+
+#endif
@@ -35,8 +35,10 @@
 #include "include/NVMHelpers.h"
 #include "NVM/nvmain.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
+#include <sstream>
 #include <set>
 #include <assert.h>
 
@@ -95,6 +97,9 @@ LH_Cache::LH_Cache( )
 
     mainMemory = NULL;
 
+    drcTagRead1Tag = drcTagRead2Tag = drcTagRead3Tag = 0;
+    drcMemReadTag = drcFillTag = drcAccessTag = 0;
+
     /* Alias */
     drcQueue = &(transactionQueues[0]);
     fillQueue = &(transactionQueues[1]);
@@ -106,6 +111,13 @@ LH_Cache::~LH_Cache( )
 
 void LH_Cache::SetConfig( Config *conf, bool createChildren )
 {
+    drcTagRead1Tag = tagGen->CreateTag( "DRC_TAGREAD1" );
+    drcTagRead2Tag = tagGen->CreateTag( "DRC_TAGREAD2" );
+    drcTagRead3Tag = tagGen->CreateTag( "DRC_TAGREAD3" );
+    drcMemReadTag = tagGen->CreateTag( "DRC_MEMREAD" );
+    drcFillTag = tagGen->CreateTag( "DRC_FILL" );
+    drcAccessTag = tagGen->CreateTag( "DRC_ACCESS" );
+
     /* Defaults */
     starvationThreshold = 4;
     drcQueueSize = 32;
@@ -132,6 +144,13 @@ void LH_Cache::SetConfig( Config *conf, bool createChildren )
     ranks = static_cast<ncounter_t>( conf->GetValue( "RANKS" ) );
     banks = static_cast<ncounter_t>( conf->GetValue( "BANKS" ) );
 
+    std::string replacement = "LRU";
+    uint64_t seed = 1;
+
+    if( conf->KeyExists( "DRCReplacement" ) )
+        replacement = conf->GetString( "DRCReplacement" );
+    conf->GetValueUL( "RandomSeed", seed );
+
     bankLocked = new bool*[ranks];
     functionalCache = new CacheBank**[ranks];
     for( i = 0; i < ranks; i++ )
@@ -142,8 +161,16 @@ void LH_Cache::SetConfig( Config *conf, bool createChildren )
         for( j = 0; j < banks; j++ )
         {
             bankLocked[i][j] = false;
+            /* Only tags are modeled, so no data is stored. */
             functionalCache[i][j] = new CacheBank( 
-                                         conf->GetValue( "ROWS" ), 1, 29, 64 );
+                                         conf->GetValue( "ROWS" ), 1, 29, 64, false );
+
+            if( !functionalCache[i][j]->SetReplacementPolicy( replacement, seed ) )
+            {
+                std::cout << "[+] LH_Cache: Unknown DRCReplacement " << replacement
+                          << ", using LRU." << std::endl;
+                replacement = "LRU";
+            }
         }
     }
 
@@ -286,7 +313,7 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
 
     req->completionCycle = GetEventQueue()->GetCurrentCycle();
 
-    if( req->tag == DRC_TAGREAD3 )
+    if( req->tag == drcTagRead3Tag )
     {
         bool miss;
         uint64_t rank, bank;
@@ -318,7 +345,7 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
 
             *memReq = *req;
             memReq->owner = this;
-            memReq->tag = DRC_MEMREAD;
+            memReq->tag = drcMemReadTag;
 
             mm_reqs++;
 
@@ -338,14 +365,14 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
         bankLocked[rank][bank] = false;
 
     }
-    else if( req->tag == DRC_MEMREAD )
+    else if( req->tag == drcMemReadTag )
     {
         /* Issue new fill request to drcQueue to be filled */
         NVMainRequest *fillReq = new NVMainRequest( );
 
         *fillReq = *req;
         fillReq->owner = this;
-        fillReq->tag = DRC_FILL;
+        fillReq->tag = drcFillTag;
         fillReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
 
         /* TODO: Figure out what to do if this is full. */
@@ -373,7 +400,7 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
                 &measuredMissQueueLatencies );
 
     }
-    else if( req->tag == DRC_FILL )
+    else if( req->tag == drcFillTag )
     {
         fills++;
 
@@ -384,7 +411,7 @@ bool LH_Cache::RequestComplete( NVMainRequest *req )
         CalculateQueueLatency( req, &averageFillQueueLatency, 
                 &measuredFillQueueLatencies );
     }
-    else if( req->tag == DRC_ACCESS )
+    else if( req->tag == drcAccessTag )
     {
         CalculateLatency( req, &averageHitLatency, &measuredHitLatencies );
         CalculateQueueLatency( req, &averageHitQueueLatency, 
@@ -505,7 +532,7 @@ void LH_Cache::Cycle( ncycle_t /*steps*/ )
 
     if( nextRequest != NULL )
     {
-        if( nextRequest->tag == DRC_FILL )
+        if( nextRequest->tag == drcFillTag )
             IssueFillCommands( nextRequest );
         else
             IssueDRCCommands( nextRequest );
@@ -535,7 +562,7 @@ NVMainRequest *LH_Cache::MakeDRCRequest( NVMainRequest *triggerRequest)
     /* Retreive the original request. */
     NVMainRequest *drcRequest = static_cast<NVMainRequest *>(triggerRequest->reqInfo);
 
-    drcRequest->tag = DRC_ACCESS;
+    drcRequest->tag = drcAccessTag;
 
     /* Set the request as issued now. */
     drcRequest->issueCycle = GetEventQueue()->GetCurrentCycle();
@@ -576,9 +603,9 @@ bool LH_Cache::IssueDRCCommands( NVMainRequest *req )
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
         commandQueues[queueId].push_back( MakeActivateRequest( req ) );
-        commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD1 ) );
-        commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD2 ) );
-        commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD3 ) );
+        commandQueues[queueId].push_back( MakeTagRequest( req, drcTagRead1Tag ) );
+        commandQueues[queueId].push_back( MakeTagRequest( req, drcTagRead2Tag ) );
+        commandQueues[queueId].push_back( MakeTagRequest( req, drcTagRead3Tag ) );
         bankLocked[rank][bank] = true;
 
         rv = true;
@@ -594,9 +621,9 @@ bool LH_Cache::IssueDRCCommands( NVMainRequest *req )
 
         commandQueues[queueId].push_back( MakePrechargeRequest( req ) );
         commandQueues[queueId].push_back( MakeActivateRequest( req ) );
-        commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD1 ) );
-        commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD2 ) );
-        commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD3 ) );
+        commandQueues[queueId].push_back( MakeTagRequest( req, drcTagRead1Tag ) );
+        commandQueues[queueId].push_back( MakeTagRequest( req, drcTagRead2Tag ) );
+        commandQueues[queueId].push_back( MakeTagRequest( req, drcTagRead3Tag ) );
         bankLocked[rank][bank] = true;
 
         rv = true;
@@ -607,9 +634,9 @@ bool LH_Cache::IssueDRCCommands( NVMainRequest *req )
 
         req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
-        commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD1 ) );
-        commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD2 ) );
-        commandQueues[queueId].push_back( MakeTagRequest( req, DRC_TAGREAD3 ) );
+        commandQueues[queueId].push_back( MakeTagRequest( req, drcTagRead1Tag ) );
+        commandQueues[queueId].push_back( MakeTagRequest( req, drcTagRead2Tag ) );
+        commandQueues[queueId].push_back( MakeTagRequest( req, drcTagRead3Tag ) );
         bankLocked[rank][bank] = true;
 
         rv = true;
@@ -685,3 +712,44 @@ void LH_Cache::CalculateStats( )
 {
     MemoryController::CalculateStats( );
 }
+
+void LH_Cache::CreateCheckpoint( std::string dir )
+{
+    for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+    {
+        for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+        {
+            std::stringstream cpt_file;
+            cpt_file << StatName( ) << "_r" << rankIdx << "_b" << bankIdx;
+
+            CheckpointWriter cpt( dir, cpt_file.str( ), 1 );
+
+            if( cpt.IsOpen( ) )
+                functionalCache[rankIdx][bankIdx]->WriteCheckpoint( cpt );
+        }
+    }
+
+    MemoryController::CreateCheckpoint( dir );
+}
+
+void LH_Cache::RestoreCheckpoint( std::string dir )
+{
+    for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+    {
+        for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+        {
+            std::stringstream cpt_file;
+            cpt_file << StatName( ) << "_r" << rankIdx << "_b" << bankIdx;
+
+            CheckpointReader cpt( dir, cpt_file.str( ), 1 );
+
+            if( cpt.IsOpen( ) && !functionalCache[rankIdx][bankIdx]->ReadCheckpoint( cpt ) )
+            {
+                std::cout << "[+] LH_Cache: Warning: Checkpoint " << cpt_file.str( ) 
+                          << " differs from DRAM cache configuration." << std::endl;
+            }
+        }
+    }
+
+    MemoryController::RestoreCheckpoint( dir );
+}
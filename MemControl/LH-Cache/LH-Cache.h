@@ -39,13 +39,6 @@
 
 namespace NVM {
 
-#define DRC_TAGREAD1 tagGen->CreateTag("DRC_TAGREAD1")
-#define DRC_TAGREAD2 tagGen->CreateTag("DRC_TAGREAD2")
-#define DRC_TAGREAD3 tagGen->CreateTag("DRC_TAGREAD3")
-#define DRC_MEMREAD  tagGen->CreateTag("DRC_MEMREAD")
-#define DRC_FILL     tagGen->CreateTag("DRC_FILL")
-#define DRC_ACCESS   tagGen->CreateTag("DRC_ACCESS")
-
 class NVMain;
 
 
@@ -69,6 +62,9 @@ class LH_Cache : public AbstractDRAMCache
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   protected:
     NVMainRequest *MakeTagRequest( NVMainRequest *triggerRequest, int tag );
     NVMainRequest *MakeTagWriteRequest( NVMainRequest *triggerRequest );
@@ -159,6 +155,10 @@ class LH_Cache : public AbstractDRAMCache
     NVMain *mainMemory;
 
     CacheBank ***functionalCache;
+
+    /* Request tags are interned once in SetConfig. */
+    int drcTagRead1Tag, drcTagRead2Tag, drcTagRead3Tag;
+    int drcMemReadTag, drcFillTag, drcAccessTag;
 };
 
 };
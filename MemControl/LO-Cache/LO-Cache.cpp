@@ -33,6 +33,7 @@
 
 
 #include "MemControl/LO-Cache/LO-Cache.h"
+#include "src/Checkpoint.h"
 #include "include/NVMHelpers.h"
 #include "NVM/nvmain.h"
 #include "src/EventQueue.h"
@@ -70,6 +71,29 @@ LO_Cache::LO_Cache( )
     perfectFills = false;
     max_addr = 0;
 
+    lineBytes = 64;
+    tagBytes = 8;
+    tadBytes = lineBytes + tagBytes;
+
+    drcMemReadTag = drcFillTag = drcEvictTag = 0;
+
+    insertionPolicy = DRC_INSERT_FILL;
+    duelConstituency = 32;
+    duelInterval = 100000;
+    bypassFillRatio = 32;
+    pselMax = 1023;
+    psel = 0;
+    followerBypassing = false;
+
+    bypassed_fills = 0;
+    fill_bytes_saved = 0;
+    duel_policy_switches = 0;
+    duel_intervals = 0;
+    interval_hitrate = 0.0;
+    interval_hitrate_change = 0.0;
+
+    intervalHits = intervalMisses = intervalBypassed = 0;
+
     psInterval = 0;
 
     /*
@@ -98,6 +122,51 @@ void LO_Cache::SetConfig( Config *conf, bool createChildren )
     if( conf->KeyExists( "PerfectFills" ) && conf->GetString( "PerfectFills" ) == "true" )
         perfectFills = true;
 
+    if( conf->KeyExists( "DRCInsertion" ) )
+    {
+        std::string insertion = conf->GetString( "DRCInsertion" );
+
+        if( insertion == "Fill" )
+            insertionPolicy = DRC_INSERT_FILL;
+        else if( insertion == "Bypass" )
+            insertionPolicy = DRC_INSERT_BYPASS;
+        else if( insertion == "Duel" )
+            insertionPolicy = DRC_INSERT_DUEL;
+        else
+            std::cout << "[+] LO_Cache: Unknown DRCInsertion " << insertion
+                      << ", filling every miss." << std::endl;
+    }
+
+    ncounter_t pselBits = 10;
+
+    conf->GetValueUL( "DRCDuelConstituency", duelConstituency );
+    conf->GetValueUL( "DRCDuelInterval", duelInterval );
+    conf->GetValueUL( "DRCDuelPselBits", pselBits );
+    conf->GetValueUL( "DRCBypassFillRatio", bypassFillRatio );
+    conf->GetValueUL( "DRCLineSize", lineBytes );
+    conf->GetValueUL( "DRCTagSize", tagBytes );
+
+    if( duelConstituency < 2 )
+        duelConstituency = 2;
+    if( duelInterval == 0 )
+        duelInterval = 1;
+    if( bypassFillRatio == 0 )
+        bypassFillRatio = 1;
+    if( pselBits == 0 || pselBits > 31 )
+        pselBits = 10;
+    if( lineBytes == 0 )
+        lineBytes = 64;
+
+    tadBytes = lineBytes + tagBytes;
+
+    /* Start undecided, leaning towards filling. */
+    pselMax = ( 1ULL << pselBits ) - 1;
+    psel = pselMax / 2;
+
+
+    drcMemReadTag = tagGen->CreateTag( "DRC_MEMREAD" );
+    drcFillTag = tagGen->CreateTag( "DRC_FILL" );
+    drcEvictTag = tagGen->CreateTag( "DRC_EVICT" );
 
     ranks = static_cast<ncounter_t>( conf->GetValue( "RANKS" ) );
     banks = static_cast<ncounter_t>( conf->GetValue( "BANKS" ) );
@@ -115,6 +184,17 @@ void LO_Cache::SetConfig( Config *conf, bool createChildren )
               * static_cast<ncounter_t>( conf->GetValue( "tBURST" ) );
     word_size /= 8;
 
+    /* Cached data is only needed to write back dirty lines with their data. */
+    bool storeData = !( conf->KeyExists( "IgnoreData" ) && conf->GetBool( "IgnoreData" ) );
+
+    std::string replacement = "LRU";
+    uint64_t seed = 1;
+
+    if( conf->KeyExists( "DRCReplacement" ) )
+        replacement = conf->GetString( "DRCReplacement" );
+    conf->GetValueUL( "RandomSeed", seed );
+
+    insertionRng.Seed( seed, StatName( ) + ".insertion" );
 
     functionalCache = new CacheBank**[ranks];
     for( ncounter_t i = 0; i < ranks; i++ )
@@ -125,14 +205,21 @@ void LO_Cache::SetConfig( Config *conf, bool createChildren )
         {
             /*
              *  The number of cache lines per row depends on the number
-             *  of columns: N = (cols word_size) / (8 tag bytes + 64 cache line bytes)
-             *  The LO-Cache has the data tag (8 bytes) along with 64
-             *  bytes for the cache line. The cache is direct mapped,
-             *  so we will have up to N cache lines + tags per row,
-             *  an assoc of 1, and cache line size of 64 bytes.
+             *  of columns: N = (cols word_size) / (tag bytes + cache line bytes)
+             *  The LO-Cache has the data tag (DRCTagSize, 8 bytes) along
+             *  with the cache line (DRCLineSize, 64 bytes). The cache is
+             *  direct mapped, so we will have up to N cache lines + tags
+             *  per row and an assoc of 1.
              */
-            lines = (cols * word_size) / 72;
-            functionalCache[i][j] = new CacheBank( rows, lines, 1, 64 );
+            lines = (cols * word_size) / tadBytes;
+            functionalCache[i][j] = new CacheBank( rows, lines, 1, lineBytes, storeData );
+
+            if( !functionalCache[i][j]->SetReplacementPolicy( replacement, seed ) )
+            {
+                std::cout << "[+] LO_Cache: Unknown DRCReplacement " << replacement
+                          << ", using LRU." << std::endl;
+                replacement = "LRU";
+            }
         }
     }
 
@@ -153,6 +240,17 @@ void LO_Cache::RegisterStats( )
     AddStat(rb_miss);
     AddStat(starvation_precharges);
 
+    if( insertionPolicy != DRC_INSERT_FILL )
+    {
+        AddStat(bypassed_fills);
+        AddUnitStat(fill_bytes_saved, "B");
+        AddStat(duel_intervals);
+        AddStat(duel_policy_switches);
+        AddStat(psel);
+        AddStat(interval_hitrate);
+        AddStat(interval_hitrate_change);
+    }
+
     MemoryController::RegisterStats( );
 }
 
@@ -280,7 +378,7 @@ bool LO_Cache::RequestComplete( NVMainRequest *req )
     }
     else if( req->owner == this )
     {
-        if( req->tag == DRC_FILL )
+        if( req->tag == drcFillTag )
         {
             /* Install the missed request */
             uint64_t rank, bank;
@@ -314,7 +412,7 @@ bool LO_Cache::RequestComplete( NVMainRequest *req )
 
                 memReq->address = victim;
                 memReq->owner = this;
-                memReq->tag = DRC_EVICT;
+                memReq->tag = drcEvictTag;
                 memReq->type = WRITE;
                 memReq->data = vicData;
                 memReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
@@ -334,24 +432,26 @@ bool LO_Cache::RequestComplete( NVMainRequest *req )
         /*
          *  Intercept memory read requests from misses to create a fill request.
          */
-        else if( req->tag == DRC_MEMREAD )
+        else if( req->tag == drcMemReadTag )
         {
 
-            /* Issue as a fill request. */
-            NVMainRequest *fillReq = new NVMainRequest( );
+            /* Issue as a fill request unless the insertion policy bypasses it. */
+            if( ShouldFill( req ) )
+            {
+                NVMainRequest *fillReq = new NVMainRequest( );
 
-            *fillReq = *req;
-            fillReq->owner = this;
-            fillReq->tag = DRC_FILL;
-            fillReq->type = WRITE;
-            fillReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
+                *fillReq = *req;
+                fillReq->owner = this;
+                fillReq->tag = drcFillTag;
+                fillReq->type = WRITE;
+                fillReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
 
-            this->IssueCommand( fillReq );
+                this->IssueCommand( fillReq );
+            }
 
             /* Find the original request and send back to requestor. */
-            assert( outstandingFills.count( req ) > 0 );
-            NVMainRequest *originalReq = outstandingFills[req];
-            outstandingFills.erase( req );
+            NVMainRequest *originalReq = static_cast<NVMainRequest *>( req->reqInfo );
+            assert( originalReq != NULL );
 
             GetParent( )->RequestComplete( originalReq );
             rv = false;
@@ -407,7 +507,7 @@ bool LO_Cache::RequestComplete( NVMainRequest *req )
 
                 memReq->address = victim;
                 memReq->owner = this;
-                memReq->tag = DRC_EVICT;
+                memReq->tag = drcEvictTag;
                 memReq->type = WRITE;
                 memReq->data = vicData;
                 memReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
@@ -441,12 +541,12 @@ bool LO_Cache::RequestComplete( NVMainRequest *req )
 
                 *memReq = *req;
                 memReq->owner = this;
-                memReq->tag = DRC_MEMREAD;
+                memReq->tag = drcMemReadTag;
                 memReq->type = READ;
                 memReq->arrivalCycle = GetEventQueue()->GetCurrentCycle();
 
-                assert( outstandingFills.count( req ) == 0 );
-                outstandingFills.insert( std::pair<NVMainRequest*, NVMainRequest*>( memReq, req ) );
+                /* The reqInfo pointer will point to the original request from cache. */
+                memReq->reqInfo = static_cast<void *>( req );
 
                 if (mainMemory->IsIssuable( memReq, NULL )) {
                     mainMemory->IssueCommand( memReq );
@@ -473,10 +573,107 @@ bool LO_Cache::RequestComplete( NVMainRequest *req )
     return rv;
 }
 
+/*
+ *  Set dueling: a few leader sets always fill and a few always use the
+ *  bypass policy. Misses in either move the saturating psel counter and the
+ *  remaining follower sets use whichever policy is missing less. Leaders
+ *  are picked per constituency of duelConstituency sets with the
+ *  complement-select scheme so both policies sample every part of a bank.
+ */
+bool LO_Cache::ShouldFill( NVMainRequest *req )
+{
+    bool bypass = true;
+
+    if( insertionPolicy == DRC_INSERT_FILL )
+        return true;
+
+    if( insertionPolicy == DRC_INSERT_DUEL )
+    {
+        uint64_t rank, bank;
+
+        req->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
+
+        uint64_t set = functionalCache[rank][bank]->GetSetIndex( req->address )
+                     + rank * banks + bank;
+        uint64_t leader = ( set / duelConstituency ) % duelConstituency;
+        uint64_t offset = set % duelConstituency;
+
+        if( offset == leader )
+        {
+            if( psel < pselMax )
+                psel++;
+
+            bypass = false;
+        }
+        else if( offset == duelConstituency - 1 - leader )
+        {
+            if( psel > 0 )
+                psel--;
+        }
+        else
+        {
+            bypass = FollowerBypasses( );
+        }
+    }
+
+    /* Bypassing still fills occasionally so a new working set can settle in. */
+    if( bypass && insertionRng.NextBelow( bypassFillRatio ) != 0 )
+    {
+        bypassed_fills++;
+        return false;
+    }
+
+    return true;
+}
+
+bool LO_Cache::FollowerBypasses( )
+{
+    return ( psel > pselMax / 2 );
+}
+
+void LO_Cache::EndDuelInterval( )
+{
+    ncounter_t hits = drc_hits - intervalHits;
+    ncounter_t misses = drc_miss - intervalMisses;
+    double hitrate = 0.0;
+
+    if( hits + misses > 0 )
+        hitrate = static_cast<double>(hits) / static_cast<double>(hits + misses);
+
+    interval_hitrate_change = ( duel_intervals > 0 ) ? hitrate - interval_hitrate : 0.0;
+    interval_hitrate = hitrate;
+
+    bool bypassing = ( insertionPolicy == DRC_INSERT_BYPASS )
+                  || ( insertionPolicy == DRC_INSERT_DUEL && FollowerBypasses( ) );
+
+    if( duel_intervals > 0 && bypassing != followerBypassing )
+        duel_policy_switches++;
+    followerBypassing = bypassing;
+
+    /* Each bypassed fill saves writing one tag and data (TAD) entry. */
+    *debugStream << GetEventQueue()->GetCurrentCycle() << " " << StatName( )
+                 << ": interval " << duel_intervals << " hit rate " << hitrate
+                 << " (change " << interval_hitrate_change << "), saved "
+                 << ( bypassed_fills - intervalBypassed ) * tadBytes
+                 << " fill bytes, followers " << ( bypassing ? "bypass" : "fill" )
+                 << std::endl;
+
+    intervalHits = drc_hits;
+    intervalMisses = drc_miss;
+    intervalBypassed = bypassed_fills;
+    duel_intervals++;
+}
+
 void LO_Cache::Cycle( ncycle_t steps )
 {
     NVMainRequest *nextRequest = NULL;
 
+    if( insertionPolicy != DRC_INSERT_FILL
+        && drc_hits + drc_miss - intervalHits - intervalMisses >= duelInterval )
+    {
+        EndDuelInterval( );
+    }
+
     /* Check for starved requests BEFORE row buffer hits. */
     if( FindStarvedRequest( *drcQueue, &nextRequest ) )
     {
@@ -521,6 +718,8 @@ void LO_Cache::CalculateStats( )
     if( drc_hits+drc_miss > 0 )
         drc_hitrate = static_cast<float>(drc_hits) / static_cast<float>(drc_miss+drc_hits);
 
+    fill_bytes_saved = bypassed_fills * tadBytes;
+
     MemoryController::CalculateStats( );
 }
 
@@ -532,51 +731,28 @@ void LO_Cache::CreateCheckpoint( std::string dir )
         for( ncounter_t bankIdx = 0; bankIdx < banks; bankIdx++ )
         {
             std::stringstream cpt_file;
-            cpt_file.str("");
-            cpt_file << dir << "/" << statName << "_r";
-            cpt_file << rankIdx << "_b" << bankIdx;
+            cpt_file << statName << "_r" << rankIdx << "_b" << bankIdx;
 
-            std::ofstream cpt_handle;
-            
-            cpt_handle.open( cpt_file.str().c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
-
-            if( !cpt_handle.is_open( ) )
-            {
-                std::cout << "[+] LO_Cache: Warning: Could not open checkpoint file: " << cpt_file.str() << "!" << std::endl;
-            }
-            else
-            {
-                /* Iterate over cache sets, since they may not be allocated contiguously. */
-                for( uint64_t set = 0; set < functionalCache[rankIdx][bankIdx]->numSets; set++ )
-                {
-                    cpt_handle.write( (const char *)(functionalCache[rankIdx][bankIdx]->cacheEntry[set]), 
-                                      sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numAssoc );
-                }
-
-                cpt_handle.close( );
-            }
+            CheckpointWriter cpt( dir, cpt_file.str( ), 3 );
 
-            /* Write checkpoint information. */
-            /* Note: For future compatability only at the memory. This is not read during restoration. */
-            std::string cpt_info = cpt_file.str() + ".json";
+            if( cpt.IsOpen( ) )
+                functionalCache[rankIdx][bankIdx]->WriteCheckpoint( cpt );
+        }
+    }
 
-            cpt_handle.open( cpt_info.c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
+    CheckpointWriter cpt( dir, statName + ".policy", 1 );
 
-            if( !cpt_handle.is_open() )
-            {
-                std::cout << "[+] LO_Cache: Warning: Could not open checkpoint info file: " << cpt_info << "!" << std::endl;
-            }
-            else
-            {
-                std::string cpt_info_str = "{\n\t\"Version\": 1\n}";
-                cpt_handle.write( cpt_info_str.c_str(), cpt_info_str.length() ); 
-
-                cpt_handle.close();
-            }
-        }
+    if( cpt.IsOpen( ) )
+    {
+        cpt.Write( psel );
+        cpt.Write( intervalHits );
+        cpt.Write( intervalMisses );
+        cpt.Write( intervalBypassed );
+        cpt.Write( followerBypassing );
+        insertionRng.WriteCheckpoint( cpt );
     }
 
-    NVMObject::CreateCheckpoint( dir );
+    MemoryController::CreateCheckpoint( dir );
 }
 
 void LO_Cache::RestoreCheckpoint( std::string dir )
@@ -586,45 +762,29 @@ void LO_Cache::RestoreCheckpoint( std::string dir )
         for( ncounter_t bankIdx = 0; bankIdx < banks; bankIdx++ )
         {
             std::stringstream cpt_file;
-            cpt_file.str("");
-            cpt_file << dir << "/" << statName << "_r";
-            cpt_file << rankIdx << "_b" << bankIdx;
-
-            std::ifstream cpt_handle;
+            cpt_file << statName << "_r" << rankIdx << "_b" << bankIdx;
 
-            cpt_handle.open( cpt_file.str().c_str(), std::ifstream::ate | std::ifstream::binary );
+            CheckpointReader cpt( dir, cpt_file.str( ), 3 );
 
-            if( !cpt_handle.is_open( ) )
+            if( cpt.IsOpen( ) && !functionalCache[rankIdx][bankIdx]->ReadCheckpoint( cpt ) )
             {
-                std::cout << "[+] LO_Cache: Warning: Could not open checkpoint file: " << cpt_file.str() << "!" << std::endl;
+                std::cout << "[+] LO_Cache: Warning: Checkpoint " << cpt_file.str( ) 
+                          << " differs from DRAM cache configuration." << std::endl;
             }
-            else
-            {
-                std::streampos expectedSize = sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numSets*functionalCache[rankIdx][bankIdx]->numAssoc;
-                if( cpt_handle.tellg( ) != expectedSize )
-                {
-                    std::cout << "[+] LO_Cache: Warning: Expected checkpoint size differs from DRAM cache configuration. Skipping restore." << std::endl;
-                }
-                else
-                {
-                    cpt_handle.close( );
-
-                    cpt_handle.open( cpt_file.str().c_str(), std::ifstream::in | std::ifstream::binary );
-
-                    /* Iterate over cache sets, since they may not be allocated contiguously. */
-                    for( uint64_t set = 0; set < functionalCache[rankIdx][bankIdx]->numSets; set++ )
-                    {
-                        cpt_handle.read( (char *)(functionalCache[rankIdx][bankIdx]->cacheEntry[set]), 
-                                          sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numAssoc );
-                    }
+        }
+    }
 
-                    cpt_handle.close( );
+    CheckpointReader cpt( dir, statName + ".policy", 1 );
 
-                    std::cout << "[+] LO_Cache: Checkpoint read " << (sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numAssoc*functionalCache[rankIdx][bankIdx]->numSets) << " bytes." << std::endl;
-                }
-            }
-        }
+    if( cpt.IsOpen( ) )
+    {
+        psel = cpt.Read( );
+        intervalHits = cpt.Read( );
+        intervalMisses = cpt.Read( );
+        intervalBypassed = cpt.Read( );
+        followerBypassing = ( cpt.Read( ) != 0 );
+        insertionRng.ReadCheckpoint( cpt );
     }
 
-    NVMObject::RestoreCheckpoint( dir );
+    MemoryController::RestoreCheckpoint( dir );
 }
@@ -38,20 +38,21 @@
 
 #include "Utils/Caches/CacheBank.h"
 #include "MemControl/DRAMCache/AbstractDRAMCache.h"
-
-
-#include <map>
+#include "include/NVMRandom.h"
 
 
 namespace NVM {
 
 
-#define DRC_MEMREAD tagGen->CreateTag("DRC_MEMREAD")
-#define DRC_FILL    tagGen->CreateTag("DRC_FILL")
-#define DRC_EVICT   tagGen->CreateTag("DRC_EVICT")
+class NVMain;
 
 
-class NVMain;
+/*
+ *  Whether read misses are filled into the DRAM cache. Bypass only fills
+ *  one in DRCBypassFillRatio misses (bimodal insertion) and Duel picks
+ *  between the two with a few leader sets of each policy.
+ */
+enum DRCInsertionPolicy { DRC_INSERT_FILL, DRC_INSERT_BYPASS, DRC_INSERT_DUEL };
 
 
 class LO_Cache : public AbstractDRAMCache
@@ -77,7 +78,7 @@ class LO_Cache : public AbstractDRAMCache
     void CreateCheckpoint( std::string dir );
     void RestoreCheckpoint( std::string dir );
 
-  private:
+  protected:
     NVMTransactionQueue *drcQueue;
     NVMain *mainMemory;
     Config *mainMemoryConfig;
@@ -95,9 +96,32 @@ class LO_Cache : public AbstractDRAMCache
 
     bool perfectFills;
     uint64_t max_addr;
+
+    /* Each tag and data (TAD) entry holds a cache line and its tag. */
+    ncounter_t lineBytes, tagBytes, tadBytes;
+
     double drc_hitrate;
 
-    std::map<NVMainRequest *, NVMainRequest *> outstandingFills;
+    /* Request tags are interned once in SetConfig. */
+    int drcMemReadTag, drcFillTag, drcEvictTag;
+
+    DRCInsertionPolicy insertionPolicy;
+    ncounter_t duelConstituency, duelInterval, bypassFillRatio;
+    ncounter_t pselMax, psel;
+    bool followerBypassing;
+    RandomGenerator insertionRng;
+
+    ncounter_t bypassed_fills, fill_bytes_saved;
+    ncounter_t duel_policy_switches;
+    ncounter_t duel_intervals;
+    double interval_hitrate, interval_hitrate_change;
+
+    /* Counter values at the start of the current duel interval. */
+    ncounter_t intervalHits, intervalMisses, intervalBypassed;
+
+    bool ShouldFill( NVMainRequest *req );
+    bool FollowerBypasses( );
+    void EndDuelInterval( );
 };
 
 
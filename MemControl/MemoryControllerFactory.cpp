@@ -40,6 +40,8 @@
 #include "MemControl/LH-Cache/LH-Cache.h"
 #include "MemControl/LO-Cache/LO-Cache.h"
 #include "MemControl/PredictorDRC/PredictorDRC.h"
+#include "MemControl/Alloy-Cache/Alloy-Cache.h"
+#include "MemControl/Footprint-Cache/Footprint-Cache.h"
 
 #include <iostream>
 
@@ -68,6 +70,10 @@ MemoryController *MemoryControllerFactory::CreateNewController( std::string cont
         memoryController = new LO_Cache( );
     else if( controller == "PredictorDRC" )
         memoryController = new PredictorDRC( );
+    else if( controller == "Alloy_Cache" )
+        memoryController = new Alloy_Cache( );
+    else if( controller == "Footprint_Cache" || controller == "Unison_Cache" )
+        memoryController = new Footprint_Cache( );
 
     if( memoryController == NULL )
         std::cout << "[+] NVMain: Unknown memory controller `" 
@@ -36,6 +36,7 @@
 #include "MemControl/LH-Cache/LH-Cache.h"
 #include "include/NVMHelpers.h"
 #include "NVM/nvmain.h"
+#include "src/Checkpoint.h"
 #include <assert.h>
 
 using namespace NVM;
@@ -51,6 +52,9 @@ MissMap::MissMap( )
     missMapForceEvicts = 0;
     missMapMemReads = 0;
 
+    missMapReadTag = missMapWriteTag = 0;
+    missMapMemReadTag = missMapForceEvictTag = 0;
+
     psInterval = 0;
 }
 
@@ -60,6 +64,11 @@ MissMap::~MissMap( )
 
 void MissMap::SetConfig( Config *conf, bool createChildren )
 {
+    missMapReadTag = tagGen->CreateTag( "MISSMAP_READ" );
+    missMapWriteTag = tagGen->CreateTag( "MISSMAP_WRITE" );
+    missMapMemReadTag = tagGen->CreateTag( "MISSMAP_MEMREAD" );
+    missMapForceEvictTag = tagGen->CreateTag( "MISSMAP_FORCE_EVICT" );
+
     /* Initialize DRAM Cache channels */
     if( conf->KeyExists( "DRC_CHANNELS" ) )
         numChannels = static_cast<ncounter_t>( conf->GetValue( "DRC_CHANNELS" ) );
@@ -125,6 +134,19 @@ void MissMap::SetConfig( Config *conf, bool createChildren )
         missMap = new CacheBank( 1, mmSets, mmAssoc, 64 ); 
         missMap->isMissMap = true;
 
+        std::string replacement = "LRU";
+        uint64_t seed = 1;
+
+        if( conf->KeyExists( "MissMapReplacement" ) )
+            replacement = conf->GetString( "MissMapReplacement" );
+        conf->GetValueUL( "RandomSeed", seed );
+
+        if( !missMap->SetReplacementPolicy( replacement, seed ) )
+        {
+            std::cout << "[+] MissMap: Unknown MissMapReplacement " << replacement
+                      << ", using LRU." << std::endl;
+        }
+
         missMap->SetParent( this );
         AddChild( missMap );
 
@@ -218,7 +240,7 @@ bool MissMap::IssueCommand( NVMainRequest *req )
         CacheRequest *creq = new CacheRequest;
 
         *mmReq = *req;
-        mmReq->tag = MISSMAP_READ;
+        mmReq->tag = missMapReadTag;
         mmReq->reqInfo = static_cast<void *>( creq );
         mmReq->owner = this;
 
@@ -249,7 +271,7 @@ bool MissMap::RequestComplete( NVMainRequest *req )
 
     if( req->owner == this )
     {
-        if( req->tag == MISSMAP_READ )
+        if( req->tag == missMapReadTag )
         {
             CacheRequest *cacheReq = static_cast<CacheRequest *>( req->reqInfo );
 
@@ -303,7 +325,7 @@ bool MissMap::RequestComplete( NVMainRequest *req )
                      */
                     if( cacheReq->originalRequest->type == READ )
                     {
-                        cacheReq->originalRequest->tag = MISSMAP_MEMREAD;
+                        cacheReq->originalRequest->tag = missMapMemReadTag;
                         mainMemory->IssueCommand( cacheReq->originalRequest );
                     }
                     else
@@ -334,7 +356,7 @@ bool MissMap::RequestComplete( NVMainRequest *req )
                     *mmFill = *req;
                     mmFill->owner = this;
                     mmFill->reqInfo = static_cast<void *>( fillCReq );
-                    mmFill->tag = MISSMAP_WRITE;
+                    mmFill->tag = missMapWriteTag;
 
                     missMapWrites++;
                     missMapMisses++;
@@ -358,7 +380,7 @@ bool MissMap::RequestComplete( NVMainRequest *req )
                  */
                 if( cacheReq->originalRequest->type == READ )
                 {
-                    cacheReq->originalRequest->tag = MISSMAP_MEMREAD;
+                    cacheReq->originalRequest->tag = missMapMemReadTag;
                     mainMemory->IssueCommand( cacheReq->originalRequest );
                 }
                 else
@@ -392,7 +414,7 @@ bool MissMap::RequestComplete( NVMainRequest *req )
                 *mmFill = *req;
                 mmFill->owner = this;
                 mmFill->reqInfo = static_cast<void *>( fillCReq );
-                mmFill->tag = MISSMAP_WRITE;
+                mmFill->tag = missMapWriteTag;
 
                 missMapAllocations++;
                 missMapWrites++;
@@ -410,7 +432,7 @@ bool MissMap::RequestComplete( NVMainRequest *req )
 
             delete cacheReq;
         }
-        else if( req->tag == MISSMAP_WRITE )
+        else if( req->tag == missMapWriteTag )
         {
             /* Just delete the cache request struct. */
             CacheRequest *creq = static_cast<CacheRequest *>( req->reqInfo );
@@ -432,7 +454,7 @@ bool MissMap::RequestComplete( NVMainRequest *req )
 
                 *evictReq = *req;
                 evictReq->owner = this;
-                evictReq->tag = MISSMAP_FORCE_EVICT;
+                evictReq->tag = missMapForceEvictTag;
 
 #ifdef DBGMISSMAP
                 std::cout << "[+] Miss map evicted a line.." << std::endl;
@@ -471,7 +493,7 @@ bool MissMap::RequestComplete( NVMainRequest *req )
      * MISSMAP_MEMREAD is a tagged request originating from the sequencer, 
      * so we aren't the owner. 
      */
-    else if( req->tag == MISSMAP_MEMREAD )
+    else if( req->tag == missMapMemReadTag )
     {
         uint64_t chan;
 
@@ -532,3 +554,26 @@ void MissMap::Cycle( ncycle_t )
 void MissMap::CalculateStats( )
 {
 }
+
+void MissMap::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ) + ".missMap", 1 );
+
+    if( cpt.IsOpen( ) )
+        missMap->WriteCheckpoint( cpt );
+
+    MemoryController::CreateCheckpoint( dir );
+}
+
+void MissMap::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ) + ".missMap", 1 );
+
+    if( cpt.IsOpen( ) && !missMap->ReadCheckpoint( cpt ) )
+    {
+        std::cout << "[+] MissMap: Warning: Checkpoint differs from the miss map "
+                  << "configuration." << std::endl;
+    }
+
+    MemoryController::RestoreCheckpoint( dir );
+}
@@ -42,11 +42,6 @@
 
 namespace NVM {
 
-#define MISSMAP_READ        tagGen->CreateTag("MISSMAP_READ")
-#define MISSMAP_WRITE       tagGen->CreateTag("MISSMAP_WRITE")
-#define MISSMAP_MEMREAD     tagGen->CreateTag("MISSMAP_MEMREAD")
-#define MISSMAP_FORCE_EVICT tagGen->CreateTag("MISSMAP_FORCE_EVICT")
-
 class NVMain;
 class LH_Cache;
 
@@ -69,6 +64,9 @@ class MissMap : public MemoryController
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private:
     CacheBank *missMap;
     std::queue<NVMainRequest *> missMapQueue;
@@ -84,6 +82,10 @@ class MissMap : public MemoryController
     uint64_t missMapHits, missMapMisses;
     uint64_t missMapForceEvicts;
     uint64_t missMapMemReads;
+
+    /* Request tags are interned once in SetConfig. */
+    int missMapReadTag, missMapWriteTag;
+    int missMapMemReadTag, missMapForceEvictTag;
 };
 
 };
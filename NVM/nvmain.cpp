@@ -39,6 +39,7 @@
 #include "src/EventQueue.h"
 #include "Interconnect/InterconnectFactory.h"
 #include "MemControl/MemoryControllerFactory.h"
+#include "MemControl/DRAMCache/DRAMCache.h"
 #include "traceWriter/TraceWriterFactory.h"
 #include "Decoders/DecoderFactory.h"
 #include "Utils/HookFactory.h"
@@ -48,9 +49,10 @@
 
 #include <sstream>
 #include <cassert>
+#include <algorithm>
+#include <thread>
 
 using namespace NVM;
-extern GlobalParams globalparams;
 NVMain::NVMain( )
 {
     config = NULL;
@@ -66,6 +68,21 @@ NVMain::NVMain( )
     prefetcher = NULL;
     successfulPrefetches = 0;
     unsuccessfulPrefetches = 0;
+    issuedPrefetches = 0;
+    droppedPrefetches = 0;
+    throttledPrefetches = 0;
+    latePrefetches = 0;
+    untrackedPrefetches = 0;
+    prefetchAccuracy = 0.0;
+    prefetchCoverage = 0.0;
+    prefetchTimeliness = 0.0;
+
+    prefetchDegree = 0;
+    intervalUsefulPrefetches = 0;
+    intervalUselessPrefetches = 0;
+
+    parallelChannels = false;
+    deliveringCompletions = false;
 }
 
 NVMain::~NVMain( )
@@ -87,6 +104,9 @@ NVMain::~NVMain( )
     if( translator )
         delete translator;
 
+    for( size_t i = 0; i < channelQueues.size( ); i++ )
+        delete channelQueues[i];
+
     if( channelConfig )
     {
         for( unsigned int i = 0; i < numChannels; i++ )
@@ -103,6 +123,20 @@ Config *NVMain::GetConfig( )
     return config;
 }
 
+/*
+ *  Requests issued after this call use the new layer; requests already in
+ *  flight keep the layer they were issued with.
+ */
+void NVMain::SetLayerParams( std::shared_ptr<const LayerParams> layer )
+{
+    layerParams = layer;
+}
+
+std::shared_ptr<const LayerParams> NVMain::GetLayerParams( )
+{
+    return layerParams;
+}
+
 void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildren )
 {
     TranslationMethod *method;
@@ -112,6 +146,10 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
     params->SetParams( conf );
     SetParams( params );
 
+    LayerParams *layer = new LayerParams( );
+    layer->SetParams( conf );
+    layerParams.reset( layer );
+
     StatName( memoryName );
 
     config = conf;
@@ -162,6 +200,7 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
 
         memoryControllers = new MemoryController* [channels];
         channelConfig = new Config* [channels];
+
         for( int i = 0; i < channels; i++ )
         {
             std::stringstream confString;
@@ -191,10 +230,18 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
             /* Initialize memory controller */
             memoryControllers[i] = 
                 MemoryControllerFactory::CreateNewController( channelConfig[i]->GetString( "MEM_CTL" ) );
+        }
+
+        /* Controllers exist but are not wired yet, so their queues can still be chosen. */
+        if( p->ParallelChannels )
+            parallelChannels = CanRunChannelsInParallel( );
+
+        for( int i = 0; i < channels; i++ )
+        {
+            std::stringstream confString;
 
             /* When selecting a MC child, use no field from the decoder (only-child). */
 
-            confString.str( "" );
             confString << memoryName << ".channel" << i << "." 
                 << channelConfig[i]->GetString( "MEM_CTL" ); 
             memoryControllers[i]->StatName( confString.str( ) );
@@ -203,6 +250,14 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
             AddChild( memoryControllers[i] );
             memoryControllers[i]->SetParent( this );
 
+            /* The controller's children inherit its queue. */
+            if( parallelChannels )
+            {
+                channelQueues.push_back( new EventQueue( ) );
+                mailboxes.push_back( std::vector<ChannelCompletion>( ) );
+                memoryControllers[i]->SetEventQueue( channelQueues[i] );
+            }
+
             /* Set Config recursively. */
             memoryControllers[i]->SetConfig( channelConfig[i], createChildren );
 
@@ -210,14 +265,54 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
             memoryControllers[i]->RegisterStats( );
         }
 
+        if( parallelChannels )
+        {
+            ncounter_t threads = p->ParallelThreads;
+
+            if( threads == 0 )
+                threads = std::min<ncounter_t>( channels, std::thread::hardware_concurrency( ) );
+            if( threads == 0 )
+                threads = 1;
+
+            GetGlobalEventQueue( )->AddChannelQueues( this, channelQueues, threads, p->ParallelLookahead );
+
+            std::cout << "[+] NVMain: Simulating " << channels << " channels on " 
+                      << threads << " threads." << std::endl;
+        }
     }
 
     if( p->MemoryPrefetcher != "none" )
     {
         prefetcher = PrefetcherFactory::CreateNewPrefetcher( p->MemoryPrefetcher );
+        prefetcher->SetConfig( config );
         std::cout << "[+] Made a " << p->MemoryPrefetcher << " prefetcher." << std::endl;
     }
 
+    prefetchBuffer.SetSize( p->PrefetchBufferSize, p->PrefetchLineSize );
+
+    /* 
+     *  Outstanding prefetches are bounded by what the controllers accept:
+     *  their read queue plus the low-priority prefetch queue, per channel.
+     */
+    ncounter_t inflightSize = p->PrefetchInflightSize;
+
+    if( inflightSize == 0 )
+    {
+        ncounter_t queueDepth = 32, readQueueDepth = 0;
+
+        config->GetValueUL( "QueueSize", queueDepth );
+        config->GetValueUL( "ReadQueueSize", readQueueDepth );
+
+        queueDepth = std::max( queueDepth, readQueueDepth );
+        if( p->PrefetchQueue )
+            queueDepth += p->PrefetchQueueSize;
+
+        inflightSize = p->CHANNELS * queueDepth;
+    }
+
+    inflightPrefetches.SetSize( inflightSize, p->PrefetchLineSize );
+    prefetchDegree = p->PrefetchMaxDegree;
+
     numChannels = static_cast<unsigned int>(p->CHANNELS);
     
     std::string pretraceFile;
@@ -270,28 +365,88 @@ void NVMain::GeneratePrefetches( NVMainRequest *request, std::vector<NVMAddress>
 {
     std::vector<NVMAddress>::iterator iter;
     ncounter_t channel, rank, bank, row, col, subarray;
+    ncounter_t generated = 0;
+
+    /* 
+     *  Candidates are checked with a scratch request. A real request is only
+     *  allocated once the controller says it has room for it.
+     */
+    NVMainRequest candidate;
+    candidate = *request;
+    candidate.isPrefetch = true;
+    candidate.owner = this;
+    candidate.bulkCmd = CMD_NOP;
 
     for( iter = prefetchList.begin(); iter != prefetchList.end(); iter++ )
     {
-        /* Make a request from the prefetch address. */
-        NVMainRequest *pfRequest = new NVMainRequest( );
-        *pfRequest = *request;
-        pfRequest->address = (*iter);
-        pfRequest->isPrefetch = true;
-        pfRequest->owner = this;
-        
+        if( p->PrefetchThrottle && generated >= prefetchDegree )
+        {
+            throttledPrefetches++;
+            continue;
+        }
+
+        /* Already sitting in the prefetch buffer or on its way there. */
+        if( prefetchBuffer.Contains( iter->GetPhysicalAddress( ) )
+            || inflightPrefetches.Contains( iter->GetPhysicalAddress( ) ) )
+            continue;
+
         /* Translate the address, then copy to the address struct, and copy to request. */
-        GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
+        candidate.address = (*iter);
+        GetDecoder( )->Translate( candidate.address.GetPhysicalAddress( ), 
                                &row, &col, &bank, &rank, &channel, &subarray );
-        request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
-        request->bulkCmd = CMD_NOP;
+        candidate.address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+
+        if( !GetChild( &candidate )->IsIssuable( &candidate, NULL ) )
+        {
+            droppedPrefetches++;
+            continue;
+        }
+
+        NVMainRequest *pfRequest = new NVMainRequest( );
+        *pfRequest = candidate;
+
+        if( GetChild( pfRequest )->IssueCommand( pfRequest ) )
+        {
+            /* An undersized tracker forgets the oldest outstanding prefetch. */
+            if( inflightPrefetches.Insert( pfRequest->address.GetPhysicalAddress( ) ) )
+                untrackedPrefetches++;
+            issuedPrefetches++;
+            generated++;
+        }
+        else
+        {
+            delete pfRequest;
+            droppedPrefetches++;
+        }
+    }
+}
+
+void NVMain::UpdatePrefetchAccuracy( bool useful )
+{
+    if( useful )
+        intervalUsefulPrefetches++;
+    else
+        intervalUselessPrefetches++;
+
+    ncounter_t sampled = intervalUsefulPrefetches + intervalUselessPrefetches;
 
-        //std::cout << "[+] Prefetching 0x" << std::hex << (*iter).GetPhysicalAddress() << " (trigger 0x"
-        //          << request->address.GetPhysicalAddress( ) << std::dec << std::endl;
+    if( sampled < p->PrefetchThrottleInterval )
+        return;
 
-        /* Just type to issue; If the queue is full it simply won't be enqueued. */
-        GetChild( pfRequest )->IssueCommand( pfRequest );
+    /* Raise the degree while prefetches are used and back off when they are not. */
+    double accuracy = static_cast<double>( intervalUsefulPrefetches ) 
+                    / static_cast<double>( sampled );
+
+    if( p->PrefetchThrottle )
+    {
+        if( accuracy >= p->PrefetchAccuracyHigh && prefetchDegree < p->PrefetchMaxDegree )
+            prefetchDegree++;
+        else if( accuracy < p->PrefetchAccuracyLow && prefetchDegree > 1 )
+            prefetchDegree--;
     }
+
+    intervalUsefulPrefetches = 0;
+    intervalUselessPrefetches = 0;
 }
 
 void NVMain::IssuePrefetch( NVMainRequest *request )
@@ -313,37 +468,33 @@ void NVMain::IssuePrefetch( NVMainRequest *request )
 
 bool NVMain::CheckPrefetch( NVMainRequest *request )
 {
-    bool rv = false;
-    NVMainRequest *pfRequest = NULL;
-    std::list<NVMainRequest *>::const_iterator iter;
     std::vector<NVMAddress> prefetchList;
 
-    for( iter = prefetchBuffer.begin(); iter!= prefetchBuffer.end(); iter++ )
+    if( !prefetchBuffer.Remove( request->address.GetPhysicalAddress( ) ) )
     {
-        if( (*iter)->address.GetPhysicalAddress() == request->address.GetPhysicalAddress() )
+        /* 
+         *  The line was prefetched, but not soon enough. The demand goes to
+         *  memory and the prefetch is dropped when it completes.
+         */
+        if( request->type == READ 
+            && inflightPrefetches.Remove( request->address.GetPhysicalAddress( ) ) )
         {
-            if( prefetcher->NotifyAccess(request, prefetchList) )
-            {
-                GeneratePrefetches( request, prefetchList );
-            }
-
-            successfulPrefetches++;
-            rv = true;
-            pfRequest = (*iter);
-            delete pfRequest;
-            break;
+            latePrefetches++;
+            UpdatePrefetchAccuracy( true );
         }
+
+        return false;
     }
 
-    if( pfRequest != NULL )
+    if( prefetcher->NotifyAccess(request, prefetchList) )
     {
-        //std::cout << "[+] Prefetched 0x" << std::hex << request->address.GetPhysicalAddress( )
-        //          << std::dec << " (list size " << prefetchBuffer.size() << " -> ";
-        prefetchBuffer.remove( pfRequest );
-        //std::cout << "[+]" << prefetchBuffer.size() << ")" << std::endl;
+        GeneratePrefetches( request, prefetchList );
     }
 
-    return rv;
+    successfulPrefetches++;
+    UpdatePrefetchAccuracy( true );
+
+    return true;
 }
 
 void NVMain::PrintPreTrace( NVMainRequest *request )
@@ -378,25 +529,15 @@ bool NVMain::IssueCommand( NVMainRequest *request )
         return false;
     }
     
-    if(!globalparams.Input_Addr.IsTranslated( ))
-    {
-        GetDecoder( )->Translate( globalparams.Input_Addr.GetPhysicalAddress( ), 
-                           &row, &col, &bank, &rank, &channel, &subarray );
-        globalparams.Input_Addr.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
-    }
-    if(!globalparams.Output_Addr.IsTranslated( ))
-    {
-        GetDecoder( )->Translate( globalparams.Output_Addr.GetPhysicalAddress( ),
-                            &row, &col, &bank, &rank, &channel, &subarray );
-        globalparams.Output_Addr.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
-    }
-
     /* Translate the address, then copy to the address struct, and copy to request. */
     GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
                            &row, &col, &bank, &rank, &channel, &subarray );
     request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
     request->bulkCmd = CMD_NOP;
 
+    if( (request->type == LOAD_WEIGHT || request->type == COMPUTE) && !request->layer )
+        request->layer = layerParams;
+
     /* Check for any successful prefetches. */
     if( CheckPrefetch( request ) )
     {
@@ -474,27 +615,48 @@ bool NVMain::RequestComplete( NVMainRequest *request )
 {
     bool rv = false;
 
+    /* Called from a channel window; the front end sees it when the window ends. */
+    if( parallelChannels && !deliveringCompletions )
+    {
+        ncounter_t channel = request->address.GetChannel( );
+        ChannelCompletion completion;
+
+        assert( channel < numChannels );
+
+        completion.cycle = channelQueues[channel]->GetCurrentCycle( );
+        completion.request = request;
+
+        mailboxes[channel].push_back( completion );
+
+        return true;
+    }
+
     if( request->owner == this )
     {
-        if( request->isPrefetch )
+        if( request->isPrefetch 
+            && (request->flags & NVMainRequest::FLAG_DROPPED) )
         {
-            //std::cout << "[+] Placing 0x" << std::hex << request->address.GetPhysicalAddress( )
-            //          << std::dec << " into prefetch buffer (cur size: " << prefetchBuffer.size( )
-            //          << ")." << std::endl;
+            /* The controller gave up on it; the line never arrives. */
+            inflightPrefetches.Remove( request->address.GetPhysicalAddress( ) );
+            droppedPrefetches++;
 
-            /* Place in prefetch buffer. */
-            if( prefetchBuffer.size() >= p->PrefetchBufferSize )
+            delete request;
+            rv = true;
+        }
+        else if( request->isPrefetch )
+        {
+            /* 
+             *  Place in prefetch buffer. Only the line address is kept. A
+             *  line no longer in flight was already claimed by a late demand.
+             */
+            if( inflightPrefetches.Remove( request->address.GetPhysicalAddress( ) )
+                && prefetchBuffer.Insert( request->address.GetPhysicalAddress( ) ) )
             {
                 unsuccessfulPrefetches++;
-                //std::cout << "[+] Prefetch buffer is full. Removing oldest prefetch: 0x" << std::hex
-                //          << prefetchBuffer.front()->address.GetPhysicalAddress() << std::dec
-                //          << std::endl;
-
-                delete prefetchBuffer.front();
-                prefetchBuffer.pop_front();
+                UpdatePrefetchAccuracy( false );
             }
 
-            prefetchBuffer.push_back( request );
+            delete request;
             rv = true;
         }
         else
@@ -503,6 +665,15 @@ bool NVMain::RequestComplete( NVMainRequest *request )
             rv = true;
         }
     }
+    else if( GetDecoder( )->GetLookupLatency( ) > 0
+             && !(request->flags & NVMainRequest::FLAG_LOOKUP_DONE) )
+    {
+        /* The translation (e.g., a remap table) was looked up before issue. */
+        request->flags |= NVMainRequest::FLAG_LOOKUP_DONE;
+
+        GetEventQueue( )->InsertEvent( EventResponse, this, request,
+                GetEventQueue( )->GetCurrentCycle( ) + GetDecoder( )->GetLookupLatency( ) );
+    }
     else
     {
         rv = GetParent( )->RequestComplete( request );
@@ -532,10 +703,93 @@ void NVMain::RegisterStats( )
     AddStat(totalWriteRequests);
     AddStat(successfulPrefetches);
     AddStat(unsuccessfulPrefetches);
+    AddStat(issuedPrefetches);
+    AddStat(droppedPrefetches);
+    AddStat(throttledPrefetches);
+    AddStat(latePrefetches);
+    AddStat(untrackedPrefetches);
+    AddStat(prefetchAccuracy);
+    AddStat(prefetchCoverage);
+    AddStat(prefetchTimeliness);
+    AddStat(prefetchDegree);
+}
+
+/*
+ *  Idle once no command or response is scheduled on any of our queues,
+ *  e.g. the closing precharges issued after the last request completed.
+ */
+bool NVMain::Idle( )
+{
+    if( GetEventQueue( )->HasPendingRequests( ) )
+        return false;
+
+    for( size_t i = 0; i < channelQueues.size( ); i++ )
+    {
+        if( channelQueues[i]->HasPendingRequests( ) )
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ *  The owner of the front-end event queue checkpoints it. With
+ *  ParallelChannels the channel queues belong to us, and are restored
+ *  before the channels so that their state sees the checkpointed cycle.
+ */
+void NVMain::CreateCheckpoint( std::string dir )
+{
+    for( size_t i = 0; i < channelQueues.size( ); i++ )
+    {
+        std::stringstream queueName;
+        queueName << StatName( ) << ".channel" << i << ".events";
+
+        channelQueues[i]->CreateCheckpoint( dir, queueName.str( ) );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void NVMain::RestoreCheckpoint( std::string dir )
+{
+    for( size_t i = 0; i < channelQueues.size( ); i++ )
+    {
+        std::stringstream queueName;
+        queueName << StatName( ) << ".channel" << i << ".events";
+
+        channelQueues[i]->RestoreCheckpoint( dir, queueName.str( ) );
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
 }
 
 void NVMain::CalculateStats( )
 {
+    /* 
+     *  Accuracy: used prefetches over used plus evicted unused.
+     *  Coverage: demand reads served by prefetches, late ones included.
+     *  Timeliness: used prefetches that arrived before their demand.
+     */
+    ncounter_t usedPrefetches = successfulPrefetches + latePrefetches;
+
+    if( usedPrefetches + unsuccessfulPrefetches > 0 )
+    {
+        prefetchAccuracy = static_cast<double>( usedPrefetches )
+                         / static_cast<double>( usedPrefetches + unsuccessfulPrefetches );
+    }
+
+    if( successfulPrefetches + totalReadRequests > 0 )
+    {
+        prefetchCoverage = static_cast<double>( usedPrefetches )
+                         / static_cast<double>( successfulPrefetches + totalReadRequests );
+    }
+
+    if( usedPrefetches > 0 )
+    {
+        prefetchTimeliness = static_cast<double>( successfulPrefetches )
+                           / static_cast<double>( usedPrefetches );
+    }
+
     for( unsigned int i = 0; i < numChannels; i++ )
         memoryControllers[i]->CalculateStats( );
 }
@@ -545,3 +799,81 @@ void NVMain::EnqueuePendingMemoryRequests( NVMainRequest *req )
     pendingMemoryRequests.push(req);
 }
 
+/*
+ *  Channels only interact through the front end. Completions are exact as
+ *  long as nothing above the controllers reacts to them by issuing new work
+ *  or depends on the order of completions within a cycle, so hooks and the
+ *  prefetch buffer keep the serial queue.
+ */
+bool NVMain::CanRunChannelsInParallel( )
+{
+    std::string reason = "";
+
+    if( p->CHANNELS < 2 )
+        reason = "only one channel";
+    else if( GetGlobalEventQueue( ) == NULL )
+        reason = "no global event queue";
+    else if( GetParent( ) == NULL || NVMTypeMatches(MemoryController) )
+        reason = "nested memory system";
+    else if( !GetHooks( NVMHOOK_PREISSUE ).empty( ) || !GetHooks( NVMHOOK_POSTISSUE ).empty( ) )
+        reason = "hooks observe every channel";
+    else if( p->MemoryPrefetcher != "none" )
+        reason = "the prefetch buffer depends on completion order";
+
+    for( ncounter_t i = 0; reason == "" && i < p->CHANNELS; i++ )
+    {
+        /* Its off-chip memory is a separate system on the global queue. */
+        if( dynamic_cast<DRAMCache *>( memoryControllers[i] ) != NULL )
+            reason = "a DRAM cache channel drives its own main memory";
+    }
+
+    if( reason != "" )
+    {
+        std::cout << "[+] NVMain: ParallelChannels ignored, " << reason 
+                  << "." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool CompletesBefore( const ChannelCompletion& a, const ChannelCompletion& b )
+{
+    return a.cycle < b.cycle;
+}
+
+/*
+ *  Hands the completions posted during a window to the front end in cycle
+ *  order, then brings the front end queue to the end of the window. Ties
+ *  keep channel order.
+ */
+void NVMain::DeliverCompletions( ncycle_t windowEnd )
+{
+    EventQueue *frontEnd = GetEventQueue( );
+
+    deliveries.clear( );
+
+    for( size_t i = 0; i < mailboxes.size( ); i++ )
+    {
+        deliveries.insert( deliveries.end( ), mailboxes[i].begin( ), mailboxes[i].end( ) );
+        mailboxes[i].clear( );
+    }
+
+    std::stable_sort( deliveries.begin( ), deliveries.end( ), CompletesBefore );
+
+    deliveringCompletions = true;
+
+    for( size_t i = 0; i < deliveries.size( ); i++ )
+    {
+        if( deliveries[i].cycle > frontEnd->GetCurrentCycle( ) )
+            frontEnd->Loop( deliveries[i].cycle - frontEnd->GetCurrentCycle( ) );
+
+        RequestComplete( deliveries[i].request );
+    }
+
+    if( windowEnd >= frontEnd->GetCurrentCycle( ) )
+        frontEnd->Loop( windowEnd - frontEnd->GetCurrentCycle( ) );
+
+    deliveringCompletions = false;
+}
+
@@ -40,9 +40,11 @@
 #include "src/Params.h"
 #include "src/NVMObject.h"
 #include "src/Prefetcher.h"
+#include "src/PrefetchBuffer.h"
 #include "include/NVMainRequest.h"
 #include "traceWriter/GenericTraceWriter.h"
 #include <queue>
+#include <vector>
 
 namespace NVM {
 
@@ -53,6 +55,14 @@ class Interconnect;
 class AddressTranslator;
 class SimInterface;
 class NVMainRequest;
+class EventQueue;
+
+/* A completion posted by a channel running on its own event queue. */
+struct ChannelCompletion
+{
+    ncycle_t cycle;
+    NVMainRequest *request;
+};
 
 class NVMain : public NVMObject
 {
@@ -76,10 +86,20 @@ class NVMain : public NVMObject
     void RegisterStats( );
     void CalculateStats( );
 
+    bool Idle( );
+
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
     void Cycle( ncycle_t steps );
 
     void EnqueuePendingMemoryRequests( NVMainRequest *request );
 
+    void DeliverCompletions( ncycle_t windowEnd );
+
+    void SetLayerParams( std::shared_ptr<const LayerParams> layer );
+    std::shared_ptr<const LayerParams> GetLayerParams( );
+
   private:
     Config *config;
     Config **channelConfig;
@@ -90,19 +110,48 @@ class NVMain : public NVMObject
     ncounter_t totalWriteRequests;
     ncounter_t successfulPrefetches;
     ncounter_t unsuccessfulPrefetches;
+    ncounter_t issuedPrefetches;
+    ncounter_t droppedPrefetches;
+    ncounter_t throttledPrefetches;
+    ncounter_t latePrefetches;
+    ncounter_t untrackedPrefetches;
+    double prefetchAccuracy;
+    double prefetchCoverage;
+    double prefetchTimeliness;
 
     unsigned int numChannels;
     double syncValue;
 
     Prefetcher *prefetcher;
-    std::list<NVMainRequest *> prefetchBuffer;
+    PrefetchBuffer prefetchBuffer;
+    PrefetchBuffer inflightPrefetches;
+
+    /* Accuracy feedback for the prefetch throttle. */
+    ncounter_t prefetchDegree;
+    ncounter_t intervalUsefulPrefetches;
+    ncounter_t intervalUselessPrefetches;
     std::queue<NVMainRequest *> pendingMemoryRequests;
 
     std::ofstream pretraceOutput;
     GenericTraceWriter *preTracer;
 
+    /* Layer given to compute-in-memory requests that do not carry one. */
+    std::shared_ptr<const LayerParams> layerParams;
+
+    /* 
+     *  With ParallelChannels each channel runs on its own event queue and
+     *  completions wait in a per-channel mailbox until the window ends.
+     */
+    bool parallelChannels;
+    bool deliveringCompletions;
+    std::vector<EventQueue *> channelQueues;
+    std::vector< std::vector<ChannelCompletion> > mailboxes;
+    std::vector<ChannelCompletion> deliveries;
+
+    bool CanRunChannelsInParallel( );
     void PrintPreTrace( NVMainRequest *request );
     void GeneratePrefetches( NVMainRequest *request, std::vector<NVMAddress>& prefetchList );
+    void UpdatePrefetchAccuracy( bool useful );
 };
 
 };
@@ -0,0 +1,168 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Prefetchers/BestOffset/BestOffset.h"
+#include "include/NVMHelpers.h"
+#include "src/Config.h"
+
+using namespace NVM;
+
+BestOffset::BestOffset( )
+{
+    testIndex = 0;
+    round = 0;
+    maxScore = 31;
+    maxRounds = 100;
+    badScore = 1;
+
+    bestOffset = 1;
+    prefetchOn = true;
+
+    lineShift = 6;
+    pageShift = 12;
+}
+
+void BestOffset::SetConfig( Config *conf )
+{
+    uint64_t lineSize = 64, pageSize = 4096;
+    uint64_t rrEntries = 256;
+
+    conf->GetValueUL( "PrefetchLineSize", lineSize );
+    conf->GetValueUL( "PrefetchPageSize", pageSize );
+    conf->GetValueUL( "BORecentRequests", rrEntries );
+    conf->GetValueUL( "BOMaxScore", maxScore );
+    conf->GetValueUL( "BOMaxRounds", maxRounds );
+    conf->GetValueUL( "BOBadScore", badScore );
+
+    lineShift = mlog2( static_cast<int>( lineSize ) );
+    pageShift = mlog2( static_cast<int>( pageSize ) );
+
+    /* Offsets of the form 2^i * 3^j * 5^k that stay inside a page. */
+    int64_t pageLines = static_cast<int64_t>( pageSize / lineSize );
+
+    offsets.clear( );
+    for( int64_t d = 1; d < pageLines; d++ )
+    {
+        int64_t rest = d;
+
+        while( rest % 2 == 0 ) rest /= 2;
+        while( rest % 3 == 0 ) rest /= 3;
+        while( rest % 5 == 0 ) rest /= 5;
+
+        if( rest == 1 )
+            offsets.push_back( d );
+    }
+
+    if( offsets.empty( ) )
+        offsets.push_back( 1 );
+
+    scores.assign( offsets.size( ), 0 );
+    recentRequests.assign( (rrEntries > 0) ? rrEntries : 1, ~0ULL );
+}
+
+uint64_t BestOffset::RecentIndex( uint64_t line )
+{
+    return (line ^ (line >> 8)) % recentRequests.size( );
+}
+
+void BestOffset::EndPhase( )
+{
+    ncounter_t best = 0;
+
+    for( ncounter_t i = 1; i < scores.size( ); i++ )
+    {
+        if( scores[i] > scores[best] )
+            best = i;
+    }
+
+    bestOffset = offsets[best];
+    prefetchOn = (scores[best] > badScore);
+
+    scores.assign( scores.size( ), 0 );
+    testIndex = 0;
+    round = 0;
+}
+
+bool BestOffset::NotifyAccess( NVMainRequest *accessOp, 
+                               std::vector<NVMAddress>& prefetchList )
+{
+    return DoPrefetch( accessOp, prefetchList );
+}
+
+bool BestOffset::DoPrefetch( NVMainRequest *triggerOp, 
+                             std::vector<NVMAddress>& prefetchList )
+{
+    /* SetConfig was never called; use the defaults. */
+    if( offsets.empty( ) )
+        return false;
+
+    uint64_t line = triggerOp->address.GetPhysicalAddress( ) >> lineShift;
+    unsigned int pageLineShift = pageShift - lineShift;
+
+    /* Learning: test one offset per access. */
+    uint64_t base = line - static_cast<uint64_t>( offsets[testIndex] );
+
+    if( (base >> pageLineShift) == (line >> pageLineShift)
+        && recentRequests[RecentIndex( base )] == base )
+    {
+        scores[testIndex]++;
+    }
+
+    if( scores[testIndex] >= maxScore )
+    {
+        EndPhase( );
+    }
+    else if( ++testIndex == offsets.size( ) )
+    {
+        testIndex = 0;
+
+        if( ++round >= maxRounds )
+            EndPhase( );
+    }
+
+    recentRequests[RecentIndex( line )] = line;
+
+    if( !prefetchOn )
+        return false;
+
+    uint64_t target = line + static_cast<uint64_t>( bestOffset );
+
+    if( (target >> pageLineShift) != (line >> pageLineShift) )
+        return false;
+
+    NVMAddress pfAddr = triggerOp->address;
+    pfAddr.SetPhysicalAddress( target << lineShift );
+    prefetchList.push_back( pfAddr );
+
+    return true;
+}
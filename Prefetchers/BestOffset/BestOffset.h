@@ -0,0 +1,86 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __PREFETCHERS_BESTOFFSET_H__
+#define __PREFETCHERS_BESTOFFSET_H__
+
+#include "src/Prefetcher.h"
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Best-Offset prefetcher (Michaud, HPCA 2016). Each access tests one
+ *  candidate offset d against the recent-requests table: if line - d was
+ *  seen recently, d scores a point. A learning phase ends when an offset
+ *  reaches the maximum score or after a fixed number of rounds, and the
+ *  best offset is used until the next phase ends. Prefetching is turned
+ *  off while the best score stays too low.
+ *
+ *  The memory side does not see prefetch fills at the cache, so the
+ *  recent-requests table records demand lines instead of fill bases.
+ */
+class BestOffset : public Prefetcher
+{
+  public:
+    BestOffset( );
+    ~BestOffset( ) { }
+
+    void SetConfig( Config *conf );
+
+    bool NotifyAccess( NVMainRequest *accessOp, 
+                       std::vector<NVMAddress>& prefetchList );
+    bool DoPrefetch( NVMainRequest *triggerOp, 
+                     std::vector<NVMAddress>& prefetchList );
+
+  private:
+    std::vector<int64_t> offsets;
+    std::vector<ncounter_t> scores;
+    std::vector<uint64_t> recentRequests;
+
+    ncounter_t testIndex;
+    ncounter_t round;
+    ncounter_t maxScore, maxRounds, badScore;
+
+    int64_t bestOffset;
+    bool prefetchOn;
+
+    unsigned int lineShift, pageShift;
+
+    uint64_t RecentIndex( uint64_t line );
+    void EndPhase( );
+};
+
+};
+
+#endif
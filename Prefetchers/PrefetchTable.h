@@ -0,0 +1,119 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __PREFETCHERS_PREFETCHTABLE_H__
+#define __PREFETCHERS_PREFETCHTABLE_H__
+
+#include "include/NVMTypes.h"
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Fixed-size set-associative table with LRU replacement, shaped like the
+ *  tables a hardware prefetcher would have. Entries are allocated once in
+ *  SetSize, so training never allocates. Keys should already be hashed;
+ *  the set is the key modulo the number of sets.
+ */
+template<typename EntryType>
+class PrefetchTable
+{
+  public:
+    PrefetchTable( ) : sets(0), ways(0), useClock(0) { }
+
+    void SetSize( ncounter_t numSets, ncounter_t numWays )
+    {
+        sets = (numSets > 0) ? numSets : 1;
+        ways = (numWays > 0) ? numWays : 1;
+
+        entries.assign( sets * ways, EntryType( ) );
+        tags.assign( sets * ways, 0 );
+        valid.assign( sets * ways, false );
+        lastUse.assign( sets * ways, 0 );
+    }
+
+    EntryType *Find( uint64_t key )
+    {
+        ncounter_t base = (key % sets) * ways;
+
+        for( ncounter_t way = 0; way < ways; way++ )
+        {
+            if( valid[base + way] && tags[base + way] == key )
+            {
+                lastUse[base + way] = ++useClock;
+                return &entries[base + way];
+            }
+        }
+
+        return NULL;
+    }
+
+    /* Replaces an invalid or the least recently used way in key's set. */
+    EntryType *Allocate( uint64_t key )
+    {
+        ncounter_t base = (key % sets) * ways;
+        ncounter_t victim = base;
+
+        for( ncounter_t way = 0; way < ways; way++ )
+        {
+            if( !valid[base + way] )
+            {
+                victim = base + way;
+                break;
+            }
+
+            if( lastUse[base + way] < lastUse[victim] )
+                victim = base + way;
+        }
+
+        entries[victim] = EntryType( );
+        tags[victim] = key;
+        valid[victim] = true;
+        lastUse[victim] = ++useClock;
+
+        return &entries[victim];
+    }
+
+  private:
+    ncounter_t sets, ways;
+    uint64_t useClock;
+
+    std::vector<EntryType> entries;
+    std::vector<uint64_t> tags;
+    std::vector<bool> valid;
+    std::vector<uint64_t> lastUse;
+};
+
+};
+
+#endif
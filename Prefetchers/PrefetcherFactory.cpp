@@ -37,6 +37,9 @@
 /* Add your prefetcher's include file below. */
 #include "Prefetchers/NaivePrefetcher/NaivePrefetcher.h"
 #include "Prefetchers/STeMS/STeMS.h"
+#include "Prefetchers/StridePrefetcher/StridePrefetcher.h"
+#include "Prefetchers/BestOffset/BestOffset.h"
+#include "Prefetchers/SPP/SPP.h"
 
 using namespace NVM;
 
@@ -52,6 +55,12 @@ Prefetcher *PrefetcherFactory::CreateNewPrefetcher( std::string name )
         prefetcher = new NaivePrefetcher( );
     else if( name == "STeMS" ) 
         prefetcher = new STeMS( );
+    else if( name == "StridePrefetcher" ) 
+        prefetcher = new StridePrefetcher( );
+    else if( name == "BestOffset" ) 
+        prefetcher = new BestOffset( );
+    else if( name == "SPP" ) 
+        prefetcher = new SPP( );
 
     /*
      *  If prefetcher isn't found, default to the NULL prefetcher.
@@ -0,0 +1,195 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Prefetchers/SPP/SPP.h"
+#include "include/NVMHelpers.h"
+#include "src/Config.h"
+
+using namespace NVM;
+
+SPP::SPP( )
+{
+    threshold = 25;
+    maxDepth = 8;
+    counterMax = 15;
+    lineShift = 6;
+    pageShift = 12;
+
+    signatureTable.SetSize( 64, 4 );
+    patternTable.assign( 512, PatternEntry( ) );
+}
+
+void SPP::SetConfig( Config *conf )
+{
+    uint64_t lineSize = 64, pageSize = 4096;
+    uint64_t stSets = 64, stWays = 4, ptEntries = 512;
+
+    conf->GetValueUL( "PrefetchLineSize", lineSize );
+    conf->GetValueUL( "PrefetchPageSize", pageSize );
+    conf->GetValueUL( "SPPSignatureSets", stSets );
+    conf->GetValueUL( "SPPSignatureWays", stWays );
+    conf->GetValueUL( "SPPPatternEntries", ptEntries );
+    conf->GetValueUL( "SPPThreshold", threshold );
+    conf->GetValueUL( "SPPMaxDepth", maxDepth );
+
+    lineShift = mlog2( static_cast<int>( lineSize ) );
+    pageShift = mlog2( static_cast<int>( pageSize ) );
+
+    signatureTable.SetSize( stSets, stWays );
+    patternTable.assign( (ptEntries > 0) ? ptEntries : 1, PatternEntry( ) );
+}
+
+uint64_t SPP::NextSignature( uint64_t signature, int64_t delta )
+{
+    /* 12-bit signature; deltas are folded in as 7-bit sign-magnitude. */
+    uint64_t folded = (delta < 0) ? (static_cast<uint64_t>( -delta ) | 0x40)
+                                  : static_cast<uint64_t>( delta );
+
+    return ((signature << 3) ^ (folded & 0x7F)) & 0xFFF;
+}
+
+void SPP::UpdatePattern( uint64_t signature, int64_t delta )
+{
+    PatternEntry& pattern = patternTable[signature % patternTable.size( )];
+    int slot = -1;
+
+    for( int i = 0; i < PatternEntry::deltas; i++ )
+    {
+        if( pattern.deltaCount[i] > 0 && pattern.delta[i] == delta )
+        {
+            slot = i;
+            break;
+        }
+    }
+
+    /* Replace the weakest delta. */
+    if( slot == -1 )
+    {
+        slot = 0;
+        for( int i = 1; i < PatternEntry::deltas; i++ )
+        {
+            if( pattern.deltaCount[i] < pattern.deltaCount[slot] )
+                slot = i;
+        }
+
+        pattern.delta[slot] = delta;
+        pattern.deltaCount[slot] = 0;
+    }
+
+    pattern.deltaCount[slot]++;
+    pattern.sigCount++;
+
+    /* Saturating counters are halved together to keep their ratios. */
+    if( pattern.sigCount > counterMax )
+    {
+        pattern.sigCount /= 2;
+        for( int i = 0; i < PatternEntry::deltas; i++ )
+            pattern.deltaCount[i] /= 2;
+    }
+}
+
+bool SPP::NotifyAccess( NVMainRequest *accessOp, 
+                        std::vector<NVMAddress>& prefetchList )
+{
+    return DoPrefetch( accessOp, prefetchList );
+}
+
+bool SPP::DoPrefetch( NVMainRequest *triggerOp, 
+                      std::vector<NVMAddress>& prefetchList )
+{
+    uint64_t line = triggerOp->address.GetPhysicalAddress( ) >> lineShift;
+    unsigned int pageLineShift = pageShift - lineShift;
+    int64_t pageLines = static_cast<int64_t>( 1ULL << pageLineShift );
+    uint64_t page = line >> pageLineShift;
+    int64_t offset = static_cast<int64_t>( line & (pageLines - 1) );
+
+    SignatureEntry *entry = signatureTable.Find( page );
+
+    if( entry == NULL )
+    {
+        entry = signatureTable.Allocate( page );
+        entry->lastOffset = offset;
+        return false;
+    }
+
+    int64_t delta = offset - entry->lastOffset;
+
+    if( delta == 0 )
+        return false;
+
+    UpdatePattern( entry->signature, delta );
+
+    entry->signature = NextSignature( entry->signature, delta );
+    entry->lastOffset = offset;
+
+    /* Lookahead along the most confident path. */
+    uint64_t signature = entry->signature;
+    int64_t current = offset;
+    double confidence = 1.0;
+
+    for( ncounter_t depth = 0; depth < maxDepth; depth++ )
+    {
+        PatternEntry& pattern = patternTable[signature % patternTable.size( )];
+
+        if( pattern.sigCount == 0 )
+            break;
+
+        int best = 0;
+        for( int i = 1; i < PatternEntry::deltas; i++ )
+        {
+            if( pattern.deltaCount[i] > pattern.deltaCount[best] )
+                best = i;
+        }
+
+        confidence *= static_cast<double>( pattern.deltaCount[best] )
+                    / static_cast<double>( pattern.sigCount );
+
+        if( pattern.deltaCount[best] == 0 
+            || confidence * 100.0 < static_cast<double>( threshold ) )
+            break;
+
+        current += pattern.delta[best];
+
+        if( current < 0 || current >= pageLines )
+            break;
+
+        NVMAddress pfAddr = triggerOp->address;
+        pfAddr.SetPhysicalAddress( ((page << pageLineShift) + static_cast<uint64_t>( current )) 
+                                   << lineShift );
+        prefetchList.push_back( pfAddr );
+
+        signature = NextSignature( signature, pattern.delta[best] );
+    }
+
+    return !prefetchList.empty( );
+}
@@ -0,0 +1,104 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __PREFETCHERS_SPP_H__
+#define __PREFETCHERS_SPP_H__
+
+#include "src/Prefetcher.h"
+#include "Prefetchers/PrefetchTable.h"
+#include <vector>
+
+namespace NVM {
+
+struct SignatureEntry
+{
+    SignatureEntry( ) : lastOffset(0), signature(0) { }
+
+    int64_t lastOffset;
+    uint64_t signature;
+};
+
+struct PatternEntry
+{
+    static const int deltas = 4;
+
+    PatternEntry( ) : sigCount(0)
+    {
+        for( int i = 0; i < deltas; i++ )
+        {
+            delta[i] = 0;
+            deltaCount[i] = 0;
+        }
+    }
+
+    ncounter_t sigCount;
+    int64_t delta[deltas];
+    ncounter_t deltaCount[deltas];
+};
+
+/*
+ *  Signature Path Prefetcher (Kim et al., MICRO 2016). The signature table
+ *  compresses the last few line deltas seen in each page into a signature.
+ *  The pattern table maps a signature to the deltas that followed it. On
+ *  each access the prefetcher walks the most likely path ahead while the
+ *  product of delta confidences stays above SPPThreshold (in percent).
+ */
+class SPP : public Prefetcher
+{
+  public:
+    SPP( );
+    ~SPP( ) { }
+
+    void SetConfig( Config *conf );
+
+    bool NotifyAccess( NVMainRequest *accessOp, 
+                       std::vector<NVMAddress>& prefetchList );
+    bool DoPrefetch( NVMainRequest *triggerOp, 
+                     std::vector<NVMAddress>& prefetchList );
+
+  private:
+    PrefetchTable<SignatureEntry> signatureTable;
+    std::vector<PatternEntry> patternTable;
+
+    ncounter_t threshold;
+    ncounter_t maxDepth;
+    ncounter_t counterMax;
+    unsigned int lineShift, pageShift;
+
+    uint64_t NextSignature( uint64_t signature, int64_t delta );
+    void UpdatePattern( uint64_t signature, int64_t delta );
+};
+
+};
+
+#endif
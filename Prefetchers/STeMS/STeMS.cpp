@@ -33,14 +33,18 @@
 
 #include "Prefetchers/STeMS/STeMS.h"
 #include <iostream>
+#include <cassert>
 
 using namespace NVM;
 
 void STeMS::FetchNextUnused( PatternSequence *rps, int count, 
                              std::vector<NVMAddress>& prefetchList )
 {
-    uint64_t *lastUnused = new uint64_t[count];
-    bool *foundUnused = new bool[count];
+    /* A pattern holds at most 16 offsets, so the scratch space is fixed. */
+    uint64_t lastUnused[16];
+    bool foundUnused[16];
+
+    assert( count <= 16 );
 
     for( int i = 0; i < count; i++ )
     {
@@ -0,0 +1,134 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Prefetchers/StridePrefetcher/StridePrefetcher.h"
+#include "include/NVMHelpers.h"
+#include "src/Config.h"
+
+using namespace NVM;
+
+StridePrefetcher::StridePrefetcher( )
+{
+    degree = 4;
+    confidenceThreshold = 2;
+    maxConfidence = 3;
+    lineShift = 6;
+    pageShift = 12;
+
+    table.SetSize( 16, 4 );
+}
+
+void StridePrefetcher::SetConfig( Config *conf )
+{
+    uint64_t sets = 16, ways = 4;
+    uint64_t lineSize = 64, pageSize = 4096;
+
+    conf->GetValueUL( "StrideTableSets", sets );
+    conf->GetValueUL( "StrideTableWays", ways );
+    conf->GetValueUL( "StrideDegree", degree );
+    conf->GetValueUL( "StrideConfidence", confidenceThreshold );
+    conf->GetValueUL( "PrefetchLineSize", lineSize );
+    conf->GetValueUL( "PrefetchPageSize", pageSize );
+
+    if( confidenceThreshold > maxConfidence )
+        maxConfidence = confidenceThreshold;
+
+    lineShift = mlog2( static_cast<int>( lineSize ) );
+    pageShift = mlog2( static_cast<int>( pageSize ) );
+
+    table.SetSize( sets, ways );
+}
+
+bool StridePrefetcher::NotifyAccess( NVMainRequest *accessOp, 
+                                     std::vector<NVMAddress>& prefetchList )
+{
+    /* Hits in the prefetch buffer keep training so the stream keeps going. */
+    return DoPrefetch( accessOp, prefetchList );
+}
+
+bool StridePrefetcher::DoPrefetch( NVMainRequest *triggerOp, 
+                                   std::vector<NVMAddress>& prefetchList )
+{
+    uint64_t address = triggerOp->address.GetPhysicalAddress( );
+    uint64_t line = address >> lineShift;
+    uint64_t key = (triggerOp->programCounter << 8) ^ triggerOp->threadId;
+
+    StrideEntry *entry = table.Find( key );
+
+    if( entry == NULL )
+    {
+        entry = table.Allocate( key );
+        entry->lastLine = line;
+        return false;
+    }
+
+    int64_t delta = static_cast<int64_t>( line - entry->lastLine );
+
+    if( delta == 0 )
+        return false;
+
+    if( delta == entry->stride )
+    {
+        if( entry->confidence < maxConfidence )
+            entry->confidence++;
+    }
+    else
+    {
+        if( entry->confidence > 0 )
+            entry->confidence--;
+
+        if( entry->confidence == 0 )
+            entry->stride = delta;
+    }
+
+    entry->lastLine = line;
+
+    if( entry->confidence < confidenceThreshold )
+        return false;
+
+    unsigned int pageLineShift = pageShift - lineShift;
+
+    for( ncounter_t i = 1; i <= degree; i++ )
+    {
+        uint64_t target = line + static_cast<uint64_t>( entry->stride * static_cast<int64_t>( i ) );
+
+        if( (target >> pageLineShift) != (line >> pageLineShift) )
+            break;
+
+        NVMAddress pfAddr = triggerOp->address;
+        pfAddr.SetPhysicalAddress( target << lineShift );
+        prefetchList.push_back( pfAddr );
+    }
+
+    return !prefetchList.empty( );
+}
@@ -35,6 +35,7 @@
 
 #include "Ranks/StandardRank/StandardRank.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 #include "Banks/BankFactory.h"
 #include "rvSim/rvSim.h"
 
@@ -44,7 +45,6 @@
 
 using namespace NVM;
 
-extern GlobalParams globalparams;
 
 Addrgen::Addrgen( )
 {
@@ -53,6 +53,7 @@ Addrgen::Addrgen( )
     n_channel = 0;
     n_kernel = 0;
     complete = false;
+    layer = NULL;
 }
 
 Addrgen::~Addrgen( )
@@ -60,8 +61,9 @@ Addrgen::~Addrgen( )
 
 }
 
-void Addrgen::init( )
+void Addrgen::init( const LayerParams *layerParams )
 {
+    layer = layerParams;
     n_col = 0;
     n_row = 0;
     n_channel = 0;
@@ -71,20 +73,20 @@ void Addrgen::init( )
 
 void Addrgen::generator_input( )
 {
-    if( n_col < globalparams.Input_Col ) 
+    if( n_col < layer->Input_Col ) 
         n_col++;
-    else if( n_row < globalparams.Input_Row )
+    else if( n_row < layer->Input_Row )
     {
         n_col = 0;
         n_row++;
     }
-    else if( n_channel < globalparams.Input_Channel )
+    else if( n_channel < layer->Input_Channel )
     {
         n_col = 0;
         n_row = 0;
         n_channel++;
     }
-    else if ( ( n_col == globalparams.Input_Col ) && ( n_row == globalparams.Input_Row ) && ( n_channel == globalparams.Input_Channel ))
+    else if ( ( n_col == layer->Input_Col ) && ( n_row == layer->Input_Row ) && ( n_channel == layer->Input_Channel ))
     {
         complete = true;
     }
@@ -92,27 +94,27 @@ void Addrgen::generator_input( )
 
 void Addrgen::generator_weight( )
 {
-    if( n_col < globalparams.K_Col ) 
+    if( n_col < layer->K_Col ) 
         n_col++;
-    else if( n_row < globalparams.K_Row )
+    else if( n_row < layer->K_Row )
     {
         n_col = 0;
         n_row++;
     }
-    else if( n_channel < globalparams.K_Channel )
+    else if( n_channel < layer->K_Channel )
     {
         n_col = 0;
         n_row = 0;
         n_channel++;
     }
-    else if( n_kernel < globalparams.K_num )
+    else if( n_kernel < layer->K_num )
     {
         n_col = 0;
         n_row = 0;
         n_channel = 0;
         n_kernel++;
     }
-    else if ( ( n_col == globalparams.K_Col ) && ( n_row == globalparams.K_Row ) && ( n_channel == globalparams.K_Channel ) && ( n_kernel == globalparams.K_num ))
+    else if ( ( n_col == layer->K_Col ) && ( n_row == layer->K_Row ) && ( n_channel == layer->K_Channel ) && ( n_kernel == layer->K_num ))
     {
         complete = true;
     }
@@ -123,8 +125,8 @@ NVMAddress Addrgen::GetAddr_weight( NVMAddress *addr )
     NVMAddress nAddress;
     uint64_t Row, Col, Bank, Rank, Channel, Sub;
     uint64_t Offset;
-    Offset = n_col + n_row * globalparams.K_Row + n_channel * globalparams.K_Row * globalparams.K_Col;
-    Offset = Offset + n_kernel * globalparams.K_Row * globalparams.K_Col * globalparams.K_Channel;
+    Offset = n_col + n_row * layer->K_Row + n_channel * layer->K_Row * layer->K_Col;
+    Offset = Offset + n_kernel * layer->K_Row * layer->K_Col * layer->K_Channel;
     Offset = Offset / 8 ; // burst cycle is 8
     addr->GetTranslatedAddress( &Row, &Col, &Bank, &Rank, &Channel, &Sub );
     nAddress.SetTranslatedAddress( Row, Col + Offset, Bank, Rank, Channel, Sub );
@@ -179,6 +181,7 @@ StandardRank::StandardRank( )
     conf = NULL;
 
     state = STANDARDRANK_CLOSED;
+    backgroundSettledCycle = 0;
     backgroundEnergy = 0.0f;
 
     psInterval = 0;
@@ -283,7 +286,7 @@ void StandardRank::SetConfig( Config *c, bool createChildren )
 
 void StandardRank::RegisterStats( )
 {
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         AddUnitStat(totalEnergy, "mA*t");
         AddUnitStat(backgroundEnergy, "mA*t");
@@ -367,7 +370,7 @@ bool StandardRank::Activate( NVMainRequest *request )
         GetChild( request )->IssueCommand( request );
 
         if( state == STANDARDRANK_CLOSED )
-            state = STANDARDRANK_OPEN;
+            SetState( STANDARDRANK_OPEN );
 
         /* move to the next counter */
         RAWindex = (RAWindex + 1) % rawNum;
@@ -498,7 +501,7 @@ bool StandardRank::LoadWeight( NVMainRequest *request )
 {
     uint64_t readBank;
     std::cout << "[+] rec Load command in rank*****" << std::endl;
-    //addrgen.init();
+    //addrgen.init( request->layer.get( ) );
 
     request->address.GetTranslatedAddress( NULL, NULL, &readBank, NULL, NULL, NULL );
 
@@ -542,7 +545,7 @@ bool StandardRank::Transfer( NVMainRequest *request )
 {
     uint64_t readBank;
     std::cout << "[+] rec Transfer command in rank*****" << std::endl;
-    //addrgen.init();
+    //addrgen.init( request->layer.get( ) );
 
     request->address.GetTranslatedAddress( NULL, NULL, &readBank, NULL, NULL, NULL );
 
@@ -587,7 +590,7 @@ bool StandardRank::ReadCycle( NVMainRequest *request )
     uint64_t readBank;
     std::cout << "[+] rec readcycle command in rank*****" << std::endl;
     compute_flag = true;
-    //addrgen.init();
+    //addrgen.init( request->layer.get( ) );
 
     request->address.GetTranslatedAddress( NULL, NULL, &readBank, NULL, NULL, NULL );
 
@@ -683,7 +686,7 @@ bool StandardRank::WriteCycle( NVMainRequest *request )
 {
     uint64_t writeBank;
     std::cout << "[+] rec writecycle command in rank*****" << std::endl;
-    //addrgen.init();
+    //addrgen.init( request->layer.get( ) );
 
     request->address.GetTranslatedAddress( NULL, NULL, &writeBank, NULL, NULL, NULL );
 
@@ -771,7 +774,7 @@ bool StandardRank::Precharge( NVMainRequest *request )
     bool success = GetChild( request )->IssueCommand( request );
 
     if( Idle( ) )
-        state = STANDARDRANK_CLOSED;
+        SetState( STANDARDRANK_CLOSED );
 
     nextPrecharge = MAX( nextPrecharge, 
                          GetEventQueue()->GetCurrentCycle() + p->tPPD );
@@ -823,15 +826,15 @@ bool StandardRank::PowerDown( NVMainRequest *request )
     switch( request->type )
     {
         case POWERDOWN_PDA:
-            state = STANDARDRANK_PDA;
+            SetState( STANDARDRANK_PDA );
             break;
 
         case POWERDOWN_PDPF:
-            state = STANDARDRANK_PDPF;
+            SetState( STANDARDRANK_PDPF );
             break;
 
         case POWERDOWN_PDPS:
-            state = STANDARDRANK_PDPS;
+            SetState( STANDARDRANK_PDPS );
             break;
 
         default:
@@ -890,18 +893,18 @@ bool StandardRank::PowerUp( NVMainRequest *request )
     switch( state )
     {
         case STANDARDRANK_PDA:
-            state = STANDARDRANK_OPEN;
+            SetState( STANDARDRANK_OPEN );
             puTimer = p->tXP;
             break;
 
         case STANDARDRANK_PDPF:
             puTimer = p->tXP;
-            state = STANDARDRANK_CLOSED;
+            SetState( STANDARDRANK_CLOSED );
             break;
 
         case STANDARDRANK_PDPS:
             puTimer = p->tXPDLL;
-            state = STANDARDRANK_CLOSED;
+            SetState( STANDARDRANK_CLOSED );
             break;
 
         default:
@@ -937,7 +940,7 @@ bool StandardRank::Refresh( NVMainRequest *request )
         GetChild( refreshBankGroupHead+i )->IssueCommand( refReq );
     }
 
-    state = STANDARDRANK_REFRESHING;
+    SetState( STANDARDRANK_REFRESHING );
 
     request->owner = this;
     GetEventQueue( )->InsertEvent( EventResponse, this, request, 
@@ -1271,6 +1274,11 @@ bool StandardRank::IsIssuable( NVMainRequest *req, FailReason *reason )
     return rv;
 }
 
+bool StandardRank::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 bool StandardRank::IssueCommand( NVMainRequest *req )
 {
     bool rv = false;
@@ -1427,7 +1435,7 @@ bool StandardRank::RequestComplete( NVMainRequest* req )
             case REFRESH:
                 {
                     if( Idle( ) )
-                        state = STANDARDRANK_CLOSED;
+                        SetState( STANDARDRANK_CLOSED );
 
                     break;
                 }
@@ -1443,10 +1451,26 @@ bool StandardRank::RequestComplete( NVMainRequest* req )
         return GetParent( )->RequestComplete( req );
 }
 
-void StandardRank::Cycle( ncycle_t steps )
+/*
+ *  Background energy is counted when the state changes and when stats are
+ *  calculated. The banks do the same, so wake ups are not forwarded.
+ */
+void StandardRank::Cycle( ncycle_t /*steps*/ )
+{
+}
+
+void StandardRank::SetState( StandardRank_State newState )
+{
+    SettleBackground( );
+    state = newState;
+}
+
+void StandardRank::SettleBackground( )
 {
-    for( ncounter_t childIdx = 0; childIdx < GetChildCount( ); childIdx++ )
-        GetChild( childIdx )->Cycle( steps );
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+    ncycle_t steps = now - backgroundSettledCycle;
+
+    backgroundSettledCycle = now;
 
     /* Count cycle numbers and calculate background energy for each state */
     switch( state )
@@ -1454,7 +1478,7 @@ void StandardRank::Cycle( ncycle_t steps )
         /* active powerdown */
         case STANDARDRANK_PDA:
             fastExitActiveCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
                 backgroundEnergy += ( p->EIDD3P * (double)steps ) * (double)deviceCount;  
             else
                 backgroundEnergy += ( p->Epda * (double)steps );  
@@ -1463,7 +1487,7 @@ void StandardRank::Cycle( ncycle_t steps )
         /* precharge powerdown fast exit */
         case STANDARDRANK_PDPF:
             fastExitPrechargeCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
                 backgroundEnergy += ( p->EIDD2P1 * (double)steps ) * (double)deviceCount;
             else 
                 backgroundEnergy += ( p->Epdpf * (double)steps );  
@@ -1472,7 +1496,7 @@ void StandardRank::Cycle( ncycle_t steps )
         /* precharge powerdown slow exit */
         case STANDARDRANK_PDPS:
             slowExitCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
                 backgroundEnergy += ( p->EIDD2P0 * (double)steps ) * (double)deviceCount;  
             else 
                 backgroundEnergy += ( p->Epdps * (double)steps );  
@@ -1482,7 +1506,7 @@ void StandardRank::Cycle( ncycle_t steps )
         case STANDARDRANK_REFRESHING:
         case STANDARDRANK_OPEN:
             activeCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
                 backgroundEnergy += ( p->EIDD3N * (double)steps ) * (double)deviceCount;  
             else
                 backgroundEnergy += ( p->Eactstdby * (double)steps );  
@@ -1491,14 +1515,14 @@ void StandardRank::Cycle( ncycle_t steps )
         /* precharge standby */
         case STANDARDRANK_CLOSED:
             standbyCycles += steps;
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
                 backgroundEnergy += ( p->EIDD2N * (double)steps ) * (double)deviceCount;  
             else
                 backgroundEnergy += ( p->Eprestdby * (double)steps );  
             break;
 
         default:
-            if( p->EnergyModel == "current" )
+            if( p->energyModel == EnergyModel_Current )
                 backgroundEnergy += ( p->EIDD2N * (double)steps ) * (double)deviceCount;  
             else
                 backgroundEnergy += ( p->Eprestdby * (double)steps );  
@@ -1510,6 +1534,8 @@ void StandardRank::CalculateStats( )
 {
     NVMObject::CalculateStats( );
 
+    SettleBackground( );
+
     totalEnergy = activateEnergy = burstEnergy = refreshEnergy = 0.0;
     totalPower = backgroundPower = activatePower = burstPower = refreshPower = 0.0;
     reads = writes = 0;
@@ -1537,7 +1563,7 @@ void StandardRank::CalculateStats( )
     /* Get simulation time in nanoseconds (ns). Since energy is in nJ, energy / ns = W */
     double simulationTime = 1.0;
     
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         simulationTime = GetEventQueue()->GetCurrentCycle() - lastReset;
     }
@@ -1550,7 +1576,7 @@ void StandardRank::CalculateStats( )
     if( simulationTime != 0 )
     {
         /* power in W */
-        if( p->EnergyModel == "current" )
+        if( p->energyModel == EnergyModel_Current )
         {
             backgroundPower = ( backgroundEnergy / (double)deviceCount * p->Voltage ) / (double)simulationTime / 1000.0; 
             activatePower = ( activateEnergy * p->Voltage ) / (double)simulationTime / 1000.0; 
@@ -1567,7 +1593,7 @@ void StandardRank::CalculateStats( )
     }
 
     /* Current mode is measured on a per-device basis. */
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         /* energy breakdown. device is in lockstep within a rank */
         activateEnergy *= (double)deviceCount;
@@ -1593,3 +1619,64 @@ void StandardRank::ResetStats( )
     lastReset = GetEventQueue()->GetCurrentCycle();
 }
 
+/* Compute-in-memory operations in progress are not saved. */
+void StandardRank::CreateCheckpoint( std::string dir )
+{
+    /* The background energy is saved with the stats. */
+    SettleBackground( );
+
+    CheckpointWriter cpt( dir, StatName( ), 1 );
+
+    if( cpt.IsOpen( ) )
+    {
+        cpt.Write( state );
+        cpt.Write( stateTimeout );
+        cpt.Write( nextRead );
+        cpt.Write( nextWrite );
+        cpt.Write( nextActivate );
+        cpt.Write( nextPrecharge );
+        cpt.Write( lastReset );
+
+        cpt.Write( rawNum );
+        cpt.Write( RAWindex );
+        for( ncounter_t i = 0; i < rawNum; i++ )
+            cpt.Write( lastActivate[i] );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void StandardRank::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ), 1 );
+
+    if( cpt.IsOpen( ) )
+    {
+        state = static_cast<StandardRank_State>( cpt.Read( ) );
+        stateTimeout = cpt.Read( );
+        nextRead = cpt.Read( );
+        nextWrite = cpt.Read( );
+        nextActivate = cpt.Read( );
+        nextPrecharge = cpt.Read( );
+        lastReset = cpt.Read( );
+
+        /* A different activation window size starts with an empty window. */
+        ncounter_t savedRawNum = cpt.Read( );
+        ncounter_t savedIndex = cpt.Read( );
+
+        if( savedRawNum == rawNum )
+        {
+            RAWindex = savedIndex;
+            for( ncounter_t i = 0; i < rawNum; i++ )
+                lastActivate[i] = cpt.Read( );
+        }
+
+        if( !cpt.Good( ) )
+            std::cout << "[+] " << StatName( ) << ": Warning: Checkpoint is truncated." << std::endl;
+    }
+
+    backgroundSettledCycle = GetEventQueue( )->GetCurrentCycle( );
+
+    NVMObject::RestoreCheckpoint( dir );
+}
+
@@ -75,7 +75,7 @@ class Addrgen
     Addrgen();
     ~Addrgen();
 
-    void init();
+    void init( const LayerParams *layerParams );
     NVMAddress GetAddr_weight( NVMAddress *addr );
     NVMAddress GetAddr_input( NVMAddress *addr );
     void generator_weight();
@@ -85,6 +85,7 @@ class Addrgen
   protected:
     ncounter_t n_col, n_row, n_channel, n_kernel;
     bool complete;
+    const LayerParams *layer;
 
 };
 
@@ -97,6 +98,7 @@ class StandardRank : public Rank
     void SetConfig( Config *c, bool createChildren = true );
 
     bool IssueCommand( NVMainRequest *request );
+    bool IssueAtomic( NVMainRequest *request );
     bool IsIssuable( NVMainRequest *request, FailReason *reason = NULL );
     void Notify( NVMainRequest *request );
     bool RequestComplete( NVMainRequest* );
@@ -112,6 +114,9 @@ class StandardRank : public Rank
     void CalculateStats( );
     void ResetStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   protected:
     Config *conf;
     ncounter_t stateTimeout;
@@ -139,6 +144,9 @@ class StandardRank : public Rank
     ncounter_t slowExitCycles;
     ncycle_t lastReset;
 
+    /* Background energy in the current state up to here is already counted. */
+    ncycle_t backgroundSettledCycle;
+
     ncounter_t rrdWaits;
     ncounter_t rrdWaitTotal;
     double rrdWaitAverage;
@@ -163,6 +171,8 @@ class StandardRank : public Rank
     bool PowerUp( NVMainRequest *request );
     bool CanPowerDown( NVMainRequest *request );
     bool CanPowerUp( NVMainRequest *request );
+    void SetState( StandardRank_State newState );
+    void SettleBackground( );
     bool LoadWeight( NVMainRequest *request );
     bool Transfer( NVMainRequest *request );
     bool ReadCycle( NVMainRequest *request );
@@ -0,0 +1,222 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+/*
+ *  Microbenchmark of the write-data bit counts done on every SubArray
+ *  write. Times CountMLC2Levels and CountOneBits with each kernel this CPU
+ *  supports, and the four-pass 32-bit SWAR code SubArray used before, in
+ *  nanoseconds per block. Built and run by "make bench".
+ *
+ *  Usage: BitCountBench [BLOCKS] [BYTES]
+ */
+
+#include "include/NVMHelpers.h"
+#include "include/NVMRandom.h"
+
+#include <sys/time.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace NVM;
+
+namespace {
+
+/* Enough distinct blocks to defeat branch prediction, small enough for L1. */
+const uint64_t benchBlocks = 256;
+
+double Now( )
+{
+    struct timeval tv;
+
+    gettimeofday( &tv, NULL );
+
+    return static_cast<double>( tv.tv_sec ) + static_cast<double>( tv.tv_usec ) / 1e6;
+}
+
+/* The former SubArray::Count32MLC1 and Count32MLC2. */
+uint64_t Count32MLC1( uint32_t data )
+{
+    uint32_t count = data;
+    count = count - ((count >> 1) & 0x55555555);
+    count = (count & 0x33333333) + ((count >> 2) & 0x33333333);
+    count = (((count + (count >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+
+    return static_cast<uint64_t>(count);
+}
+
+uint64_t Count32MLC2( uint8_t value, uint32_t data )
+{
+    if( value == 0 )
+        data ^= 0xFFFFFFFF;
+    else if( value == 1 )
+        data ^= 0xAAAAAAAA;
+    else if( value == 2 )
+        data ^= 0x55555555;
+
+    uint32_t count = (data & 0x55555555) & ((data & 0xAAAAAAAA) >> 1);
+
+    return Count32MLC1(count);
+}
+
+/* One pass per level, as SubArray::WriteCellData did. */
+void OldMLC2Levels( const uint8_t *data, uint64_t bytes, uint64_t counts[4] )
+{
+    for( uint8_t value = 0; value < 4; value++ )
+    {
+        counts[value] = 0;
+
+        for( uint64_t byte = 0; byte + 4 <= bytes; byte += 4 )
+        {
+            uint32_t word;
+
+            memcpy( &word, data + byte, sizeof(word) );
+            counts[value] += Count32MLC2( value, word );
+        }
+    }
+}
+
+uint64_t OldOneBits( const uint8_t *data, uint64_t bytes )
+{
+    uint64_t count = 0;
+
+    for( uint64_t byte = 0; byte + 4 <= bytes; byte += 4 )
+    {
+        uint32_t word;
+
+        memcpy( &word, data + byte, sizeof(word) );
+        count += Count32MLC1( word );
+    }
+
+    return count;
+}
+
+/* Returns nanoseconds per block and adds the counts to checksum. */
+double TimeMLC2( bool old, const std::vector<uint8_t>& data, uint64_t bytes,
+                 uint64_t iterations, uint64_t& checksum )
+{
+    uint64_t counts[4];
+    double start = Now( );
+
+    for( uint64_t i = 0; i < iterations; i++ )
+    {
+        const uint8_t *block = &data[( i % benchBlocks ) * bytes];
+
+        if( old )
+            OldMLC2Levels( block, bytes, counts );
+        else
+            CountMLC2Levels( block, bytes, counts );
+
+        checksum += counts[1] + 3 * counts[2] + 7 * counts[3];
+    }
+
+    return ( Now( ) - start ) * 1e9 / static_cast<double>( iterations );
+}
+
+double TimeOneBits( bool old, const std::vector<uint8_t>& data, uint64_t bytes,
+                    uint64_t iterations, uint64_t& checksum )
+{
+    double start = Now( );
+
+    for( uint64_t i = 0; i < iterations; i++ )
+    {
+        const uint8_t *block = &data[( i % benchBlocks ) * bytes];
+
+        checksum += ( old ? OldOneBits( block, bytes ) : CountOneBits( block, bytes ) );
+    }
+
+    return ( Now( ) - start ) * 1e9 / static_cast<double>( iterations );
+}
+
+void Report( const char *kernel, uint64_t bytes, double mlc2, double ones )
+{
+    std::cout << "[+] BitCountBench: " << kernel << ", " << bytes << "-byte blocks: "
+              << mlc2 << " ns MLC levels, " << ones << " ns one bits" << std::endl;
+}
+
+}
+
+int main( int argc, char *argv[] )
+{
+    uint64_t iterations = 5000000;
+    uint64_t bytes = 64;
+
+    if( argc > 1 )
+        iterations = strtoull( argv[1], NULL, 10 );
+    if( argc > 2 )
+        bytes = strtoull( argv[2], NULL, 10 );
+
+    /* The old code only counted whole 32-bit words. */
+    bytes = ( bytes < 4 ) ? 4 : bytes - bytes % 4;
+
+    std::vector<uint8_t> data( benchBlocks * bytes );
+    RandomGenerator rng;
+    uint64_t expected = 0, checksum = 0;
+
+    rng.Seed( 1, "BitCountBench" );
+
+    for( uint64_t byte = 0; byte < data.size( ); byte++ )
+        data[byte] = static_cast<uint8_t>( rng.NextBelow( 256 ) );
+
+    double oldMLC2 = TimeMLC2( true, data, bytes, iterations, expected );
+    double oldOnes = TimeOneBits( true, data, bytes, iterations, expected );
+
+    Report( "old four-pass", bytes, oldMLC2, oldOnes );
+
+    BitCountKernel selected = GetBitCountKernel( );
+
+    for( int k = BITCOUNT_SCALAR; k < BITCOUNT_KERNELS; k++ )
+    {
+        BitCountKernel kernel = static_cast<BitCountKernel>( k );
+
+        if( !SetBitCountKernel( kernel ) )
+            continue;
+
+        checksum = 0;
+
+        double mlc2 = TimeMLC2( false, data, bytes, iterations, checksum );
+        double ones = TimeOneBits( false, data, bytes, iterations, checksum );
+
+        Report( BitCountKernelName( kernel ), bytes, mlc2, ones );
+
+        /* Keeps the counts from being optimized away. */
+        if( checksum != expected )
+            std::cout << "[-] BitCountBench: " << BitCountKernelName( kernel )
+                      << " counts differ from the old code." << std::endl;
+    }
+
+    SetBitCountKernel( selected );
+
+    return 0;
+}
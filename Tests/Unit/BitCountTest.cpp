@@ -0,0 +1,232 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+/*
+ *  Checks every bit counting kernel this CPU can run against the 32-bit
+ *  SWAR logic SubArray used before the kernels (Count32MLC1/Count32MLC2),
+ *  on empty, partial and multi-word blocks at every byte alignment. Built
+ *  and run by "make check". The exit status is the number of failed checks.
+ */
+
+#include "include/NVMHelpers.h"
+#include "include/NVMRandom.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace NVM;
+
+namespace {
+
+unsigned int failures = 0;
+
+void Check( bool condition, std::string what )
+{
+    if( !condition )
+    {
+        std::cout << "[-] BitCountTest: " << what << std::endl;
+        failures++;
+    }
+}
+
+/* The former SubArray::Count32MLC1. */
+uint64_t Count32MLC1( uint32_t data )
+{
+    uint32_t count = data;
+    count = count - ((count >> 1) & 0x55555555);
+    count = (count & 0x33333333) + ((count >> 2) & 0x33333333);
+    count = (((count + (count >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+
+    return static_cast<uint64_t>(count);
+}
+
+/* The former SubArray::Count32MLC2. */
+uint64_t Count32MLC2( uint8_t value, uint32_t data )
+{
+    if( value == 0 )
+        data ^= 0xFFFFFFFF;
+    else if( value == 1 )
+        data ^= 0xAAAAAAAA;
+    else if( value == 2 )
+        data ^= 0x55555555;
+
+    uint32_t count = (data & 0x55555555) & ((data & 0xAAAAAAAA) >> 1);
+
+    return Count32MLC1(count);
+}
+
+/*
+ *  The old helpers only took whole 32-bit words. A partial block is zero
+ *  padded, and the padding cells are taken back out of level 00.
+ */
+void ReferenceCounts( const uint8_t *data, uint64_t bytes, uint64_t counts[4],
+                      uint64_t& ones )
+{
+    uint64_t words = ( bytes + 3 ) / 4;
+    std::vector<uint32_t> padded( words, 0 );
+
+    if( bytes > 0 )
+        memcpy( &padded[0], data, bytes );
+
+    ones = 0;
+    counts[0] = counts[1] = counts[2] = counts[3] = 0;
+
+    for( uint64_t word = 0; word < words; word++ )
+    {
+        ones += Count32MLC1( padded[word] );
+
+        for( uint8_t value = 0; value < 4; value++ )
+            counts[value] += Count32MLC2( value, padded[word] );
+    }
+
+    counts[0] -= ( words * 4 - bytes ) * 4;
+}
+
+/*
+ *  The block is copied to the end of its own allocation so a kernel
+ *  reading past the last byte shows up under a memory checker.
+ */
+void CheckBlock( BitCountKernel kernel, const std::vector<uint8_t>& source,
+                 uint64_t offset, uint64_t bytes, std::string pattern )
+{
+    std::vector<uint8_t> buffer( offset + bytes );
+    uint64_t expected[4], counts[4], expectedOnes;
+
+    for( uint64_t byte = 0; byte < bytes; byte++ )
+        buffer[offset + byte] = source[byte];
+
+    const uint8_t *data = ( buffer.empty( ) ? NULL : &buffer[0] ) + offset;
+
+    ReferenceCounts( data, bytes, expected, expectedOnes );
+    CountMLC2Levels( data, bytes, counts );
+
+    std::stringstream what;
+
+    what << BitCountKernelName( kernel ) << " kernel, " << pattern << " block of "
+         << bytes << " bytes at offset " << offset;
+
+    Check( CountOneBits( data, bytes ) == expectedOnes, what.str( ) + ": one bits" );
+
+    for( int value = 0; value < 4; value++ )
+    {
+        std::stringstream level;
+
+        level << ": level " << value << " cells " << counts[value] 
+              << ", expected " << expected[value];
+
+        Check( counts[value] == expected[value], what.str( ) + level.str( ) );
+    }
+}
+
+void CheckKernel( BitCountKernel kernel )
+{
+    const uint64_t maxBytes = 300;
+    std::vector<uint8_t> random( maxBytes ), zeros( maxBytes, 0x00 );
+    std::vector<uint8_t> allOnes( maxBytes, 0xFF ), levels( maxBytes );
+    const uint8_t levelBytes[4] = { 0xE4, 0x39, 0x4E, 0x93 };
+    RandomGenerator rng;
+
+    rng.Seed( 1, "BitCountTest" );
+
+    for( uint64_t byte = 0; byte < maxBytes; byte++ )
+    {
+        random[byte] = static_cast<uint8_t>( rng.NextBelow( 256 ) );
+        /* Every byte holds one cell of each level, in rotating order. */
+        levels[byte] = levelBytes[byte % 4];
+    }
+
+    /* Zero length, partial words and several vector widths (32 and 64 bytes). */
+    for( uint64_t bytes = 0; bytes <= maxBytes; bytes++ )
+    {
+        for( uint64_t offset = 0; offset < 8; offset++ )
+        {
+            CheckBlock( kernel, random, offset, bytes, "random" );
+            CheckBlock( kernel, zeros, offset, bytes, "all-zero" );
+            CheckBlock( kernel, allOnes, offset, bytes, "all-one" );
+            CheckBlock( kernel, levels, offset, bytes, "mixed-level" );
+        }
+    }
+
+    /* Fresh random data for a typical 64-byte memory word. */
+    for( uint64_t trial = 0; trial < 10000; trial++ )
+    {
+        for( uint64_t byte = 0; byte < 64; byte++ )
+            random[byte] = static_cast<uint8_t>( rng.NextBelow( 256 ) );
+
+        CheckBlock( kernel, random, 0, 64, "random 64-byte" );
+    }
+}
+
+}
+
+int main( )
+{
+    BitCountKernel selected = GetBitCountKernel( );
+    BitCountKernel best = BITCOUNT_SCALAR;
+
+    for( int k = BITCOUNT_SCALAR; k < BITCOUNT_KERNELS; k++ )
+    {
+        BitCountKernel kernel = static_cast<BitCountKernel>( k );
+
+        if( !BitCountKernelSupported( kernel ) )
+        {
+            Check( !SetBitCountKernel( kernel ), 
+                   std::string( "selecting unsupported kernel " ) + BitCountKernelName( kernel ) );
+            std::cout << "[+] BitCountTest: " << BitCountKernelName( kernel )
+                      << " kernel not supported by this CPU, skipped." << std::endl;
+            continue;
+        }
+
+        best = kernel;
+
+        Check( SetBitCountKernel( kernel ), 
+               std::string( "selecting supported kernel " ) + BitCountKernelName( kernel ) );
+        Check( GetBitCountKernel( ) == kernel, 
+               std::string( "active kernel after selecting " ) + BitCountKernelName( kernel ) );
+
+        CheckKernel( kernel );
+    }
+
+    Check( selected == best, "startup selection is the fastest supported kernel" );
+    Check( !SetBitCountKernel( BITCOUNT_KERNELS ), "selecting an invalid kernel" );
+
+    SetBitCountKernel( selected );
+
+    if( failures == 0 )
+        std::cout << "[+] BitCountTest: all checks passed." << std::endl;
+
+    return static_cast<int>( failures );
+}
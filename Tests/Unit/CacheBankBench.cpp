@@ -0,0 +1,157 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+/*
+ *  Microbenchmark of CacheBank tag probes per second. "make bench" builds
+ *  it twice: CacheBankBench uses the SIMD tag compare enabled by the
+ *  compiler flags (SSE2 on x86-64, AVX2 with ARCHFLAGS=-mavx2), and
+ *  CacheBankBench-scalar builds CacheBank with NVM_SCALAR_TAG_COMPARE.
+ *
+ *  Usage: CacheBankBench [PROBES] [ASSOC ...]
+ */
+
+#include "Utils/Caches/CacheBank.h"
+#include "include/NVMRandom.h"
+
+#include <sys/time.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace NVM;
+
+namespace {
+
+const uint64_t benchSets = 4096;
+
+double Now( )
+{
+    struct timeval tv;
+
+    gettimeofday( &tv, NULL );
+
+    return static_cast<double>( tv.tv_sec ) + static_cast<double>( tv.tv_usec ) / 1e6;
+}
+
+/*
+ *  Fill every set and probe with a mix of hits and misses. Half of the
+ *  probes look for a resident line at a random way, the other half for a
+ *  tag that is not in the set, so each miss compares every way.
+ */
+double ProbesPerSecond( uint64_t assoc, uint64_t probes )
+{
+    CacheBank bank( 1, benchSets, assoc, 64, false );
+    RandomGenerator rng;
+    std::vector<NVMAddress> addrs( 4096 );
+    NVMDataBlock block;
+    uint64_t hits = 0;
+
+    rng.Seed( 1, "CacheBankBench" );
+
+    for( uint64_t set = 0; set < benchSets; set++ )
+    {
+        for( uint64_t way = 0; way < assoc; way++ )
+        {
+            NVMAddress addr( 0, set, 0, 0, 0, 0 );
+
+            addr.SetPhysicalAddress( ( way * benchSets + set ) * 64 );
+            bank.Install( addr, block );
+        }
+    }
+
+    for( uint64_t i = 0; i < addrs.size( ); i++ )
+    {
+        uint64_t set = rng.NextBelow( benchSets );
+        uint64_t way = rng.NextBelow( assoc );
+        uint64_t tag = ( way * benchSets + set ) * 64;
+
+        if( i % 2 )
+            tag += assoc * benchSets * 64;
+
+        addrs[i].SetTranslatedAddress( 0, set, 0, 0, 0, 0 );
+        addrs[i].SetPhysicalAddress( tag );
+    }
+
+    double start = Now( );
+
+    for( uint64_t i = 0; i < probes; i++ )
+    {
+        if( bank.Present( addrs[i % addrs.size( )] ) )
+            hits++;
+    }
+
+    double elapsed = Now( ) - start;
+
+    /* Keep the probes from being optimized away. */
+    if( hits != probes - probes / 2 )
+        std::cout << "[-] CacheBankBench: unexpected hit count " << hits << std::endl;
+
+    return static_cast<double>( probes ) / elapsed;
+}
+
+}
+
+int main( int argc, char *argv[] )
+{
+    uint64_t probes = 20000000;
+    std::vector<uint64_t> assocs;
+
+    if( argc > 1 )
+        probes = strtoull( argv[1], NULL, 10 );
+
+    for( int arg = 2; arg < argc; arg++ )
+        assocs.push_back( strtoull( argv[arg], NULL, 10 ) );
+
+    if( assocs.empty( ) )
+    {
+        assocs.push_back( 4 );
+        assocs.push_back( 8 );
+        assocs.push_back( 16 );
+        assocs.push_back( 29 );
+    }
+
+#if defined(NVM_SCALAR_TAG_COMPARE)
+    const char *compare = "scalar";
+#else
+    const char *compare = "SIMD";
+#endif
+
+    for( uint64_t i = 0; i < assocs.size( ); i++ )
+    {
+        std::cout << "[+] CacheBankBench: " << compare << " tag compare, " 
+                  << assocs[i] << " ways, " << ProbesPerSecond( assocs[i], probes )
+                  << " probes/s" << std::endl;
+    }
+
+    return 0;
+}
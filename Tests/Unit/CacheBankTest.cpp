@@ -0,0 +1,266 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+/*
+ *  Unit checks for CacheBank tag lookup and the replacement policies that
+ *  can be selected with DRCReplacement/MissMapReplacement. Built and run by
+ *  "make check". The exit status is the number of failed checks.
+ */
+
+#include "Utils/Caches/CacheBank.h"
+#include "include/NVMRandom.h"
+
+#include <iostream>
+#include <string>
+
+using namespace NVM;
+
+namespace {
+
+unsigned int failures = 0;
+
+void Check( bool condition, std::string what )
+{
+    if( !condition )
+    {
+        std::cout << "[-] CacheBankTest: " << what << std::endl;
+        failures++;
+    }
+}
+
+/* Every test line maps to row 0, set 0; the tag is the physical address. */
+NVMAddress LineAddress( uint64_t tag )
+{
+    NVMAddress addr( 0, 0, 0, 0, 0, 0 );
+
+    addr.SetPhysicalAddress( tag );
+
+    return addr;
+}
+
+void InstallLine( CacheBank& bank, uint64_t tag )
+{
+    NVMAddress addr = LineAddress( tag );
+    NVMDataBlock block;
+
+    Check( bank.Install( addr, block ), "install of a line into a free way" );
+}
+
+void TouchLine( CacheBank& bank, uint64_t tag )
+{
+    NVMAddress addr = LineAddress( tag );
+    NVMDataBlock block;
+
+    Check( bank.Read( addr, &block ), "read of a present line" );
+}
+
+uint64_t Victim( CacheBank& bank )
+{
+    NVMAddress addr = LineAddress( 0 );
+    NVMAddress victim;
+
+    bank.ChooseVictim( addr, &victim );
+
+    return victim.GetPhysicalAddress( );
+}
+
+/*
+ *  Fill every way and look each tag up again. Odd associativities cover
+ *  the scalar tail after the SIMD compares. The upper tags differ from
+ *  their neighbours only in the high 32 bits, which the SSE2 path compares
+ *  as two halves.
+ */
+void CheckFindWay( uint64_t assoc )
+{
+    CacheBank bank( 1, 1, assoc, 64, false );
+    NVMAddress addr;
+
+    for( uint64_t way = 0; way < assoc; way++ )
+    {
+        addr = LineAddress( 0x40 * way + 0x40 );
+        Check( !bank.Present( addr ), "lookup of a line before it is installed" );
+
+        InstallLine( bank, 0x40 * way + 0x40 );
+    }
+
+    addr = LineAddress( 0x40 );
+    Check( bank.SetFull( addr ), "set is full after every way is installed" );
+
+    for( uint64_t way = 0; way < assoc; way++ )
+    {
+        addr = LineAddress( 0x40 * way + 0x40 );
+        Check( bank.Present( addr ), "lookup of an installed line" );
+
+        addr = LineAddress( ( 0x40 * way + 0x40 ) | ( 1ULL << 40 ) );
+        Check( !bank.Present( addr ), "lookup of a tag differing in the high half" );
+    }
+}
+
+/* Lines A-D fill a 4-way set; A is touched last so B is least recent. */
+void CheckLRU( )
+{
+    CacheBank bank( 1, 1, 4, 64, false );
+
+    Check( bank.SetReplacementPolicy( "LRU", 1 ), "LRU is a known policy" );
+
+    InstallLine( bank, 0x100 );
+    InstallLine( bank, 0x200 );
+    InstallLine( bank, 0x300 );
+    InstallLine( bank, 0x400 );
+    TouchLine( bank, 0x100 );
+
+    Check( Victim( bank ) == 0x200, "LRU evicts the least recently used line" );
+
+    TouchLine( bank, 0x200 );
+    TouchLine( bank, 0x300 );
+
+    Check( Victim( bank ) == 0x400, "LRU victim follows later touches" );
+}
+
+/*
+ *  Installing D sets the last clear bit, so a new epoch keeps only D. After
+ *  A and B are touched the first clear bit belongs to C.
+ */
+void CheckPLRU( )
+{
+    CacheBank bank( 1, 1, 4, 64, false );
+
+    Check( bank.SetReplacementPolicy( "PLRU", 1 ), "PLRU is a known policy" );
+
+    InstallLine( bank, 0x100 );
+    InstallLine( bank, 0x200 );
+    InstallLine( bank, 0x300 );
+    InstallLine( bank, 0x400 );
+
+    Check( Victim( bank ) == 0x100, "PLRU evicts the first way after an epoch reset" );
+
+    TouchLine( bank, 0x100 );
+    TouchLine( bank, 0x200 );
+
+    Check( Victim( bank ) == 0x300, "PLRU evicts the first way not used this epoch" );
+}
+
+/*
+ *  Lines are inserted with a long re-reference interval and a hit makes it
+ *  near-immediate, so the first line not hit since insertion is evicted.
+ */
+void CheckRRIP( )
+{
+    CacheBank bank( 1, 1, 4, 64, false );
+
+    Check( bank.SetReplacementPolicy( "RRIP", 1 ), "RRIP is a known policy" );
+
+    InstallLine( bank, 0x100 );
+    InstallLine( bank, 0x200 );
+    InstallLine( bank, 0x300 );
+    InstallLine( bank, 0x400 );
+    TouchLine( bank, 0x100 );
+    TouchLine( bank, 0x300 );
+
+    Check( Victim( bank ) == 0x200, "RRIP evicts a line that was never re-referenced" );
+
+    /* Aging must not let a re-referenced line overtake the others. */
+    Check( Victim( bank ) == 0x200, "RRIP victim is stable while the set is unchanged" );
+
+    TouchLine( bank, 0x200 );
+    TouchLine( bank, 0x400 );
+
+    Check( Victim( bank ) == 0x100, "RRIP ages re-referenced lines towards eviction" );
+}
+
+/* Random victims come from the bank's seeded stream. */
+void CheckRandom( )
+{
+    const uint64_t assoc = 8;
+    CacheBank bank( 1, 1, assoc, 64, false );
+    RandomGenerator reference;
+    uint64_t chosen[assoc] = { 0 };
+
+    Check( bank.SetReplacementPolicy( "Random", 42 ), "Random is a known policy" );
+    reference.Seed( 42, bank.StatName( ) );
+
+    for( uint64_t way = 0; way < assoc; way++ )
+        InstallLine( bank, 0x40 * way + 0x40 );
+
+    for( unsigned int i = 0; i < 1000; i++ )
+    {
+        uint64_t expected = reference.NextBelow( assoc );
+        uint64_t victim = Victim( bank );
+
+        Check( victim == 0x40 * expected + 0x40, "Random victim follows the seeded stream" );
+        chosen[expected]++;
+    }
+
+    for( uint64_t way = 0; way < assoc; way++ )
+        Check( chosen[way] > 0, "Random eventually evicts every way" );
+}
+
+/* Unknown names are rejected and leave the previous policy in place. */
+void CheckPolicySelection( )
+{
+    CacheBank bank( 1, 1, 4, 64, false );
+
+    Check( bank.SetReplacementPolicy( "PLRU", 1 ), "PLRU is a known policy" );
+    Check( !bank.SetReplacementPolicy( "MRU", 1 ), "MRU is rejected" );
+    Check( !bank.SetReplacementPolicy( "lru", 1 ), "policy names are case sensitive" );
+
+    InstallLine( bank, 0x100 );
+    InstallLine( bank, 0x200 );
+    InstallLine( bank, 0x300 );
+    InstallLine( bank, 0x400 );
+    TouchLine( bank, 0x100 );
+    TouchLine( bank, 0x200 );
+
+    Check( Victim( bank ) == 0x300, "a rejected name keeps the previous policy" );
+}
+
+}
+
+int main( )
+{
+    uint64_t assocs[] = { 1, 2, 3, 4, 5, 7, 8, 16, 29 };
+
+    for( unsigned int i = 0; i < sizeof(assocs) / sizeof(assocs[0]); i++ )
+        CheckFindWay( assocs[i] );
+
+    CheckLRU( );
+    CheckPLRU( );
+    CheckRRIP( );
+    CheckRandom( );
+    CheckPolicySelection( );
+
+    if( failures == 0 )
+        std::cout << "[+] CacheBankTest: all checks passed." << std::endl;
+
+    return static_cast<int>( failures );
+}
@@ -0,0 +1,124 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+/*
+ *  Unit checks for the JSON stat dump used by stats snapshots. Built and
+ *  run by "make check". The exit status is the number of failed checks.
+ */
+
+#include "src/Stats.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace NVM;
+
+namespace {
+
+unsigned int failures = 0;
+
+void Check( bool condition, std::string what )
+{
+    if( !condition )
+    {
+        std::cout << "[-] StatsJSONTest: " << what << std::endl;
+        failures++;
+    }
+}
+
+/* Registers a stat the way _AddStat does, so ~Stats can free the reset value. */
+template<typename T>
+void AddTestStat( Stats& stats, T& stat, std::string name, std::string units )
+{
+    uint8_t *resetValue = new uint8_t [sizeof(T)];
+
+    memcpy( resetValue, static_cast<StatType>(&stat), sizeof(T) );
+    stats.addStat( static_cast<StatType>(&stat), static_cast<StatType>(resetValue),
+                   typeid(T).name(), sizeof(T), name, units );
+}
+
+std::string DumpJSON( Stats& stats )
+{
+    std::stringstream json;
+
+    stats.PrintJSON( json );
+
+    return json.str( );
+}
+
+bool Contains( const std::string& text, const std::string& part )
+{
+    return text.find( part ) != std::string::npos;
+}
+
+}
+
+int main( )
+{
+    Stats stats;
+    ncounter_t reads = 42;
+    double power = 0.0 / 0.0;
+    std::string text = std::string( "a\"b\\c\nd\re\tf" ) + '\x01' + '\x1f' + "g";
+    std::string histo = "{40: 3}";
+
+    AddTestStat( stats, reads, "mem\tory.reads", "" );
+    AddTestStat( stats, power, "rank0.totalPower", "W" );
+    AddTestStat( stats, text, "trace\n\"name\"", "" );
+    AddTestStat( stats, histo, "subarray0.mlcTimingHisto", "\n" );
+
+    std::string json = DumpJSON( stats );
+
+    Check( Contains( json, "  \"mem\\tory.reads\": 42" ), "numeric stat with an escaped name" );
+    Check( Contains( json, "  \"rank0.totalPower\": null" ), "non-finite value written as null" );
+    Check( Contains( json, "  \"trace\\n\\\"name\\\"\": \"a\\\"b\\\\c\\nd\\re\\tf\\u0001\\u001Fg\"" ),
+           "string stat with escaped name and control characters" );
+    Check( Contains( json, "  \"subarray0.mlcTimingHisto\": \"{40: 3}\\n\"" ),
+           "units escaped with the value" );
+
+    /* No raw control characters may appear except the separating newlines. */
+    for( std::string::iterator c = json.begin(); c != json.end(); c++ )
+    {
+        if( static_cast<unsigned char>( *c ) < 0x20 && *c != '\n' )
+        {
+            Check( false, "raw control character in the JSON dump" );
+            break;
+        }
+    }
+
+    if( failures == 0 )
+        std::cout << "[+] StatsJSONTest: all checks passed." << std::endl;
+
+    return static_cast<int>( failures );
+}
@@ -35,6 +35,8 @@
 
 #include "Utils/AccessPredictor/PerfectPredictor/PerfectPredictor.h"
 #include "Utils/AccessPredictor/VariablePredictor/VariablePredictor.h"
+#include "Utils/AccessPredictor/TablePredictor/TablePredictor.h"
+#include "Utils/AccessPredictor/PerceptronPredictor/PerceptronPredictor.h"
 
 
 #include <cstdlib>
@@ -50,6 +52,8 @@ AccessPredictor *AccessPredictorFactory::CreateAccessPredictor( std::string name
 
     if( name == "PerfectPredictor" ) predictor = new PerfectPredictor( );
     else if( name == "VariablePredictor" ) predictor = new VariablePredictor( );
+    else if( name == "TablePredictor" ) predictor = new TablePredictor( );
+    else if( name == "PerceptronPredictor" ) predictor = new PerceptronPredictor( );
 
     if( predictor == NULL )
     {
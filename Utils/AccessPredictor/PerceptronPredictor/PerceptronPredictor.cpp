@@ -0,0 +1,171 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/AccessPredictor/PerceptronPredictor/PerceptronPredictor.h"
+#include "include/NVMHelpers.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cassert>
+
+
+using namespace NVM;
+
+
+PerceptronPredictor::PerceptronPredictor( )
+{
+    entries = 256;
+    threshold = 14;
+    weightMax = 31;
+    weightMin = -32;
+    pageShift = 12;
+    bias = 0;
+
+    truePredictions = 0;
+    falsePredictions = 0;
+    predictedHits = 0;
+    predictedMisses = 0;
+    wastedProbes = 0;
+    missedHits = 0;
+    predictionAccuracy = 0.0;
+}
+
+
+PerceptronPredictor::~PerceptronPredictor( )
+{
+
+}
+
+
+void PerceptronPredictor::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    uint64_t weightBits = 6, pageSize = 4096;
+    uint64_t trainThreshold = 14;
+
+    config->GetValueUL( "PerceptronEntries", entries );
+    config->GetValueUL( "PerceptronWeightBits", weightBits );
+    config->GetValueUL( "PerceptronThreshold", trainThreshold );
+    config->GetValueUL( "PredictorPageSize", pageSize );
+
+    if( entries == 0 )
+        entries = 1;
+    if( weightBits < 2 || weightBits > 8 )
+        weightBits = 6;
+
+    weightMax = (1 << (weightBits - 1)) - 1;
+    weightMin = -(1 << (weightBits - 1));
+    threshold = static_cast<int64_t>( trainThreshold );
+    pageShift = mlog2( static_cast<int>( pageSize ) );
+
+    weights.assign( features * entries, 0 );
+    bias = 0;
+
+    AddStat(truePredictions);
+    AddStat(falsePredictions);
+    AddStat(predictedHits);
+    AddStat(predictedMisses);
+    AddStat(wastedProbes);
+    AddStat(missedHits);
+    AddStat(predictionAccuracy);
+}
+
+void PerceptronPredictor::GetIndices( NVMainRequest *request, uint64_t *indices )
+{
+    uint64_t pc = request->programCounter;
+    uint64_t page = request->address.GetPhysicalAddress( ) >> pageShift;
+
+    indices[0] = (pc ^ (pc >> 10) ^ (pc >> 20)) % entries;
+    indices[1] = (page ^ (page >> 11)) % entries;
+    indices[2] = request->threadId % entries;
+    indices[3] = ((pc << 3) ^ page ^ (page >> 7)) % entries;
+}
+
+void PerceptronPredictor::Adjust( int8_t *weight, bool hit )
+{
+    if( hit && *weight < weightMax )
+        (*weight)++;
+    else if( !hit && *weight > weightMin )
+        (*weight)--;
+}
+
+uint64_t PerceptronPredictor::Translate( NVMainRequest *request )
+{
+    /* Write always hits, no prediction should be done. */
+    if( request->type == WRITE || request->type == WRITE_PRECHARGE )
+        return GetHitDestination( );
+
+    assert( parent != NULL );
+
+    uint64_t indices[features];
+    int64_t sum = bias;
+
+    GetIndices( request, indices );
+
+    for( int i = 0; i < features; i++ )
+        sum += weights[i * entries + indices[i]];
+
+    bool predictHit = (sum >= 0);
+    bool hit = GetParent()->GetTrampoline()->GetChild(GetHitDestination())->IssueFunctional(request);
+
+    if( predictHit != hit || (sum < threshold && sum > -threshold) )
+    {
+        for( int i = 0; i < features; i++ )
+            Adjust( &weights[i * entries + indices[i]], hit );
+
+        if( hit && bias < weightMax )
+            bias++;
+        else if( !hit && bias > weightMin )
+            bias--;
+    }
+
+    if( predictHit == hit )
+        truePredictions++;
+    else
+        falsePredictions++;
+
+    if( predictHit )
+    {
+        predictedHits++;
+        if( !hit ) wastedProbes++;
+    }
+    else
+    {
+        predictedMisses++;
+        if( hit ) missedHits++;
+    }
+
+    predictionAccuracy = static_cast<double>( truePredictions )
+                       / static_cast<double>( truePredictions + falsePredictions );
+
+    return (predictHit ? GetHitDestination( ) : GetMissDestination( ));
+}
@@ -0,0 +1,194 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/AccessPredictor/TablePredictor/TablePredictor.h"
+#include "include/NVMHelpers.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cassert>
+
+
+using namespace NVM;
+
+
+TablePredictor::TablePredictor( )
+{
+    predictorType = TABLE_PREDICT_MAPI;
+    entries = 256;
+    counterMax = 7;
+    pageShift = 12;
+
+    truePredictions = 0;
+    falsePredictions = 0;
+    predictedHits = 0;
+    predictedMisses = 0;
+    wastedProbes = 0;
+    missedHits = 0;
+    predictionAccuracy = 0.0;
+}
+
+
+TablePredictor::~TablePredictor( )
+{
+
+}
+
+
+void TablePredictor::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    if( config->KeyExists( "TablePredictorType" ) )
+    {
+        std::string type = config->GetString( "TablePredictorType" );
+
+        if( type == "MAP-G" )
+            predictorType = TABLE_PREDICT_MAPG;
+        else if( type == "MAP-I" )
+            predictorType = TABLE_PREDICT_MAPI;
+        else if( type == "MAP-P" )
+            predictorType = TABLE_PREDICT_MAPP;
+        else if( type == "MAP-IP" )
+            predictorType = TABLE_PREDICT_MAPIP;
+        else
+            std::cout << "[-] TablePredictor: Unknown type `" << type 
+                      << "'. Using MAP-I." << std::endl;
+    }
+
+    uint64_t counterBits = 3, pageSize = 4096;
+
+    config->GetValueUL( "TablePredictorEntries", entries );
+    config->GetValueUL( "TablePredictorBits", counterBits );
+    config->GetValueUL( "PredictorPageSize", pageSize );
+
+    if( entries == 0 )
+        entries = 1;
+    if( counterBits == 0 || counterBits > 8 )
+        counterBits = 3;
+
+    counterMax = (1ULL << counterBits) - 1;
+    pageShift = mlog2( static_cast<int>( pageSize ) );
+
+    /* Start weakly predicting a hit. */
+    uint8_t initial = static_cast<uint8_t>( (counterMax + 1) / 2 );
+
+    pcCounters.assign( entries, initial );
+    pageCounters.assign( entries, initial );
+
+    AddStat(truePredictions);
+    AddStat(falsePredictions);
+    AddStat(predictedHits);
+    AddStat(predictedMisses);
+    AddStat(wastedProbes);
+    AddStat(missedHits);
+    AddStat(predictionAccuracy);
+}
+
+uint8_t *TablePredictor::PCCounter( NVMainRequest *request )
+{
+    uint64_t index;
+
+    /* MAP-G keeps a single counter per thread. */
+    if( predictorType == TABLE_PREDICT_MAPG )
+    {
+        index = request->threadId;
+    }
+    else
+    {
+        uint64_t pc = request->programCounter;
+        index = (pc ^ (pc >> 8) ^ (pc >> 16)) + request->threadId;
+    }
+
+    return &pcCounters[index % entries];
+}
+
+uint8_t *TablePredictor::PageCounter( NVMainRequest *request )
+{
+    uint64_t page = request->address.GetPhysicalAddress( ) >> pageShift;
+
+    return &pageCounters[(page ^ (page >> 11)) % entries];
+}
+
+void TablePredictor::Train( uint8_t *counter, bool hit )
+{
+    if( hit && *counter < counterMax )
+        (*counter)++;
+    else if( !hit && *counter > 0 )
+        (*counter)--;
+}
+
+uint64_t TablePredictor::Translate( NVMainRequest *request )
+{
+    /* Write always hits, no prediction should be done. */
+    if( request->type == WRITE || request->type == WRITE_PRECHARGE )
+        return GetHitDestination( );
+
+    assert( parent != NULL );
+
+    uint8_t *pcCounter = PCCounter( request );
+    uint8_t *pageCounter = PageCounter( request );
+    ncounter_t threshold = (counterMax + 1) / 2;
+    bool predictHit;
+
+    if( predictorType == TABLE_PREDICT_MAPP )
+        predictHit = (*pageCounter >= threshold);
+    else if( predictorType == TABLE_PREDICT_MAPIP )
+        predictHit = (*pcCounter + *pageCounter >= 2 * threshold);
+    else
+        predictHit = (*pcCounter >= threshold);
+
+    bool hit = GetParent()->GetTrampoline()->GetChild(GetHitDestination())->IssueFunctional(request);
+
+    Train( pcCounter, hit );
+    Train( pageCounter, hit );
+
+    if( predictHit == hit )
+        truePredictions++;
+    else
+        falsePredictions++;
+
+    if( predictHit )
+    {
+        predictedHits++;
+        if( !hit ) wastedProbes++;
+    }
+    else
+    {
+        predictedMisses++;
+        if( hit ) missedHits++;
+    }
+
+    predictionAccuracy = static_cast<double>( truePredictions )
+                       / static_cast<double>( truePredictions + falsePredictions );
+
+    return (predictHit ? GetHitDestination( ) : GetMissDestination( ));
+}
@@ -0,0 +1,95 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __UTILS_TABLEPREDICTOR_H__
+#define __UTILS_TABLEPREDICTOR_H__
+
+
+#include "Utils/AccessPredictor/AccessPredictor.h"
+
+#include <vector>
+
+
+namespace NVM {
+
+
+enum TablePredictorType
+{
+    TABLE_PREDICT_MAPG,     /* One global counter per thread. */
+    TABLE_PREDICT_MAPI,     /* Counters indexed by PC. */
+    TABLE_PREDICT_MAPP,     /* Counters indexed by page. */
+    TABLE_PREDICT_MAPIP     /* PC and page counters voting together. */
+};
+
+
+/*
+ *  Hit/miss predictor built from saturating counters (Qureshi and Loh,
+ *  MICRO 2012). Counters count up on DRAM cache hits and down on misses.
+ *  Training uses the outcome of the DRAM cache tag check, which is taken
+ *  functionally at prediction time.
+ */
+class TablePredictor : public AccessPredictor
+{
+  public:
+    TablePredictor( );
+    ~TablePredictor( );
+
+    void SetConfig( Config *conf, bool createChildren );
+
+    using AccessPredictor::Translate;
+    uint64_t Translate( NVMainRequest *request );
+
+  private:
+    TablePredictorType predictorType;
+    ncounter_t entries;
+    ncounter_t counterMax;
+    unsigned int pageShift;
+
+    std::vector<uint8_t> pcCounters;
+    std::vector<uint8_t> pageCounters;
+
+    ncounter_t truePredictions, falsePredictions;
+    ncounter_t predictedHits, predictedMisses;
+    ncounter_t wastedProbes, missedHits;
+    double predictionAccuracy;
+
+    uint8_t *PCCounter( NVMainRequest *request );
+    uint8_t *PageCounter( NVMainRequest *request );
+    void Train( uint8_t *counter, bool hit );
+};
+
+
+};
+
+
+#endif
@@ -51,8 +51,6 @@ VariablePredictor::VariablePredictor( )
 {
     /* Approximate default value from the literature. */
     accuracy = 0.95;
-
-    seed = 1;
 }
 
 
@@ -67,6 +65,10 @@ void VariablePredictor::SetConfig( Config *config, bool /*createChildren*/ )
     /* Check for user defined accuracy. */
     config->GetEnergy( "VariablePredictorAccuracy", accuracy ); 
 
+    uint64_t seed = 1;
+    config->GetValueUL( "RandomSeed", seed );
+    rng.Seed( seed, StatName( ) );
+
     AddStat(truePredictions);
     AddStat(falsePredictions);
 }
@@ -90,8 +92,7 @@ uint64_t VariablePredictor::Translate( NVMainRequest *request )
      */
     assert( parent != NULL );
 
-    double coinToss = static_cast<double>(::rand_r(&seed)) 
-                    / static_cast<double>(RAND_MAX);
+    double coinToss = rng.NextUniform( );
     bool hit = GetParent()->GetTrampoline()->GetChild(GetHitDestination())->IssueFunctional(request);
 
     /* Predict correctly with probability "p" (accuracy) and mispredict with 1-p. */
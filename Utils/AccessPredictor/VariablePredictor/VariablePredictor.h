@@ -36,6 +36,7 @@
 
 
 #include "Utils/AccessPredictor/AccessPredictor.h"
+#include "include/NVMRandom.h"
 
 #include <set>
 
@@ -55,7 +56,7 @@ class VariablePredictor : public AccessPredictor
     uint64_t Translate( NVMainRequest *request );
 
   private:
-    unsigned int seed;
+    RandomGenerator rng;
     double accuracy;
 
     ncounter_t truePredictions, falsePredictions;
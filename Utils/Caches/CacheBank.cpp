@@ -34,31 +34,45 @@
 #include "Utils/Caches/CacheBank.h"
 #include "include/NVMHelpers.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
 #include <cassert>
 
+/*
+ *  Building with NVM_SCALAR_TAG_COMPARE compares one tag at a time. The
+ *  CacheBankBench microbenchmark uses it as the scalar baseline.
+ */
+#if !defined(NVM_SCALAR_TAG_COMPARE) && ( defined(__AVX2__) || defined(__SSE2__) )
+#define NVM_SIMD_TAG_COMPARE
+#include <immintrin.h>
+#endif
+
 using namespace NVM;
 
-CacheBank::CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, uint64_t lineSize )
+CacheBank::CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, uint64_t lineSize,
+                      bool storeData )
 {
-    uint64_t r, i, j;
+    uint64_t entries = rows * sets * assoc;
+
+    tags = new uint64_t[ entries ];
+    states = new uint8_t[ entries ];
+    replacement = new uint16_t[ entries ];
+    data = ( storeData ) ? new NVMDataBlock[ entries ] : NULL;
 
-    cacheEntry = new CacheEntry** [ rows ];
-    for( r = 0; r < rows; r++ )
+    for( uint64_t i = 0; i < entries; i++ )
     {
-        cacheEntry[r] = new CacheEntry* [ sets ];
-        for( i = 0; i < sets; i++ )
-        {
-            cacheEntry[r][i] = new CacheEntry[ assoc ];
-            for( j = 0; j < assoc; j++ )
-            {
-                /* Clear valid bit, dirty bit, etc. */
-                cacheEntry[r][i][j].flags = CACHE_ENTRY_NONE;
-            }
-        }
+        /* Clear valid bit, dirty bit, etc. */
+        tags[i] = invalidTag;
+        states[i] = CACHE_ENTRY_NONE;
+
+        /* LRU ages start as a permutation of the ways. */
+        replacement[i] = static_cast<uint16_t>( i % assoc );
     }
 
+    /* LRU ages are 16 bits. */
+    assert( assoc <= 65536 );
+
     numRows = rows;
     numSets = sets;
     numAssoc = assoc;
@@ -76,22 +90,16 @@ CacheBank::CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, uint64_t lin
     writeTime = 1;  // 1 cycle
 
     isMissMap = false;
+
+    policy = CACHE_REPLACE_LRU;
 }
 
 CacheBank::~CacheBank( )
 {
-    uint64_t i, r;
-
-    for( r = 0; r < numRows; r++ )
-    {
-        for( i = 0; i < numSets; i++ )
-        {
-            delete [] cacheEntry[r][i];
-        }
-        delete [] cacheEntry[r];
-    }
-
-    delete [] cacheEntry;
+    delete [] tags;
+    delete [] states;
+    delete [] replacement;
+    delete [] data;
 }
 
 void CacheBank::SetDecodeFunction( NVMObject *dcClass, CacheSetDecoder dcFunc )
@@ -122,148 +130,287 @@ uint64_t CacheBank::SetID( NVMAddress& addr )
     return setID;
 }
 
-CacheEntry *CacheBank::FindSet( NVMAddress& addr )
+/*
+ *  Returns the index of the first way of the set in the flat arrays.
+ */
+uint64_t CacheBank::FindSet( NVMAddress& addr )
 {
-    /*
-     *  By default we'll just chop off the bits for the cacheline and use the
-     *  least significant bits as the set address, and the remaining bits are 
-     *  the tag bits.
-     */
     uint64_t setID = SetID( addr );
 
-    return cacheEntry[addr.GetRow()][setID];
+    assert( addr.GetRow( ) < numRows && setID < numSets );
+
+    return ( addr.GetRow( ) * numSets + setID ) * numAssoc;
 }
 
-bool CacheBank::Present( NVMAddress& addr )
+/*
+ *  Returns the way holding tag, or numAssoc if it is not in the set. The
+ *  ways are compared several at a time when SIMD is available.
+ */
+uint64_t CacheBank::FindWay( uint64_t set, uint64_t tag )
 {
-    CacheEntry *set = FindSet( addr );
-    bool found = false;
+    const uint64_t *setTags = tags + set;
+    uint64_t way = 0;
+
+#if defined(NVM_SIMD_TAG_COMPARE) && defined(__AVX2__)
+    __m256i key4 = _mm256_set1_epi64x( static_cast<long long>(tag) );
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    for( ; way + 4 <= numAssoc; way += 4 )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( ) 
-            && (set[i].flags & CACHE_ENTRY_VALID ) )
-        {
-            found = true;
-            break;
-        }
+        __m256i ways = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(setTags + way) );
+        int match = _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( ways, key4 ) ) );
+
+        if( match )
+            return way + CountTrailingZeros64( static_cast<uint64_t>(match) );
     }
+#endif
+
+#if defined(NVM_SIMD_TAG_COMPARE)
+    __m128i key2 = _mm_set1_epi64x( static_cast<long long>(tag) );
+
+    for( ; way + 2 <= numAssoc; way += 2 )
+    {
+        __m128i ways = _mm_loadu_si128( reinterpret_cast<const __m128i *>(setTags + way) );
+
+        /* SSE2 has no 64-bit compare, so both 32-bit halves must match. */
+        __m128i halves = _mm_cmpeq_epi32( ways, key2 );
+        __m128i equal = _mm_and_si128( halves, _mm_shuffle_epi32( halves, _MM_SHUFFLE(2, 3, 0, 1) ) );
+        int match = _mm_movemask_pd( _mm_castsi128_pd( equal ) );
 
-    return found;
+        if( match )
+            return way + CountTrailingZeros64( static_cast<uint64_t>(match) );
+    }
+#endif
+
+    for( ; way < numAssoc; way++ )
+    {
+        if( setTags[way] == tag )
+            return way;
+    }
+
+    return numAssoc;
 }
 
-bool CacheBank::SetFull( NVMAddress& addr )
+bool CacheBank::SetReplacementPolicy( std::string policyName, uint64_t seed )
 {
-    CacheEntry *set = FindSet( addr );
     bool rv = true;
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( policyName == "LRU" )
+        policy = CACHE_REPLACE_LRU;
+    else if( policyName == "PLRU" )
+        policy = CACHE_REPLACE_PLRU;
+    else if( policyName == "RRIP" )
+        policy = CACHE_REPLACE_RRIP;
+    else if( policyName == "Random" )
+        policy = CACHE_REPLACE_RANDOM;
+    else
+        rv = false;
+
+    if( rv )
     {
-        /* If there is an invalid entry (e.g., not used) the set isn't full. */
-        if( !(set[i].flags & CACHE_ENTRY_VALID) )
+        uint64_t entries = numRows * numSets * numAssoc;
+
+        /* Reset the replacement state to the policy's initial state. */
+        for( uint64_t i = 0; i < entries; i++ )
         {
-            rv = false;
-            break;
+            if( policy == CACHE_REPLACE_LRU )
+                replacement[i] = static_cast<uint16_t>( i % numAssoc );
+            else if( policy == CACHE_REPLACE_RRIP )
+                replacement[i] = rripDistant;
+            else
+                replacement[i] = 0;
         }
+
+        rng.Seed( seed, StatName( ) );
     }
 
     return rv;
 }
 
-bool CacheBank::Install( NVMAddress& addr, NVMDataBlock& data )
+CacheReplacement CacheBank::GetReplacementPolicy( )
 {
-    CacheEntry *set = FindSet( addr );
-    bool rv = false;
+    return policy;
+}
 
-    //assert( !Present( addr ) );
+/*
+ *  Update the replacement state on a hit.
+ */
+void CacheBank::Touch( uint64_t set, uint64_t way )
+{
+    uint16_t *ways = replacement + set;
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( policy == CACHE_REPLACE_LRU )
     {
-        if( !(set[i].flags & CACHE_ENTRY_VALID) )
+        uint16_t age = ways[way];
+
+        for( uint64_t i = 0; i < numAssoc; i++ )
         {
-            set[i].address = addr;
-            set[i].data = data;
-            set[i].flags |= CACHE_ENTRY_VALID; 
-            rv = true;
-            break;
+            if( ways[i] < age )
+                ways[i]++;
         }
+
+        ways[way] = 0;
     }
+    else if( policy == CACHE_REPLACE_PLRU )
+    {
+        bool allUsed = true;
 
-    return rv;
+        ways[way] = 1;
+
+        for( uint64_t i = 0; i < numAssoc; i++ )
+        {
+            if( ways[i] == 0 )
+            {
+                allUsed = false;
+                break;
+            }
+        }
+
+        /* Once every way was used recently, start a new epoch. */
+        if( allUsed )
+        {
+            for( uint64_t i = 0; i < numAssoc; i++ )
+                ways[i] = 0;
+
+            ways[way] = 1;
+        }
+    }
+    else if( policy == CACHE_REPLACE_RRIP )
+    {
+        ways[way] = 0;
+    }
 }
 
-bool CacheBank::Read( NVMAddress& addr, NVMDataBlock *data )
+/*
+ *  Update the replacement state for a newly installed line.
+ */
+void CacheBank::Inserted( uint64_t set, uint64_t way )
 {
-    CacheEntry *set = FindSet( addr );
-    bool rv = false;
+    if( policy == CACHE_REPLACE_RRIP )
+        replacement[set + way] = rripLong;
+    else
+        Touch( set, way );
+}
 
-    assert( Present( addr ) );
+uint64_t CacheBank::FindVictimWay( uint64_t set )
+{
+    uint16_t *ways = replacement + set;
+    uint64_t victim = 0;
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( policy == CACHE_REPLACE_LRU )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( ) 
-            && (set[i].flags & CACHE_ENTRY_VALID) )
+        for( uint64_t i = 1; i < numAssoc; i++ )
         {
-            *data = set[i].data;
-            rv = true;
-
-            /* Move cache entry to MRU position */
-            CacheEntry tmp;
-
-            tmp.flags = set[i].flags;
-            tmp.address = set[i].address;
-            tmp.data = set[i].data;
+            if( ways[i] > ways[victim] )
+                victim = i;
+        }
+    }
+    else if( policy == CACHE_REPLACE_PLRU )
+    {
+        for( victim = 0; victim < numAssoc - 1; victim++ )
+        {
+            if( ways[victim] == 0 )
+                break;
+        }
+    }
+    else if( policy == CACHE_REPLACE_RRIP )
+    {
+        /* Age every way at once so that the oldest reaches distant. */
+        uint16_t oldest = 0;
 
-            for( uint64_t j = i; j > 0; j-- )
+        for( uint64_t i = 0; i < numAssoc; i++ )
+        {
+            if( ways[i] > oldest )
             {
-                set[j].flags = set[j-1].flags;
-                set[j].address = set[j-1].address;
-                set[j].data = set[j-1].data;
+                oldest = ways[i];
+                victim = i;
             }
-
-            set[0].flags = tmp.flags;
-            set[0].address = tmp.address;
-            set[0].data = tmp.data;
         }
+
+        for( uint64_t i = 0; i < numAssoc; i++ )
+            ways[i] = static_cast<uint16_t>( ways[i] + rripDistant - oldest );
+    }
+    else
+    {
+        victim = rng.NextBelow( numAssoc );
+    }
+
+    return victim;
+}
+
+bool CacheBank::Present( NVMAddress& addr )
+{
+    uint64_t set = FindSet( addr );
+
+    return ( FindWay( set, addr.GetPhysicalAddress( ) ) != numAssoc );
+}
+
+bool CacheBank::SetFull( NVMAddress& addr )
+{
+    uint64_t set = FindSet( addr );
+
+    /* If there is an invalid entry (e.g., not used) the set isn't full. */
+    return ( FindWay( set, invalidTag ) == numAssoc );
+}
+
+bool CacheBank::Install( NVMAddress& addr, NVMDataBlock& newData )
+{
+    uint64_t set = FindSet( addr );
+    uint64_t way = FindWay( set, invalidTag );
+    bool rv = false;
+
+    //assert( !Present( addr ) );
+    assert( addr.GetPhysicalAddress( ) != invalidTag );
+
+    if( way != numAssoc )
+    {
+        tags[set + way] = addr.GetPhysicalAddress( );
+        states[set + way] = CACHE_ENTRY_VALID;
+        if( data != NULL )
+            data[set + way] = newData;
+
+        Inserted( set, way );
+        rv = true;
     }
 
     return rv;
 }
 
-bool CacheBank::Write( NVMAddress& addr, NVMDataBlock& data )
+bool CacheBank::Read( NVMAddress& addr, NVMDataBlock *readData )
 {
-    CacheEntry *set = FindSet( addr );
+    uint64_t set = FindSet( addr );
+    uint64_t way = FindWay( set, addr.GetPhysicalAddress( ) );
     bool rv = false;
 
-    assert( Present( addr ) );
+    assert( way != numAssoc );
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( way != numAssoc )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( )
-            && (set[i].flags & CACHE_ENTRY_VALID) )
-        {
-            set[i].data = data;
-            set[i].flags |= CACHE_ENTRY_DIRTY;
-            rv = true;
+        if( data != NULL )
+            *readData = data[set + way];
 
-            /* Move cache entry to MRU position */
-            CacheEntry tmp;
+        Touch( set, way );
+        rv = true;
+    }
 
-            tmp.flags = set[i].flags;
-            tmp.address = set[i].address;
-            tmp.data = set[i].data;
+    return rv;
+}
 
-            for( uint64_t j = i; j > 1; j-- )
-            {
-                set[j].flags = set[j-1].flags;
-                set[j].address = set[j-1].address;
-                set[j].data = set[j-1].data;
-            }
+bool CacheBank::Write( NVMAddress& addr, NVMDataBlock& newData )
+{
+    uint64_t set = FindSet( addr );
+    uint64_t way = FindWay( set, addr.GetPhysicalAddress( ) );
+    bool rv = false;
 
-            set[0].flags = tmp.flags;
-            set[0].address = tmp.address;
-            set[0].data = tmp.data;
-        }
+    assert( way != numAssoc );
+
+    if( way != numAssoc )
+    {
+        if( data != NULL )
+            data[set + way] = newData;
+        states[set + way] |= CACHE_ENTRY_DIRTY;
+
+        Touch( set, way );
+        rv = true;
     }
 
     return rv;
@@ -273,73 +420,62 @@ bool CacheBank::Write( NVMAddress& addr, NVMDataBlock& data )
  *  Updates data without changing dirty bit or LRU position
  *  Returns true if the block was found and updated.
  */
-bool CacheBank::UpdateData( NVMAddress& addr, NVMDataBlock& data )
+bool CacheBank::UpdateData( NVMAddress& addr, NVMDataBlock& newData )
 {
-    CacheEntry *set = FindSet( addr );
+    uint64_t set = FindSet( addr );
+    uint64_t way = FindWay( set, addr.GetPhysicalAddress( ) );
     bool rv = false;
 
-    assert( Present( addr ) );
+    assert( way != numAssoc );
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( way != numAssoc )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( )
-            && (set[i].flags & CACHE_ENTRY_VALID) )
-        {
-            set[i].data = data;
-            rv = true;
-        }
+        if( data != NULL )
+            data[set + way] = newData;
+        rv = true;
     }
 
     return rv;
 }
 
-/* Return true if the victim data is dirty. */
+/* 
+ *  Return true if the victim data is dirty. The victim keeps the translated
+ *  address of addr, which maps to the same set.
+ */
 bool CacheBank::ChooseVictim( NVMAddress& addr, NVMAddress *victim )
 {
-    bool rv = false;
-    CacheEntry *set = FindSet( addr );
+    uint64_t set = FindSet( addr );
 
     assert( SetFull( addr ) );
-    assert( set[numAssoc-1].flags & CACHE_ENTRY_VALID );
 
-    *victim = set[numAssoc-1].address;
-    
-    if( set[numAssoc-1].flags & CACHE_ENTRY_DIRTY )
-        rv = true;
+    uint64_t way = FindVictimWay( set );
 
-    return rv;
+    assert( states[set + way] & CACHE_ENTRY_VALID );
+
+    *victim = addr;
+    victim->SetPhysicalAddress( tags[set + way] );
+    
+    return ( states[set + way] & CACHE_ENTRY_DIRTY ) != 0;
 }
 
 
-bool CacheBank::Evict( NVMAddress& addr, NVMDataBlock *data )
+bool CacheBank::Evict( NVMAddress& addr, NVMDataBlock *evictData )
 {
-    bool rv;
-    CacheEntry *set = FindSet( addr );
-
-    assert( Present( addr ) );
+    uint64_t set = FindSet( addr );
+    uint64_t way = FindWay( set, addr.GetPhysicalAddress( ) );
+    bool rv = false;
 
-    rv = false; 
+    assert( way != numAssoc );
 
-    for( uint64_t i = 0; i < numAssoc; i++ )
+    if( way != numAssoc )
     {
-        if( set[i].address.GetPhysicalAddress( ) == addr.GetPhysicalAddress( ) 
-            && (set[i].flags & CACHE_ENTRY_VALID) )
-        {
-            if( set[i].flags & CACHE_ENTRY_DIRTY )
-            {
-                *data = set[i].data;
-                rv = true;
-            }
-            else
-            {
-                *data = set[i].data;
-                rv = false;
-            }
+        if( data != NULL )
+            *evictData = data[set + way];
 
-            set[i].flags = CACHE_ENTRY_NONE;
+        rv = ( states[set + way] & CACHE_ENTRY_DIRTY ) != 0;
 
-            break;
-        }
+        tags[set + way] = invalidTag;
+        states[set + way] = CACHE_ENTRY_NONE;
     }
 
     return rv;
@@ -380,6 +516,24 @@ uint64_t CacheBank::GetSetCount( )
     return numSets;
 }
 
+uint64_t CacheBank::GetSetIndex( NVMAddress& addr )
+{
+    return FindSet( addr ) / numAssoc;
+}
+
+uint64_t CacheBank::GetEntryIndex( NVMAddress& addr )
+{
+    uint64_t set = FindSet( addr );
+    uint64_t way = FindWay( set, addr.GetPhysicalAddress( ) );
+
+    return ( way != numAssoc ) ? set + way : GetEntryCount( );
+}
+
+uint64_t CacheBank::GetEntryCount( )
+{
+    return numRows * numSets * numAssoc;
+}
+
 double CacheBank::GetCacheOccupancy( )
 {
     double occupancy;
@@ -388,18 +542,10 @@ double CacheBank::GetCacheOccupancy( )
     valid = 0;
     total = numRows*numSets*numAssoc;
 
-    for( uint64_t rowIdx = 0; rowIdx < numRows; rowIdx++ )
+    for( uint64_t entry = 0; entry < total; entry++ )
     {
-        for( uint64_t setIdx = 0; setIdx < numSets; setIdx++ )
-        {
-            CacheEntry *set = cacheEntry[rowIdx][setIdx];
-
-            for( uint64_t assocIdx = 0; assocIdx < numAssoc; assocIdx++ )
-            {
-                if( set[assocIdx].flags & CACHE_ENTRY_VALID )
-                    valid++;
-            }
-        }
+        if( tags[entry] != invalidTag )
+            valid++;
     }
 
     occupancy = static_cast<double>(valid) / static_cast<double>(total);
@@ -407,6 +553,52 @@ double CacheBank::GetCacheOccupancy( )
     return occupancy;
 }
 
+/*
+ *  Writes the tags, line states and replacement state of every way. Line
+ *  data is not saved. Returns false from ReadCheckpoint if the checkpoint
+ *  was written by a cache with a different geometry.
+ */
+void CacheBank::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    uint64_t entries = numRows * numSets * numAssoc;
+
+    cpt.Write( numRows );
+    cpt.Write( numSets );
+    cpt.Write( numAssoc );
+    cpt.Write( policy );
+
+    for( uint64_t entry = 0; entry < entries; entry++ )
+        cpt.Write( tags[entry] );
+
+    cpt.WriteBytes( states, entries );
+
+    for( uint64_t entry = 0; entry < entries; entry++ )
+        cpt.Write( replacement[entry] );
+
+    rng.WriteCheckpoint( cpt );
+}
+
+bool CacheBank::ReadCheckpoint( CheckpointReader& cpt )
+{
+    uint64_t entries = numRows * numSets * numAssoc;
+
+    if( cpt.Read( ) != numRows || cpt.Read( ) != numSets || cpt.Read( ) != numAssoc 
+        || cpt.Read( ) != static_cast<uint64_t>( policy ) )
+        return false;
+
+    for( uint64_t entry = 0; entry < entries; entry++ )
+        tags[entry] = cpt.Read( );
+
+    cpt.ReadBytes( states, entries );
+
+    for( uint64_t entry = 0; entry < entries; entry++ )
+        replacement[entry] = static_cast<uint16_t>( cpt.Read( ) );
+
+    rng.ReadCheckpoint( cpt );
+
+    return cpt.Good( );
+}
+
 bool CacheBank::IsIssuable( NVMainRequest * /*req*/, FailReason * /*reason*/ )
 {
     bool rv = false;
@@ -35,10 +35,14 @@
 #define __NVMAIN_UTILS_CACHES_CACHEBANK_H__
 
 #include <utility>
+#include <string>
+#include <iostream>
 #include "include/NVMAddress.h"
 #include "include/NVMDataBlock.h"
+#include "include/NVMRandom.h"
 #include "src/NVMObject.h"
 #include "src/AddressTranslator.h"
+#include "src/Checkpoint.h"
 
 namespace NVM {
 
@@ -66,17 +70,19 @@ enum { CACHE_ENTRY_NONE = 0,
        CACHE_ENTRY_EXAMPLE = 4
 };
 
-struct CacheEntry
-{
-    uint64_t flags;
-    NVMAddress address;
-    NVMDataBlock data;
-};
+/*
+ *  PLRU keeps one MRU bit per way (bit-PLRU), so it also works for
+ *  associativities that are not a power of two. RRIP is static RRIP with
+ *  2-bit re-reference predictions.
+ */
+enum CacheReplacement { CACHE_REPLACE_LRU, CACHE_REPLACE_PLRU, 
+                        CACHE_REPLACE_RRIP, CACHE_REPLACE_RANDOM };
 
 class CacheBank : public NVMObject
 {
   public:
-    CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, uint64_t lineSize );
+    CacheBank( uint64_t rows, uint64_t sets, uint64_t assoc, uint64_t lineSize,
+               bool storeData = true );
     ~CacheBank( );
 
     /* Return true if the address is in the cache. */
@@ -108,6 +114,25 @@ class CacheBank : public NVMObject
     uint64_t GetSetCount( );
     double GetCacheOccupancy( );
 
+    /* Index of the set holding addr across all rows of the bank. */
+    uint64_t GetSetIndex( NVMAddress& addr );
+
+    /* 
+     *  Index of the way holding addr across all sets of the bank, or
+     *  GetEntryCount( ) if it is not present. Owners use it to keep
+     *  per-line metadata in a table alongside the tags.
+     */
+    uint64_t GetEntryIndex( NVMAddress& addr );
+    uint64_t GetEntryCount( );
+
+    /* Returns false for unknown policy names and keeps the current policy. */
+    bool SetReplacementPolicy( std::string policy, uint64_t seed = 1 );
+    CacheReplacement GetReplacementPolicy( );
+
+    /* Tag and state arrays only. Cached data is not checkpointed. */
+    void WriteCheckpoint( CheckpointWriter& cpt );
+    bool ReadCheckpoint( CheckpointReader& cpt );
+
     bool IsIssuable( NVMainRequest *req, FailReason *reason );
     bool IssueCommand( NVMainRequest *req );
     bool RequestComplete( NVMainRequest *req );
@@ -119,18 +144,41 @@ class CacheBank : public NVMObject
     void SetDecodeFunction( NVMObject *dcClass, CacheSetDecoder dcFunc );
 
     uint64_t numRows, numSets, numAssoc, cachelineSize;
-    CacheEntry ***cacheEntry;
     uint64_t accessTime, stateTimer;
     uint64_t readTime, writeTime;
     CacheState state;
 
-    CacheEntry *FindSet( NVMAddress& addr );
     uint64_t SetID( NVMAddress& addr );
     bool isMissMap;
 
     CacheSetDecoder decodeFunc;
     NVMObject *decodeClass;
     uint64_t DefaultDecoder( NVMAddress& addr );
+
+  private:
+    /*
+     *  Entries are stored flat, set after set, so a probe touches one
+     *  contiguous run of tags. The tag is the physical address; invalid
+     *  ways hold invalidTag so the tag compare needs no valid check.
+     */
+    static const uint64_t invalidTag = ~0ULL;
+    static const uint16_t rripLong = 2;
+    static const uint16_t rripDistant = 3;
+
+    uint64_t *tags;
+    uint8_t *states;
+    uint16_t *replacement;
+    NVMDataBlock *data;
+
+    CacheReplacement policy;
+    RandomGenerator rng;
+
+    uint64_t FindSet( NVMAddress& addr );
+    uint64_t FindWay( uint64_t set, uint64_t tag );
+    uint64_t FindVictimWay( uint64_t set );
+
+    void Touch( uint64_t set, uint64_t way );
+    void Inserted( uint64_t set, uint64_t way );
 };
 
 }; 
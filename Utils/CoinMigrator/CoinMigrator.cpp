@@ -52,12 +52,19 @@ CoinMigrator::CoinMigrator( )
 
     promoRequest = NULL;
     demoRequest = NULL;
+    migReadTag = migWriteTag = 0;
     promoBuffered = false;
     demoBuffered = false;
 
+    pageBytes = 0;
+
     migrationCount = 0;
     queueWaits = 0;
     bufferedReads = 0;
+    migrationBytes = 0;
+    demandAccesses = 0;
+    fastTierAccesses = 0;
+    fastTierHitRate = 0.0;
 
     queriedMemory = false;
     promotionChannelParams = NULL;
@@ -77,7 +84,12 @@ void CoinMigrator::Init( Config *config )
      *  Our seed for migration probability. This should be a known constant if
      *  you wish to reproduce the same results each simulation.
      */
-    seed = 1;
+    uint64_t seed = 1;
+    config->GetValueUL( "RandomSeed", seed );
+
+    migReadTag = GetTagGenerator( )->CreateTag( "MIGREAD" );
+    migWriteTag = GetTagGenerator( )->CreateTag( "MIGWRITE" );
+    rng.Seed( seed, StatName( ) );
 
     /* Chance to migrate: 0 = 0%, 1.00 = 100%. */
     probability = 0.02; 
@@ -97,9 +109,22 @@ void CoinMigrator::Init( Config *config )
      */
     numCols = config->GetValue( "COLS" );
 
+    /* Each column is one burst of the default burst length (64 bytes of DDR3). */
+    ncounter_t busWidth = 64, rate = 2, burst = 4;
+
+    config->GetValueUL( "BusWidth", busWidth );
+    config->GetValueUL( "RATE", rate );
+    config->GetValueUL( "tBURST", burst );
+
+    pageBytes = numCols * busWidth * rate * burst / 8;
+
     AddStat(migrationCount);
     AddStat(queueWaits);
     AddStat(bufferedReads);
+    AddUnitStat(migrationBytes, "B");
+    AddStat(demandAccesses);
+    AddStat(fastTierAccesses);
+    AddStat(fastTierHitRate);
 }
 
 
@@ -128,7 +153,7 @@ bool CoinMigrator::RequestComplete( NVMainRequest *request )
         Migrator *migratorTranslator = dynamic_cast<Migrator *>(parent->GetTrampoline( )->GetDecoder( ));
         assert( migratorTranslator != NULL );
 
-        if( request->owner == parent->GetTrampoline( ) && request->tag == MIG_READ_TAG )
+        if( request->owner == parent->GetTrampoline( ) && request->tag == migReadTag )
         {
             /* A migration read completed, update state. */
             migratorTranslator->SetMigrationState( request->address, MIGRATION_BUFFERED ); 
@@ -178,8 +203,8 @@ bool CoinMigrator::RequestComplete( NVMainRequest *request )
                 demoRequest->type = WRITE;
                 promoRequest->type = WRITE;
 
-                demoRequest->tag = MIG_WRITE_TAG;
-                promoRequest->tag = MIG_WRITE_TAG;
+                demoRequest->tag = migWriteTag;
+                promoRequest->tag = migWriteTag;
 
                 /* Try to issue these now, otherwise we can try later. */
                 bool demoIssued, promoIssued;
@@ -201,12 +226,14 @@ bool CoinMigrator::RequestComplete( NVMainRequest *request )
             }
         }
         /* A write completed. */
-        else if( request->owner == parent->GetTrampoline( ) && request->tag == MIG_WRITE_TAG )
+        else if( request->owner == parent->GetTrampoline( ) && request->tag == migWriteTag )
         {
             // Note: request should be deleted by parent
             migratorTranslator->SetMigrationState( request->address, MIGRATION_DONE );
 
+            /* The page was read into the buffer and written to its new home. */
             migrationCount++;
+            migrationBytes += 2 * pageBytes;
         }
         /* Some other request completed, see if we can ninja issue some migration writes that did not queue. */
         else if( promoBuffered || demoBuffered )
@@ -273,6 +300,19 @@ bool CoinMigrator::TryMigration( NVMainRequest *request, bool atomic )
             return rv;
         }
 
+        /* Hooks never see CalculateStats, so keep the hit rate current. */
+        if( request->owner != parent->GetTrampoline( ) )
+        {
+            demandAccesses++;
+            if( request->address.GetChannel( ) == promotionChannel )
+                fastTierAccesses++;
+
+            fastTierHitRate = static_cast<double>(fastTierAccesses)
+                            / static_cast<double>(demandAccesses);
+
+            RecordAccess( migratorTranslator, request );
+        }
+
         /* See if any migration is possible (i.e., no migration is in progress) */
         bool migrationPossible = false;
 
@@ -287,11 +327,7 @@ bool CoinMigrator::TryMigration( NVMainRequest *request, bool atomic )
         {
             assert( !demoBuffered && !promoBuffered );
 
-            /* Flip a biased coin to determine whether to migrate. */
-            double coinToss = static_cast<double>(::rand_r(&seed)) 
-                            / static_cast<double>(RAND_MAX);
-
-            if( coinToss <= probability )
+            if( ShouldMigrate( migratorTranslator, request ) )
             {
                 /* 
                  *  Note: once IssueCommand is called, this hook may receive
@@ -315,29 +351,37 @@ bool CoinMigrator::TryMigration( NVMainRequest *request, bool atomic )
                 assert( migratorTranslator->IsMigrated( demotee ) == false );
                 assert( migratorTranslator->IsMigrated( promotee ) == false );
 
+                /* Both pages need a remap entry; refusals are counted by the migrator. */
+                if( !migratorTranslator->CanRemap( promotee, demotee ) )
+                {
+                    return rv;
+                }
+
                 if( atomic )
                 {
                     migratorTranslator->StartMigration( request->address, demotee );
                     migratorTranslator->SetMigrationState( promotee, MIGRATION_DONE );
                     migratorTranslator->SetMigrationState( demotee, MIGRATION_DONE );
+                    MigrationStarted( migratorTranslator, request );
                 }
                 /* Lastly, make sure we can queue the migration requests. */
                 else if( CheckIssuable( promotee, READ ) &&
                          CheckIssuable( demotee, READ ) )
                 {
                     migratorTranslator->StartMigration( request->address, demotee );
+                    MigrationStarted( migratorTranslator, request );
 
                     promoRequest = new NVMainRequest( ); 
                     demoRequest = new NVMainRequest( );
 
                     promoRequest->address = promotee;
                     promoRequest->type = READ;
-                    promoRequest->tag = MIG_READ_TAG;
+                    promoRequest->tag = migReadTag;
                     promoRequest->burstCount = numCols;
 
                     demoRequest->address = demotee;
                     demoRequest->type = READ;
-                    demoRequest->tag = MIG_READ_TAG;
+                    demoRequest->tag = migReadTag;
                     demoRequest->burstCount = numCols;
 
                     promoRequest->owner = savedParent;
@@ -357,6 +401,27 @@ bool CoinMigrator::TryMigration( NVMainRequest *request, bool atomic )
 }
 
 
+void CoinMigrator::RecordAccess( Migrator * /*at*/, NVMainRequest * /*request*/ )
+{
+
+}
+
+
+bool CoinMigrator::ShouldMigrate( Migrator * /*at*/, NVMainRequest * /*request*/ )
+{
+    /* Flip a biased coin to determine whether to migrate. */
+    double coinToss = rng.NextUniform( );
+
+    return ( coinToss <= probability );
+}
+
+
+void CoinMigrator::MigrationStarted( Migrator * /*at*/, NVMainRequest * /*request*/ )
+{
+
+}
+
+
 void CoinMigrator::ChooseVictim( Migrator *at, NVMAddress& /*promotee*/, NVMAddress& victim )
 {
     /*
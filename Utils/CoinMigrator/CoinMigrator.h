@@ -37,21 +37,19 @@
 #include "src/NVMObject.h"
 #include "src/Params.h"
 #include "include/NVMainRequest.h"
+#include "include/NVMRandom.h"
 
 namespace NVM {
 
-#define MIG_READ_TAG GetTagGenerator( )->CreateTag("MIGREAD")
-#define MIG_WRITE_TAG GetTagGenerator( )->CreateTag("MIGWRITE")
-
 class Migrator;
 
 class CoinMigrator : public NVMObject
 {
   public:
     CoinMigrator( );
-    ~CoinMigrator( );
+    virtual ~CoinMigrator( );
 
-    void Init( Config *config );
+    virtual void Init( Config *config );
 
     bool IssueAtomic( NVMainRequest *request );
     bool IssueCommand( NVMainRequest *request );
@@ -59,13 +57,13 @@ class CoinMigrator : public NVMObject
 
     void Cycle( ncycle_t steps );
 
-  private:
+  protected:
     bool promoBuffered, demoBuffered; 
     NVMAddress demotee, promotee; 
     NVMainRequest *promoRequest;
     NVMainRequest *demoRequest;
 
-    unsigned int seed;
+    RandomGenerator rng;
     double probability;
     ncounter_t numCols;
     bool queriedMemory;
@@ -75,13 +73,28 @@ class CoinMigrator : public NVMObject
     ncounter_t currentPromotionPage;
     ncounter_t promotionChannel;
 
+    ncounter_t pageBytes;
+
     ncounter_t migrationCount;
     ncounter_t queueWaits;
     ncounter_t bufferedReads;
+    ncounter_t migrationBytes;
+    ncounter_t demandAccesses, fastTierAccesses;
+    double fastTierHitRate;
+
+    /* Request tags are interned once in Init. */
+    int migReadTag, migWriteTag;
 
     bool CheckIssuable( NVMAddress address, OpType type );
     bool TryMigration( NVMainRequest *request, bool atomic );
     void ChooseVictim( Migrator *at, NVMAddress& promo, NVMAddress& victim );
+
+    /* Sees every issued demand request, e.g., to track page hotness. */
+    virtual void RecordAccess( Migrator *at, NVMainRequest *request );
+    /* Decides whether a slow memory page should be promoted now. */
+    virtual bool ShouldMigrate( Migrator *at, NVMainRequest *request );
+    /* Called once the promotion chosen by ShouldMigrate has started. */
+    virtual void MigrationStarted( Migrator *at, NVMainRequest *request );
 };
 
 };
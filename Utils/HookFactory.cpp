@@ -37,6 +37,8 @@
 #include "Utils/Visualizer/Visualizer.h"
 #include "Utils/PostTrace/PostTrace.h"
 #include "Utils/CoinMigrator/CoinMigrator.h"
+#include "Utils/HotnessMigrator/HotnessMigrator.h"
+#include "Utils/WearLevelMover/WearLevelMover.h"
 
 
 using namespace NVM;
@@ -49,6 +51,8 @@ NVMObject *HookFactory::CreateHook( std::string hookName )
     if( hookName == "Visualizer" ) hook = new Visualizer( );
     else if( hookName == "PostTrace" ) hook = new PostTrace( );
     else if( hookName == "CoinMigrator" ) hook = new CoinMigrator( );
+    else if( hookName == "HotnessMigrator" ) hook = new HotnessMigrator( );
+    else if( hookName == "WearLevelMover" ) hook = new WearLevelMover( );
     //else if( hookName == "MyHook" ) hook = new MyHook( );
 
     if( hook != NULL )
@@ -0,0 +1,341 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/HotnessMigrator/HotnessMigrator.h"
+#include "Decoders/Migrator/Migrator.h"
+#include "src/EventQueue.h"
+
+#include <iostream>
+
+using namespace NVM;
+
+HotnessMigrator::HotnessMigrator( )
+{
+    policy = HOTNESS_EPOCH;
+    epochLength = 100000;
+    epochEnd = 0;
+    threshold = 8;
+    counterMask = 0;
+
+    meaEntries = 16;
+
+    mqQueues = 8;
+    mqPromotionQueue = 3;
+    mqLifetime = 10000;
+
+    epochs = 0;
+    hotPagesFound = 0;
+    counterConflicts = 0;
+}
+
+
+HotnessMigrator::~HotnessMigrator( )
+{
+
+}
+
+
+void HotnessMigrator::Init( Config *config )
+{
+    CoinMigrator::Init( config );
+
+    if( config->KeyExists( "MigrationPolicy" ) )
+    {
+        std::string policyName = config->GetString( "MigrationPolicy" );
+
+        if( policyName == "Epoch" )
+            policy = HOTNESS_EPOCH;
+        else if( policyName == "MEA" )
+            policy = HOTNESS_MEA;
+        else if( policyName == "MultiQueue" )
+            policy = HOTNESS_MULTIQUEUE;
+        else
+            std::cout << "[+] HotnessMigrator: Unknown MigrationPolicy " << policyName
+                      << ", using Epoch." << std::endl;
+    }
+
+    ncounter_t counterEntries = 4096;
+
+    config->GetValueUL( "MigrationEpoch", epochLength );
+    config->GetValueUL( "MigrationThreshold", threshold );
+    config->GetValueUL( "MigrationCounterEntries", counterEntries );
+    config->GetValueUL( "MEAEntries", meaEntries );
+    config->GetValueUL( "MQQueues", mqQueues );
+    config->GetValueUL( "MQPromotionQueue", mqPromotionQueue );
+    config->GetValueUL( "MQLifetime", mqLifetime );
+
+    if( epochLength == 0 )
+        epochLength = 1;
+    if( threshold == 0 )
+        threshold = 1;
+    if( meaEntries == 0 )
+        meaEntries = 1;
+    if( mqQueues == 0 )
+        mqQueues = 1;
+    if( mqLifetime == 0 )
+        mqLifetime = 1;
+
+    /* Round the counter table up to a power of two. */
+    uint64_t slots = 1;
+    while( slots < counterEntries )
+        slots <<= 1;
+
+    PageCounter empty;
+
+    empty.key = noPage;
+    empty.count = 0;
+    empty.lastAccess = 0;
+
+    counters.assign( slots, empty );
+    counterMask = slots - 1;
+
+    meaCounters.reserve( meaEntries );
+    epochEnd = epochLength;
+
+    AddStat(epochs);
+    AddStat(hotPagesFound);
+    AddStat(counterConflicts);
+}
+
+
+HotnessMigrator::PageCounter *HotnessMigrator::Slot( uint64_t key )
+{
+    return &counters[( ( key * 0x9E3779B97F4A7C15ULL ) >> 17 ) & counterMask];
+}
+
+
+/*
+ *  Counters are direct mapped, so a page colliding with another page
+ *  restarts the count.
+ */
+HotnessMigrator::PageCounter *HotnessMigrator::Counter( uint64_t key )
+{
+    PageCounter *counter = Slot( key );
+
+    if( counter->key != key )
+    {
+        if( counter->key != noPage )
+            counterConflicts++;
+
+        counter->key = key;
+        counter->count = 0;
+        counter->lastAccess = GetEventQueue( )->GetCurrentCycle( );
+    }
+
+    return counter;
+}
+
+
+/* Returns the page's counter without claiming the slot, or NULL. */
+HotnessMigrator::PageCounter *HotnessMigrator::FindCounter( uint64_t key )
+{
+    PageCounter *counter = Slot( key );
+
+    return ( counter->key == key ) ? counter : NULL;
+}
+
+
+/* Queue i holds pages with 2^i to 2^(i+1)-1 accesses. */
+ncounter_t HotnessMigrator::Queue( ncounter_t count )
+{
+    ncounter_t queue = 0;
+
+    while( count > 1 && queue < mqQueues - 1 )
+    {
+        count >>= 1;
+        queue++;
+    }
+
+    return queue;
+}
+
+
+void HotnessMigrator::CountMEA( uint64_t key )
+{
+    for( ncounter_t idx = 0; idx < meaCounters.size( ); idx++ )
+    {
+        if( meaCounters[idx].key == key )
+        {
+            meaCounters[idx].count++;
+            return;
+        }
+    }
+
+    if( meaCounters.size( ) < meaEntries )
+    {
+        PageCounter counter;
+
+        counter.key = key;
+        counter.count = 1;
+        counter.lastAccess = 0;
+
+        meaCounters.push_back( counter );
+        return;
+    }
+
+    /* No free counter: every tracked page loses one vote. */
+    for( ncounter_t idx = meaCounters.size( ); idx > 0; idx-- )
+    {
+        if( --meaCounters[idx - 1].count == 0 )
+        {
+            meaCounters[idx - 1] = meaCounters.back( );
+            meaCounters.pop_back( );
+        }
+    }
+}
+
+
+void HotnessMigrator::EndEpoch( )
+{
+    epochs++;
+
+    if( policy == HOTNESS_EPOCH )
+    {
+        for( uint64_t slot = 0; slot < counters.size( ); slot++ )
+            counters[slot].count = 0;
+    }
+    else if( policy == HOTNESS_MEA )
+    {
+        hotPages.clear( );
+
+        for( ncounter_t idx = 0; idx < meaCounters.size( ); idx++ )
+            hotPages.push_back( meaCounters[idx].key );
+
+        meaCounters.clear( );
+    }
+}
+
+
+void HotnessMigrator::RecordAccess( Migrator *at, NVMainRequest *request )
+{
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+
+    if( now >= epochEnd )
+    {
+        EndEpoch( );
+        epochEnd = now + epochLength;
+    }
+
+    /* Only pages in the slow memory are candidates. */
+    if( request->address.GetChannel( ) == promotionChannel )
+        return;
+
+    uint64_t key = at->GetAddressKey( request->address );
+
+    if( policy == HOTNESS_EPOCH )
+    {
+        Counter( key )->count++;
+    }
+    else if( policy == HOTNESS_MEA )
+    {
+        CountMEA( key );
+    }
+    else
+    {
+        PageCounter *counter = Counter( key );
+        ncycle_t idle = now - counter->lastAccess;
+
+        /* Drop one queue per lifetime the page went untouched. */
+        if( idle >= mqLifetime )
+        {
+            ncycle_t lifetimes = idle / mqLifetime;
+
+            counter->count = ( lifetimes >= 64 ) ? 0 : ( counter->count >> lifetimes );
+        }
+
+        counter->count++;
+        counter->lastAccess = now;
+    }
+}
+
+
+/*
+ *  Only looks at the page's history. The migration may still be refused
+ *  or deferred, so the history is consumed in MigrationStarted.
+ */
+bool HotnessMigrator::ShouldMigrate( Migrator *at, NVMainRequest *request )
+{
+    uint64_t key = at->GetAddressKey( request->address );
+    bool hot = false;
+
+    if( policy == HOTNESS_MEA )
+    {
+        for( ncounter_t idx = 0; idx < hotPages.size( ); idx++ )
+        {
+            if( hotPages[idx] == key )
+            {
+                hot = true;
+                break;
+            }
+        }
+    }
+    else
+    {
+        PageCounter *counter = FindCounter( key );
+
+        if( counter != NULL && policy == HOTNESS_EPOCH )
+            hot = ( counter->count >= threshold );
+        else if( counter != NULL )
+            hot = ( Queue( counter->count ) >= mqPromotionQueue );
+    }
+
+    return hot;
+}
+
+
+void HotnessMigrator::MigrationStarted( Migrator *at, NVMainRequest *request )
+{
+    uint64_t key = at->GetAddressKey( request->address );
+
+    if( policy == HOTNESS_MEA )
+    {
+        for( ncounter_t idx = 0; idx < hotPages.size( ); idx++ )
+        {
+            if( hotPages[idx] == key )
+            {
+                hotPages[idx] = hotPages.back( );
+                hotPages.pop_back( );
+                break;
+            }
+        }
+    }
+    else
+    {
+        PageCounter *counter = FindCounter( key );
+
+        if( counter != NULL )
+            counter->count = 0;
+    }
+
+    hotPagesFound++;
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_UTILS_HOTNESSMIGRATOR_H__
+#define __NVMAIN_UTILS_HOTNESSMIGRATOR_H__
+
+#include "Utils/CoinMigrator/CoinMigrator.h"
+
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  How hot slow memory pages are found.
+ *
+ *  Epoch:      Per-page access counters, cleared every epoch. A page is
+ *              promoted once it reaches MigrationThreshold accesses.
+ *  MEA:        Majority element algorithm. A few counters track the most
+ *              frequent pages of an epoch; those pages are promoted on
+ *              their next access during the following epoch.
+ *  MultiQueue: Pages move up one queue each time their access count
+ *              doubles and down one queue for every MQLifetime cycles
+ *              without an access. Pages reaching MQPromotionQueue are
+ *              promoted.
+ */
+enum HotnessPolicy { HOTNESS_EPOCH, HOTNESS_MEA, HOTNESS_MULTIQUEUE };
+
+/*
+ *  Migrates pages between a fast and slow channel like the CoinMigrator, but
+ *  chooses pages by their access history instead of a coin flip.
+ */
+class HotnessMigrator : public CoinMigrator
+{
+  public:
+    HotnessMigrator( );
+    ~HotnessMigrator( );
+
+    void Init( Config *config );
+
+  protected:
+    void RecordAccess( Migrator *at, NVMainRequest *request );
+    bool ShouldMigrate( Migrator *at, NVMainRequest *request );
+    void MigrationStarted( Migrator *at, NVMainRequest *request );
+
+  private:
+    struct PageCounter
+    {
+        uint64_t key;
+        ncounter_t count;
+        ncycle_t lastAccess;
+    };
+
+    static const uint64_t noPage = ~0ULL;
+
+    HotnessPolicy policy;
+    ncycle_t epochLength, epochEnd;
+    ncounter_t threshold;
+
+    /* Direct mapped counters for the Epoch and MultiQueue policies. */
+    std::vector<PageCounter> counters;
+    uint64_t counterMask;
+
+    /* MEA counters for this epoch and the pages found hot last epoch. */
+    ncounter_t meaEntries;
+    std::vector<PageCounter> meaCounters;
+    std::vector<uint64_t> hotPages;
+
+    ncounter_t mqQueues, mqPromotionQueue;
+    ncycle_t mqLifetime;
+
+    ncounter_t epochs;
+    ncounter_t hotPagesFound;
+    ncounter_t counterConflicts;
+
+    PageCounter *Slot( uint64_t key );
+    PageCounter *Counter( uint64_t key );
+    PageCounter *FindCounter( uint64_t key );
+    ncounter_t Queue( ncounter_t count );
+    void CountMEA( uint64_t key );
+    void EndEpoch( );
+};
+
+};
+
+#endif
@@ -0,0 +1,274 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/StatsSnapshot/StatsSnapshot.h"
+#include "src/Config.h"
+#include "src/NVMObject.h"
+#include "src/Stats.h"
+#include "include/NVMHelpers.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace NVM;
+
+volatile sig_atomic_t StatsSnapshot::signalled = 0;
+
+StatsSnapshot::StatsSnapshot( )
+{
+    snapshotFile = "nvmain_snapshot.json";
+    socketPath = "";
+    listenSocket = -1;
+    clientSocket = -1;
+
+    pollCount = 0;
+    pollInterval = 1000;
+    snapshotCount = 0;
+
+    lastCycle = 0;
+    lastRequests = 0;
+
+    gettimeofday( &startTime, NULL );
+    lastTime = startTime;
+}
+
+StatsSnapshot::~StatsSnapshot( )
+{
+    if( clientSocket >= 0 )
+        close( clientSocket );
+
+    if( listenSocket >= 0 )
+    {
+        close( listenSocket );
+        unlink( socketPath.c_str( ) );
+    }
+}
+
+void StatsSnapshot::SignalHandler( int /*signum*/ )
+{
+    signalled = 1;
+}
+
+void StatsSnapshot::SetConfig( Config *conf )
+{
+    if( conf->KeyExists( "SnapshotFile" ) )
+    {
+        snapshotFile = conf->GetString( "SnapshotFile" );
+
+        if( snapshotFile[0] != '/' )
+            snapshotFile = NVM::GetFilePath( conf->GetFileName( ) ) + snapshotFile;
+    }
+
+    if( conf->KeyExists( "SnapshotPollInterval" ) )
+        pollInterval = conf->GetValueUL( "SnapshotPollInterval" );
+
+    if( pollInterval == 0 )
+        pollInterval = 1;
+
+    /* The handler only sets a flag; the snapshot is taken from Pending(). */
+    struct sigaction action;
+
+    memset( &action, 0, sizeof(action) );
+    action.sa_handler = &StatsSnapshot::SignalHandler;
+    sigemptyset( &action.sa_mask );
+    action.sa_flags = SA_RESTART;
+    sigaction( SIGUSR1, &action, NULL );
+
+    if( conf->KeyExists( "SnapshotSocket" ) )
+    {
+        socketPath = conf->GetString( "SnapshotSocket" );
+        OpenSocket( );
+    }
+
+    std::cout << "[+] StatsSnapshot: Send SIGUSR1 to pid " << getpid( );
+    if( listenSocket >= 0 )
+        std::cout << " or connect to " << socketPath;
+    std::cout << " to write a snapshot to " << snapshotFile << std::endl;
+}
+
+void StatsSnapshot::OpenSocket( )
+{
+    struct sockaddr_un address;
+
+    if( socketPath.length( ) >= sizeof(address.sun_path) )
+    {
+        std::cerr << "[-] StatsSnapshot: Socket path `" << socketPath 
+                  << "' is too long." << std::endl;
+        return;
+    }
+
+    listenSocket = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if( listenSocket < 0 )
+    {
+        std::cerr << "[-] StatsSnapshot: Could not create socket: " 
+                  << strerror( errno ) << std::endl;
+        return;
+    }
+
+    memset( &address, 0, sizeof(address) );
+    address.sun_family = AF_UNIX;
+    strncpy( address.sun_path, socketPath.c_str( ), sizeof(address.sun_path) - 1 );
+
+    /* Remove a stale socket left behind by a previous run. */
+    unlink( socketPath.c_str( ) );
+
+    if( bind( listenSocket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address) ) < 0
+        || listen( listenSocket, 4 ) < 0 )
+    {
+        std::cerr << "[-] StatsSnapshot: Could not listen on " << socketPath 
+                  << ": " << strerror( errno ) << std::endl;
+        close( listenSocket );
+        listenSocket = -1;
+        return;
+    }
+
+    /* Never block the simulation waiting for a client. */
+    fcntl( listenSocket, F_SETFL, fcntl( listenSocket, F_GETFL, 0 ) | O_NONBLOCK );
+}
+
+/*
+ *  Called by the driver at event boundaries. Checking the signal flag is free,
+ *  but the socket is only polled every pollInterval calls to keep the accept()
+ *  system call out of the common path.
+ */
+bool StatsSnapshot::Pending( )
+{
+    if( signalled )
+    {
+        signalled = 0;
+        return true;
+    }
+
+    if( listenSocket >= 0 && clientSocket < 0 && ++pollCount >= pollInterval )
+    {
+        pollCount = 0;
+        clientSocket = accept( listenSocket, NULL, NULL );
+
+        if( clientSocket >= 0 )
+            return true;
+    }
+
+    return false;
+}
+
+void StatsSnapshot::Write( NVMObject *root, Stats *stats, ncycle_t currentCycle,
+                           ncounter_t tracePosition, ncounter_t requests )
+{
+    struct timeval now;
+    double totalSeconds, intervalSeconds;
+    double requestRate = 0.0, cycleRate = 0.0;
+
+    root->CalculateStats( );
+
+    gettimeofday( &now, NULL );
+    totalSeconds = static_cast<double>(now.tv_sec - startTime.tv_sec)
+                 + static_cast<double>(now.tv_usec - startTime.tv_usec) / 1000000.0;
+    intervalSeconds = static_cast<double>(now.tv_sec - lastTime.tv_sec)
+                    + static_cast<double>(now.tv_usec - lastTime.tv_usec) / 1000000.0;
+
+    /* Rates are reported over the interval since the previous snapshot. */
+    if( intervalSeconds > 0.0 )
+    {
+        requestRate = static_cast<double>(requests - lastRequests) / intervalSeconds;
+        cycleRate = static_cast<double>(currentCycle - lastCycle) / intervalSeconds;
+    }
+
+    std::stringstream json;
+
+    json << "{" << std::endl
+         << "\"snapshot\": " << snapshotCount << "," << std::endl
+         << "\"currentCycle\": " << currentCycle << "," << std::endl
+         << "\"tracePosition\": " << tracePosition << "," << std::endl
+         << "\"requests\": " << requests << "," << std::endl
+         << "\"hostSeconds\": " << totalSeconds << "," << std::endl
+         << "\"requestsPerSecond\": " << requestRate << "," << std::endl
+         << "\"cyclesPerSecond\": " << cycleRate << "," << std::endl
+         << "\"stats\": ";
+    stats->PrintJSON( json );
+    json << std::endl << "}" << std::endl;
+
+    /* Write to a temporary file first so readers never see a partial snapshot. */
+    std::string tempFile = snapshotFile + ".tmp";
+    std::ofstream snapshotStream( tempFile.c_str( ), std::ofstream::out | std::ofstream::trunc );
+
+    if( snapshotStream.is_open( ) )
+    {
+        snapshotStream << json.str( );
+        snapshotStream.close( );
+
+        if( rename( tempFile.c_str( ), snapshotFile.c_str( ) ) != 0 )
+            std::cerr << "[-] StatsSnapshot: Could not rename " << tempFile << std::endl;
+    }
+    else
+    {
+        std::cerr << "[-] StatsSnapshot: Could not open " << tempFile << std::endl;
+    }
+
+    /* A socket client receives the same snapshot and is then disconnected. */
+    if( clientSocket >= 0 )
+    {
+        std::string data = json.str( );
+        size_t sent = 0;
+
+        fcntl( clientSocket, F_SETFL, fcntl( clientSocket, F_GETFL, 0 ) & ~O_NONBLOCK );
+
+        while( sent < data.length( ) )
+        {
+            ssize_t rv = send( clientSocket, data.c_str( ) + sent, data.length( ) - sent, MSG_NOSIGNAL );
+
+            if( rv <= 0 )
+                break;
+
+            sent += static_cast<size_t>(rv);
+        }
+
+        close( clientSocket );
+        clientSocket = -1;
+    }
+
+    std::cout << "[+] StatsSnapshot: Wrote snapshot " << snapshotCount << " at cycle "
+              << currentCycle << " to " << snapshotFile << std::endl;
+
+    snapshotCount++;
+    lastTime = now;
+    lastCycle = currentCycle;
+    lastRequests = requests;
+}
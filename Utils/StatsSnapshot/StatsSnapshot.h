@@ -0,0 +1,91 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_UTILS_STATSSNAPSHOT_H__
+#define __NVMAIN_UTILS_STATSSNAPSHOT_H__
+
+#include "include/NVMTypes.h"
+
+#include <csignal>
+#include <string>
+#include <sys/time.h>
+
+namespace NVM {
+
+class Config;
+class NVMObject;
+class Stats;
+
+/*
+ *  Writes live JSON snapshots of the statistics while a simulation is running.
+ *  A snapshot is requested by sending SIGUSR1 to the simulator or by connecting
+ *  to the UNIX-domain socket named by SnapshotSocket. The request is only
+ *  serviced when the driver calls Pending() between event queue steps, so the
+ *  memory system is never inspected in the middle of an event.
+ */
+class StatsSnapshot
+{
+  public:
+    StatsSnapshot( );
+    ~StatsSnapshot( );
+
+    void SetConfig( Config *conf );
+
+    bool Pending( );
+    void Write( NVMObject *root, Stats *stats, ncycle_t currentCycle,
+                ncounter_t tracePosition, ncounter_t requests );
+
+  private:
+    std::string snapshotFile;
+    std::string socketPath;
+    int listenSocket;
+    int clientSocket;
+
+    ncounter_t pollCount;
+    ncounter_t pollInterval;
+    ncounter_t snapshotCount;
+
+    struct timeval startTime;
+    struct timeval lastTime;
+    ncycle_t lastCycle;
+    ncounter_t lastRequests;
+
+    static volatile sig_atomic_t signalled;
+    static void SignalHandler( int signum );
+
+    void OpenSocket( );
+};
+
+};
+
+#endif
@@ -0,0 +1,273 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/WearLevelMover/WearLevelMover.h"
+#include "src/MemoryController.h"
+
+#include <cassert>
+
+using namespace NVM;
+
+WearLevelMover::WearLevelMover( )
+{
+    /*
+     *  Like CoinMigrator, the original write is issued before injecting any
+     *  moves so the moves do not take its queue slot.
+     */
+    SetHookType( NVMHOOK_BOTHISSUE );
+
+    numCols = 0;
+    wlReadTag = wlWriteTag = 0;
+
+    moveReads = 0;
+    moveWrites = 0;
+    blockedMoveWrites = 0;
+}
+
+WearLevelMover::~WearLevelMover( )
+{
+}
+
+void WearLevelMover::Init( Config *config )
+{
+    /* Entire rows are moved. */
+    numCols = config->GetValue( "COLS" );
+
+    wlReadTag = GetTagGenerator( )->CreateTag( "WLREAD" );
+    wlWriteTag = GetTagGenerator( )->CreateTag( "WLWRITE" );
+
+    AddStat(moveReads);
+    AddStat(moveWrites);
+    AddStat(blockedMoveWrites);
+}
+
+/*
+ *  Only the memory controller's translator decides where a request lands in
+ *  its channel, so the moves are handled at the memory controller level.
+ */
+WearLeveler *WearLevelMover::GetLeveler( )
+{
+    WearLeveler *leveler = NULL;
+
+    if( NVMTypeMatches(MemoryController) )
+    {
+        leveler = dynamic_cast<WearLeveler *>(parent->GetTrampoline( )->GetDecoder( ));
+    }
+
+    return leveler;
+}
+
+bool WearLevelMover::IssueAtomic( NVMainRequest *request )
+{
+    /* For atomic mode, the rows are moved instantly. */
+    return TryRemap( request, true );
+}
+
+bool WearLevelMover::IssueCommand( NVMainRequest *request )
+{
+    return TryRemap( request, false );
+}
+
+NVMainRequest *WearLevelMover::MakeMoveRequest( WearLeveler *leveler, NVMAddress& region,
+                                                uint64_t row, OpType type )
+{
+    NVMainRequest *moveRequest = new NVMainRequest( );
+    uint64_t bank, rank, channel, subarray;
+
+    region.GetTranslatedAddress( NULL, NULL, &bank, &rank, &channel, &subarray );
+
+    /* The physical address must translate to this row under the current mapping. */
+    moveRequest->address.SetPhysicalAddress( 
+            leveler->ReverseTranslate( row, 0, bank, rank, channel, subarray ) );
+    moveRequest->address.SetTranslatedAddress( row, 0, bank, rank, channel, subarray );
+    moveRequest->type = type;
+    moveRequest->tag = (type == READ) ? wlReadTag : wlWriteTag;
+    moveRequest->burstCount = numCols;
+    moveRequest->owner = parent->GetTrampoline( );
+
+    return moveRequest;
+}
+
+bool WearLevelMover::TryRemap( NVMainRequest *request, bool atomic )
+{
+    WearLeveler *leveler = GetLeveler( );
+
+    /* Don't inject moves before the original is issued. */
+    if( leveler == NULL || GetCurrentHookType( ) != NVMHOOK_POSTISSUE 
+        || request->type != WRITE || request->owner == parent->GetTrampoline( ) )
+    {
+        return true;
+    }
+
+    if( !leveler->RecordWrite( request->address ) )
+        return true;
+
+    std::vector<RowMove> moves;
+    std::vector<NVMainRequest *> reads;
+    std::vector<RowMove>::iterator it;
+
+    leveler->GetRemapMoves( request->address, moves );
+
+    if( atomic )
+    {
+        leveler->StartRemap( request->address );
+        leveler->FinishRemap( );
+        return true;
+    }
+
+    /* Make sure all of the reads can be queued before changing the mapping. */
+    for( it = moves.begin( ); it != moves.end( ); it++ )
+    {
+        NVMainRequest *moveRead = MakeMoveRequest( leveler, request->address, 
+                                                   it->source, READ );
+
+        /* The destination row rides along with the move read. */
+        moveRead->reqInfo = reinterpret_cast<void *>( 
+                static_cast<uintptr_t>( it->destination ) );
+        reads.push_back( moveRead );
+    }
+
+    bool issuable = true;
+
+    for( size_t i = 0; i < reads.size( ); i++ )
+    {
+        if( !parent->GetTrampoline( )->IsIssuable( reads[i], NULL ) )
+            issuable = false;
+    }
+
+    if( !issuable )
+    {
+        for( size_t i = 0; i < reads.size( ); i++ )
+            delete reads[i];
+
+        leveler->DeferRemap( );
+        return true;
+    }
+
+    for( size_t i = 0; i < reads.size( ); i++ )
+    {
+        bool queued = parent->GetTrampoline( )->IssueCommand( reads[i] );
+
+        assert( queued );
+        (void)queued;
+
+        moveReads++;
+    }
+
+    leveler->StartRemap( request->address );
+
+    if( moves.empty( ) )
+        leveler->FinishRemap( );
+    else
+        movesLeft[leveler] = 2 * moves.size( );
+
+    return true;
+}
+
+bool WearLevelMover::RequestComplete( NVMainRequest *request )
+{
+    if( GetCurrentHookType( ) != NVMHOOK_PREISSUE || !NVMTypeMatches(MemoryController) )
+        return true;
+
+    WearLeveler *leveler = GetLeveler( );
+
+    if( leveler != NULL && request->owner == parent->GetTrampoline( ) 
+        && request->tag == wlReadTag )
+    {
+        /* The request will be deleted by the memory controller. */
+        uint64_t destination = static_cast<uint64_t>( 
+                reinterpret_cast<uintptr_t>( request->reqInfo ) );
+
+        NVMainRequest *moveWrite = MakeMoveRequest( leveler, request->address,
+                                                    destination, WRITE );
+
+        if( !parent->GetTrampoline( )->IssueCommand( moveWrite ) )
+        {
+            blockedWrites.push_back( moveWrite );
+            blockedMoveWrites++;
+        }
+        else
+        {
+            moveWrites++;
+        }
+
+        MoveCompleted( leveler );
+
+        return true;
+    }
+    else if( leveler != NULL && request->owner == parent->GetTrampoline( ) 
+             && request->tag == wlWriteTag )
+    {
+        MoveCompleted( leveler );
+    }
+
+    /* Any completion may have freed a queue slot for a blocked write. */
+    if( !blockedWrites.empty( ) )
+        IssueBlockedWrites( );
+
+    return true;
+}
+
+void WearLevelMover::IssueBlockedWrites( )
+{
+    std::list<NVMainRequest *>::iterator it = blockedWrites.begin( );
+
+    while( it != blockedWrites.end( ) )
+    {
+        /* Only retry writes for the controller that just freed a slot. */
+        if( (*it)->owner == parent->GetTrampoline( ) 
+            && parent->GetTrampoline( )->IssueCommand( *it ) )
+        {
+            moveWrites++;
+            it = blockedWrites.erase( it );
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+void WearLevelMover::MoveCompleted( WearLeveler *leveler )
+{
+    assert( movesLeft[leveler] > 0 );
+
+    movesLeft[leveler]--;
+
+    if( movesLeft[leveler] == 0 )
+        leveler->FinishRemap( );
+}
+
+void WearLevelMover::Cycle( ncycle_t )
+{
+}
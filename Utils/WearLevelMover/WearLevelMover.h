@@ -0,0 +1,91 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_UTILS_WEARLEVELMOVER_H__
+#define __NVMAIN_UTILS_WEARLEVELMOVER_H__
+
+#include "src/NVMObject.h"
+#include "include/NVMainRequest.h"
+#include "Decoders/WearLeveler/WearLeveler.h"
+
+#include <list>
+#include <map>
+
+namespace NVM {
+
+/*
+ *  Issues the row copies needed by a WearLeveler decoder (e.g., StartGap or
+ *  SecurityRefresh) through the memory controllers. Each row is read under
+ *  the old mapping and written back to its new location once the read
+ *  completes.
+ */
+class WearLevelMover : public NVMObject
+{
+  public:
+    WearLevelMover( );
+    ~WearLevelMover( );
+
+    void Init( Config *config );
+
+    bool IssueAtomic( NVMainRequest *request );
+    bool IssueCommand( NVMainRequest *request );
+    bool RequestComplete( NVMainRequest *request );
+
+    void Cycle( ncycle_t steps );
+
+  private:
+    ncounter_t numCols;
+
+    /* Request tags are interned once in Init. */
+    int wlReadTag, wlWriteTag;
+
+    /* Number of move reads and writes left per translator. */
+    std::map<WearLeveler *, ncounter_t> movesLeft;
+    /* Move writes the controller could not queue yet. */
+    std::list<NVMainRequest *> blockedWrites;
+
+    ncounter_t moveReads;
+    ncounter_t moveWrites;
+    ncounter_t blockedMoveWrites;
+
+    WearLeveler *GetLeveler( );
+    NVMainRequest *MakeMoveRequest( WearLeveler *leveler, NVMAddress& region, 
+                                    uint64_t row, OpType type );
+    bool TryRemap( NVMainRequest *request, bool atomic );
+    void IssueBlockedWrites( );
+    void MoveCompleted( WearLeveler *leveler );
+};
+
+};
+
+#endif
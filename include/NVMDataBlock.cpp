@@ -77,6 +77,37 @@ uint8_t NVMDataBlock::GetByte( uint64_t byte )
     return rv;
 }
 
+/*
+ *  Returns bytes [8 * word, 8 * word + 8) as a little-endian 64-bit word, so
+ *  bit i of the result is bit (i % 8) of byte (8 * word + i / 8). Bytes past
+ *  the end of the block read as zero, like GetByte( ).
+ */
+uint64_t NVMDataBlock::GetWord( uint64_t word )
+{
+    uint64_t rv = 0;
+    uint64_t firstByte = word * 8;
+
+    if( !isValid || rawData == NULL || firstByte >= size )
+        return rv;
+
+    if( firstByte + 8 <= size )
+    {
+        uint8_t bytes[8];
+
+        memcpy( bytes, rawData + firstByte, sizeof(bytes) );
+
+        for( int i = 7; i >= 0; i-- )
+            rv = ( rv << 8 ) | bytes[i];
+    }
+    else
+    {
+        for( uint64_t byte = size; byte > firstByte; byte-- )
+            rv = ( rv << 8 ) | rawData[byte - 1];
+    }
+
+    return rv;
+}
+
 void NVMDataBlock::SetByte( uint64_t byte, uint8_t value )
 {
     if( byte <= size )
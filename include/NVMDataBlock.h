@@ -52,6 +52,8 @@ class NVMDataBlock
     uint8_t GetByte( uint64_t byte );
     void SetByte( uint64_t byte, uint8_t value );
 
+    uint64_t GetWord( uint64_t word );
+
     void SetValid( bool valid );
     bool IsValid( );
 
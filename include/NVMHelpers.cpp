@@ -33,6 +33,13 @@
 
 #include "include/NVMHelpers.h"
 
+#include <cstring>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define NVM_BITCOUNT_DISPATCH
+#include <immintrin.h>
+#endif
+
 namespace NVM {
 
 int mlog2( int num )
@@ -61,4 +68,353 @@ std::string GetFilePath( std::string file )
     return file.substr( 0, last_sep+1 );
 } 
 
+/*
+ *  Bit counting kernels for write energy and MLC pulse counts. A write
+ *  usually covers one 64-byte memory word, so each kernel handles whole
+ *  words with a single pass. Without -mpopcnt the compiler turns the
+ *  popcount builtin into a library call, so on x86 the best kernel the
+ *  CPU supports is chosen once at startup.
+ */
+#define NVM_ALWAYS_INLINE inline __attribute__((always_inline))
+
+static const uint64_t evenBits = 0x5555555555555555ULL;
+
+/* Reads the next 8 bytes, zero padding past the end of the data. */
+static NVM_ALWAYS_INLINE uint64_t LoadWord( const uint8_t *data, uint64_t bytes )
+{
+    uint64_t word = 0;
+
+    /* memcpy avoids aliasing problems with the uint8_t buffer at -O3. */
+    if( bytes >= sizeof(word) )
+        memcpy( &word, data, sizeof(word) );
+    else
+        memcpy( &word, data, bytes );
+
+    return word;
+}
+
+static NVM_ALWAYS_INLINE uint64_t CountOneBitsBody( const uint8_t *data, uint64_t bytes )
+{
+    uint64_t count = 0;
+
+    for( uint64_t byte = 0; byte < bytes; byte += 8 )
+        count += PopCount64( LoadWord( data + byte, bytes - byte ) );
+
+    return count;
+}
+
+/*
+ *  Cells are bit pairs (2i+1, 2i) with the odd bit as the high bit. Zero
+ *  padding in a partial word reads as 00, so level 0 is what is left over.
+ */
+static NVM_ALWAYS_INLINE void CountMLC2Body( const uint8_t *data, uint64_t bytes,
+                                             uint64_t counts[4] )
+{
+    uint64_t count01 = 0, count10 = 0, count11 = 0;
+
+    for( uint64_t byte = 0; byte < bytes; byte += 8 )
+    {
+        uint64_t word = LoadWord( data + byte, bytes - byte );
+        uint64_t low = word & evenBits;
+        uint64_t high = ( word >> 1 ) & evenBits;
+
+        count01 += PopCount64( low & ~high );
+        count10 += PopCount64( high & ~low );
+        count11 += PopCount64( high & low );
+    }
+
+    counts[1] += count01;
+    counts[2] += count10;
+    counts[3] += count11;
+}
+
+static uint64_t CountOneBitsScalar( const uint8_t *data, uint64_t bytes )
+{
+    return CountOneBitsBody( data, bytes );
+}
+
+static void CountMLC2Scalar( const uint8_t *data, uint64_t bytes, uint64_t counts[4] )
+{
+    CountMLC2Body( data, bytes, counts );
+}
+
+#if defined(NVM_BITCOUNT_DISPATCH)
+
+__attribute__((target("popcnt")))
+static uint64_t CountOneBitsPopcnt( const uint8_t *data, uint64_t bytes )
+{
+    return CountOneBitsBody( data, bytes );
+}
+
+__attribute__((target("popcnt")))
+static void CountMLC2Popcnt( const uint8_t *data, uint64_t bytes, uint64_t counts[4] )
+{
+    CountMLC2Body( data, bytes, counts );
+}
+
+/* 
+ *  AVX2 has no vector popcount, so bytes are counted with a nibble lookup
+ *  table and summed into 64-bit lanes.
+ */
+__attribute__((target("avx2")))
+static NVM_ALWAYS_INLINE __m256i PopCount256( __m256i v )
+{
+    const __m256i table = _mm256_setr_epi8( 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+    const __m256i lowNibble = _mm256_set1_epi8( 0x0F );
+
+    __m256i low = _mm256_shuffle_epi8( table, _mm256_and_si256( v, lowNibble ) );
+    __m256i high = _mm256_shuffle_epi8( table, 
+                       _mm256_and_si256( _mm256_srli_epi16( v, 4 ), lowNibble ) );
+
+    return _mm256_sad_epu8( _mm256_add_epi8( low, high ), _mm256_setzero_si256( ) );
+}
+
+__attribute__((target("avx2")))
+static NVM_ALWAYS_INLINE uint64_t SumLanes256( __m256i v )
+{
+    __m128i sum = _mm_add_epi64( _mm256_castsi256_si128( v ), 
+                                 _mm256_extracti128_si256( v, 1 ) );
+
+    return static_cast<uint64_t>( _mm_cvtsi128_si64( sum ) ) 
+         + static_cast<uint64_t>( _mm_extract_epi64( sum, 1 ) );
+}
+
+__attribute__((target("avx2,popcnt")))
+static uint64_t CountOneBitsAVX2( const uint8_t *data, uint64_t bytes )
+{
+    __m256i ones = _mm256_setzero_si256( );
+    uint64_t byte = 0;
+
+    for( ; byte + 32 <= bytes; byte += 32 )
+    {
+        __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( data + byte ) );
+
+        ones = _mm256_add_epi64( ones, PopCount256( v ) );
+    }
+
+    return SumLanes256( ones ) + CountOneBitsBody( data + byte, bytes - byte );
+}
+
+__attribute__((target("avx2,popcnt")))
+static void CountMLC2AVX2( const uint8_t *data, uint64_t bytes, uint64_t counts[4] )
+{
+    const __m256i even = _mm256_set1_epi64x( static_cast<long long>( evenBits ) );
+    __m256i count01 = _mm256_setzero_si256( );
+    __m256i count10 = _mm256_setzero_si256( );
+    __m256i count11 = _mm256_setzero_si256( );
+    uint64_t byte = 0;
+
+    for( ; byte + 32 <= bytes; byte += 32 )
+    {
+        __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( data + byte ) );
+        __m256i low = _mm256_and_si256( v, even );
+        __m256i high = _mm256_and_si256( _mm256_srli_epi64( v, 1 ), even );
+
+        count01 = _mm256_add_epi64( count01, PopCount256( _mm256_andnot_si256( high, low ) ) );
+        count10 = _mm256_add_epi64( count10, PopCount256( _mm256_andnot_si256( low, high ) ) );
+        count11 = _mm256_add_epi64( count11, PopCount256( _mm256_and_si256( high, low ) ) );
+    }
+
+    counts[1] += SumLanes256( count01 );
+    counts[2] += SumLanes256( count10 );
+    counts[3] += SumLanes256( count11 );
+
+    CountMLC2Body( data + byte, bytes - byte, counts );
+}
+
+/*
+ *  Plain vector operators are used instead of the shift, logic and reduce
+ *  intrinsics, which trip -Wmaybe-uninitialized in some GCC versions.
+ */
+__attribute__((target("avx512f")))
+static NVM_ALWAYS_INLINE uint64_t SumLanes512( __m512i v )
+{
+    uint64_t lanes[8];
+    uint64_t sum = 0;
+
+    _mm512_storeu_si512( lanes, v );
+    for( int lane = 0; lane < 8; lane++ )
+        sum += lanes[lane];
+
+    return sum;
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+static uint64_t CountOneBitsAVX512( const uint8_t *data, uint64_t bytes )
+{
+    __m512i ones = _mm512_setzero_si512( );
+    uint64_t byte = 0;
+
+    for( ; byte + 64 <= bytes; byte += 64 )
+    {
+        __m512i v = _mm512_loadu_si512( data + byte );
+
+        ones = _mm512_add_epi64( ones, _mm512_popcnt_epi64( v ) );
+    }
+
+    return SumLanes512( ones ) + CountOneBitsBody( data + byte, bytes - byte );
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+static void CountMLC2AVX512( const uint8_t *data, uint64_t bytes, uint64_t counts[4] )
+{
+    const __m512i even = _mm512_set1_epi64( static_cast<long long>( evenBits ) );
+    __m512i count01 = _mm512_setzero_si512( );
+    __m512i count10 = _mm512_setzero_si512( );
+    __m512i count11 = _mm512_setzero_si512( );
+    uint64_t byte = 0;
+
+    for( ; byte + 64 <= bytes; byte += 64 )
+    {
+        __m512i v = _mm512_loadu_si512( data + byte );
+        __m512i low = v & even;
+        __m512i high = ( v >> 1 ) & even;
+
+        count01 = _mm512_add_epi64( count01, _mm512_popcnt_epi64( low & ~high ) );
+        count10 = _mm512_add_epi64( count10, _mm512_popcnt_epi64( high & ~low ) );
+        count11 = _mm512_add_epi64( count11, _mm512_popcnt_epi64( high & low ) );
+    }
+
+    counts[1] += SumLanes512( count01 );
+    counts[2] += SumLanes512( count10 );
+    counts[3] += SumLanes512( count11 );
+
+    CountMLC2Body( data + byte, bytes - byte, counts );
+}
+
+#endif
+
+struct BitCountKernels
+{
+    uint64_t (*countOneBits)( const uint8_t *, uint64_t );
+    void (*countMLC2)( const uint8_t *, uint64_t, uint64_t * );
+};
+
+/* Indexed by BitCountKernel. Kernels not built here are NULL. */
+static const BitCountKernels kernelTable[BITCOUNT_KERNELS] =
+{
+    { CountOneBitsScalar, CountMLC2Scalar },
+#if defined(NVM_BITCOUNT_DISPATCH)
+    { CountOneBitsPopcnt, CountMLC2Popcnt },
+    { CountOneBitsAVX2, CountMLC2AVX2 },
+    { CountOneBitsAVX512, CountMLC2AVX512 }
+#else
+    { NULL, NULL },
+    { NULL, NULL },
+    { NULL, NULL }
+#endif
+};
+
+static const char *kernelNames[BITCOUNT_KERNELS] = { "scalar", "popcnt", "avx2", "avx512" };
+
+bool BitCountKernelSupported( BitCountKernel kernel )
+{
+    if( kernel == BITCOUNT_SCALAR )
+        return true;
+
+#if defined(NVM_BITCOUNT_DISPATCH)
+    __builtin_cpu_init( );
+
+    if( kernel == BITCOUNT_POPCNT )
+        return __builtin_cpu_supports( "popcnt" );
+    else if( kernel == BITCOUNT_AVX2 )
+        return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "popcnt" );
+    else if( kernel == BITCOUNT_AVX512 )
+        return __builtin_cpu_supports( "avx512vpopcntdq" );
+#endif
+
+    return false;
+}
+
+static BitCountKernel SelectBitCountKernel( )
+{
+    BitCountKernel kernel = BITCOUNT_AVX512;
+
+    while( kernel != BITCOUNT_SCALAR && !BitCountKernelSupported( kernel ) )
+        kernel = static_cast<BitCountKernel>( kernel - 1 );
+
+    return kernel;
+}
+
+static BitCountKernel activeKernel = SelectBitCountKernel( );
+static BitCountKernels bitCountKernels = kernelTable[activeKernel];
+
+BitCountKernel GetBitCountKernel( )
+{
+    return activeKernel;
+}
+
+/*
+ *  Switches to the given kernel. Returns false and keeps the current one
+ *  if this CPU cannot run it.
+ */
+bool SetBitCountKernel( BitCountKernel kernel )
+{
+    if( kernel >= BITCOUNT_KERNELS || !BitCountKernelSupported( kernel ) )
+        return false;
+
+    activeKernel = kernel;
+    bitCountKernels = kernelTable[kernel];
+
+    return true;
+}
+
+const char *BitCountKernelName( BitCountKernel kernel )
+{
+    return ( kernel < BITCOUNT_KERNELS ) ? kernelNames[kernel] : "unknown";
+}
+
+/*
+ *  Counts the one bits in the first "bytes" bytes of data.
+ */
+uint64_t CountOneBits( const uint8_t *data, uint64_t bytes )
+{
+    return bitCountKernels.countOneBits( data, bytes );
+}
+
+/*
+ *  Counts the 2-bit MLC cells in the first "bytes" bytes of data holding
+ *  each level, where counts[v] is the number of cells storing v (binary
+ *  00, 01, 10 or 11).
+ */
+void CountMLC2Levels( const uint8_t *data, uint64_t bytes, uint64_t counts[4] )
+{
+    counts[0] = counts[1] = counts[2] = counts[3] = 0;
+
+    bitCountKernels.countMLC2( data, bytes, counts );
+
+    counts[0] = bytes * 4 - counts[1] - counts[2] - counts[3];
+}
+
+/*
+ *  Counts the bits in [startBit, endBit) that differ between newData and
+ *  oldData. Bit i is bit (i % 8) of byte (i / 8), as with GetByte( ).
+ */
+uint64_t CountBitFlips( NVMDataBlock& newData, NVMDataBlock& oldData,
+                        uint64_t startBit, uint64_t endBit )
+{
+    uint64_t count = 0;
+
+    if( startBit >= endBit )
+        return count;
+
+    uint64_t firstWord = startBit / 64;
+    uint64_t lastWord = ( endBit - 1 ) / 64;
+
+    for( uint64_t word = firstWord; word <= lastWord; word++ )
+    {
+        uint64_t flips = newData.GetWord( word ) ^ oldData.GetWord( word );
+
+        if( word == firstWord )
+            flips &= ~0ULL << ( startBit % 64 );
+        if( word == lastWord && ( endBit % 64 ) != 0 )
+            flips &= ~( ~0ULL << ( endBit % 64 ) );
+
+        count += PopCount64( flips );
+    }
+
+    return count;
+}
+
 };
@@ -39,11 +39,69 @@
 #include <cstdint>
 #include <sstream>
 
+#include "include/NVMDataBlock.h"
+
 namespace NVM {
 
 int mlog2( int num );
 std::string GetFilePath( std::string file );
 
+/*
+ *  Bit counting on 64-bit words. These are used wherever data is compared
+ *  bit by bit (endurance models, data encoders, write energy) so that whole
+ *  words are handled at once instead of looping over bytes and bits.
+ */
+inline uint64_t PopCount64( uint64_t word )
+{
+    return static_cast<uint64_t>( __builtin_popcountll( word ) );
+}
+
+/* Both are undefined for word == 0. */
+inline uint64_t CountTrailingZeros64( uint64_t word )
+{
+    return static_cast<uint64_t>( __builtin_ctzll( word ) );
+}
+
+inline uint64_t CountLeadingZeros64( uint64_t word )
+{
+    return static_cast<uint64_t>( __builtin_clzll( word ) );
+}
+
+/* Returns a mask with bit j set if byte j of word is non-zero. */
+inline uint64_t NonZeroBytes64( uint64_t word )
+{
+    const uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+    uint64_t highBits = ( ( ( word & low7 ) + low7 ) | word ) & ~low7;
+
+    /* Gather the high bit of byte j into bit 56 + j, then shift down. */
+    return ( ( highBits >> 7 ) * 0x0102040810204080ULL ) >> 56;
+}
+
+uint64_t CountOneBits( const uint8_t *data, uint64_t bytes );
+void CountMLC2Levels( const uint8_t *data, uint64_t bytes, uint64_t counts[4] );
+
+/*
+ *  CountOneBits and CountMLC2Levels run the fastest kernel the CPU
+ *  supports. Tests and benchmarks may pick another supported kernel; this
+ *  is not thread safe, so only switch before a simulation starts.
+ */
+enum BitCountKernel
+{
+    BITCOUNT_SCALAR,
+    BITCOUNT_POPCNT,
+    BITCOUNT_AVX2,
+    BITCOUNT_AVX512,
+    BITCOUNT_KERNELS
+};
+
+bool BitCountKernelSupported( BitCountKernel kernel );
+BitCountKernel GetBitCountKernel( );
+bool SetBitCountKernel( BitCountKernel kernel );
+const char *BitCountKernelName( BitCountKernel kernel );
+
+uint64_t CountBitFlips( NVMDataBlock& newData, NVMDataBlock& oldData,
+                        uint64_t startBit, uint64_t endBit );
+
 template <typename T1, typename T2>
 std::string PyDictHistogram( std::map<T1, T2> iiMap )
 {
@@ -0,0 +1,145 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "include/NVMRandom.h"
+#include "src/Checkpoint.h"
+
+#include <cmath>
+
+namespace NVM {
+
+RandomGenerator::RandomGenerator( )
+{
+    Seed( 1 );
+}
+
+/*
+ *  The stream name is hashed into the seed and the state is filled with
+ *  SplitMix64, as recommended for xoshiro generators.
+ */
+void RandomGenerator::Seed( uint64_t seed, std::string stream )
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for( size_t i = 0; i < stream.size( ); i++ )
+    {
+        hash ^= static_cast<uint8_t>( stream[i] );
+        hash *= 0x100000001b3ULL;
+    }
+
+    uint64_t x = seed ^ hash;
+
+    for( int i = 0; i < 4; i++ )
+    {
+        uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+
+        z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+        z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+        state[i] = z ^ ( z >> 31 );
+    }
+
+    normalIndex = normalBatch;
+}
+
+double RandomGenerator::NextNormal( )
+{
+    if( normalIndex == normalBatch )
+    {
+        FillNormal( normals, normalBatch );
+        normalIndex = 0;
+    }
+
+    return normals[normalIndex++];
+}
+
+void RandomGenerator::FillUniform( double *values, uint64_t count )
+{
+    for( uint64_t i = 0; i < count; i++ )
+        values[i] = NextUniform( );
+}
+
+/*
+ *  Basic Box-Muller transform. Unlike the polar method there is no rejection
+ *  step, so the uniforms are drawn first and the transform runs as a plain
+ *  loop over the batch.
+ */
+void RandomGenerator::FillNormal( double *values, uint64_t count )
+{
+    const double twoPi = 6.283185307179586;
+    uint64_t pairs = count / 2;
+
+    FillUniform( values, pairs * 2 );
+
+    for( uint64_t i = 0; i < pairs; i++ )
+    {
+        /* Use (0, 1] for the radius so log( ) stays finite. */
+        double radius = std::sqrt( -2.0 * std::log( 1.0 - values[2*i] ) );
+        double angle = twoPi * values[2*i+1];
+
+        values[2*i] = radius * std::cos( angle );
+        values[2*i+1] = radius * std::sin( angle );
+    }
+
+    if( count % 2 )
+    {
+        double radius = std::sqrt( -2.0 * std::log( 1.0 - NextUniform( ) ) );
+
+        values[count-1] = radius * std::cos( twoPi * NextUniform( ) );
+    }
+}
+
+/* The buffered normals are saved too, so the stream continues exactly. */
+void RandomGenerator::WriteCheckpoint( CheckpointWriter& cpt )
+{
+    for( int i = 0; i < 4; i++ )
+        cpt.Write( state[i] );
+
+    cpt.Write( normalIndex );
+    for( uint64_t i = normalIndex; i < normalBatch; i++ )
+        cpt.WriteDouble( normals[i] );
+}
+
+void RandomGenerator::ReadCheckpoint( CheckpointReader& cpt )
+{
+    for( int i = 0; i < 4; i++ )
+        state[i] = cpt.Read( );
+
+    normalIndex = cpt.Read( );
+    if( normalIndex > normalBatch )
+        normalIndex = normalBatch;
+
+    for( uint64_t i = normalIndex; i < normalBatch; i++ )
+        normals[i] = cpt.ReadDouble( );
+}
+
+};
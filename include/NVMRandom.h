@@ -0,0 +1,111 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_RANDOM_H__
+#define __NVMAIN_RANDOM_H__
+
+#include <string>
+#include <cstdint>
+
+namespace NVM {
+
+class CheckpointWriter;
+class CheckpointReader;
+
+/*
+ *  Small xoshiro256** generator. Each component owns its own generator so
+ *  results do not depend on the order in which components draw numbers.
+ *  Streams are derived from a global seed (the RandomSeed parameter) and a
+ *  name unique to the component, typically its stat name.
+ */
+class RandomGenerator
+{
+  public:
+    RandomGenerator( );
+    ~RandomGenerator( ) { }
+
+    void Seed( uint64_t seed, std::string stream = "" );
+
+    inline uint64_t Next( )
+    {
+        uint64_t result = Rotate( state[1] * 5, 7 ) * 9;
+        uint64_t shifted = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = Rotate( state[3], 45 );
+
+        return result;
+    }
+
+    /* Uniform in [0, 1) with 53 bits of precision. */
+    inline double NextUniform( )
+    {
+        return static_cast<double>( Next( ) >> 11 ) * ( 1.0 / 9007199254740992.0 );
+    }
+
+    /* Uniform in [0, bound). */
+    inline uint64_t NextBelow( uint64_t bound )
+    {
+        return static_cast<uint64_t>( 
+                ( static_cast<unsigned __int128>( Next( ) ) * bound ) >> 64 );
+    }
+
+    /* Standard normal samples, generated in batches. */
+    double NextNormal( );
+
+    void FillUniform( double *values, uint64_t count );
+    void FillNormal( double *values, uint64_t count );
+
+    void WriteCheckpoint( CheckpointWriter& cpt );
+    void ReadCheckpoint( CheckpointReader& cpt );
+
+  private:
+    static const uint64_t normalBatch = 64;
+
+    uint64_t state[4];
+    double normals[normalBatch];
+    uint64_t normalIndex;
+
+    static inline uint64_t Rotate( uint64_t x, int bits )
+    {
+        return ( x << bits ) | ( x >> ( 64 - bits ) );
+    }
+};
+
+};
+
+#endif
@@ -39,6 +39,7 @@
 #include "include/NVMTypes.h"
 #include <iostream>
 #include <signal.h>
+#include <memory>
 
 namespace NVM {
 
@@ -127,6 +128,7 @@ enum BulkCommand
 };
 
 class NVMObject;
+class LayerParams;
 
 class NVMainRequest
 {
@@ -188,6 +190,7 @@ class NVMainRequest
     Transfer_mode t_mode;
     uint64_t t_size;
     bool isReused;
+    std::shared_ptr<const LayerParams> layer; //< CNN layer of a compute-in-memory request
     
     ncycle_t arrivalCycle;         //< When the request arrived at the memory controller
     ncycle_t queueCycle;           //< When the memory controller accepted (queued) the request
@@ -210,6 +213,8 @@ class NVMainRequest
         FLAG_FORCED = 32,               // This write can not be paused or cancelled
         FLAG_PRIORITY = 64,             // Request (or precursor) that takes priority over write
         FLAG_ISSUED = 128,              // Request has left the command queue
+        FLAG_DROPPED = 256,             // Prefetch discarded without being serviced
+        FLAG_LOOKUP_DONE = 512,         // Decoder lookup latency was charged
         FLAG_COUNT
     };
 
@@ -25,7 +25,6 @@
 using namespace NVM;
 
 //Define some global params
-GlobalParams globalparams;
 rvSim *riscv_sim = new rvSim();
 
 /*
@@ -160,32 +159,55 @@ rvSim::~rvSim()
 
 bool rvSim::setParameters()
 {
-	if(!globalparams.isUsing)
-	{
-		//std::cout << "[+](setParameters) Test" << std::endl;
-		globalparams.Func_n = 0;
-    globalparams.Input_Row = 5; //28;
-    globalparams.Input_Col = 5; //28;
-    globalparams.Input_Channel = 3;
-    globalparams.BitWidth = 4;
-    globalparams.K_Row = 3;
-    globalparams.K_Col = 3;
-    globalparams.K_Channel = globalparams.Input_Channel;
-    globalparams.K_num = 32;
-    globalparams.Input_Width = 8;
-    globalparams.Weight_Width = 8;
-    globalparams.act_mode = ACT_RELU;
-    globalparams.pooling_mode = Pooling_Max;
-		globalparams.Buffer_n = 4;
-
-		//globalparams.Input_Addr.SetPhysicalAddress(0);
-		//globalparams.Output_Addr.SetPhysicalAddress(100000000);
-		
-		return true;
-	}
+	LayerParams *params = new LayerParams( );
+
+	params->Func_n = 0;
+	params->Input_Row = 5; //28;
+	params->Input_Col = 5; //28;
+	params->Input_Channel = 3;
+	params->BitWidth = 4;
+	params->K_Row = 3;
+	params->K_Col = 3;
+	params->K_Channel = params->Input_Channel;
+	params->K_num = 32;
+	params->Input_Width = 8;
+	params->Weight_Width = 8;
+	params->act_mode = ACT_RELU;
+	params->pooling_mode = Pooling_Max;
+	params->Buffer_n = 4;
+
+	layer.reset( params );
+
+	return true;
+}
 
-	else 
-		return false;
+/*
+ *  Layer changes publish a new descriptor; requests that were already
+ *  issued keep the one they were issued with.
+ */
+bool rvSim::SetLayerInput( uint64_t col, uint64_t row, uint64_t channels, uint64_t width )
+{
+	LayerParams *params = (layer) ? new LayerParams( *layer ) : new LayerParams( );
+
+	params->Input_Col = col;
+	params->Input_Row = row;
+	params->Input_Channel = channels;
+	params->Input_Width = width;
+
+	layer.reset( params );
+
+	return true;
+}
+
+bool rvSim::SetLayerFunction( uint64_t func )
+{
+	LayerParams *params = (layer) ? new LayerParams( *layer ) : new LayerParams( );
+
+	params->Func_n = func;
+
+	layer.reset( params );
+
+	return true;
 }
 
 void rvSim::SetConfig( int argc, char *argv[] )
@@ -205,6 +227,7 @@ void rvSim::SetConfig( int argc, char *argv[] )
 	mainEventQueue = new EventQueue( );
 	globalEventQueue = new GlobalEventQueue( );
 	tagGenerator = new TagGenerator( 1000 );
+	snapshot = new StatsSnapshot( );
 	
   config->Read( argv[1] );
   config->SetSimInterface( simInterface );
@@ -248,8 +271,14 @@ void rvSim::SetConfig( int argc, char *argv[] )
   globalEventQueue->AddSystem( nvmain, config );
   simInterface->SetConfig( config, true );
   nvmain->SetConfig( config, "defaultMemory", true );
+  snapshot->SetConfig( config );
+
+  /* Without setParameters() the layer comes from the CIM_* config keys. */
+  if( !layer )
+    layer = nvmain->GetLayerParams( );
   currentCycle = 0;
 	outstandingRequests = 0;
+	issuedRequests = 0;
 
 	CommandQueueSize = 5;
 }
@@ -270,10 +299,16 @@ void rvSim::Cycle( ncycle_t steps )
 					//std::cout << "[+](Cycle) Send a commmmmand" << std::endl;
 					GetChild( )->IssueCommand( CommandQueue.front() );
 					CommandQueue.pop_front();
+					issuedRequests++;
 				}
 			//std::cout << "[+](Cycle) Now it is: " << currentCycle << std::endl;
 			globalEventQueue->Cycle( 1 );
 			currentCycle++;
+
+			/* Live stats snapshot requested via SIGUSR1 or the snapshot socket. */
+			if( snapshot->Pending( ) )
+				snapshot->Write( GetChild( )->GetTrampoline( ), stats, currentCycle,
+				                 issuedRequests, issuedRequests );
 			
 		}
 		
@@ -389,7 +424,7 @@ bool rvSim::IssueCommand( uint64_t input_addr, uint64_t output_addr, char opt, u
 		request->C_address2 = nAddress2;
 		//globalparams.Input_Addr.SetPhysicalAddress(input_addr);
 		//globalparams.Output_Addr.SetPhysicalAddress(output_addr);
-		request->BufferSize = globalparams.Buffer_n;
+		request->BufferSize = layer->Buffer_n;
 		request->type = COMPUTE;
 		if( slide == 'X')
 		{
@@ -500,7 +535,7 @@ bool rvSim::IssueCommand( uint64_t addr, char opt, uint64_t data, uint64_t threa
 		request->type = LOAD_WEIGHT;
 	else if ( opt == 'C')
 	{
-		request->BufferSize = globalparams.Buffer_n;
+		request->BufferSize = layer->Buffer_n;
 		request->type = COMPUTE;
 	}
 	else if ( opt == 'T')
@@ -541,6 +576,8 @@ bool rvSim::IssueCommand( uint64_t addr, char opt, uint64_t data, uint64_t threa
 bool rvSim::IssueCommand( NVMainRequest *request )
 {	
 	outstandingRequests++;
+	if( request->type == LOAD_WEIGHT || request->type == COMPUTE )
+		request->layer = layer;
 	//GetChild( )->IssueCommand( request );
 	if (IsIssuable())
 		CommandQueue.push_back(request);
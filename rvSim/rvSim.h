@@ -5,6 +5,7 @@
 
 #include "src/NVMObject.h"
 #include "MemControl/DRAMCache/DRAMCache.h"
+#include "Utils/StatsSnapshot/StatsSnapshot.h"
 
 namespace NVM {
   class rvSim : public NVMObject
@@ -29,6 +30,8 @@ namespace NVM {
     bool RequestComplete( NVMainRequest *request );
     
     bool setParameters();
+    bool SetLayerInput( uint64_t col, uint64_t row, uint64_t channels, uint64_t width );
+    bool SetLayerFunction( uint64_t func );
     
     uint64_t getCycle();
     
@@ -36,6 +39,7 @@ namespace NVM {
     
     private:
       ncounter_t outstandingRequests;
+      ncounter_t issuedRequests;
       
       Stats *stats ;
       Config *config ;
@@ -46,6 +50,8 @@ namespace NVM {
       EventQueue *mainEventQueue ;
       GlobalEventQueue *globalEventQueue ;
       TagGenerator *tagGenerator ;
+      StatsSnapshot *snapshot ;
+      std::shared_ptr<const LayerParams> layer ;
       std::list<NVMainRequest *> CommandQueue;
       uint64_t CommandQueueSize;
     
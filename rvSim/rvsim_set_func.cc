@@ -20,7 +20,6 @@ using namespace NVM;
 
 //Define some params
 extern rvSim *riscv_sim;
-extern GlobalParams globalparams;
 
 // $rvsim_set_func((uint64_t)func_value)
 extern "C" int rvsim_set_func()
@@ -55,27 +54,13 @@ extern "C" int rvsim_set_func()
 
   vpi_free_object(argI);
 
-  if(!globalparams.isUsing)
-	{
+  uint64_t input_col      = value_arg0;
+  uint64_t input_row      = value_arg1;
+  uint64_t input_channels = value_arg2;
+  uint64_t input_bitwidth = value_arg3;
 
-    uint64_t input_col      = value_arg0;
-    uint64_t input_row      = value_arg1;
-    uint64_t input_channels = value_arg2;
-    uint64_t input_bitwidth = value_arg3;
+  printf("[+](set_input) Input col=%d row=%d channels=%d bitwidth=%d\n", \
+                        input_col, input_row, input_channels, input_bitwidth);
 
-    printf("[+](set_input) Input col=%d row=%d channels=%d bitwidth=%d\n", \
-                          input_col, input_row, input_channels, input_bitwidth);
-
-		globalparams.Input_Col     = input_col;
-    globalparams.Input_Row     = input_row;
-    globalparams.Input_Channel = input_channels;
-    globalparams.Input_Width   = input_bitwidth;
-		return true;
-	}  
-
-	else
-  {
-    printf("[-](set_input) Failed: globalparams is using!\n");
-    return false;
-  }
+  return riscv_sim->SetLayerInput( input_col, input_row, input_channels, input_bitwidth );
 }
\ No newline at end of file
@@ -20,7 +20,6 @@ using namespace NVM;
 
 //Define some params
 extern rvSim *riscv_sim;
-extern GlobalParams globalparams;
 
 // $rvsim_set_func((uint64_t)func_value)
 extern "C" int rvsim_set_func()
@@ -46,17 +45,8 @@ extern "C" int rvsim_set_func()
 
   vpi_free_object(argI);
 
-  if(!globalparams.isUsing)
-	{
-    uint64_t func_value = value_arg0;
-    printf("[+](set_func) Func_n = %d\n", func_value);
-		globalparams.Func_n = 0;
-		return true;
-	}
+  uint64_t func_value = value_arg0;
+  printf("[+](set_func) Func_n = %d\n", func_value);
 
-	else
-  {
-    printf("[-](set_func) Failed: globalparams is using!\n");
-    return false;
-  }
+  return riscv_sim->SetLayerFunction( func_value );
 }
\ No newline at end of file
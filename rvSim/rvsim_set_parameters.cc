@@ -17,7 +17,6 @@ using namespace NVM;
 
 //Define some params
 extern rvSim *riscv_sim;
-extern GlobalParams globalparams;
 
 extern "C" int rvsim_set_parameters()
 {
@@ -80,6 +80,9 @@ class AddressTranslator
     virtual uint64_t Translate( NVMainRequest *request );
     virtual void SetDefaultField( TranslationField f ); 
 
+    /* Cycles spent looking up a translation, e.g., in a remap table. */
+    virtual ncycle_t GetLookupLatency( ) { return 0; }
+
     void SetStats( Stats *stats );
     Stats *GetStats( );
 
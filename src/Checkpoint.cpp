@@ -0,0 +1,347 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/Checkpoint.h"
+
+#include <iostream>
+#include <cstring>
+
+using namespace NVM;
+
+
+namespace {
+
+const char checkpointMagic[8] = { 'N', 'V', 'M', 'C', 'K', 'P', 'T', '\0' };
+const uint32_t checkpointFormat = 1;
+
+void WriteWord( std::ofstream& out, uint64_t value, unsigned int bytes )
+{
+    uint8_t buffer[8];
+
+    for( unsigned int i = 0; i < bytes; i++ )
+        buffer[i] = static_cast<uint8_t>( value >> (8 * i) );
+
+    out.write( reinterpret_cast<const char *>(buffer), bytes );
+}
+
+uint64_t ReadWord( std::ifstream& in, unsigned int bytes )
+{
+    uint8_t buffer[8];
+    uint64_t value = 0;
+
+    std::memset( buffer, 0, sizeof(buffer) );
+    in.read( reinterpret_cast<char *>(buffer), bytes );
+
+    for( unsigned int i = 0; i < bytes; i++ )
+        value |= static_cast<uint64_t>( buffer[i] ) << (8 * i);
+
+    return value;
+}
+
+};
+
+
+CheckpointWriter::CheckpointWriter( std::string dir, std::string name, uint32_t version )
+{
+    fileName = dir + "/" + name;
+
+    handle.open( fileName.c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
+
+    if( !handle.is_open( ) )
+    {
+        std::cout << "[+] " << name << ": Warning: Could not open checkpoint file: " 
+                  << fileName << "!" << std::endl;
+        return;
+    }
+
+    handle.write( checkpointMagic, sizeof(checkpointMagic) );
+    WriteWord( handle, checkpointFormat, 4 );
+    WriteWord( handle, version, 4 );
+
+    /* Note: For future compatability only at the memory. This is not read during restoration. */
+    std::string infoName = fileName + ".json";
+    std::ofstream info( infoName.c_str(), std::ofstream::out | std::ofstream::trunc );
+
+    if( !info.is_open( ) )
+    {
+        std::cout << "[+] " << name << ": Warning: Could not open checkpoint info file: " 
+                  << infoName << "!" << std::endl;
+    }
+    else
+    {
+        info << "{\n\t\"Version\": " << version << "\n}";
+    }
+}
+
+CheckpointWriter::~CheckpointWriter( )
+{
+    Close( );
+}
+
+bool CheckpointWriter::IsOpen( )
+{
+    return handle.is_open( );
+}
+
+void CheckpointWriter::Close( )
+{
+    if( handle.is_open( ) )
+        handle.close( );
+}
+
+void CheckpointWriter::Write( uint64_t value )
+{
+    WriteWord( handle, value, 8 );
+}
+
+void CheckpointWriter::WriteDouble( double value )
+{
+    uint64_t bits;
+
+    std::memcpy( &bits, &value, sizeof(bits) );
+    WriteWord( handle, bits, 8 );
+}
+
+void CheckpointWriter::WriteString( const std::string& value )
+{
+    Write( value.length( ) );
+    handle.write( value.data( ), value.length( ) );
+}
+
+void CheckpointWriter::WriteBytes( const uint8_t *bytes, uint64_t count )
+{
+    handle.write( reinterpret_cast<const char *>(bytes), count );
+}
+
+void CheckpointWriter::WriteMap( const std::map<uint64_t, uint64_t>& values )
+{
+    std::map<uint64_t, uint64_t>::const_iterator it;
+
+    Write( values.size( ) );
+    for( it = values.begin( ); it != values.end( ); it++ )
+    {
+        Write( it->first );
+        Write( it->second );
+    }
+}
+
+void CheckpointWriter::WriteSet( const std::set<uint64_t>& values )
+{
+    std::set<uint64_t>::const_iterator it;
+
+    Write( values.size( ) );
+    for( it = values.begin( ); it != values.end( ); it++ )
+        Write( *it );
+}
+
+void CheckpointWriter::WriteDoubleMap( const std::map<double, uint64_t>& values )
+{
+    std::map<double, uint64_t>::const_iterator it;
+
+    Write( values.size( ) );
+    for( it = values.begin( ); it != values.end( ); it++ )
+    {
+        WriteDouble( it->first );
+        Write( it->second );
+    }
+}
+
+void CheckpointWriter::WriteAddress( NVMAddress& address )
+{
+    Write( address.GetPhysicalAddress( ) );
+    Write( address.GetRow( ) );
+    Write( address.GetCol( ) );
+    Write( address.GetBank( ) );
+    Write( address.GetRank( ) );
+    Write( address.GetChannel( ) );
+    Write( address.GetSubArray( ) );
+    Write( address.GetBitAddress( ) );
+}
+
+
+CheckpointReader::CheckpointReader( std::string dir, std::string name, uint32_t version )
+{
+    char magic[sizeof(checkpointMagic)];
+
+    fileName = dir + "/" + name;
+    fileSize = 0;
+    valid = false;
+
+    handle.open( fileName.c_str(), std::ifstream::in | std::ifstream::binary );
+
+    if( !handle.is_open( ) )
+    {
+        std::cout << "[+] " << name << ": Warning: Could not open checkpoint file: " 
+                  << fileName << "!" << std::endl;
+        return;
+    }
+
+    handle.seekg( 0, std::ifstream::end );
+    fileSize = static_cast<uint64_t>( handle.tellg( ) );
+    handle.seekg( 0, std::ifstream::beg );
+
+    handle.read( magic, sizeof(magic) );
+    uint64_t format = ReadWord( handle, 4 );
+    uint64_t fileVersion = ReadWord( handle, 4 );
+
+    if( !handle.good( ) || std::memcmp( magic, checkpointMagic, sizeof(magic) ) != 0 
+        || format != checkpointFormat )
+    {
+        std::cout << "[+] " << name << ": Warning: " << fileName 
+                  << " is not an NVMain checkpoint. Skipping restore." << std::endl;
+    }
+    else if( fileVersion != version )
+    {
+        std::cout << "[+] " << name << ": Warning: Checkpoint version " << fileVersion
+                  << " does not match version " << version << ". Skipping restore." << std::endl;
+    }
+    else
+    {
+        valid = true;
+    }
+}
+
+CheckpointReader::~CheckpointReader( )
+{
+    Close( );
+}
+
+bool CheckpointReader::IsOpen( )
+{
+    return valid && handle.is_open( );
+}
+
+bool CheckpointReader::Good( )
+{
+    return valid && handle.good( );
+}
+
+void CheckpointReader::Close( )
+{
+    if( handle.is_open( ) )
+        handle.close( );
+}
+
+uint64_t CheckpointReader::Read( )
+{
+    return ReadWord( handle, 8 );
+}
+
+double CheckpointReader::ReadDouble( )
+{
+    uint64_t bits = ReadWord( handle, 8 );
+    double value;
+
+    std::memcpy( &value, &bits, sizeof(value) );
+
+    return value;
+}
+
+std::string CheckpointReader::ReadString( )
+{
+    uint64_t length = Read( );
+    std::string value;
+
+    /* Do not trust the length of a truncated file. */
+    if( !handle.good( ) )
+        return value;
+
+    /* A length past the end of the file is treated as truncation. */
+    uint64_t position = static_cast<uint64_t>( handle.tellg( ) );
+
+    if( length > fileSize - position )
+    {
+        handle.setstate( std::ifstream::failbit );
+        return value;
+    }
+
+    value.resize( length );
+    if( length > 0 )
+        handle.read( &value[0], length );
+
+    return value;
+}
+
+void CheckpointReader::ReadBytes( uint8_t *bytes, uint64_t count )
+{
+    handle.read( reinterpret_cast<char *>(bytes), count );
+}
+
+void CheckpointReader::ReadMap( std::map<uint64_t, uint64_t>& values )
+{
+    uint64_t count = Read( );
+
+    values.clear( );
+    for( uint64_t i = 0; i < count && handle.good( ); i++ )
+    {
+        uint64_t key = Read( );
+        values[key] = Read( );
+    }
+}
+
+void CheckpointReader::ReadSet( std::set<uint64_t>& values )
+{
+    uint64_t count = Read( );
+
+    values.clear( );
+    for( uint64_t i = 0; i < count && handle.good( ); i++ )
+        values.insert( Read( ) );
+}
+
+void CheckpointReader::ReadDoubleMap( std::map<double, uint64_t>& values )
+{
+    uint64_t count = Read( );
+
+    values.clear( );
+    for( uint64_t i = 0; i < count && handle.good( ); i++ )
+    {
+        double key = ReadDouble( );
+        values[key] = Read( );
+    }
+}
+
+void CheckpointReader::ReadAddress( NVMAddress& address )
+{
+    uint64_t physical = Read( );
+    uint64_t row = Read( );
+    uint64_t col = Read( );
+    uint64_t bank = Read( );
+    uint64_t rank = Read( );
+    uint64_t channel = Read( );
+    uint64_t subarray = Read( );
+    uint64_t bit = Read( );
+
+    address.SetPhysicalAddress( physical );
+    address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+    address.SetBitAddress( static_cast<uint8_t>( bit ) );
+}
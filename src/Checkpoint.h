@@ -0,0 +1,118 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __SRC_CHECKPOINT_H__
+#define __SRC_CHECKPOINT_H__
+
+
+#include <fstream>
+#include <string>
+#include <map>
+#include <set>
+#include <stdint.h>
+
+#include "include/NVMAddress.h"
+
+
+namespace NVM {
+
+
+/*
+ *  Checkpoint files are a short header (magic, format version and the
+ *  version of the object that wrote the file) followed by fixed width
+ *  little-endian fields. Nothing written is a pointer, so a checkpoint can
+ *  be restored into a fresh simulator on any host. Each file also gets a
+ *  "<name>.json" info file with its version, as the checkpoints always had.
+ *
+ *  Checkpoints are only taken at a drained point: no requests are in flight
+ *  and the controller queues are empty. The event queues are restored to
+ *  the checkpointed cycle before any other object, so timing state can be
+ *  written as absolute cycles.
+ */
+class CheckpointWriter
+{
+  public:
+    CheckpointWriter( std::string dir, std::string name, uint32_t version );
+    ~CheckpointWriter( );
+
+    bool IsOpen( );
+    void Close( );
+
+    void Write( uint64_t value );
+    void WriteDouble( double value );
+    void WriteString( const std::string& value );
+    void WriteBytes( const uint8_t *bytes, uint64_t count );
+    void WriteMap( const std::map<uint64_t, uint64_t>& values );
+    void WriteSet( const std::set<uint64_t>& values );
+    void WriteDoubleMap( const std::map<double, uint64_t>& values );
+    void WriteAddress( NVMAddress& address );
+
+  private:
+    std::ofstream handle;
+    std::string fileName;
+};
+
+
+class CheckpointReader
+{
+  public:
+    CheckpointReader( std::string dir, std::string name, uint32_t version );
+    ~CheckpointReader( );
+
+    /* False if the file is missing or its header does not match. */
+    bool IsOpen( );
+    /* False once a read ran past the end of the file. */
+    bool Good( );
+    void Close( );
+
+    uint64_t Read( );
+    double ReadDouble( );
+    std::string ReadString( );
+    void ReadBytes( uint8_t *bytes, uint64_t count );
+    void ReadMap( std::map<uint64_t, uint64_t>& values );
+    void ReadSet( std::set<uint64_t>& values );
+    void ReadDoubleMap( std::map<double, uint64_t>& values );
+    void ReadAddress( NVMAddress& address );
+
+  private:
+    std::ifstream handle;
+    std::string fileName;
+    uint64_t fileSize;
+    bool valid;
+};
+
+
+};
+
+
+#endif
@@ -139,11 +139,13 @@ void Config::Read( std::string filename )
             cline = new char[subline.size( ) + 1];
             strcpy( cline, subline.c_str( ) );
             
-            char *tokens = strtok( cline, " " );
+            /* strtok_r, since channel configs may be read on sweep threads. */
+            char *savePtr;
+            char *tokens = strtok_r( cline, " ", &savePtr );
             
             std::string ty = std::string( tokens );
             
-            tokens = strtok( NULL, " " );
+            tokens = strtok_r( NULL, " ", &savePtr );
             
             i = values.find( ty );
             if( i != values.end( ) )
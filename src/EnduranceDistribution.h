@@ -35,6 +35,7 @@
 #define __ENDURANCEDISTRIBUTION_H__
 
 #include "src/Config.h"
+#include "include/NVMRandom.h"
 
 namespace NVM {
 
@@ -46,6 +47,17 @@ class EnduranceDistribution
 
      virtual uint64_t GetEndurance( ) = 0;
 
+     /* Upper bound on GetEndurance( ), used to size the life counters. */
+     virtual uint64_t GetMaxEndurance( ) { return ~0ULL; }
+
+     /* Give each user of a distribution its own random stream. */
+     void Seed( uint64_t seed, std::string stream ) { rng.Seed( seed, stream ); }
+
+     /* The stream position is saved with the life table in checkpoints. */
+     RandomGenerator& GetGenerator( ) { return rng; }
+
+  protected:
+     RandomGenerator rng;
 };
 
 };
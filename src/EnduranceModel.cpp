@@ -34,6 +34,7 @@
 #include "src/EnduranceModel.h"
 #include "Endurance/EnduranceDistributionFactory.h"
 #include "src/FaultModel.h"
+#include "src/Checkpoint.h"
 #include <iostream>
 #include <limits>
 
@@ -41,7 +42,7 @@ using namespace NVM;
 
 EnduranceModel::EnduranceModel( )
 {
-    life.clear( );
+    life.Clear( );
 
     granularity = 0;
 }
@@ -50,43 +51,71 @@ void EnduranceModel::SetConfig( Config *config, bool /*createChildren*/ )
 {
     enduranceDist = EnduranceDistributionFactory::CreateEnduranceDistribution( 
             config->GetString( "EnduranceDist" ), config );
+
+    /* Each model instance draws lifetimes from its own stream. */
+    uint64_t seed = 1;
+    config->GetValueUL( "RandomSeed", seed );
+    if( enduranceDist != NULL )
+        enduranceDist->Seed( seed, StatName( ) );
+
+    /*
+     *  Size the life table for every key the model could generate. Keys are
+     *  assumed to be dense in [0, rows * row bits / granularity), which is an
+     *  upper bound for the bundled models. The table grows if this is wrong.
+     */
+    uint64_t rows = config->GetValueUL( "ROWS" );
+    uint64_t rowBits = config->GetValueUL( "COLS" ) * config->GetValueUL( "BusWidth" )
+                     * config->GetValueUL( "tBURST" ) * config->GetValueUL( "RATE" );
+    uint64_t keys = rows * rowBits / ( ( granularity > 0 ) ? granularity : 1 );
+
+    std::string mode = "auto";
+    uint64_t denseLimit = 64;
+
+    if( config->KeyExists( "EnduranceTable" ) )
+        mode = config->GetString( "EnduranceTable" );
+    if( config->KeyExists( "EnduranceDenseLimit" ) )
+        denseLimit = config->GetValueUL( "EnduranceDenseLimit" );
+
+    if( mode != "auto" && mode != "dense" && mode != "sparse" )
+    {
+        std::cout << "[+] EnduranceModel: Unknown EnduranceTable " << mode
+                  << ", using auto." << std::endl;
+        mode = "auto";
+    }
+
+    uint64_t maxLife = ( enduranceDist != NULL ) ? enduranceDist->GetMaxEndurance( ) : ~0ULL;
+
+    life.SetSize( keys, maxLife, mode, denseLimit * 1024 * 1024 );
 }
 
 /*
- *  Finds the worst life in the life map. If you do not use the life
- *  map, you will need to overload this function to return the worst
+ *  Finds the worst life in the life table. If you do not use the life
+ *  table, you will need to overload this function to return the worst
  *  case life for statistics reporting.
  */
 uint64_t EnduranceModel::GetWorstLife( )
 {
-    std::map<uint64_t, uint64_t>::iterator i;
-    uint64_t min = std::numeric_limits< uint64_t >::max( );
+    uint64_t min, total, count;
 
-    for( i = life.begin( ); i != life.end( ); i++ )
-    {
-        if( i->second < min )
-            min = i->second;
-    }
+    life.GetSummary( min, total, count );
 
     return min;
 }
 
 /*
- *  Finds the worst life in the life map. If you do not use the life
- *  map, you will need to overload this function to return the worst
- *  case life for statistics reporting.
+ *  Finds the average life in the life table. If you do not use the life
+ *  table, you will need to overload this function to return the average
+ *  life for statistics reporting.
  */
 uint64_t EnduranceModel::GetAverageLife( )
 {
-    std::map<uint64_t, uint64_t>::iterator i;
-    uint64_t total = 0;
+    uint64_t min, total, count;
     uint64_t average = 0;
 
-    for( i = life.begin( ); i != life.end( ); i++ )
-        total += i->second;
+    life.GetSummary( min, total, count );
 
-    if( life.size( ) != 0 )
-        average = total / life.size( );
+    if( count != 0 )
+        average = total / count;
     else
         average = 0;
 
@@ -95,20 +124,20 @@ uint64_t EnduranceModel::GetAverageLife( )
 
 bool EnduranceModel::DecrementLife( uint64_t addr )
 {
-    std::map<uint64_t, uint64_t>::iterator i = life.find( addr );
+    uint64_t remaining;
     bool rv = true;
 
-    if( i == life.end( ) )
+    if( !life.GetLife( addr, remaining ) )
     {
           /* Generate a random number using the specified distribution */
-          life.insert( std::pair<uint64_t, uint64_t>( addr, enduranceDist->GetEndurance( ) ) );
+          life.SetLife( addr, enduranceDist->GetEndurance( ) );
     }
     else
     {
         /* If the life is 0, leave it at that.  */
-        if( i->second != 0 )
+        if( remaining != 0 )
         {
-            i->second = i->second - 1;
+            life.SetLife( addr, remaining - 1 );
         }
         else
         {
@@ -119,12 +148,21 @@ bool EnduranceModel::DecrementLife( uint64_t addr )
     return rv;
 }
 
+/*
+ *  Same as calling DecrementLife( firstAddr + i ) for each bit i set in mask,
+ *  in increasing order, but consecutive keys are updated together.
+ */
+bool EnduranceModel::DecrementLifeRange( uint64_t firstAddr, uint64_t mask )
+{
+    return life.DecrementRange( firstAddr, mask, enduranceDist );
+}
+
 bool EnduranceModel::IsDead( uint64_t addr )
 {
-    std::map<uint64_t, uint64_t>::iterator i = life.find( addr );
+    uint64_t remaining;
     bool rv = false;
 
-    if( i != life.end( ) && i->second == 0 )
+    if( life.GetLife( addr, remaining ) && remaining == 0 )
     {
         rv = true;
     }
@@ -147,3 +185,37 @@ uint64_t EnduranceModel::GetGranularity( )
 void EnduranceModel::Cycle( ncycle_t )
 {
 }
+
+void EnduranceModel::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, StatName( ), 1 );
+
+    if( cpt.IsOpen( ) )
+    {
+        life.WriteCheckpoint( cpt );
+
+        cpt.Write( (enduranceDist != NULL) ? 1 : 0 );
+        if( enduranceDist != NULL )
+            enduranceDist->GetGenerator( ).WriteCheckpoint( cpt );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void EnduranceModel::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, StatName( ), 1 );
+
+    if( cpt.IsOpen( ) )
+    {
+        life.ReadCheckpoint( cpt );
+
+        if( cpt.Read( ) != 0 && enduranceDist != NULL )
+            enduranceDist->GetGenerator( ).ReadCheckpoint( cpt );
+
+        if( !cpt.Good( ) )
+            std::cout << "[+] " << StatName( ) << ": Warning: Checkpoint is truncated." << std::endl;
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
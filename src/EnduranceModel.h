@@ -35,12 +35,12 @@
 #define __ENDURANCEMODEL_H__
 
 #include <string>
-#include <map>
 #include <stdint.h>
 #include "src/Config.h"
 #include "src/Params.h"
 #include "src/NVMObject.h"
 #include "src/EnduranceDistribution.h"
+#include "src/LifeTable.h"
 #include "include/NVMDataBlock.h"
 #include "include/NVMAddress.h"
 #include "src/FaultModel.h"
@@ -69,11 +69,15 @@ class EnduranceModel : public NVMObject
 
     void Cycle( ncycle_t steps );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   protected:
     EnduranceDistribution *enduranceDist;
-    std::map<uint64_t, uint64_t> life;
+    LifeTable life;
     
     bool DecrementLife( uint64_t addr );
+    bool DecrementLifeRange( uint64_t firstAddr, uint64_t mask );
     bool IsDead( uint64_t addr );
 
     void SetGranularity( uint64_t bits );
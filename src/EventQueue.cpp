@@ -34,9 +34,11 @@
 #include "src/EventQueue.h"
 #include "src/NVMObject.h"
 #include "src/Config.h"
+#include "src/Checkpoint.h"
 #include "NVM/nvmain.h"
 
 #include <limits>
+#include <cmath>
 #include <assert.h>
 
 using namespace NVM;
@@ -443,15 +445,191 @@ void EventQueue::SetCurrentCycle( ncycle_t curCycle )
     currentCycle = curCycle;
 }
 
+bool EventQueue::HasPendingRequests( )
+{
+    std::map<ncycle_t, EventList>::iterator mapIt;
+    EventList::iterator it;
+
+    for( mapIt = eventMap.begin( ); mapIt != eventMap.end( ); mapIt++ )
+    {
+        for( it = mapIt->second.begin( ); it != mapIt->second.end( ); it++ )
+        {
+            if( (*it)->GetRequest( ) != NULL )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ *  Events are written as the recipient's stat name, the event type and
+ *  priority, the recipient's key for the callback data and the number of
+ *  cycles until the event fires. Events carrying requests are in-flight
+ *  work, which a drained system does not have, so they are not written.
+ */
+void EventQueue::CreateCheckpoint( std::string dir, std::string name )
+{
+    CheckpointWriter cpt( dir, name, 1 );
+    std::map<ncycle_t, EventList>::iterator mapIt;
+    EventList::iterator it;
+    std::vector<Event *> pending;
+    ncounter_t inflight = 0;
+
+    if( !cpt.IsOpen( ) )
+        return;
+
+    for( mapIt = eventMap.begin( ); mapIt != eventMap.end( ); mapIt++ )
+    {
+        for( it = mapIt->second.begin( ); it != mapIt->second.end( ); it++ )
+        {
+            if( (*it)->GetRequest( ) != NULL )
+                inflight++;
+            else
+                pending.push_back( *it );
+        }
+    }
+
+    if( inflight > 0 )
+    {
+        std::cout << "[+] " << name << ": Warning: " << inflight << " events with "
+                  << "requests in flight are not checkpointed." << std::endl;
+    }
+
+    cpt.Write( currentCycle );
+    cpt.Write( (lastEventCycle < currentCycle) ? currentCycle - lastEventCycle : 0 );
+    cpt.Write( pending.size( ) );
+
+    for( size_t i = 0; i < pending.size( ); i++ )
+    {
+        NVMObject *recipient = pending[i]->GetRecipient( )->GetTrampoline( );
+
+        cpt.WriteString( recipient->StatName( ) );
+        cpt.Write( static_cast<uint64_t>( pending[i]->GetType( ) ) );
+        cpt.Write( static_cast<uint64_t>( static_cast<int64_t>( pending[i]->GetPriority( ) ) ) );
+        cpt.Write( recipient->GetCheckpointKey( pending[i]->GetData( ) ) );
+        cpt.Write( pending[i]->GetCycle( ) - currentCycle );
+    }
+}
+
+/*
+ *  Callbacks can not be recreated from a file, so the events in the
+ *  checkpoint are matched against the events the freshly built system
+ *  scheduled for itself (refresh, wakeups, ...) and those are moved to
+ *  the checkpointed cycles. Unmatched events of the fresh system keep
+ *  their distance from the start of simulation.
+ */
+void EventQueue::RestoreCheckpoint( std::string dir, std::string name )
+{
+    CheckpointReader cpt( dir, name, 1 );
+    std::map<ncycle_t, EventList>::iterator mapIt;
+    EventList::iterator it;
+    std::vector<Event *> fresh;
+    std::vector<bool> matched;
+    ncounter_t dropped = 0;
+
+    if( !cpt.IsOpen( ) )
+        return;
+
+    ncycle_t restoreCycle = cpt.Read( );
+    ncycle_t sinceLastEvent = cpt.Read( );
+    uint64_t eventCount = cpt.Read( );
+
+    for( mapIt = eventMap.begin( ); mapIt != eventMap.end( ); mapIt++ )
+    {
+        for( it = mapIt->second.begin( ); it != mapIt->second.end( ); it++ )
+            fresh.push_back( *it );
+    }
+
+    matched.resize( fresh.size( ), false );
+
+    for( uint64_t eventIdx = 0; eventIdx < eventCount && cpt.Good( ); eventIdx++ )
+    {
+        std::string recipientName = cpt.ReadString( );
+        EventType type = static_cast<EventType>( cpt.Read( ) );
+        int priority = static_cast<int>( static_cast<int64_t>( cpt.Read( ) ) );
+        uint64_t key = cpt.Read( );
+        ncycle_t delta = cpt.Read( );
+        bool found = false;
+
+        for( size_t i = 0; i < fresh.size( ) && !found; i++ )
+        {
+            NVMObject *recipient = fresh[i]->GetRecipient( )->GetTrampoline( );
+
+            if( matched[i] || fresh[i]->GetType( ) != type 
+                || fresh[i]->GetPriority( ) != priority
+                || recipient->StatName( ) != recipientName 
+                || recipient->GetCheckpointKey( fresh[i]->GetData( ) ) != key )
+                continue;
+
+            fresh[i]->SetCycle( restoreCycle + delta );
+            matched[i] = true;
+            found = true;
+        }
+
+        if( !found )
+            dropped++;
+    }
+
+    if( !cpt.Good( ) )
+    {
+        std::cout << "[+] " << name << ": Warning: Checkpoint is truncated." << std::endl;
+    }
+
+    if( dropped > 0 )
+    {
+        std::cout << "[+] " << name << ": Warning: " << dropped << " checkpointed "
+                  << "events have no counterpart in this configuration." << std::endl;
+    }
+
+    /* Rebuild the queue keeping the priority order within each cycle. */
+    eventMap.clear( );
+
+    for( size_t i = 0; i < fresh.size( ); i++ )
+    {
+        if( !matched[i] )
+            fresh[i]->SetCycle( fresh[i]->GetCycle( ) - currentCycle + restoreCycle );
+
+        EventList& eventList = eventMap[fresh[i]->GetCycle( )];
+
+        for( it = eventList.begin( ); it != eventList.end( ); it++ )
+        {
+            if( (*it)->GetPriority( ) > fresh[i]->GetPriority( ) )
+                break;
+        }
+
+        eventList.insert( it, fresh[i] );
+    }
+
+    currentCycle = restoreCycle;
+    lastEventCycle = restoreCycle - sinceLastEvent;
+
+    if( eventMap.empty( ) )
+        nextEventCycle = std::numeric_limits<ncycle_t>::max( );
+    else
+        nextEventCycle = eventMap.begin( )->first;
+}
+
 
-GlobalEventQueue::GlobalEventQueue( )
+GlobalEventQueue::GlobalEventQueue( ) : windowId( 0 ), windowPending( 0 ), stopWorkers( false )
 {
     currentCycle = 0;
+    frequency = 0.0;
+    windowSystem = NULL;
+    windowEnd = 0;
 }
 
 GlobalEventQueue::~GlobalEventQueue( )
 {
+    {
+        std::lock_guard<std::mutex> lock( windowMutex );
+        stopWorkers = true;
+    }
+
+    windowStart.notify_all( );
 
+    for( size_t i = 0; i < workers.size( ); i++ )
+        workers[i].join( );
 }
 
 void GlobalEventQueue::AddSystem( NVMain *subSystem, Config *config )
@@ -466,7 +644,14 @@ void GlobalEventQueue::AddSystem( NVMain *subSystem, Config *config )
      *  We aren't doing and checks here to make sure the input side (i.e. CPUFreq) is
      *  corrent since we don't know what it should be.
      */
-    eventQueues.insert( std::pair<EventQueue*, double>(queue, subSystemFrequency) );
+    ClockDomain domain;
+
+    domain.queue = queue;
+    domain.frequency = subSystemFrequency;
+    domain.parallelSystem = -1;
+    SetClockRatio( domain );
+
+    clockDomains.push_back( domain );
     queue->SetFrequency( subSystemFrequency );
 
     //std::cout << "[+] NVMain: GlobalEventQueue: Added a memory subsystem running at "
@@ -474,11 +659,56 @@ void GlobalEventQueue::AddSystem( NVMain *subSystem, Config *config )
     //          << (frequency / 1000000.0) << "MHz." << std::endl;
 }
 
+/*
+ *  Gives each channel of a subsystem its own event queue. The channels only
+ *  interact through the front end, which runs between calls to Cycle( ), so
+ *  the channel queues may be advanced concurrently up to the end of each
+ *  call. A nonzero lookahead additionally splits the call into windows of at
+ *  most that many cycles, bounding how long completions sit in the mailboxes.
+ */
+void GlobalEventQueue::AddChannelQueues( NVMain *subSystem, std::vector<EventQueue *>& channelQueues,
+                                         ncounter_t threads, ncycle_t lookahead )
+{
+    ParallelSystem system;
+
+    system.system = subSystem;
+    system.frontEnd = subSystem->GetEventQueue( );
+    system.channels = channelQueues;
+    system.lookahead = lookahead;
+
+    for( size_t i = 0; i < channelQueues.size( ); i++ )
+    {
+        channelQueues[i]->SetFrequency( system.frontEnd->GetFrequency( ) );
+        channelQueues[i]->SetCurrentCycle( system.frontEnd->GetCurrentCycle( ) );
+    }
+
+    parallelSystems.push_back( system );
+
+    size_t domain = 0;
+    while( domain < clockDomains.size( ) && clockDomains[domain].queue != system.frontEnd )
+        domain++;
+
+    assert( domain < clockDomains.size( ) );
+    clockDomains[domain].parallelSystem = static_cast<int>( parallelSystems.size( ) - 1 );
+
+    while( workers.size( ) + 1 < threads )
+    {
+        workers.push_back( std::thread( &GlobalEventQueue::WorkerLoop, this, 
+                                        static_cast<ncounter_t>( workers.size( ) + 1 ) ) );
+    }
+}
+
 void GlobalEventQueue::Cycle( ncycle_t steps )
 {
     EventQueue *nextEventQueue;
     ncycle_t iterationSteps = 0;
 
+    if( !parallelSystems.empty( ) )
+    {
+        CycleParallel( steps );
+        return;
+    }
+
     while( iterationSteps <= steps )
     {
         ncycle_t nextEvent = GetNextEvent( &nextEventQueue );
@@ -511,6 +741,9 @@ void GlobalEventQueue::Cycle( ncycle_t steps )
 void GlobalEventQueue::SetFrequency( double freq )
 {
     frequency = freq;
+
+    for( size_t i = 0; i < clockDomains.size( ); i++ )
+        SetClockRatio( clockDomains[i] );
 }
 
 double GlobalEventQueue::GetFrequency( )
@@ -520,29 +753,21 @@ double GlobalEventQueue::GetFrequency( )
 
 ncycle_t GlobalEventQueue::GetNextEvent( EventQueue **eq )
 {
-    std::map<EventQueue *, double>::const_iterator iter;
     ncycle_t nextEventCycle = std::numeric_limits<ncycle_t>::max( );
 
     if( eq != NULL )
         *eq = NULL;
 
-    for( iter = eventQueues.begin( ); iter != eventQueues.end( ); iter++ )
+    for( size_t i = 0; i < clockDomains.size( ); i++ )
     {
-        /* 
-         *  If there is no event, we must skip frequency alignment to prevent
-         *  underflow causing an invalid nextEventCycle.
-         */
-        if( iter->first->GetNextEvent( ) == std::numeric_limits<ncycle_t>::max( ) )
-            continue;
-
-        double frequencyMultiplier = frequency / iter->second;
-        double globalEventCycle = iter->first->GetNextEvent( ) * frequencyMultiplier;
+        ncycle_t globalEventCycle = ToGlobalCycle( clockDomains[i], 
+                                        GetNextLocalEvent( clockDomains[i] ) );
 
-        if( static_cast<ncycle_t>(globalEventCycle) < nextEventCycle )
+        if( globalEventCycle < nextEventCycle )
         {
-            nextEventCycle = static_cast<ncycle_t>(globalEventCycle);
+            nextEventCycle = globalEventCycle;
             if( eq != NULL )
-                *eq = iter->first;
+                *eq = clockDomains[i].queue;
         }
     }
 
@@ -554,20 +779,232 @@ ncycle_t GlobalEventQueue::GetCurrentCycle( )
     return currentCycle;
 }
 
+void GlobalEventQueue::SetCurrentCycle( ncycle_t curCycle )
+{
+    currentCycle = curCycle;
+}
+
 void GlobalEventQueue::Sync( )
 {
-    std::map<EventQueue *, double>::const_iterator iter;
-    for( iter = eventQueues.begin( ); iter != eventQueues.end( ); iter++ )
+    for( size_t i = 0; i < clockDomains.size( ); i++ )
+    {
+        EventQueue *queue = clockDomains[i].queue;
+        ncycle_t setCycle = ToLocalCycle( clockDomains[i], currentCycle );
+
+        if( setCycle > queue->GetCurrentCycle( ) )
+            queue->Loop( setCycle - queue->GetCurrentCycle( ) );
+    }
+}
+
+static ncycle_t GreatestCommonDivisor( ncycle_t a, ncycle_t b )
+{
+    while( b != 0 )
+    {
+        ncycle_t r = a % b;
+        a = b;
+        b = r;
+    }
+
+    return a;
+}
+
+/* 
+ *  Frequencies are taken in whole Hz, so the ratio is exact and a cycle
+ *  converted back and forth never drifts.
+ */
+void GlobalEventQueue::SetClockRatio( ClockDomain& domain )
+{
+    ncycle_t globalHz = static_cast<ncycle_t>( std::llround( frequency ) );
+    ncycle_t localHz = static_cast<ncycle_t>( std::llround( domain.frequency ) );
+
+    if( globalHz == 0 || localHz == 0 )
+    {
+        domain.globalCycles = 1;
+        domain.localCycles = 1;
+        return;
+    }
+
+    ncycle_t divisor = GreatestCommonDivisor( globalHz, localHz );
+
+    domain.globalCycles = globalHz / divisor;
+    domain.localCycles = localHz / divisor;
+}
+
+/* Returns floor( cycle * multiplier / divisor ) without overflowing. */
+static ncycle_t ScaleCycle( ncycle_t cycle, ncycle_t multiplier, ncycle_t divisor )
+{
+    if( cycle == std::numeric_limits<ncycle_t>::max( ) )
+        return cycle;
+
+    return ( cycle / divisor ) * multiplier + ( cycle % divisor ) * multiplier / divisor;
+}
+
+ncycle_t GlobalEventQueue::ToGlobalCycle( const ClockDomain& domain, ncycle_t localCycle )
+{
+    return ScaleCycle( localCycle, domain.globalCycles, domain.localCycles );
+}
+
+ncycle_t GlobalEventQueue::ToLocalCycle( const ClockDomain& domain, ncycle_t globalCycle )
+{
+    return ScaleCycle( globalCycle, domain.localCycles, domain.globalCycles );
+}
+
+/* Next event of a subsystem, including the events of its channel queues. */
+ncycle_t GlobalEventQueue::GetNextLocalEvent( ClockDomain& domain )
+{
+    ncycle_t nextEvent = domain.queue->GetNextEvent( );
+
+    if( domain.parallelSystem >= 0 )
+    {
+        ParallelSystem& system = parallelSystems[domain.parallelSystem];
+
+        for( size_t i = 0; i < system.channels.size( ); i++ )
+        {
+            if( system.channels[i]->GetNextEvent( ) < nextEvent )
+                nextEvent = system.channels[i]->GetNextEvent( );
+        }
+    }
+
+    return nextEvent;
+}
+
+/*
+ *  Subsystems do not interact during a call, so each one is brought to the
+ *  target cycle on its own instead of interleaving the queues event by event.
+ *  The end state matches Cycle( ): a serial run also handles an event whose
+ *  scaled cycle rounds down into this step, one local cycle past the target.
+ */
+void GlobalEventQueue::CycleParallel( ncycle_t steps )
+{
+    currentCycle += steps;
+
+    for( size_t i = 0; i < clockDomains.size( ); i++ )
     {
-        double frequencyMultiplier = frequency / iter->second;
-        double setCycle = static_cast<double>(currentCycle) / frequencyMultiplier;
-        ncycle_t stepCount = static_cast<ncycle_t>(setCycle) - iter->first->GetCurrentCycle( );
+        ClockDomain& domain = clockDomains[i];
+        ncycle_t target = ToLocalCycle( domain, currentCycle );
+        ncycle_t nextTarget = target + 1;
+        bool roundsDown = ( ToGlobalCycle( domain, nextTarget ) <= currentCycle );
+
+        if( domain.parallelSystem >= 0 )
+        {
+            ParallelSystem *system = &parallelSystems[domain.parallelSystem];
 
-        if( static_cast<ncycle_t>(setCycle) > iter->first->GetCurrentCycle( ) )
+            AdvanceParallel( system, target );
+
+            if( roundsDown && GetNextLocalEvent( domain ) == nextTarget )
+                AdvanceParallel( system, nextTarget );
+        }
+        else
         {
-            iter->first->Loop( stepCount );
+            if( target >= domain.queue->GetCurrentCycle( ) )
+                domain.queue->Loop( target - domain.queue->GetCurrentCycle( ) );
+
+            if( roundsDown && domain.queue->GetNextEvent( ) == nextTarget )
+                domain.queue->Loop( 1 );
         }
     }
 }
 
+void GlobalEventQueue::AdvanceParallel( ParallelSystem *system, ncycle_t target )
+{
+    EventQueue *frontEnd = system->frontEnd;
+
+    do
+    {
+        ncycle_t now = frontEnd->GetCurrentCycle( );
+        ncycle_t end = target;
+
+        /* Front end events may issue new work, so a window stops at them. */
+        if( frontEnd->GetNextEvent( ) >= now && frontEnd->GetNextEvent( ) < end )
+            end = frontEnd->GetNextEvent( );
+
+        if( system->lookahead > 0 && now + system->lookahead < end )
+            end = now + system->lookahead;
+
+        RunWindow( system, end );
+        system->system->DeliverCompletions( end );
+    } while( frontEnd->GetCurrentCycle( ) < target );
+}
+
+static void RunChannel( EventQueue *queue, ncycle_t end )
+{
+    if( end >= queue->GetCurrentCycle( ) )
+        queue->Loop( end - queue->GetCurrentCycle( ) );
+}
+
+void GlobalEventQueue::RunWindow( ParallelSystem *system, ncycle_t end )
+{
+    ncounter_t busyChannels = 0;
+
+    for( size_t i = 0; i < system->channels.size( ); i++ )
+    {
+        if( system->channels[i]->GetNextEvent( ) <= end )
+            busyChannels++;
+    }
+
+    /* Waking the workers costs more than running a single channel here. */
+    if( busyChannels <= 1 || workers.empty( ) )
+    {
+        for( size_t i = 0; i < system->channels.size( ); i++ )
+            RunChannel( system->channels[i], end );
+
+        return;
+    }
+
+    windowSystem = system;
+    windowEnd = end;
+    windowPending = workers.size( );
+
+    {
+        std::lock_guard<std::mutex> lock( windowMutex );
+        windowId++;
+    }
+
+    windowStart.notify_all( );
+
+    RunChannels( 0 );
+
+    while( windowPending.load( ) != 0 )
+        std::this_thread::yield( );
+}
+
+/* Channels are dealt to the workers round robin. */
+void GlobalEventQueue::RunChannels( ncounter_t worker )
+{
+    std::vector<EventQueue *>& channels = windowSystem->channels;
+    ncounter_t stride = workers.size( ) + 1;
+
+    for( ncounter_t i = worker; i < channels.size( ); i += stride )
+        RunChannel( channels[i], windowEnd );
+}
+
+void GlobalEventQueue::WorkerLoop( ncounter_t worker )
+{
+    ncounter_t seenWindow = 0;
+
+    while( true )
+    {
+        /* Windows usually follow each other closely, so spin a little first. */
+        for( ncounter_t spin = 0; spin < 4096 && windowId.load( ) == seenWindow; spin++ )
+        {
+            if( stopWorkers.load( ) )
+                return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock( windowMutex );
+
+            while( windowId.load( ) == seenWindow && !stopWorkers.load( ) )
+                windowStart.wait( lock );
+        }
+
+        if( stopWorkers.load( ) )
+            return;
+
+        seenWindow = windowId.load( );
 
+        RunChannels( worker );
+
+        windowPending--;
+    }
+}
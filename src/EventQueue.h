@@ -36,6 +36,11 @@
 
 #include <map>
 #include <list>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include "include/NVMTypes.h"
 #include "include/NVMainRequest.h"
 
@@ -123,6 +128,12 @@ class EventQueue
     ncycle_t GetCurrentCycle( );
     void SetCurrentCycle( ncycle_t curCycle );
 
+    /* True while any command or response is still scheduled. */
+    bool HasPendingRequests( );
+
+    void CreateCheckpoint( std::string dir, std::string name );
+    void RestoreCheckpoint( std::string dir, std::string name );
+
   private:
     ncycle_t nextEventCycle;
     ncycle_t lastEventCycle;
@@ -140,6 +151,8 @@ class GlobalEventQueue
     ~GlobalEventQueue();
 
     void AddSystem( NVMain *subSystem, Config *config );
+    void AddChannelQueues( NVMain *subSystem, std::vector<EventQueue *>& channelQueues,
+                           ncounter_t threads, ncycle_t lookahead );
     void Cycle( ncycle_t steps );
 
     void SetFrequency( double freq );
@@ -147,15 +160,65 @@ class GlobalEventQueue
 
     ncycle_t GetNextEvent( EventQueue **eq = NULL );
     ncycle_t GetCurrentCycle( );
+    void SetCurrentCycle( ncycle_t curCycle );
 
   private:
     ncycle_t currentCycle;
     double frequency;
 
-    std::map<EventQueue *, double> eventQueues;
+    /*
+     *  A subsystem whose channels run on their own event queues. The front
+     *  end queue is the one registered with AddSystem.
+     */
+    struct ParallelSystem
+    {
+        NVMain *system;
+        EventQueue *frontEnd;
+        std::vector<EventQueue *> channels;
+        ncycle_t lookahead;
+    };
+
+    std::vector<ParallelSystem> parallelSystems;
+
+    /*
+     *  A subsystem clock. globalCycles global cycles take exactly as long as
+     *  localCycles subsystem cycles, reduced to lowest terms, so cycles are
+     *  converted with integer math only.
+     */
+    struct ClockDomain
+    {
+        EventQueue *queue;
+        double frequency;
+        ncycle_t globalCycles;
+        ncycle_t localCycles;
+        int parallelSystem;
+    };
+
+    std::vector<ClockDomain> clockDomains;
+
+    /* Worker pool shared by all parallel subsystems; the caller is worker 0. */
+    std::vector<std::thread> workers;
+    std::mutex windowMutex;
+    std::condition_variable windowStart;
+    std::atomic<ncounter_t> windowId;
+    std::atomic<ncounter_t> windowPending;
+    std::atomic<bool> stopWorkers;
+    ParallelSystem *windowSystem;
+    ncycle_t windowEnd;
 
     void Sync( );
 
+    void SetClockRatio( ClockDomain& domain );
+    ncycle_t ToGlobalCycle( const ClockDomain& domain, ncycle_t localCycle );
+    ncycle_t ToLocalCycle( const ClockDomain& domain, ncycle_t globalCycle );
+
+    ncycle_t GetNextLocalEvent( ClockDomain& domain );
+    void CycleParallel( ncycle_t steps );
+    void AdvanceParallel( ParallelSystem *system, ncycle_t target );
+    void RunWindow( ParallelSystem *system, ncycle_t end );
+    void RunChannels( ncounter_t worker );
+    void WorkerLoop( ncounter_t worker );
+
 };
 
 };
@@ -0,0 +1,536 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/LifeTable.h"
+#include "src/EnduranceDistribution.h"
+#include "include/NVMHelpers.h"
+#include "src/Checkpoint.h"
+
+#include <cstring>
+#include <limits>
+
+using namespace NVM;
+
+LifeTable::LifeTable( )
+{
+    dense = false;
+    count = 0;
+    counterBytes = 8;
+    unsetLife = UnsetLife( counterBytes );
+    bucketMask = 0;
+}
+
+LifeTable::~LifeTable( )
+{
+    Clear( );
+}
+
+/*
+ *  Chooses the storage for up to "keys" entries. In "auto" mode a dense table
+ *  is used if it would fit within denseLimit bytes when fully populated.
+ */
+void LifeTable::SetSize( uint64_t keys, uint64_t maxLife, std::string mode, 
+                         uint64_t denseLimit )
+{
+    Clear( );
+
+    counterBytes = CounterBytes( maxLife );
+    unsetLife = UnsetLife( counterBytes );
+
+    if( mode == "dense" )
+        dense = true;
+    else if( mode == "sparse" )
+        dense = false;
+    else
+        dense = ( keys <= denseLimit / counterBytes );
+
+    if( dense )
+        pages.resize( ( keys + pageEntries - 1 ) >> pageBits, NULL );
+}
+
+bool LifeTable::GetLife( uint64_t key, uint64_t& life ) const
+{
+    if( dense )
+    {
+        uint64_t page = key >> pageBits;
+
+        if( page >= pages.size( ) || pages[page] == NULL )
+            return false;
+
+        uint64_t value = ReadCounter( pages[page], key & (pageEntries - 1) );
+
+        if( value == unsetLife )
+            return false;
+
+        life = value;
+        return true;
+    }
+
+    if( buckets.empty( ) )
+        return false;
+
+    const HashEntry& entry = buckets[FindBucket( key )];
+
+    if( entry.key != key )
+        return false;
+
+    life = entry.life;
+    return true;
+}
+
+void LifeTable::SetLife( uint64_t key, uint64_t life )
+{
+    /*
+     *  Keys a little past the expected key space just grow the page directory,
+     *  but a key far outside of it would need a huge directory, so fall back
+     *  to the hash table instead.
+     */
+    if( dense && ( key >> pageBits ) >= 2 * pages.size( ) + 16 )
+        ConvertToSparse( );
+
+    if( dense )
+    {
+        uint64_t page = key >> pageBits;
+        uint64_t offset = key & (pageEntries - 1);
+
+        if( life >= unsetLife )
+            Widen( life );
+
+        if( page >= pages.size( ) )
+            pages.resize( page + 1, NULL );
+
+        if( pages[page] == NULL )
+            pages[page] = AllocatePage( );
+
+        if( ReadCounter( pages[page], offset ) == unsetLife )
+            count++;
+
+        WriteCounter( pages[page], offset, life );
+        return;
+    }
+
+    /* Keep the load factor below 70% so probe sequences stay short. */
+    if( ( count + 1 ) * 10 > buckets.size( ) * 7 )
+        Rehash( buckets.empty( ) ? 1024 : buckets.size( ) * 2 );
+
+    HashEntry& entry = buckets[FindBucket( key )];
+
+    if( entry.key != key )
+    {
+        entry.key = key;
+        count++;
+    }
+
+    entry.life = life;
+}
+
+/*
+ *  Decrements the life of firstKey + i for every bit i set in mask, in order
+ *  of increasing key. Keys seen for the first time get a new life from dist
+ *  instead. Returns false if any of the keys already had no life left.
+ */
+bool LifeTable::DecrementRange( uint64_t firstKey, uint64_t mask, 
+                                EnduranceDistribution *dist )
+{
+    bool rv = true;
+
+    if( mask == 0 )
+        return rv;
+
+    uint64_t lastKey = firstKey + 63 - CountLeadingZeros64( mask );
+    uint64_t page = firstKey >> pageBits;
+
+    /* Update the whole range with a single page lookup when possible. */
+    while( dense && mask != 0 && page == ( lastKey >> pageBits ) 
+           && page < pages.size( ) )
+    {
+        if( pages[page] == NULL )
+            pages[page] = AllocatePage( );
+
+        if( counterBytes == 2 )
+            rv = DecrementPage( reinterpret_cast<uint16_t *>(pages[page]), firstKey, mask, dist ) && rv;
+        else if( counterBytes == 4 )
+            rv = DecrementPage( reinterpret_cast<uint32_t *>(pages[page]), firstKey, mask, dist ) && rv;
+        else
+            rv = DecrementPage( reinterpret_cast<uint64_t *>(pages[page]), firstKey, mask, dist ) && rv;
+    }
+
+    while( mask != 0 )
+    {
+        uint64_t key = firstKey + CountTrailingZeros64( mask );
+        uint64_t life;
+
+        if( !GetLife( key, life ) )
+            SetLife( key, dist->GetEndurance( ) );
+        else if( life != 0 )
+            SetLife( key, life - 1 );
+        else
+            rv = false;
+
+        mask &= mask - 1;
+    }
+
+    return rv;
+}
+
+/*
+ *  Clears bits from mask as their counters are updated. Stops early if a new
+ *  life does not fit in T, leaving the remaining bits for the caller.
+ */
+template<typename T>
+bool LifeTable::DecrementPage( T *counters, uint64_t firstKey, uint64_t& mask,
+                               EnduranceDistribution *dist )
+{
+    uint64_t offset = firstKey & (pageEntries - 1);
+    bool rv = true;
+
+    while( mask != 0 )
+    {
+        uint64_t bit = CountTrailingZeros64( mask );
+        T& counter = counters[offset + bit];
+
+        mask &= mask - 1;
+
+        if( counter == static_cast<T>(unsetLife) )
+        {
+            uint64_t life = dist->GetEndurance( );
+
+            /* Widen( ) reallocates the pages, so counters is stale after this. */
+            if( life >= unsetLife )
+            {
+                SetLife( firstKey + bit, life );
+                break;
+            }
+
+            counter = static_cast<T>(life);
+            count++;
+        }
+        else if( counter != 0 )
+        {
+            counter--;
+        }
+        else
+        {
+            rv = false;
+        }
+    }
+
+    return rv;
+}
+
+void LifeTable::GetSummary( uint64_t& minLife, uint64_t& totalLife, uint64_t& entries ) const
+{
+    minLife = std::numeric_limits<uint64_t>::max( );
+    totalLife = 0;
+    entries = count;
+
+    if( dense )
+    {
+        for( uint64_t page = 0; page < pages.size( ); page++ )
+        {
+            if( pages[page] == NULL )
+                continue;
+
+            for( uint64_t offset = 0; offset < pageEntries; offset++ )
+            {
+                uint64_t value = ReadCounter( pages[page], offset );
+
+                if( value == unsetLife )
+                    continue;
+
+                if( value < minLife )
+                    minLife = value;
+                totalLife += value;
+            }
+        }
+    }
+    else
+    {
+        for( uint64_t i = 0; i < buckets.size( ); i++ )
+        {
+            if( buckets[i].key == emptyKey )
+                continue;
+
+            if( buckets[i].life < minLife )
+                minLife = buckets[i].life;
+            totalLife += buckets[i].life;
+        }
+    }
+}
+
+void LifeTable::Clear( )
+{
+    for( uint64_t page = 0; page < pages.size( ); page++ )
+    {
+        delete [] pages[page];
+        pages[page] = NULL;
+    }
+
+    buckets.clear( );
+    bucketMask = 0;
+    count = 0;
+}
+
+/*
+ *  Only the (key, life) pairs are written, so a table checkpointed in dense
+ *  mode can be restored into a sparse table and vice versa.
+ */
+void LifeTable::WriteCheckpoint( CheckpointWriter& cpt ) const
+{
+    cpt.Write( count );
+
+    if( dense )
+    {
+        for( uint64_t page = 0; page < pages.size( ); page++ )
+        {
+            if( pages[page] == NULL )
+                continue;
+
+            for( uint64_t offset = 0; offset < pageEntries; offset++ )
+            {
+                uint64_t value = ReadCounter( pages[page], offset );
+
+                if( value == unsetLife )
+                    continue;
+
+                cpt.Write( ( page << pageBits ) | offset );
+                cpt.Write( value );
+            }
+        }
+    }
+    else
+    {
+        for( uint64_t i = 0; i < buckets.size( ); i++ )
+        {
+            if( buckets[i].key == emptyKey )
+                continue;
+
+            cpt.Write( buckets[i].key );
+            cpt.Write( buckets[i].life );
+        }
+    }
+}
+
+void LifeTable::ReadCheckpoint( CheckpointReader& cpt )
+{
+    uint64_t entries = cpt.Read( );
+
+    Clear( );
+
+    for( uint64_t entry = 0; entry < entries && cpt.Good( ); entry++ )
+    {
+        uint64_t key = cpt.Read( );
+        uint64_t life = cpt.Read( );
+
+        SetLife( key, life );
+    }
+}
+
+unsigned int LifeTable::CounterBytes( uint64_t maxLife )
+{
+    unsigned int bytes = 8;
+
+    if( maxLife < UnsetLife( 2 ) )
+        bytes = 2;
+    else if( maxLife < UnsetLife( 4 ) )
+        bytes = 4;
+
+    return bytes;
+}
+
+uint64_t LifeTable::UnsetLife( unsigned int bytes )
+{
+    return ( bytes >= 8 ) ? ~0ULL : ( ( 1ULL << ( bytes * 8 ) ) - 1 );
+}
+
+/* 64-bit finalizer from MurmurHash3 to spread out sequential keys. */
+uint64_t LifeTable::Hash( uint64_t key )
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+
+    return key;
+}
+
+uint8_t *LifeTable::AllocatePage( ) const
+{
+    uint8_t *page = new uint8_t[pageEntries * counterBytes];
+
+    /* All-ones is the unset value for every counter width. */
+    memset( page, 0xFF, pageEntries * counterBytes );
+
+    return page;
+}
+
+uint64_t LifeTable::ReadCounter( const uint8_t *page, uint64_t offset ) const
+{
+    uint64_t value;
+
+    switch( counterBytes )
+    {
+        case 2:
+            value = reinterpret_cast<const uint16_t *>(page)[offset];
+            break;
+
+        case 4:
+            value = reinterpret_cast<const uint32_t *>(page)[offset];
+            break;
+
+        default:
+            value = reinterpret_cast<const uint64_t *>(page)[offset];
+            break;
+    }
+
+    return value;
+}
+
+void LifeTable::WriteCounter( uint8_t *page, uint64_t offset, uint64_t life )
+{
+    switch( counterBytes )
+    {
+        case 2:
+            reinterpret_cast<uint16_t *>(page)[offset] = static_cast<uint16_t>(life);
+            break;
+
+        case 4:
+            reinterpret_cast<uint32_t *>(page)[offset] = static_cast<uint32_t>(life);
+            break;
+
+        default:
+            reinterpret_cast<uint64_t *>(page)[offset] = life;
+            break;
+    }
+}
+
+/*
+ *  The distribution generated a life larger than the counters can hold, so
+ *  copy every allocated page into wider counters.
+ */
+void LifeTable::Widen( uint64_t life )
+{
+    unsigned int oldBytes = counterBytes;
+    uint64_t oldUnset = unsetLife;
+
+    for( uint64_t page = 0; page < pages.size( ); page++ )
+    {
+        if( pages[page] == NULL )
+            continue;
+
+        uint8_t *oldPage = pages[page];
+        uint64_t values[pageEntries];
+
+        for( uint64_t offset = 0; offset < pageEntries; offset++ )
+            values[offset] = ReadCounter( oldPage, offset );
+
+        counterBytes = CounterBytes( life );
+        unsetLife = UnsetLife( counterBytes );
+        pages[page] = AllocatePage( );
+
+        for( uint64_t offset = 0; offset < pageEntries; offset++ )
+        {
+            if( values[offset] != oldUnset )
+                WriteCounter( pages[page], offset, values[offset] );
+        }
+
+        delete [] oldPage;
+
+        counterBytes = oldBytes;
+        unsetLife = oldUnset;
+    }
+
+    counterBytes = CounterBytes( life );
+    unsetLife = UnsetLife( counterBytes );
+}
+
+void LifeTable::ConvertToSparse( )
+{
+    uint64_t entries = count;
+    uint64_t size = 1024;
+
+    while( entries * 10 >= size * 7 )
+        size *= 2;
+
+    dense = false;
+    count = 0;
+    Rehash( size );
+
+    for( uint64_t page = 0; page < pages.size( ); page++ )
+    {
+        if( pages[page] == NULL )
+            continue;
+
+        for( uint64_t offset = 0; offset < pageEntries; offset++ )
+        {
+            uint64_t value = ReadCounter( pages[page], offset );
+
+            if( value != unsetLife )
+                SetLife( ( page << pageBits ) + offset, value );
+        }
+
+        delete [] pages[page];
+    }
+
+    pages.clear( );
+}
+
+uint64_t LifeTable::FindBucket( uint64_t key ) const
+{
+    uint64_t bucket = Hash( key ) & bucketMask;
+
+    while( buckets[bucket].key != emptyKey && buckets[bucket].key != key )
+        bucket = ( bucket + 1 ) & bucketMask;
+
+    return bucket;
+}
+
+void LifeTable::Rehash( uint64_t size )
+{
+    std::vector<HashEntry> oldBuckets;
+    HashEntry empty;
+
+    empty.key = emptyKey;
+    empty.life = 0;
+
+    oldBuckets.swap( buckets );
+    buckets.assign( size, empty );
+    bucketMask = size - 1;
+
+    for( uint64_t i = 0; i < oldBuckets.size( ); i++ )
+    {
+        if( oldBuckets[i].key != emptyKey )
+            buckets[FindBucket( oldBuckets[i].key )] = oldBuckets[i];
+    }
+}
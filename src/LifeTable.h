@@ -0,0 +1,124 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_LIFETABLE_H__
+#define __NVMAIN_LIFETABLE_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace NVM {
+
+class EnduranceDistribution;
+class CheckpointWriter;
+class CheckpointReader;
+
+/*
+ *  Storage for the remaining life of each cell tracked by an endurance model.
+ *
+ *  In dense mode the key space is split into fixed size pages which are only
+ *  allocated when a key in the page is first written. Counters are stored with
+ *  the smallest width (16, 32 or 64 bits) that holds the largest endurance the
+ *  distribution can generate. The all-ones counter value marks untouched cells.
+ *
+ *  Key spaces too large for a dense table use an open-addressing hash table
+ *  with linear probing instead.
+ */
+class LifeTable
+{
+  public:
+    LifeTable( );
+    ~LifeTable( );
+
+    void SetSize( uint64_t keys, uint64_t maxLife, std::string mode, 
+                  uint64_t denseLimit );
+
+    bool GetLife( uint64_t key, uint64_t& life ) const;
+    void SetLife( uint64_t key, uint64_t life );
+    bool DecrementRange( uint64_t firstKey, uint64_t mask, 
+                         EnduranceDistribution *dist );
+
+    void GetSummary( uint64_t& minLife, uint64_t& totalLife, uint64_t& count ) const;
+    uint64_t GetCount( ) const { return count; }
+    bool IsDense( ) const { return dense; }
+
+    void Clear( );
+
+    void WriteCheckpoint( CheckpointWriter& cpt ) const;
+    void ReadCheckpoint( CheckpointReader& cpt );
+
+  private:
+    struct HashEntry
+    {
+        uint64_t key;
+        uint64_t life;
+    };
+
+    bool dense;
+    uint64_t count;
+
+    /* Dense mode: lazily allocated pages of counterBytes wide counters. */
+    std::vector<uint8_t *> pages;
+    unsigned int counterBytes;
+    uint64_t unsetLife;
+
+    /* Sparse mode: power of two sized open-addressing table. */
+    std::vector<HashEntry> buckets;
+    uint64_t bucketMask;
+
+    static const unsigned int pageBits = 12;
+    static const uint64_t pageEntries = 1ULL << pageBits;
+    static const uint64_t emptyKey = ~0ULL;
+
+    static unsigned int CounterBytes( uint64_t maxLife );
+    static uint64_t UnsetLife( unsigned int bytes );
+    static uint64_t Hash( uint64_t key );
+
+    uint8_t *AllocatePage( ) const;
+    uint64_t ReadCounter( const uint8_t *page, uint64_t offset ) const;
+    void WriteCounter( uint8_t *page, uint64_t offset, uint64_t life );
+    void Widen( uint64_t life );
+    void ConvertToSparse( );
+
+    template<typename T>
+    bool DecrementPage( T *counters, uint64_t firstKey, uint64_t& mask,
+                        EnduranceDistribution *dist );
+
+    uint64_t FindBucket( uint64_t key ) const;
+    void Rehash( uint64_t size );
+};
+
+};
+
+#endif
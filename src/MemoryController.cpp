@@ -36,6 +36,7 @@
 #include "src/MemoryController.h"
 #include "include/NVMainRequest.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 #include "src/Interconnect.h"
 #include "Interconnect/InterconnectFactory.h"
 #include "src/Rank.h"
@@ -51,7 +52,6 @@
 
 using namespace NVM;
 
-extern GlobalParams globalparams;
 
 /* Command queue removal predicate. */
 bool WasIssued( NVMainRequest *request );
@@ -83,6 +83,11 @@ MemoryController::MemoryController( )
     nextRefreshBank = 0;
 
     handledRefresh = std::numeric_limits<ncycle_t>::max( );
+
+    prefetch_row_hits = 0;
+    prefetch_idle_issues = 0;
+    prefetch_stale_drops = 0;
+    prefetch_overflow_drops = 0;
 }
 
 MemoryController::~MemoryController( )
@@ -149,6 +154,10 @@ void MemoryController::Cycle( ncycle_t /*steps*/ )
     bool scheduled = false;
     ncycle_t nextWakeup = GetEventQueue( )->GetCurrentCycle( ) + 1;
 
+    /* Prefetches go after the controller has had its pick of demand work. */
+    if( !prefetchQueue.empty( ) )
+        IssuePrefetches( );
+
     /* Skip this if another transaction is scheduled this cycle. */
     if( GetEventQueue( )->FindEvent( EventCycle, this, NULL, nextWakeup ) )
         return;
@@ -189,10 +198,27 @@ void MemoryController::Enqueue( ncounter_t queueNum, NVMainRequest *request )
     channel = request->address.GetChannel( );
     request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
 
-    /* Enqueue the request. */
-    assert( queueNum < transactionQueueCount );
+    if( DefersPrefetch( request ) )
+    {
+        /* Make room by giving up on the oldest prefetch. */
+        if( prefetchQueue.size( ) >= p->PrefetchQueueSize )
+        {
+            NVMainRequest *oldest = prefetchQueue.front( );
 
-    transactionQueues[queueNum].push_back( request );
+            prefetchQueue.pop_front( );
+            prefetch_overflow_drops++;
+            DropPrefetch( oldest );
+        }
+
+        prefetchQueue.push_back( request );
+    }
+    else
+    {
+        /* Enqueue the request. */
+        assert( queueNum < transactionQueueCount );
+
+        transactionQueues[queueNum].push_back( request );
+    }
     
     /* If this command queue is empty, we can schedule a new transaction right away. */
     ncounter_t queueId = GetCommandQueueId( request->address );
@@ -209,6 +235,22 @@ void MemoryController::Enqueue( ncounter_t queueNum, NVMainRequest *request )
 }
 
 bool MemoryController::TransactionAvailable( ncounter_t queueId )
+{
+    if( DemandAvailable( queueId ) )
+        return true;
+
+    std::list<NVMainRequest *>::iterator it;
+
+    for( it = prefetchQueue.begin( ); it != prefetchQueue.end( ); it++ )
+    {
+        if( GetCommandQueueId( (*it)->address ) == queueId )
+            return true;
+    }
+
+    return false;
+}
+
+bool MemoryController::DemandAvailable( ncounter_t queueId )
 {
     bool rv = false; 
 
@@ -329,11 +371,108 @@ bool MemoryController::RequestComplete( NVMainRequest *request )
     return true;
 }
 
+/*
+ *  Atomic requests have no timing. They are passed down to the subarrays
+ *  so that functional warming still wears the cells and trains encoders.
+ */
+bool MemoryController::IssueAtomic( NVMainRequest *request )
+{
+    return GetChild( )->IssueAtomic( request );
+}
+
 bool MemoryController::IsIssuable( NVMainRequest * /*request*/, FailReason * /*fail*/ )
 {
     return true;
 }
 
+bool MemoryController::DefersPrefetch( NVMainRequest *request )
+{
+    return (p->PrefetchQueue && request->isPrefetch);
+}
+
+void MemoryController::DropPrefetch( NVMainRequest *request )
+{
+    /* The owner needs to know the line will never arrive. */
+    request->flags |= NVMainRequest::FLAG_DROPPED;
+    request->status = MEM_REQUEST_COMPLETE;
+    request->completionCycle = GetEventQueue( )->GetCurrentCycle( );
+
+    GetParent( )->RequestComplete( request );
+}
+
+void MemoryController::IssuePrefetches( )
+{
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+    std::list<NVMainRequest *>::iterator it = prefetchQueue.begin( );
+
+    while( it != prefetchQueue.end( ) )
+    {
+        NVMainRequest *prefetch = (*it);
+
+        if( now - prefetch->arrivalCycle > p->PrefetchMaxAge )
+        {
+            it = prefetchQueue.erase( it );
+            prefetch_stale_drops++;
+            DropPrefetch( prefetch );
+            continue;
+        }
+
+        ncounter_t rank, bank, row, subarray, col;
+        ncounter_t queueId = GetCommandQueueId( prefetch->address );
+
+        prefetch->address.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
+
+        if( !EffectivelyEmpty( queueId ) || bankNeedRefresh[rank][bank] 
+            || refreshQueued[rank][bank] || prefetch->arrivalCycle == now )
+        {
+            it++;
+            continue;
+        }
+
+        ncounter_t muxLevel = static_cast<ncounter_t>(col / p->RBSize);
+        bool rowHit = activateQueued[rank][bank]
+                      && activeSubArray[rank][bank][subarray]
+                      && effectiveRow[rank][bank][subarray] == row
+                      && effectiveMuxedRow[rank][bank][subarray] == muxLevel;
+
+        /* A row miss is only worth it when no demand wants the bank. */
+        if( !rowHit && DemandAvailable( queueId ) )
+        {
+            it++;
+            continue;
+        }
+
+        it = prefetchQueue.erase( it );
+
+        bool lastRequest = IsLastRequest( prefetchQueue, prefetch );
+        for( ncounter_t queueIdx = 0; queueIdx < transactionQueueCount; queueIdx++ )
+        {
+            if( !IsLastRequest( transactionQueues[queueIdx], prefetch ) )
+                lastRequest = false;
+        }
+
+        if( lastRequest )
+            prefetch->flags |= NVMainRequest::FLAG_LAST_REQUEST;
+
+        if( IssueMemoryCommands( prefetch ) )
+        {
+            if( rowHit )
+                prefetch_row_hits++;
+            else
+                prefetch_idle_issues++;
+        }
+        else
+        {
+            /* Put it back where it was so the queue stays in arrival order. */
+            prefetch->flags &= ~NVMainRequest::FLAG_LAST_REQUEST;
+            prefetchQueue.insert( it, prefetch );
+        }
+
+        /* One prefetch per cycle, like any other transaction. */
+        break;
+    }
+}
+
 void MemoryController::SetMappingScheme( )
 {
     /* Configure common memory controller parameters. */
@@ -565,6 +704,14 @@ void MemoryController::RegisterStats( )
 {
     AddStat(simulation_cycles);
     AddStat(wakeupCount);
+
+    if( p->PrefetchQueue )
+    {
+        AddStat(prefetch_row_hits);
+        AddStat(prefetch_idle_issues);
+        AddStat(prefetch_stale_drops);
+        AddStat(prefetch_overflow_drops);
+    }
 }
 
 /* 
@@ -920,6 +1067,7 @@ NVMainRequest *MemoryController::MakeComputeRequest( NVMainRequest *triggerReque
     tmp->BufferSize = triggerRequest->BufferSize;
     tmp->C_address1 = triggerRequest->C_address1;
     tmp->C_address2 = triggerRequest->C_address2;
+    tmp->layer = triggerRequest->layer;
 
     return tmp;
 }
@@ -940,6 +1088,7 @@ NVMainRequest *MemoryController::MakeReadCycleRequest( NVMainRequest *triggerReq
     rcRequest->BufferSize = triggerRequest->BufferSize;
     rcRequest->C_address1 = triggerRequest->C_address1;
     rcRequest->C_address2 = triggerRequest->C_address2;
+    rcRequest->layer = triggerRequest->layer;
     rcRequest->isReused = triggerRequest->isReused;
 
     return rcRequest;
@@ -962,6 +1111,7 @@ NVMainRequest *MemoryController::MakeRealComputeRequest( NVMainRequest *triggerR
     cRequest->BufferSize = triggerRequest->BufferSize;
     cRequest->C_address1 = triggerRequest->C_address1;
     cRequest->C_address2 = triggerRequest->C_address2;
+    cRequest->layer = triggerRequest->layer;
 
     return cRequest;    
 }
@@ -983,6 +1133,7 @@ NVMainRequest *MemoryController::MakePostReadRequest( NVMainRequest *triggerRequ
     prRequest->BufferSize = triggerRequest->BufferSize;
     prRequest->C_address1 = triggerRequest->C_address1;
     prRequest->C_address2 = triggerRequest->C_address2;
+    prRequest->layer = triggerRequest->layer;
 
     return prRequest;    
 }
@@ -1005,6 +1156,7 @@ NVMainRequest *MemoryController::MakeWriteCycleRequest( NVMainRequest *triggerRe
     wcRequest->BufferSize = triggerRequest->BufferSize;
     wcRequest->C_address1 = triggerRequest->C_address1;
     wcRequest->C_address2 = triggerRequest->C_address2;
+    wcRequest->layer = triggerRequest->layer;
 
     return wcRequest;    
 }
@@ -1984,6 +2136,9 @@ void MemoryController::CycleCommandQueues( )
 
             if( queueHead->type == COMPUTE )
             {
+                assert( queueHead->layer );
+                const LayerParams& layer = *queueHead->layer;
+
                 if ( queueHead->Buffer_n > 1 )
                 {
                     commandQueues[queueId].pop_front();
@@ -2057,16 +2212,16 @@ void MemoryController::CycleCommandQueues( )
                         std::cout << "[+]  now is col " << col << " row " << row << std::endl;
                         queueHead->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
                         
-                        queueHead->BufferSize = globalparams.Buffer_n;
-                        if(( queueHead->col + queueHead->BufferSize / 2 + globalparams.K_Col - 2) >= globalparams.Input_Col)
+                        queueHead->BufferSize = layer.Buffer_n;
+                        if(( queueHead->col + queueHead->BufferSize / 2 + layer.K_Col - 2) >= layer.Input_Col)
                         {
-                            queueHead->BufferSize = 2*(globalparams.Input_Row - queueHead->col + 2 - globalparams.K_Col);
+                            queueHead->BufferSize = 2*(layer.Input_Row - queueHead->col + 2 - layer.K_Col);
                             queueHead->ColComplete = true;
                         }
                         queueHead->Buffer_n = queueHead->BufferSize;
                         std::cout << "[+] buffer_n is " << queueHead->Buffer_n << std::endl;
                         /*
-                        if((col + queueHead->Buffer_n / 2 + globalparams.K_Col - 1) >= p->COLS)
+                        if((col + queueHead->Buffer_n / 2 + layer.K_Col - 1) >= p->COLS)
                             queueHead->rowIntr = true;
                         else
                             queueHead->rowIntr = false;
@@ -2092,7 +2247,7 @@ void MemoryController::CycleCommandQueues( )
                         
                         ncounter_t rank, bank, row, subarray, col, channel;
                         queueHead->C_address1.GetTranslatedAddress( &row, &col, &bank, &rank, &channel, &subarray );
-                        col = col + (queueHead->row - 1)*globalparams.Input_Row;
+                        col = col + (queueHead->row - 1)*layer.Input_Row;
                         while (col>=p->COLS)
                         {
                             col = col - p->COLS;
@@ -2107,15 +2262,15 @@ void MemoryController::CycleCommandQueues( )
 
                         commandQueues[queueId].pop_front();
                         commandQueues[queueId].push_front(MakeComputeRequest( queueHead ));
-                        queueHead->BufferSize = globalparams.Buffer_n;
-                        if(( queueHead->col + queueHead->BufferSize / 2 + globalparams.K_Col - 2) >= globalparams.Input_Col)
+                        queueHead->BufferSize = layer.Buffer_n;
+                        if(( queueHead->col + queueHead->BufferSize / 2 + layer.K_Col - 2) >= layer.Input_Col)
                         {
-                            queueHead->BufferSize = 2*(globalparams.Input_Row - queueHead->col + 2 - globalparams.K_Col);
+                            queueHead->BufferSize = 2*(layer.Input_Row - queueHead->col + 2 - layer.K_Col);
                             queueHead->ColComplete = true;
                         }
                         queueHead->Buffer_n = queueHead->BufferSize;
                         std::cout << "[+] buffer is " << queueHead->Buffer_n << std::endl;
-                        if(( queueHead->row + globalparams.K_Row - 1 ) >= globalparams.Input_Row)
+                        if(( queueHead->row + layer.K_Row - 1 ) >= layer.Input_Row)
                         {
                             queueHead->RowComplete = true;
                         }
@@ -2153,7 +2308,7 @@ void MemoryController::CycleCommandQueues( )
                         ncounter_t rank, bank, row, subarray, col, channel;
                         queueHead->C_address1.GetTranslatedAddress( &row, &col, &bank, &rank, &channel, &subarray );
                         std::cout << "[+]  point is col " << queueHead->col << " row " << queueHead->row << std::endl;
-                        col = col + (queueHead->row - 1)*globalparams.Input_Col + queueHead->col - 1;
+                        col = col + (queueHead->row - 1)*layer.Input_Col + queueHead->col - 1;
                         while (col >=p->COLS)
                         {
                             col = col - p->COLS;
@@ -2167,7 +2322,7 @@ void MemoryController::CycleCommandQueues( )
                         std::cout << "[+]  now is col " << col << " row " << row << std::endl;
                         queueHead->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
 
-                        if(( queueHead->row + globalparams.K_Row - 1 ) >= globalparams.Input_Row)
+                        if(( queueHead->row + layer.K_Row - 1 ) >= layer.Input_Row)
                         {
                             queueHead->RowComplete = true;
                         }
@@ -2195,7 +2350,7 @@ void MemoryController::CycleCommandQueues( )
 
                         ncounter_t rank, bank, row, subarray, col, channel;
                         queueHead->C_address1.GetTranslatedAddress( &row, &col, &bank, &rank, &channel, &subarray );
-                        col = col + (queueHead->row - 1)*globalparams.Input_Row + queueHead->col - 1;
+                        col = col + (queueHead->row - 1)*layer.Input_Row + queueHead->col - 1;
                         while (col>=p->COLS)
                         {
                             col = col - p->COLS;
@@ -2208,10 +2363,10 @@ void MemoryController::CycleCommandQueues( )
                         }
                         queueHead->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
                         std::cout << "[+]  now is col " << col << " row " << row << std::endl;
-                        queueHead->BufferSize = globalparams.Buffer_n;
-                        if(( queueHead->col + queueHead->BufferSize / 2 + globalparams.K_Col - 2) >= globalparams.Input_Col)
+                        queueHead->BufferSize = layer.Buffer_n;
+                        if(( queueHead->col + queueHead->BufferSize / 2 + layer.K_Col - 2) >= layer.Input_Col)
                         {
-                            queueHead->BufferSize = 2*(globalparams.Input_Row - queueHead->col + 2 - globalparams.K_Col);
+                            queueHead->BufferSize = 2*(layer.Input_Row - queueHead->col + 2 - layer.K_Col);
                             queueHead->ColComplete = true;
                         }
                         queueHead->Buffer_n = queueHead->BufferSize;
@@ -2441,8 +2596,166 @@ void MemoryController::CalculateStats( )
     ncycle_t syncCycles = GetEventQueue( )->GetCurrentCycle( ) - lastCommandWake;
     GetChild( )->Cycle( syncCycles );
 
+    /* Stats may be calculated mid-run (e.g., snapshots), don't count these cycles twice. */
+    lastCommandWake = GetEventQueue( )->GetCurrentCycle( );
+
     simulation_cycles = GetEventQueue()->GetCurrentCycle();
 
     GetChild( )->CalculateStats( );
     GetDecoder( )->CalculateStats( );
 }
+
+/* Refresh pulses are told apart by the rank and bank they refresh. */
+uint64_t MemoryController::GetCheckpointKey( void *data )
+{
+    NVMainRequest *refresh = reinterpret_cast<NVMainRequest *>( data );
+    ncounter_t rank, bank;
+
+    if( refresh == NULL || refresh->type != REFRESH )
+        return 0;
+
+    refresh->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
+
+    return rank * p->BANKS + bank + 1;
+}
+
+/*
+ *  The controller is checkpointed once the system is drained, so only the
+ *  queue depths are written to catch checkpoints taken with requests still
+ *  queued. The row, refresh and power down bookkeeping is saved in full.
+ */
+void MemoryController::CreateCheckpoint( std::string dir )
+{
+    /* Front ends such as DRAMCache never set up the controller state. */
+    if( effectiveRow == NULL )
+    {
+        NVMObject::CreateCheckpoint( dir );
+        return;
+    }
+
+    CheckpointWriter cpt( dir, StatName( ), 1 );
+    ncounter_t queued = prefetchQueue.size( );
+
+    for( ncounter_t queueIdx = 0; queueIdx < transactionQueueCount; queueIdx++ )
+        queued += transactionQueues[queueIdx].size( );
+
+    for( ncounter_t queueIdx = 0; queueIdx < commandQueueCount; queueIdx++ )
+        queued += commandQueues[queueIdx].size( );
+
+    if( queued > 0 )
+    {
+        std::cout << "[+] " << StatName( ) << ": Warning: " << queued << " queued "
+                  << "requests are not checkpointed. Drain before checkpointing." << std::endl;
+    }
+
+    if( cpt.IsOpen( ) )
+    {
+        cpt.Write( p->RANKS );
+        cpt.Write( p->BANKS );
+        cpt.Write( subArrayNum );
+        cpt.Write( (p->UseRefresh) ? m_refreshBankNum : 0 );
+
+        cpt.Write( queued );
+        cpt.Write( lastCommandWake );
+        cpt.Write( lastIssueCycle );
+        cpt.Write( curQueue );
+        cpt.Write( handledRefresh );
+        cpt.Write( nextRefreshRank );
+        cpt.Write( nextRefreshBank );
+
+        for( ncounter_t i = 0; i < p->RANKS; i++ )
+        {
+            cpt.Write( rankPowerDown[i] );
+
+            for( ncounter_t j = 0; j < p->BANKS; j++ )
+            {
+                cpt.Write( activateQueued[i][j] );
+                cpt.Write( refreshQueued[i][j] );
+                cpt.Write( bankNeedRefresh[i][j] );
+
+                for( ncounter_t k = 0; k < subArrayNum; k++ )
+                {
+                    cpt.Write( effectiveRow[i][j][k] );
+                    cpt.Write( effectiveMuxedRow[i][j][k] );
+                    cpt.Write( activeSubArray[i][j][k] );
+                    cpt.Write( starvationCounter[i][j][k] );
+                }
+            }
+
+            for( ncounter_t j = 0; p->UseRefresh && j < m_refreshBankNum; j++ )
+                cpt.Write( delayedRefreshCounter[i][j] );
+        }
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void MemoryController::RestoreCheckpoint( std::string dir )
+{
+    if( effectiveRow == NULL )
+    {
+        NVMObject::RestoreCheckpoint( dir );
+        return;
+    }
+
+    CheckpointReader cpt( dir, StatName( ), 1 );
+
+    if( cpt.IsOpen( ) )
+    {
+        ncounter_t ranks = cpt.Read( );
+        ncounter_t banks = cpt.Read( );
+        ncounter_t subArrays = cpt.Read( );
+        ncounter_t refreshBanks = cpt.Read( );
+
+        if( ranks != p->RANKS || banks != p->BANKS || subArrays != subArrayNum
+            || refreshBanks != ( (p->UseRefresh) ? m_refreshBankNum : 0 ) )
+        {
+            std::cout << "[+] " << StatName( ) << ": Warning: Checkpoint organization "
+                      << "differs from the configuration. Skipping restore." << std::endl;
+        }
+        else
+        {
+            if( cpt.Read( ) != 0 )
+            {
+                std::cout << "[+] " << StatName( ) << ": Warning: Checkpoint was taken "
+                          << "with queued requests, which are lost." << std::endl;
+            }
+
+            lastCommandWake = cpt.Read( );
+            lastIssueCycle = cpt.Read( );
+            curQueue = cpt.Read( );
+            handledRefresh = cpt.Read( );
+            nextRefreshRank = cpt.Read( );
+            nextRefreshBank = cpt.Read( );
+
+            for( ncounter_t i = 0; i < p->RANKS; i++ )
+            {
+                rankPowerDown[i] = ( cpt.Read( ) != 0 );
+
+                for( ncounter_t j = 0; j < p->BANKS; j++ )
+                {
+                    activateQueued[i][j] = ( cpt.Read( ) != 0 );
+                    refreshQueued[i][j] = ( cpt.Read( ) != 0 );
+                    bankNeedRefresh[i][j] = ( cpt.Read( ) != 0 );
+
+                    for( ncounter_t k = 0; k < subArrayNum; k++ )
+                    {
+                        effectiveRow[i][j][k] = cpt.Read( );
+                        effectiveMuxedRow[i][j][k] = cpt.Read( );
+                        activeSubArray[i][j][k] = cpt.Read( );
+                        starvationCounter[i][j][k] = cpt.Read( );
+                    }
+                }
+
+                for( ncounter_t j = 0; p->UseRefresh && j < m_refreshBankNum; j++ )
+                    delayedRefreshCounter[i][j] = cpt.Read( );
+            }
+
+            if( !cpt.Good( ) )
+                std::cout << "[+] " << StatName( ) << ": Warning: Checkpoint is truncated." << std::endl;
+        }
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
+
@@ -109,11 +109,16 @@ class MemoryController : public NVMObject
 
     virtual bool RequestComplete( NVMainRequest *request );
     virtual bool IsIssuable( NVMainRequest *request, FailReason *fail );
+    virtual bool IssueAtomic( NVMainRequest *request );
     ncycle_t NextIssuable( NVMainRequest *request );
 
     virtual void RegisterStats( );
     virtual void CalculateStats( );
 
+    virtual void CreateCheckpoint( std::string dir );
+    virtual void RestoreCheckpoint( std::string dir );
+    uint64_t GetCheckpointKey( void *data );
+
     void CommandQueueCallback( void *data );
     void CleanupCallback( void *data );
     void RefreshCallback( void *data );
@@ -154,10 +159,20 @@ class MemoryController : public NVMObject
     bool *rankPowerDown;
 
     bool TransactionAvailable( ncounter_t queueId );
+    bool DemandAvailable( ncounter_t queueId );
     void ScheduleCommandWake( );
     void Prequeue( ncounter_t queueNum, NVMainRequest *request );
     void Enqueue( ncounter_t queueNum, NVMainRequest *request );
 
+    /* 
+     *  Optional low-priority prefetch queue. Prefetches wait here and only
+     *  issue to an open row or to a bank with no demand work.
+     */
+    NVMTransactionQueue prefetchQueue;
+    bool DefersPrefetch( NVMainRequest *request );
+    void IssuePrefetches( );
+    void DropPrefetch( NVMainRequest *request );
+
     NVMainRequest *MakeCachedRequest( NVMainRequest *triggerRequest );
     NVMainRequest *MakeActivateRequest( NVMainRequest *triggerRequest );
     NVMainRequest *MakeActivateRequest( const ncounter_t, const ncounter_t, 
@@ -275,6 +290,10 @@ class MemoryController : public NVMObject
 
     /* Stats */
     ncounter_t simulation_cycles;
+    ncounter_t prefetch_row_hits;
+    ncounter_t prefetch_idle_issues;
+    ncounter_t prefetch_stale_drops;
+    ncounter_t prefetch_overflow_drops;
 };
 
 };
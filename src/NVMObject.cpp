@@ -276,6 +276,7 @@ NVMObject::NVMObject( )
     hookType = NVMHOOK_NONE;
     hooks = new std::vector<NVMObject *> [NVMHOOK_COUNT];
     debugStream = NULL;
+    debugInhibitor = NULL;
     tagGen = NULL;
 }
 
@@ -285,6 +286,9 @@ NVMObject::~NVMObject( )
     {
         delete children[childIdx];
     }
+
+    if( debugInhibitor != NULL )
+        delete debugInhibitor;
 }
 
 void NVMObject::Init( Config * )
@@ -581,6 +585,16 @@ void NVMObject::RestoreCheckpoint( std::string dir )
         GetDecoder( )->RestoreCheckpoint( dir );
 }
 
+/*
+ *  Callback data is a pointer, so objects that pass data to their own
+ *  callbacks return a key here that tells the callbacks apart in an event
+ *  queue checkpoint (e.g., which rank a refresh pulse belongs to).
+ */
+uint64_t NVMObject::GetCheckpointKey( void * /*data*/ )
+{
+    return 0;
+}
+
 void NVMObject::PrintHierarchy( int depth )
 {
     std::vector<NVMObject_hook *>::iterator it;
@@ -708,7 +722,14 @@ void NVMObject::SetDebugName( std::string dn, Config *config )
     }
     else
     {
-        debugStream = &nvmainDebugInhibitor;
+        /* 
+         *  Discarded prints still change format flags, so objects that may
+         *  run on different threads (see ParallelChannels) get their own.
+         */
+        if( debugInhibitor == NULL )
+            debugInhibitor = new nullstream( );
+
+        debugStream = debugInhibitor;
     }
 }
 
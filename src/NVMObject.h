@@ -197,6 +197,7 @@ class NVMObject
 
     virtual void CreateCheckpoint( std::string dir );
     virtual void RestoreCheckpoint( std::string dir );
+    virtual uint64_t GetCheckpointKey( void *data );
 
     void PrintHierarchy( int depth = 0 );
 
@@ -235,6 +236,7 @@ class NVMObject
     EventQueue *eventQueue;
     GlobalEventQueue *globalEventQueue;
     std::ostream *debugStream;
+    std::ostream *debugInhibitor;
     TagGenerator *tagGen;
     HookType hookType, currentHookType;
 
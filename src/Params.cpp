@@ -42,7 +42,7 @@
 #include <iostream>
 
 using namespace NVM;
-GlobalParams::GlobalParams( )
+LayerParams::LayerParams( )
 {
     Func_n = 0;
     Input_Row = 0;
@@ -57,15 +57,56 @@ GlobalParams::GlobalParams( )
     Weight_Width = 0;
     act_mode = ACT_RELU;
     pooling_mode = Pooling_Max;
-    isUsing = false;
     Buffer_n = 0;
 }
 
-GlobalParams::~GlobalParams( )
+LayerParams::~LayerParams( )
 {
     
 }
 
+void LayerParams::SetParams( Config *c )
+{
+    c->GetValueUL( "CIM_Function", Func_n );
+    c->GetValueUL( "CIM_InputRow", Input_Row );
+    c->GetValueUL( "CIM_InputCol", Input_Col );
+    c->GetValueUL( "CIM_InputChannel", Input_Channel );
+    c->GetValueUL( "CIM_BitWidth", BitWidth );
+    c->GetValueUL( "CIM_KernelRow", K_Row );
+    c->GetValueUL( "CIM_KernelCol", K_Col );
+    /* Kernels span all input channels unless told otherwise. */
+    K_Channel = Input_Channel;
+    c->GetValueUL( "CIM_KernelChannel", K_Channel );
+    c->GetValueUL( "CIM_KernelNum", K_num );
+    c->GetValueUL( "CIM_InputWidth", Input_Width );
+    c->GetValueUL( "CIM_WeightWidth", Weight_Width );
+    c->GetValueUL( "CIM_BufferSize", Buffer_n );
+
+    if( c->KeyExists( "CIM_Activation" ) )
+    {
+        if( c->GetString( "CIM_Activation" ) == "ReLU" )
+            act_mode = ACT_RELU;
+        else if( c->GetString( "CIM_Activation" ) == "Tanh" )
+            act_mode = ACT_Tanh;
+        else if( c->GetString( "CIM_Activation" ) == "Sigmoid" )
+            act_mode = ACT_Sigmoid;
+        else
+            std::cout << "[+] Unknown CIM_Activation: " << c->GetString( "CIM_Activation" )
+                << ". Defaulting to ReLU" << std::endl;
+    }
+
+    if( c->KeyExists( "CIM_Pooling" ) )
+    {
+        if( c->GetString( "CIM_Pooling" ) == "Average" )
+            pooling_mode = Pooling_Average;
+        else if( c->GetString( "CIM_Pooling" ) == "Max" )
+            pooling_mode = Pooling_Max;
+        else
+            std::cout << "[+] Unknown CIM_Pooling: " << c->GetString( "CIM_Pooling" )
+                << ". Defaulting to Max" << std::endl;
+    }
+}
+
 Params::Params( )
 {
     BusWidth = 64;
@@ -126,6 +167,7 @@ Params::Params( )
     EnduranceModel = "NullModel";
     DataEncoder = "default";
     EnergyModel = "current";
+    energyModel = EnergyModel_Current;
 
     UseLowPower = true;
     PowerDownMode = "FASTEXIT";
@@ -197,6 +239,20 @@ Params::Params( )
 
     MemoryPrefetcher = "none";
     PrefetchBufferSize = 32;
+    PrefetchLineSize = 64;
+    PrefetchThrottle = false;
+    PrefetchMaxDegree = 4;
+    PrefetchThrottleInterval = 256;
+    PrefetchAccuracyHigh = 0.75;
+    PrefetchAccuracyLow = 0.40;
+    PrefetchQueue = false;
+    PrefetchQueueSize = 16;
+    PrefetchMaxAge = 1000;
+    PrefetchInflightSize = 0;
+
+    ParallelChannels = false;
+    ParallelThreads = 0;
+    ParallelLookahead = 0;
 
     programMode = ProgramMode_SRMS;
     MLCLevels = 1;
@@ -216,6 +272,12 @@ Params::Params( )
 
     WPMaxVariance = 2;
 
+    WriteDrivers = 0;
+    Iset = 100.0;
+    Ireset = 300.0;
+    ChipWriteBudget = 0.0;
+    RankWriteBudget = 0.0;
+
     WritePausing = false;
     PauseThreshold = 0.4;
     MaxCancellations = 4;
@@ -316,6 +378,12 @@ void Params::SetParams( Config *c )
     c->GetString( "EnduranceModel", EnduranceModel );
     c->GetString( "DataEncoder", DataEncoder );
     c->GetString( "EnergyModel", EnergyModel );
+    /* Anything but "current" has always been treated as per-op energy. */
+    energyModel = ( EnergyModel == "current" ) ? EnergyModel_Current
+                                               : EnergyModel_Energy;
+    if( EnergyModel != "current" && EnergyModel != "energy" )
+        std::cout << "[+] Unknown EnergyModel: " << EnergyModel
+                  << ". Defaulting to energy" << std::endl;
 
     c->GetBool( "UseLowPower", UseLowPower );
     c->GetString( "PowerDownMode", PowerDownMode );
@@ -387,6 +455,20 @@ void Params::SetParams( Config *c )
 
     c->GetString( "MemoryPrefetcher", MemoryPrefetcher );
     c->GetValueUL( "PrefetchBufferSize", PrefetchBufferSize );
+    c->GetValueUL( "PrefetchLineSize", PrefetchLineSize );
+    c->GetBool( "PrefetchThrottle", PrefetchThrottle );
+    c->GetValueUL( "PrefetchMaxDegree", PrefetchMaxDegree );
+    c->GetValueUL( "PrefetchThrottleInterval", PrefetchThrottleInterval );
+    c->GetEnergy( "PrefetchAccuracyHigh", PrefetchAccuracyHigh );
+    c->GetEnergy( "PrefetchAccuracyLow", PrefetchAccuracyLow );
+    c->GetBool( "PrefetchQueue", PrefetchQueue );
+    c->GetValueUL( "PrefetchQueueSize", PrefetchQueueSize );
+    c->GetValueUL( "PrefetchMaxAge", PrefetchMaxAge );
+    c->GetValueUL( "PrefetchInflightSize", PrefetchInflightSize );
+
+    c->GetBool( "ParallelChannels", ParallelChannels );
+    c->GetValueUL( "ParallelThreads", ParallelThreads );
+    c->GetValueUL( "ParallelLookahead", ParallelLookahead );
 
     if( c->KeyExists( "ProgramMode" ) )
     {
@@ -415,6 +497,12 @@ void Params::SetParams( Config *c )
 
     c->GetValueUL( "WPMaxVariance", WPMaxVariance );
 
+    c->GetValueUL( "WriteDrivers", WriteDrivers );
+    c->GetEnergy( "Iset", Iset );
+    c->GetEnergy( "Ireset", Ireset );
+    c->GetEnergy( "ChipWriteBudget", ChipWriteBudget );
+    c->GetEnergy( "RankWriteBudget", RankWriteBudget );
+
     c->GetValueUL( "DeadlockTimer", DeadlockTimer );
 
     c->GetBool( "EnableDebug", debugOn );
@@ -57,6 +57,11 @@ enum PauseMode {
     PauseMode_Optimal   ///< Optimal: Same as IIWC, but consider iteration complete
 };
 
+enum EnergyModelType {
+    EnergyModel_Current,    ///< IDD currents from the datasheet, in mA
+    EnergyModel_Energy      ///< Per-operation energies, in nJ
+};
+
 enum ACT{
   ACT_RELU,
   ACT_Tanh,
@@ -73,12 +78,21 @@ enum Slide_Mode{
   Y
 };
 
-class GlobalParams{
+/*
+ *  Layer descriptor for compute-in-memory requests. A descriptor is never
+ *  modified once it is shared: NVMain builds one from its config, and the
+ *  front end may publish a new one for later requests. Each CIM request
+ *  holds the descriptor it was issued with, so separate NVMain instances
+ *  (and in-flight requests of an earlier layer) never see each other's
+ *  layers.
+ */
+class LayerParams
+{
   public:
-    GlobalParams( );
-    ~GlobalParams( );
+    LayerParams( );
+    ~LayerParams( );
 
-    //void SetGlobalParams( Config *c );
+    void SetParams( Config *c );
 
     ncounter_t Func_n;
     ncounter_t Input_Row, Input_Col, Input_Channel;
@@ -87,15 +101,7 @@ class GlobalParams{
     ncounter_t Input_Width, Weight_Width;
     ACT act_mode;
     Pooling pooling_mode;
-    bool isUsing;
     uint64_t Buffer_n;
-    
-    NVMAddress Input_Addr;
-    NVMAddress Output_Addr;
-    Slide_Mode slide;
-
-  private:
-    
 };
 
 class Params
@@ -146,6 +152,7 @@ class Params
     std::string EnduranceModel;
     std::string DataEncoder;
     std::string EnergyModel;
+    EnergyModelType energyModel;
 
     bool UseLowPower;
     std::string PowerDownMode;
@@ -217,6 +224,20 @@ class Params
 
     std::string MemoryPrefetcher;
     ncounter_t PrefetchBufferSize;
+    ncounter_t PrefetchLineSize;
+    bool PrefetchThrottle; // scale prefetch degree by measured accuracy
+    ncounter_t PrefetchMaxDegree;
+    ncounter_t PrefetchThrottleInterval; // prefetches per accuracy sample
+    double PrefetchAccuracyHigh;
+    double PrefetchAccuracyLow;
+    bool PrefetchQueue; // hold prefetches in a low-priority controller queue
+    ncounter_t PrefetchQueueSize;
+    ncycle_t PrefetchMaxAge; // cycles before a queued prefetch is dropped
+    ncounter_t PrefetchInflightSize; // tracked outstanding prefetches, 0 = from queue depths
+
+    bool ParallelChannels; // run each channel on its own event queue
+    ncounter_t ParallelThreads; // 0 = one per channel, up to the core count
+    ncycle_t ParallelLookahead; // 0 = windows end where the front end runs
 
     ProgramMode programMode;
     ncounter_t MLCLevels;
@@ -239,6 +260,16 @@ class Params
     /* 2-level MLC variance (01 and 10 only). */
     ncycle_t WPMaxVariance;
 
+    /* 
+     *  Write drivers per chip and write current limits per chip and rank,
+     *  in the same units as the per-cell Iset/Ireset. 0 is unlimited.
+     */
+    ncounter_t WriteDrivers;
+    double Iset;
+    double Ireset;
+    double ChipWriteBudget;
+    double RankWriteBudget;
+
     /* Configurable deadlock timer. */
     ncycle_t DeadlockTimer;
 
@@ -0,0 +1,217 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/PrefetchBuffer.h"
+#include "include/NVMHelpers.h"
+
+#include <cassert>
+
+using namespace NVM;
+
+PrefetchBuffer::PrefetchBuffer( )
+{
+    capacity = 0;
+    count = 0;
+    lineShift = 0;
+    head = tail = -1;
+    indexMask = 0;
+}
+
+PrefetchBuffer::~PrefetchBuffer( )
+{
+}
+
+void PrefetchBuffer::SetSize( ncounter_t entries, ncounter_t lineSize )
+{
+    capacity = entries;
+    count = 0;
+    head = tail = -1;
+    lineShift = (lineSize > 1) ? mlog2( static_cast<int>( lineSize ) ) : 0;
+
+    lines.assign( capacity, 0 );
+    prev.assign( capacity, -1 );
+    next.assign( capacity, -1 );
+
+    freeEntries.clear( );
+    for( ncounter_t i = capacity; i > 0; i-- )
+        freeEntries.push_back( static_cast<int32_t>( i - 1 ) );
+
+    /* Keep the index at most half full so probe chains stay short. */
+    uint64_t indexSize = 1;
+    while( indexSize < 2 * capacity )
+        indexSize <<= 1;
+
+    index.assign( indexSize, -1 );
+    indexMask = indexSize - 1;
+}
+
+uint64_t PrefetchBuffer::Hash( uint64_t line ) const
+{
+    return ((line * 0x9E3779B97F4A7C15ULL) >> 17) & indexMask;
+}
+
+int64_t PrefetchBuffer::FindSlot( uint64_t line ) const
+{
+    if( capacity == 0 )
+        return -1;
+
+    for( uint64_t slot = Hash( line ); ; slot = (slot + 1) & indexMask )
+    {
+        int32_t entry = index[slot];
+
+        if( entry == -1 )
+            return -1;
+        if( lines[entry] == line )
+            return static_cast<int64_t>( slot );
+    }
+}
+
+void PrefetchBuffer::EraseSlot( uint64_t slot )
+{
+    /* Backward-shift deletion keeps every probe chain unbroken. */
+    uint64_t hole = slot;
+
+    for( uint64_t cur = (slot + 1) & indexMask; index[cur] != -1; 
+         cur = (cur + 1) & indexMask )
+    {
+        uint64_t home = Hash( lines[index[cur]] );
+
+        if( ((cur - home) & indexMask) >= ((cur - hole) & indexMask) )
+        {
+            index[hole] = index[cur];
+            hole = cur;
+        }
+    }
+
+    index[hole] = -1;
+}
+
+void PrefetchBuffer::Unlink( int32_t entry )
+{
+    if( prev[entry] != -1 )
+        next[prev[entry]] = next[entry];
+    else
+        head = next[entry];
+
+    if( next[entry] != -1 )
+        prev[next[entry]] = prev[entry];
+    else
+        tail = prev[entry];
+
+    prev[entry] = next[entry] = -1;
+}
+
+void PrefetchBuffer::PushFront( int32_t entry )
+{
+    prev[entry] = -1;
+    next[entry] = head;
+
+    if( head != -1 )
+        prev[head] = entry;
+    else
+        tail = entry;
+
+    head = entry;
+}
+
+bool PrefetchBuffer::Insert( uint64_t address )
+{
+    uint64_t line = address >> lineShift;
+    bool evicted = false;
+
+    if( capacity == 0 )
+        return false;
+
+    int64_t found = FindSlot( line );
+
+    /* A duplicate prefetch only refreshes the line. */
+    if( found != -1 )
+    {
+        int32_t entry = index[found];
+
+        Unlink( entry );
+        PushFront( entry );
+        return false;
+    }
+
+    if( freeEntries.empty( ) )
+    {
+        int32_t victim = tail;
+        int64_t victimSlot = FindSlot( lines[victim] );
+
+        assert( victimSlot != -1 );
+
+        EraseSlot( static_cast<uint64_t>( victimSlot ) );
+        Unlink( victim );
+        freeEntries.push_back( victim );
+        count--;
+        evicted = true;
+    }
+
+    int32_t entry = freeEntries.back( );
+    freeEntries.pop_back( );
+
+    lines[entry] = line;
+    PushFront( entry );
+
+    uint64_t slot = Hash( line );
+    while( index[slot] != -1 )
+        slot = (slot + 1) & indexMask;
+    index[slot] = entry;
+
+    count++;
+
+    return evicted;
+}
+
+bool PrefetchBuffer::Remove( uint64_t address )
+{
+    int64_t found = FindSlot( address >> lineShift );
+
+    if( found == -1 )
+        return false;
+
+    int32_t entry = index[found];
+
+    EraseSlot( static_cast<uint64_t>( found ) );
+    Unlink( entry );
+    freeEntries.push_back( entry );
+    count--;
+
+    return true;
+}
+
+bool PrefetchBuffer::Contains( uint64_t address ) const
+{
+    return (FindSlot( address >> lineShift ) != -1);
+}
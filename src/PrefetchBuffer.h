@@ -0,0 +1,93 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_PREFETCHBUFFER_H__
+#define __NVMAIN_PREFETCHBUFFER_H__
+
+
+#include "include/NVMTypes.h"
+#include <stdint.h>
+#include <vector>
+
+
+namespace NVM {
+
+/*
+ *  Fixed-capacity set of prefetched line addresses. Lines are found through
+ *  an open-addressing index and replaced in LRU order, so lookups on every
+ *  demand request do not walk the buffer.
+ */
+class PrefetchBuffer
+{
+  public:
+    PrefetchBuffer( );
+    ~PrefetchBuffer( );
+
+    void SetSize( ncounter_t entries, ncounter_t lineSize );
+
+    /* Returns true if an unused line was evicted to make room. */
+    bool Insert( uint64_t address );
+    /* Returns true if the line was present; the line is consumed. */
+    bool Remove( uint64_t address );
+    bool Contains( uint64_t address ) const;
+
+    ncounter_t GetSize( ) const { return count; }
+    ncounter_t GetCapacity( ) const { return capacity; }
+
+  private:
+    ncounter_t capacity;
+    ncounter_t count;
+    unsigned int lineShift;
+
+    /* Entry pool with an intrusive LRU list; head is most recently used. */
+    std::vector<uint64_t> lines;
+    std::vector<int32_t> prev;
+    std::vector<int32_t> next;
+    std::vector<int32_t> freeEntries;
+    int32_t head, tail;
+
+    /* Linear probing index of entry numbers, -1 when empty. */
+    std::vector<int32_t> index;
+    uint64_t indexMask;
+
+    uint64_t Hash( uint64_t line ) const;
+    int64_t FindSlot( uint64_t line ) const;
+    void EraseSlot( uint64_t slot );
+    void Unlink( int32_t entry );
+    void PushFront( int32_t entry );
+};
+
+};
+
+
+#endif
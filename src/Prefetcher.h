@@ -40,12 +40,17 @@
 
 namespace NVM {
 
+class Config;
+
 class Prefetcher
 {
   public:
     Prefetcher( ) { }
     virtual ~Prefetcher( ) { }
 
+    /* Called once after creation so table sizes can be read. */
+    virtual void SetConfig( Config * /*conf*/ ) { }
+
     /*
      *  Called upon successful prefetch. Return true if we should prefetch more
      *  addresses and populate the prefetchList. Return false otherwise.
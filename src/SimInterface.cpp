@@ -39,6 +39,7 @@ using namespace NVM;
 
 int SimInterface::GetDataAtAddress( uint64_t address, NVMDataBlock *data )
 {
+    std::lock_guard<std::mutex> lock( dataMutex );
     int retval;
 
     if( !memoryData.count( address ) )
@@ -57,6 +58,8 @@ int SimInterface::GetDataAtAddress( uint64_t address, NVMDataBlock *data )
 
 void SimInterface::SetDataAtAddress( uint64_t address, NVMDataBlock& data )
 {
+    std::lock_guard<std::mutex> lock( dataMutex );
+
     if( !accessCounts.count( address ) )
     {
         NVMDataBlock *newData = new NVMDataBlock( );
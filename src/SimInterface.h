@@ -36,6 +36,7 @@
 
 #include <stdint.h>
 #include <map>
+#include <mutex>
 #include "include/NVMDataBlock.h"
 
 namespace NVM {
@@ -66,6 +67,9 @@ class SimInterface
     std::map< uint64_t, unsigned int > accessCounts;
     Config *conf;
 
+    /* Channels may run on separate threads (ParallelChannels). */
+    std::mutex dataMutex;
+
 };
 
 };
@@ -33,7 +33,13 @@
 
 
 #include "src/Stats.h"
+#include "src/Checkpoint.h"
 
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <map>
+#include <iostream>
 
 using namespace NVM;
 
@@ -116,6 +122,28 @@ void Stats::PrintAll( std::ostream& stream )
     psInterval++;
 }
 
+/*
+ *  Print all stats as the members of a JSON object. Unlike PrintAll() this
+ *  does not advance the periodic stats interval, so it may be called at any
+ *  point during simulation (e.g., for live snapshots).
+ */
+void Stats::PrintJSON( std::ostream& stream )
+{
+    std::vector<StatBase *>::iterator it;
+
+    stream << "{" << std::endl;
+
+    for( it = statList.begin(); it != statList.end(); it++ )
+    {
+        if( it != statList.begin() )
+            stream << "," << std::endl;
+
+        (*it)->PrintJSON( stream );
+    }
+
+    stream << std::endl << "}";
+}
+
 void Stats::ResetAll( )
 {
     std::vector<StatBase *>::iterator it;
@@ -126,6 +154,114 @@ void Stats::ResetAll( )
     }
 }
 
+/*
+ *  Stats are written by name with their value widened to 64 bits, so a
+ *  checkpoint can be restored into a configuration with a different set of
+ *  stats. Histograms and other string stats are rebuilt by CalculateStats.
+ */
+enum StatKind { STAT_KIND_SIGNED, STAT_KIND_UNSIGNED, STAT_KIND_DOUBLE, STAT_KIND_OTHER };
+
+static StatKind GetStatKind( std::string statType )
+{
+    if( statType == typeid(int).name() || statType == typeid(ncounters_t).name()
+        || statType == typeid(ncycles_t).name() )
+        return STAT_KIND_SIGNED;
+    else if( statType == typeid(ncounter_t).name() || statType == typeid(ncycle_t).name() )
+        return STAT_KIND_UNSIGNED;
+    else if( statType == typeid(float).name() || statType == typeid(double).name() )
+        return STAT_KIND_DOUBLE;
+
+    return STAT_KIND_OTHER;
+}
+
+void Stats::CreateCheckpoint( std::string dir )
+{
+    CheckpointWriter cpt( dir, "Stats", 1 );
+    std::vector<StatBase *> saved;
+    std::vector<StatBase *>::iterator it;
+
+    if( !cpt.IsOpen( ) )
+        return;
+
+    for( it = statList.begin(); it != statList.end(); it++ )
+    {
+        if( GetStatKind( (*it)->statType ) != STAT_KIND_OTHER )
+            saved.push_back( *it );
+    }
+
+    cpt.Write( psInterval );
+    cpt.Write( saved.size( ) );
+
+    for( it = saved.begin(); it != saved.end(); it++ )
+    {
+        StatKind kind = GetStatKind( (*it)->statType );
+        void *value = (*it)->value;
+
+        cpt.WriteString( (*it)->name );
+        cpt.Write( kind );
+
+        if( (*it)->statType == typeid(int).name() )
+            cpt.Write( static_cast<uint64_t>( static_cast<int64_t>( *static_cast<int *>(value) ) ) );
+        else if( (*it)->statType == typeid(float).name() )
+            cpt.WriteDouble( *static_cast<float *>(value) );
+        else if( kind == STAT_KIND_DOUBLE )
+            cpt.WriteDouble( *static_cast<double *>(value) );
+        else
+            cpt.Write( *static_cast<uint64_t *>(value) );
+    }
+}
+
+void Stats::RestoreCheckpoint( std::string dir )
+{
+    CheckpointReader cpt( dir, "Stats", 1 );
+    std::map<std::string, StatBase *> byName;
+    std::vector<StatBase *>::iterator it;
+    ncounter_t restored = 0;
+
+    if( !cpt.IsOpen( ) )
+        return;
+
+    for( it = statList.begin(); it != statList.end(); it++ )
+        byName[(*it)->name] = *it;
+
+    psInterval = cpt.Read( );
+    uint64_t statCount = cpt.Read( );
+
+    for( uint64_t statIdx = 0; statIdx < statCount && cpt.Good( ); statIdx++ )
+    {
+        std::string name = cpt.ReadString( );
+        StatKind kind = static_cast<StatKind>( cpt.Read( ) );
+        uint64_t bits = cpt.Read( );
+        double doubleValue;
+
+        std::memcpy( &doubleValue, &bits, sizeof(doubleValue) );
+
+        if( byName.count( name ) == 0 || GetStatKind( byName[name]->statType ) != kind )
+            continue;
+
+        StatBase *stat = byName[name];
+
+        if( stat->statType == typeid(int).name() )
+            *static_cast<int *>(stat->value) = static_cast<int>( static_cast<int64_t>( bits ) );
+        else if( stat->statType == typeid(float).name() )
+            *static_cast<float *>(stat->value) = static_cast<float>( doubleValue );
+        else if( kind == STAT_KIND_DOUBLE )
+            *static_cast<double *>(stat->value) = doubleValue;
+        else
+            *static_cast<uint64_t *>(stat->value) = bits;
+
+        restored++;
+    }
+
+    if( !cpt.Good( ) )
+    {
+        std::cout << "[+] Stats: Warning: Checkpoint is truncated." << std::endl;
+    }
+
+    std::cout << "[+] Stats: Restored " << restored << " of " << statCount 
+              << " checkpointed stats." << std::endl;
+}
+
 
 void StatBase::Reset( )
 {
@@ -136,6 +272,13 @@ void StatBase::Print( std::ostream& stream, ncounter_t psInterval )
 {
     stream << "i" << psInterval << "." << name << " ";
 
+    PrintValue( stream );
+
+    stream << units << std::endl;
+}
+
+void StatBase::PrintValue( std::ostream& stream )
+{
     if( statType == typeid(int).name() ) stream << *(static_cast<int *>(value));
     else if( statType == typeid(float).name() ) stream << *(static_cast<float *>(value));
     else if( statType == typeid(double).name() ) stream << *(static_cast<double *>(value));
@@ -145,8 +288,70 @@ void StatBase::Print( std::ostream& stream, ncounter_t psInterval )
     else if( statType == typeid(ncycles_t).name() ) stream << *(static_cast<ncycles_t *>(value));
     else if( statType == typeid(std::string).name() ) stream << *(static_cast<std::string *>(value));
     else stream << "?????";
+}
 
-    stream << units << std::endl;
+/*
+ *  Writes text as a quoted JSON string. Quotes, backslashes and control
+ *  characters are escaped so arbitrary stat names and values stay valid.
+ */
+static void PrintJSONString( std::ostream& stream, const std::string& text )
+{
+    stream << "\"";
+
+    for( std::string::const_iterator c = text.begin(); c != text.end(); c++ )
+    {
+        unsigned char ch = static_cast<unsigned char>( *c );
+
+        if( ch == '"' || ch == '\\' )
+            stream << '\\' << *c;
+        else if( ch == '\n' )
+            stream << "\\n";
+        else if( ch == '\r' )
+            stream << "\\r";
+        else if( ch == '\t' )
+            stream << "\\t";
+        else if( ch < 0x20 )
+        {
+            char escaped[8];
+
+            snprintf( escaped, sizeof(escaped), "\\u%04X", ch );
+            stream << escaped;
+        }
+        else
+            stream << *c;
+    }
+
+    stream << "\"";
 }
 
+void StatBase::PrintJSON( std::ostream& stream )
+{
+    stream << "  ";
+    PrintJSONString( stream, name );
+    stream << ": ";
 
+    /* JSON has no representation for NaN or infinity (e.g., 0/0 averages). */
+    if( ( statType == typeid(double).name() 
+          && !std::isfinite( *(static_cast<double *>(value)) ) )
+        || ( statType == typeid(float).name()
+          && !std::isfinite( *(static_cast<float *>(value)) ) ) )
+    {
+        stream << "null";
+    }
+    else if( statType == typeid(int).name() || statType == typeid(float).name()
+             || statType == typeid(double).name() || statType == typeid(ncounter_t).name()
+             || statType == typeid(ncounters_t).name() )
+    {
+        PrintValue( stream );
+    }
+    else
+    {
+        /* Strings, histograms and unknown types are emitted as escaped strings. */
+        std::stringstream valueStream;
+
+        PrintValue( valueStream );
+        valueStream << units;
+
+        PrintJSONString( stream, valueStream.str( ) );
+    }
+}
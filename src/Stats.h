@@ -85,6 +85,7 @@ class StatBase
 
     void Reset( );
     void Print( std::ostream& stream, ncounter_t psInterval );
+    void PrintJSON( std::ostream& stream );
 
     std::string GetName( ) { return name; }
     void SetName( std::string n ) { name = n; }
@@ -103,6 +104,10 @@ class StatBase
     std::string GetTypeName() { return statType; }
 
   private:
+    void PrintValue( std::ostream& stream );
+
+    friend class Stats;
+
     std::string name, statType, units;
     size_t typeSize;
     StatType resetValue;
@@ -120,8 +125,12 @@ class Stats
     StatType getStat( std::string name );
 
     void PrintAll( std::ostream& );
+    void PrintJSON( std::ostream& );
     void ResetAll( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private: 
     std::vector<StatBase *> statList;
     ncounter_t psInterval;
@@ -35,32 +35,21 @@
 #include "src/Bank.h"
 #include "src/MemoryController.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 #include "include/NVMHelpers.h"
 #include "Endurance/EnduranceModelFactory.h"
 #include "Endurance/NullModel/NullModel.h"
-#include "Endurance/Distributions/Normal.h"
 #include "DataEncoders/DataEncoderFactory.h"
 
 #include <signal.h>
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <limits>
 #include <cmath>
 
-
-/*
- * Using -O3 in gcc causes the popcount methods to return incorrect values.
- * Disable optimizations in these methods using compiler specific attributes.
- */
-#if defined(__clang__)
-#define NO_OPT __attribute__((optnone))
-#else
-#define NO_OPT __attribute__((optimize("0")))
-#endif
-
 using namespace NVM;
 
-extern GlobalParams globalparams;
 SubArray::SubArray( )
 {
     conf = NULL;
@@ -83,6 +72,9 @@ SubArray::SubArray( )
     
     dataCycles = 0;
     worstCaseWrite = 0;
+    writeDriverDelay = 0;
+    writeChips = 1;
+    chipWriteBudget = 0.0;
 
     subArrayEnergy = 0.0f;
     activeEnergy = 0.0f;
@@ -121,6 +113,8 @@ SubArray::SubArray( )
     precharges = 0;
     refreshes = 0;
 
+    enduranceLeveling = 0.0;
+
     actWaits = 0;
     actWaitTotal = 0;
     actWaitAverage = 0.0;
@@ -182,15 +176,36 @@ void SubArray::SetConfig( Config *c, bool createChildren )
         }
     }
 
+    /* 
+     *  A line is written by all the chips of the rank in lockstep, so each
+     *  chip gets an even share of the cells and of the rank's write current.
+     */
+    writeChips = ( p->DeviceWidth == 0 ) ? 1 : MAX( p->BusWidth / p->DeviceWidth, 1 );
+    chipWriteBudget = p->ChipWriteBudget;
+    if( p->RankWriteBudget > 0.0 )
+    {
+        double rankShare = p->RankWriteBudget / static_cast<double>( writeChips );
+
+        if( chipWriteBudget == 0.0 || rankShare < chipWriteBudget )
+            chipWriteBudget = rankShare;
+    }
+
     ncounter_t totalWritePulses = p->nWP00 + p->nWP01 + p->nWP10 + p->nWP11;
     averageWriteIterations = static_cast<ncounter_t>( (totalWritePulses+2)/4 );
 
+    /* Pulse counts for intermediate MLC states vary from write to write. */
+    uint64_t seed = 1;
+    conf->GetValueUL( "RandomSeed", seed );
+    writePulseDist.Seed( seed, StatName( ) + ".writePulse" );
+    writePulseDist.SetVariance( p->WPVariance );
+
     if( createChildren )
     {
         /* We need to create an endurance model at a sub-array level */
         endrModel = EnduranceModelFactory::CreateEnduranceModel( p->EnduranceModel );
         if( endrModel )
         {
+            endrModel->StatName( StatName( ) + ".endurance" );
             endrModel->SetConfig( conf, createChildren );
             endrModel->SetStats( GetStats( ) );
         }
@@ -198,6 +213,7 @@ void SubArray::SetConfig( Config *c, bool createChildren )
         dataEncoder = DataEncoderFactory::CreateNewDataEncoder( p->DataEncoder );
         if( dataEncoder )
         {
+            dataEncoder->StatName( StatName( ) + ".encoder" );
             dataEncoder->SetConfig( conf, createChildren );
             dataEncoder->SetStats( GetStats( ) );
         }
@@ -216,7 +232,7 @@ void SubArray::RegisterStats( )
         dataEncoder->RegisterStats( );
     }
 
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         AddUnitStat(subArrayEnergy, "mA*t");
         AddUnitStat(activeEnergy, "mA*t");
@@ -254,11 +270,18 @@ void SubArray::RegisterStats( )
         AddStat(averageEndurance);
     }
 
+    /* How close the worst cell is to the average, i.e., to ideal wear leveling. */
+    if( endrModel && dynamic_cast<NullModel *>(endrModel) == NULL )
+    {
+        AddUnitStat(enduranceLeveling, "%");
+    }
+
     AddStat(actWaits);
     AddStat(actWaitTotal);
     AddStat(actWaitAverage);
 
     AddStat(worstCaseWrite);
+    AddStat(writeDriverDelay);
     AddStat(num00Writes);
     AddStat(num01Writes);
     AddStat(num10Writes);
@@ -346,7 +369,7 @@ bool SubArray::Activate( NVMainRequest *request )
     lastActivate = GetEventQueue()->GetCurrentCycle();
 
     /* Add to bank's total energy. */
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         /* DRAM Model */
         ncycle_t tRC = p->tRAS + p->tRP;
@@ -472,7 +495,7 @@ bool SubArray::Read( NVMainRequest *request )
 
 
     /* Calculate energy */
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         /* DRAM Model */
         subArrayEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
@@ -557,17 +580,10 @@ bool SubArray::Write( NVMainRequest *request )
         /* Count the number of bits modified. */
         if( !p->WriteAllBits )
         {
-            uint8_t *bitCountData = new uint8_t[request->data.GetSize()];
-
-            for( uint64_t bitCountByte = 0; bitCountByte < request->data.GetSize(); bitCountByte++ )
-            {
-                bitCountData[bitCountByte] = request->data.GetByte( bitCountByte )
-                                           ^ request->oldData.GetByte( bitCountByte );
-            }
-
             ncounter_t bitCountWords = request->data.GetSize()/4;
 
-            ncounter_t numChangedBits = CountBitsMLC1( 1, (uint32_t*)bitCountData, bitCountWords );
+            ncounter_t numChangedBits = CountBitFlips( request->data, request->oldData,
+                                                       0, bitCountWords*32 );
 
             assert( request->data.GetSize()*8 >= numChangedBits );
             numUnchangedBits = request->data.GetSize()*8 - numChangedBits;
@@ -702,7 +718,7 @@ bool SubArray::Write( NVMainRequest *request )
     GetEventQueue( )->InsertEvent( writeEvent, writeEventTime );
 
     /* Calculate energy. */
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         /* DRAM Model. */
         subArrayEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
@@ -819,8 +835,11 @@ bool SubArray::LoadWeight( NVMainRequest *request )
     /* Any additional latency for data encoding. */
     ncycles_t decLat = (dataEncoder ? dataEncoder->Read( request ) : 0);
 
+    const LayerParams *layer = request->layer.get( );
+    assert( layer != NULL );
+
     ncycle_t Timer;
-    Timer = globalparams.K_Row*globalparams.K_Col*globalparams.K_Channel*globalparams.K_num*225;   //write weight for 225cyc/cell
+    Timer = layer->K_Row*layer->K_Col*layer->K_Channel*layer->K_num*225;   //write weight for 225cyc/cell
         
     nextActivate = MAX( nextActivate, GetEventQueue()->GetCurrentCycle() + Timer + decLat );
     nextCompute = MAX( nextActivate, GetEventQueue()->GetCurrentCycle() + Timer + decLat );
@@ -869,6 +888,9 @@ bool SubArray::ReadCycle( NVMainRequest *request)
     /* Any additional latency for data encoding. */
     ncycles_t decLat = (dataEncoder ? dataEncoder->Read( request ) : 0);
 
+    const LayerParams *layer = request->layer.get( );
+    assert( layer != NULL );
+
     /* Update timing constraints */
     ncycles_t Timer ;
     if (request->isReused)
@@ -876,18 +898,18 @@ bool SubArray::ReadCycle( NVMainRequest *request)
         if (request->slide == X)
         {
             Timer = p->tCAS+p->tBURST*(request->BufferSize/2);
-            Timer = (Timer + p->tRP)*globalparams.K_Row* ceil( globalparams.K_Channel/4.0 ); //four bank is parallel
+            Timer = (Timer + p->tRP)*layer->K_Row* ceil( layer->K_Channel/4.0 ); //four bank is parallel
         }
         else if (request->slide == Y)
         {
-            Timer = p->tCAS+p->tBURST*(request->BufferSize/2+globalparams.K_Col - 1);
-            Timer = (Timer + p->tRP)*1* ceil( globalparams.K_Channel/4.0 ); //four bank is parallel
+            Timer = p->tCAS+p->tBURST*(request->BufferSize/2+layer->K_Col - 1);
+            Timer = (Timer + p->tRP)*1* ceil( layer->K_Channel/4.0 ); //four bank is parallel
         }
     }
     else
     {
-        Timer = p->tCAS+p->tBURST*(request->BufferSize/2+globalparams.K_Col - 1);
-        Timer = (Timer + p->tRP)*globalparams.K_Row* ceil( globalparams.K_Channel/4.0 ); //four bank is parallel
+        Timer = p->tCAS+p->tBURST*(request->BufferSize/2+layer->K_Col - 1);
+        Timer = (Timer + p->tRP)*layer->K_Row* ceil( layer->K_Channel/4.0 ); //four bank is parallel
     }
 
 
@@ -925,8 +947,11 @@ bool SubArray::PostRead( NVMainRequest *request)
 {
     std::cout << "[+] rec postread command in bank*****" << std::endl;
 
+    const LayerParams *layer = request->layer.get( );
+    assert( layer != NULL );
+
     ncycles_t Timer;
-    Timer = ceil( globalparams.K_num*p->tBURST/8.0 ) + p->tCAS;
+    Timer = ceil( layer->K_num*p->tBURST/8.0 ) + p->tCAS;
     nextActivate = MAX( nextActivate, GetEventQueue()->GetCurrentCycle() + Timer );
     nextCompute = MAX( nextActivate, GetEventQueue()->GetCurrentCycle() + Timer );
     //dataCycles += p->tBURST;
@@ -978,8 +1003,11 @@ bool SubArray::WriteCycle( NVMainRequest *request)
 
     //dataCycles += p->tBURST;
     //request->type =READ;
+    const LayerParams *layer = request->layer.get( );
+    assert( layer != NULL );
+
     ncycles_t Timer;
-    Timer = ceil((( globalparams.K_num > 128 ) ? 128 : globalparams.K_num)*8*17.2/64/2.5);
+    Timer = ceil((( layer->K_num > 128 ) ? 128 : layer->K_num)*8*17.2/64/2.5);
 
     nextActivate = MAX( nextActivate, GetEventQueue()->GetCurrentCycle() + Timer + decLat);
     nextCompute = MAX( nextActivate, GetEventQueue()->GetCurrentCycle() + Timer + decLat);
@@ -1086,7 +1114,7 @@ bool SubArray::Refresh( NVMainRequest* request )
     /* set the subarray under refreshing */
     state = SUBARRAY_REFRESHING;
 
-    if( p->EnergyModel == "current" )
+    if( p->energyModel == EnergyModel_Current )
     {
         /* calibrate the refresh energy since we may have fine-grained refresh */
         subArrayEnergy += ( ( p->EIDD5B - p->EIDD3N ) 
@@ -1232,8 +1260,8 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
 
         if( rawData )
         {
-            writeCount0 = CountBitsMLC1( 0, rawData, writeBytes32 );
-            writeCount1 = CountBitsMLC1( 1, rawData, writeBytes32 );
+            writeCount1 = CountOneBits( request->data.rawData, writeBytes32*4 );
+            writeCount0 = writeBytes32*32 - writeCount1;
         }
         else
         {
@@ -1242,7 +1270,7 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
             writeCount1 = 256;
         }
 
-        if( p->EnergyModel != "current" )
+        if( p->energyModel != EnergyModel_Current )
         {
             subArrayEnergy += p->Ereset * writeCount0;
             subArrayEnergy += p->Eset * writeCount1;
@@ -1262,10 +1290,10 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
     /* Check the data for the worst-case write time. */
     if( p->MLCLevels == 1 )
     {
-        ncounter_t writeCount0 = CountBitsMLC1( 0, rawData, writeBytes32 );
-        ncounter_t writeCount1 = CountBitsMLC1( 1, rawData, writeBytes32 );
+        ncounter_t writeCount1 = CountOneBits( request->data.rawData, writeBytes32*4 );
+        ncounter_t writeCount0 = writeBytes32*32 - writeCount1;
 
-        if( p->EnergyModel != "current" )
+        if( p->energyModel != EnergyModel_Current )
         {
             subArrayEnergy += p->Ereset * writeCount0;
             subArrayEnergy += p->Eset * writeCount1;
@@ -1277,22 +1305,39 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
         ncycle_t delay1 = (writeCount1 == 0) ? 0 : p->tWP1;
 
         maxDelay = MAX(delay0, delay1);
+
+        if( WriteDriversLimited( ) )
+        {
+            std::vector<WritePulseGroup> groups;
+
+            AddWritePulseGroup( groups, writeCount0, p->tWP0, p->Ireset );
+            AddWritePulseGroup( groups, writeCount1, p->tWP1, p->Iset );
+
+            ncycle_t scheduledDelay = ScheduleWritePulses( groups );
+
+            if( scheduledDelay > maxDelay )
+                writeDriverDelay += scheduledDelay - maxDelay;
+            maxDelay = scheduledDelay;
+        }
     }
     else if( p->MLCLevels == 2 )
     {
-        ncounter_t writeCount00 = CountBitsMLC2( 0, rawData, writeBytes32 );
-        ncounter_t writeCount01 = CountBitsMLC2( 1, rawData, writeBytes32 );
-        ncounter_t writeCount10 = CountBitsMLC2( 2, rawData, writeBytes32 );
-        ncounter_t writeCount11 = CountBitsMLC2( 3, rawData, writeBytes32 );
+        uint64_t levelCounts[4];
+
+        CountMLC2Levels( request->data.rawData, writeBytes32*4, levelCounts );
+
+        ncounter_t writeCount00 = levelCounts[0];
+        ncounter_t writeCount01 = levelCounts[1];
+        ncounter_t writeCount10 = levelCounts[2];
+        ncounter_t writeCount11 = levelCounts[3];
 
         assert( (writeCount00 + writeCount01 + writeCount10 + writeCount11)
                 == (memoryWordSize/2) );
 
         /* 
-         *  Naive scheduling -- Assume we have enough write drivers for all the data.
-         *  Then, simply choose the max write pulse time as the delay value.
-         *
-         *  TODO -- Tetris the write pulses based on number of write drivers.
+         *  With enough write drivers for all the data, simply choose the max
+         *  write pulse time as the delay value. Otherwise the pulses are
+         *  scheduled onto the write drivers below.
          */
         ncycle_t oncePulseDelay = 0;
         ncycle_t repeatPulseDelay = 0;
@@ -1315,12 +1360,9 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
             ncounters_t minPulseCount = programPulseCount - max_stddev;
             if( minPulseCount < 0 ) minPulseCount = 0;
 
-            NormalDistribution norm;
-
-            norm.SetMean( programPulseCount );
-            norm.SetVariance( p->WPVariance );
+            writePulseDist.SetMean( programPulseCount );
 
-            thisPulseCount = norm.GetEndurance( );
+            thisPulseCount = writePulseDist.GetEndurance( );
 
             if( thisPulseCount > static_cast<ncycle_t>(maxPulseCount) )
                 thisPulseCount = static_cast<ncycle_t>(maxPulseCount);
@@ -1354,15 +1396,49 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
         /* Insert times for write cancellation and pausing. */
         ncycle_t iterStart = GetEventQueue( )->GetCurrentCycle( );
         writeIterationStarts.insert( iterStart );
-        iterStart += oncePulseDelay;
 
-        for( ncycle_t iter = 0; iter < thisPulseCount; iter++ )
+        maxDelay = oncePulseDelay + thisPulseCount * repeatPulseDelay;
+
+        if( WriteDriversLimited( ) )
         {
-            writeIterationStarts.insert( iterStart );
-            iterStart += repeatPulseDelay;
+            std::vector<WritePulseGroup> groups;
+            std::vector<ncycle_t> iterationStarts;
+            double onceCurrent = p->Iset;
+            double repeatCurrent = p->Ireset;
+
+            if( p->programMode == ProgramMode_SRMS )
+            {
+                onceCurrent = p->Ireset;
+                repeatCurrent = p->Iset;
+            }
+
+            /* The intermediate states go first so their iterations are tracked. */
+            AddWritePulseGroup( groups, writeCount01 + writeCount10, oncePulseDelay,
+                                onceCurrent, thisPulseCount, repeatPulseDelay, 
+                                repeatCurrent );
+            AddWritePulseGroup( groups, writeCount00, p->tWP0, p->Ireset );
+            AddWritePulseGroup( groups, writeCount11, p->tWP1, p->Iset );
+
+            ncycle_t scheduledDelay = ScheduleWritePulses( groups, 
+                                          ( thisPulseCount > 0 ) ? &iterationStarts : NULL );
+
+            for( size_t iter = 0; iter < iterationStarts.size( ); iter++ )
+                writeIterationStarts.insert( iterStart + iterationStarts[iter] );
+
+            if( scheduledDelay > maxDelay )
+                writeDriverDelay += scheduledDelay - maxDelay;
+            maxDelay = scheduledDelay;
         }
+        else
+        {
+            iterStart += oncePulseDelay;
 
-        maxDelay = oncePulseDelay + thisPulseCount * repeatPulseDelay;
+            for( ncycle_t iter = 0; iter < thisPulseCount; iter++ )
+            {
+                writeIterationStarts.insert( iterStart );
+                iterStart += repeatPulseDelay;
+            }
+        }
 
         if( mlcTimingMap.count( maxDelay ) > 0 )
             mlcTimingMap[maxDelay]++;
@@ -1376,6 +1452,159 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
     return maxDelay;
 }
 
+bool SubArray::WriteDriversLimited( )
+{
+    return ( p->WriteDrivers != 0 || chipWriteBudget > 0.0 );
+}
+
+/* Adds the share of "cells" written by one chip. */
+void SubArray::AddWritePulseGroup( std::vector<WritePulseGroup>& groups, ncounter_t cells,
+                                   ncycle_t firstPulse, double firstCurrent,
+                                   ncounter_t repeats, ncycle_t repeatPulse,
+                                   double repeatCurrent )
+{
+    WritePulseGroup group;
+
+    group.cells = ( cells + writeChips - 1 ) / writeChips;
+    group.firstPulse = firstPulse;
+    group.firstCurrent = firstCurrent;
+    group.repeats = repeats;
+    group.repeatPulse = repeatPulse;
+    group.repeatCurrent = repeatCurrent;
+
+    if( group.cells > 0 )
+        groups.push_back( group );
+}
+
+/*
+ *  Tetris write scheduling: the pulses of one chip are packed into its write
+ *  drivers and write current budget. Cells with the most pulse time left go
+ *  first, so short pulses fill the drivers and current left over by long
+ *  ones. Returns the cycles until the last pulse ends. If iterationStarts is
+ *  given, the start of each repeated pulse of the first group is added.
+ */
+ncycle_t SubArray::ScheduleWritePulses( std::vector<WritePulseGroup>& groups,
+                                        std::vector<ncycle_t> *iterationStarts )
+{
+    struct PulseBatch
+    {
+        ncycle_t end;
+        size_t group;
+        ncounter_t pulse;
+        ncounter_t cells;
+        double current;
+    };
+
+    ncounter_t freeDrivers = ( p->WriteDrivers == 0 ) 
+                           ? std::numeric_limits<ncounter_t>::max( ) : p->WriteDrivers;
+    double freeCurrent = chipWriteBudget;
+    ncounter_t pendingCells = 0;
+    ncycle_t now = 0;
+
+    /* waiting[g][i] is the number of cells of group g ready for their i-th pulse. */
+    std::vector< std::vector<ncounter_t> > waiting( groups.size( ) );
+    std::vector<PulseBatch> running;
+
+    for( size_t g = 0; g < groups.size( ); g++ )
+    {
+        waiting[g].assign( groups[g].repeats + 1, 0 );
+        waiting[g][0] = groups[g].cells;
+        pendingCells += groups[g].cells;
+    }
+
+    while( pendingCells > 0 )
+    {
+        /* Order the waiting pulses by the pulse time left for their cells. */
+        std::vector< std::pair<ncycle_t, std::pair<size_t, ncounter_t> > > ready;
+
+        for( size_t g = 0; g < groups.size( ); g++ )
+        {
+            for( ncounter_t pulse = 0; pulse <= groups[g].repeats; pulse++ )
+            {
+                if( waiting[g][pulse] == 0 )
+                    continue;
+
+                ncycle_t timeLeft = ( groups[g].repeats - pulse ) * groups[g].repeatPulse
+                                  + ( ( pulse == 0 ) ? groups[g].firstPulse 
+                                                     : groups[g].repeatPulse );
+
+                ready.push_back( std::make_pair( timeLeft, std::make_pair( g, pulse ) ) );
+            }
+        }
+
+        std::sort( ready.rbegin( ), ready.rend( ) );
+
+        for( size_t r = 0; r < ready.size( ); r++ )
+        {
+            size_t g = ready[r].second.first;
+            ncounter_t pulse = ready[r].second.second;
+            bool first = ( pulse == 0 );
+            double current = first ? groups[g].firstCurrent : groups[g].repeatCurrent;
+            ncounter_t cells = MIN( waiting[g][pulse], freeDrivers );
+
+            if( chipWriteBudget > 0.0 && current > 0.0 )
+            {
+                double fit = std::floor( freeCurrent / current + 1e-9 );
+
+                if( fit < static_cast<double>( cells ) )
+                    cells = ( fit > 0.0 ) ? static_cast<ncounter_t>( fit ) : 0;
+            }
+
+            /* A single cell over the whole budget is written on its own. */
+            if( cells == 0 && running.empty( ) )
+                cells = 1;
+
+            if( cells == 0 )
+                continue;
+
+            PulseBatch batch;
+
+            batch.end = now + ( first ? groups[g].firstPulse : groups[g].repeatPulse );
+            batch.group = g;
+            batch.pulse = pulse;
+            batch.cells = cells;
+            batch.current = current * static_cast<double>( cells );
+            running.push_back( batch );
+
+            waiting[g][pulse] -= cells;
+            freeDrivers -= cells;
+            freeCurrent -= batch.current;
+
+            if( iterationStarts && g == 0 && pulse == iterationStarts->size( ) + 1 )
+                iterationStarts->push_back( now );
+        }
+
+        /* Move on to the next pulses to finish. */
+        now = std::numeric_limits<ncycle_t>::max( );
+        for( size_t b = 0; b < running.size( ); b++ )
+            now = MIN( now, running[b].end );
+
+        for( size_t b = 0; b < running.size( ); )
+        {
+            PulseBatch& batch = running[b];
+
+            if( batch.end != now )
+            {
+                b++;
+                continue;
+            }
+
+            freeDrivers += batch.cells;
+            freeCurrent += batch.current;
+
+            if( batch.pulse < groups[batch.group].repeats )
+                waiting[batch.group][batch.pulse + 1] += batch.cells;
+            else
+                pendingCells -= batch.cells;
+
+            running[b] = running.back( );
+            running.pop_back( );
+        }
+    }
+
+    return now;
+}
+
 ncycle_t SubArray::NextIssuable( NVMainRequest *request )
 {
     ncycle_t nextCompare = 0;
@@ -1591,6 +1820,23 @@ bool SubArray::IsIssuable( NVMainRequest *req, FailReason *reason )
     return rv;
 }
 
+/*
+ *  Functional access: writes go through the encoder and the endurance
+ *  model as they would when written back, but no timing is modeled.
+ */
+bool SubArray::IssueAtomic( NVMainRequest *req )
+{
+    if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+    {
+        if( dataEncoder )
+            dataEncoder->Write( req );
+
+        UpdateEndurance( req );
+    }
+
+    return true;
+}
+
 /*
  * IssueCommand() issue the command so that bank status will be updated
  */
@@ -1797,6 +2043,8 @@ ncycle_t SubArray::UpdateEndurance( NVMainRequest *request )
                      !conf->GetSimInterface( )-> GetDataAtAddress( 
                         request->address.GetPhysicalAddress( ), &oldData ) )
             {
+                oldData.SetSize( wordSize );
+
                 for( uint64_t i = 0; i < wordSize; i++ )
                   oldData.SetByte( i, 0 );
             }
@@ -1870,6 +2118,12 @@ void SubArray::CalculateStats( )
     worstCaseEndurance = endrModel->GetWorstLife( );
     averageEndurance = endrModel->GetAverageLife( );
 
+    if( averageEndurance != 0 )
+        enduranceLeveling = static_cast<double>(worstCaseEndurance) * 100.0
+                          / static_cast<double>(averageEndurance);
+    else
+        enduranceLeveling = 100.0;
+
     actWaitAverage = static_cast<double>(actWaitTotal) / static_cast<double>(actWaits);
 
     /* Print a histogram as a python-style dict. */
@@ -1879,84 +2133,99 @@ void SubArray::CalculateStats( )
     wpCancelHisto = PyDictHistogram<double, uint64_t>( wpCancelMap );
 }
 
-bool SubArray::Idle( )
+void SubArray::CreateCheckpoint( std::string dir )
 {
-    return ( state == SUBARRAY_CLOSED || state == SUBARRAY_PRECHARGING );
-}
+    CheckpointWriter cpt( dir, StatName( ), 1 );
 
-void SubArray::Cycle( ncycle_t )
-{
-}
+    if( isWriting )
+    {
+        std::cout << "[+] " << StatName( ) << ": Warning: Checkpointing during a "
+                  << "write, the write is not saved." << std::endl;
+    }
 
-/*
- *  Count the appearances for "value" for 2-bit MLC where value
- *  can be 0 (binary 00), 1 (binary 01), 2 (binary 10) or 3
- *  (binary 11).
- */
-ncounter_t NO_OPT SubArray::Count32MLC2( uint8_t value, uint32_t data )
-{
-    /*
-     *  This method counts the number of 11 pairs, so we need to convert
-     *  the bit pattern we are looking for to be 11.
-     */
-    if( value == 0 )
-        data ^= 0xFFFFFFFF;
-    else if( value == 1 )
-        data ^= 0xAAAAAAAA;
-    else if( value == 2 )
-        data ^= 0x55555555;
+    if( cpt.IsOpen( ) )
+    {
+        cpt.Write( state );
+        cpt.Write( openRow );
+        cpt.Write( lastActivate );
+        cpt.Write( nextActivate );
+        cpt.Write( nextPrecharge );
+        cpt.Write( nextRead );
+        cpt.Write( nextWrite );
+        cpt.Write( nextPowerDown );
+        cpt.Write( nextCompute );
+        cpt.Write( nextLoad );
+        cpt.Write( nextTransfer );
+        cpt.Write( nextReadCycle );
+        cpt.Write( writeCycle );
+        cpt.Write( idleTimer );
+        cpt.Write( dataCycles );
 
-    assert( value < 4 );
+        cpt.WriteMap( mlcTimingMap );
+        cpt.WriteMap( cancelCountMap );
+        cpt.WriteDoubleMap( wpPauseMap );
+        cpt.WriteDoubleMap( wpCancelMap );
 
-    /* 
-     *  Count number of "11" pairs by ANDing together every-event bit
-     *  with every odd bit. The resulting ANDed value will be 1 if both
-     *  even and odd bit are 1 (i.e. "11") and 0 otherwise.
-     */
-    uint32_t count = (data & 0x55555555) & ((data & 0xAAAAAAAA) >> 1);
+        writePulseDist.GetGenerator( ).WriteCheckpoint( cpt );
+    }
 
-    return Count32MLC1(count);
-}
+    if( endrModel )
+        endrModel->CreateCheckpoint( dir );
 
+    if( dataEncoder )
+        dataEncoder->CreateCheckpoint( dir );
 
-ncounter_t NO_OPT SubArray::CountBitsMLC2( uint8_t value, uint32_t *data, ncounter_t words )
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void SubArray::RestoreCheckpoint( std::string dir )
 {
-    ncounter_t count = 0;
+    CheckpointReader cpt( dir, StatName( ), 1 );
 
-    for( ncounter_t i = 0; i < words; i++ )
+    if( cpt.IsOpen( ) )
     {
-        count += Count32MLC2( value, data[i] );
-    }
-
-    return count;
-}
+        state = static_cast<SubArrayState>( cpt.Read( ) );
+        openRow = cpt.Read( );
+        lastActivate = cpt.Read( );
+        nextActivate = cpt.Read( );
+        nextPrecharge = cpt.Read( );
+        nextRead = cpt.Read( );
+        nextWrite = cpt.Read( );
+        nextPowerDown = cpt.Read( );
+        nextCompute = cpt.Read( );
+        nextLoad = cpt.Read( );
+        nextTransfer = cpt.Read( );
+        nextReadCycle = cpt.Read( );
+        writeCycle = ( cpt.Read( ) != 0 );
+        idleTimer = cpt.Read( );
+        dataCycles = cpt.Read( );
 
+        cpt.ReadMap( mlcTimingMap );
+        cpt.ReadMap( cancelCountMap );
+        cpt.ReadDoubleMap( wpPauseMap );
+        cpt.ReadDoubleMap( wpCancelMap );
 
-ncounter_t NO_OPT SubArray::Count32MLC1( uint32_t data )
-{
-    /*
-     *  Count the number of ones in this value using some
-     *  bit-manipulation magic.
-     */
-    uint32_t count = data;
-    count = count - ((count >> 1) & 0x55555555);
-    count = (count & 0x33333333) + ((count >> 2) & 0x33333333);
-    count = (((count + (count >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+        writePulseDist.GetGenerator( ).ReadCheckpoint( cpt );
 
-    return static_cast<ncounter_t>(count);
-}
+        if( !cpt.Good( ) )
+            std::cout << "[+] " << StatName( ) << ": Warning: Checkpoint is truncated." << std::endl;
+    }
 
+    if( endrModel )
+        endrModel->RestoreCheckpoint( dir );
 
-ncounter_t NO_OPT SubArray::CountBitsMLC1( uint8_t value, uint32_t *data, ncounter_t words )
-{
-    ncounter_t count = 0;
+    if( dataEncoder )
+        dataEncoder->RestoreCheckpoint( dir );
 
-    for( ncounter_t i = 0; i < words; i++ )
-    {
-        count += Count32MLC1( data[i] );
-    }
+    NVMObject::RestoreCheckpoint( dir );
+}
 
-    count = (value == 1) ? count : (words*32 - count);
+bool SubArray::Idle( )
+{
+    return ( state == SUBARRAY_CLOSED || state == SUBARRAY_PRECHARGING );
+}
 
-    return count;
+void SubArray::Cycle( ncycle_t )
+{
 }
+
@@ -41,6 +41,7 @@
 #include "src/Config.h"
 #include "src/EnduranceModel.h"
 #include "src/DataEncoder.h"
+#include "Endurance/Distributions/Normal.h"
 #include "include/NVMAddress.h"
 #include "include/NVMainRequest.h"
 #include "src/Params.h"
@@ -77,6 +78,20 @@ enum WriteMode
     DELAYED_WRITE /* data is stored in a write buffer */
 };
 
+/*
+ *  Cells of one chip that need the same write pulses: a first pulse and
+ *  then a number of repeated (program-and-verify) pulses.
+ */
+struct WritePulseGroup
+{
+    ncounter_t cells;
+    ncycle_t firstPulse;
+    double firstCurrent;
+    ncounter_t repeats;
+    ncycle_t repeatPulse;
+    double repeatCurrent;
+};
+
 class SubArray : public NVMObject
 {
   public:
@@ -97,6 +112,7 @@ class SubArray : public NVMObject
     
     bool IsIssuable( NVMainRequest *req, FailReason *reason = NULL );
     bool IssueCommand( NVMainRequest *req );
+    bool IssueAtomic( NVMainRequest *req );
     bool RequestComplete( NVMainRequest *req );
     ncycle_t NextIssuable( NVMainRequest *request );
 
@@ -122,6 +138,9 @@ class SubArray : public NVMObject
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
     ncounter_t GetId( );
     std::string GetName( );
 
@@ -167,6 +186,9 @@ class SubArray : public NVMObject
     ncycle_t nextPowerDownPreWrite;
     ncounter_t dataCycles;
     ncycle_t worstCaseWrite;
+    ncycle_t writeDriverDelay;
+    ncounter_t writeChips;
+    double chipWriteBudget;
     ncounter_t num00Writes;
     ncounter_t num01Writes;
     ncounter_t num10Writes;
@@ -194,6 +216,7 @@ class SubArray : public NVMObject
     double refreshEnergy;
 
     uint64_t worstCaseEndurance, averageEndurance;
+    double enduranceLeveling;
 
     ncounter_t reads, writes, activates, precharges, refreshes;
     ncounter_t idleTimer;
@@ -202,6 +225,7 @@ class SubArray : public NVMObject
 
     DataEncoder *dataEncoder;
     EnduranceModel *endrModel;
+    NormalDistribution writePulseDist;
 
     ncounter_t subArrayId;
  
@@ -215,14 +239,17 @@ class SubArray : public NVMObject
     std::string wpCancelHisto;
 
     ncycle_t WriteCellData( NVMainRequest *request );
+    bool WriteDriversLimited( );
+    void AddWritePulseGroup( std::vector<WritePulseGroup>& groups, ncounter_t cells,
+                             ncycle_t firstPulse, double firstCurrent,
+                             ncounter_t repeats = 0, ncycle_t repeatPulse = 0,
+                             double repeatCurrent = 0.0 );
+    ncycle_t ScheduleWritePulses( std::vector<WritePulseGroup>& groups,
+                                  std::vector<ncycle_t> *iterationStarts = NULL );
     void CheckWritePausing( );
 
     ncycle_t UpdateEndurance( NVMainRequest *request );
 
-    ncounter_t Count32MLC2( uint8_t value, uint32_t data );
-    ncounter_t CountBitsMLC2( uint8_t value, uint32_t *data, ncounter_t words );
-    ncounter_t Count32MLC1( uint32_t data );
-    ncounter_t CountBitsMLC1( uint8_t value, uint32_t *data, ncounter_t words );
 };
 
 };
@@ -0,0 +1,642 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include <sstream>
+#include <cmath>
+#include <stdlib.h>
+#include <fstream>
+#include <sys/resource.h>
+
+#include "src/Interconnect.h"
+#include "Interconnect/InterconnectFactory.h"
+#include "src/Config.h"
+#include "src/TranslationMethod.h"
+#include "traceReader/TraceReaderFactory.h"
+#include "src/AddressTranslator.h"
+#include "Decoders/DecoderFactory.h"
+#include "src/MemoryController.h"
+#include "MemControl/MemoryControllerFactory.h"
+#include "Endurance/EnduranceDistributionFactory.h"
+#include "SimInterface/NullInterface/NullInterface.h"
+#include "include/NVMHelpers.h"
+#include "Utils/HookFactory.h"
+#include "Utils/StatsSnapshot/StatsSnapshot.h"
+#include "src/EventQueue.h"
+#include "NVM/nvmain.h"
+#include "traceSim/traceMain.h"
+#include "traceSim/traceSweep.h"
+
+using namespace NVM;
+
+int main( int argc, char *argv[] )
+{
+    /* Sweeps run through the same executable: nvmain --sweep CONFIG_FILE ... */
+    if( argc > 1 && std::string( argv[1] ) == "--sweep" )
+        return NVMAIN_SWEEP( argc - 1, argv + 1 );
+
+    TraceMain *traceRunner = new TraceMain( );
+
+    int rv = traceRunner->RunTrace( argc, argv );
+
+    delete traceRunner;
+
+    return rv;
+}
+
+extern "C" int NVMAIN_TEST( int argc, char *argv[] )
+{
+    TraceMain *traceRunner = new TraceMain( );
+
+    int rv = traceRunner->RunTrace( argc, argv );
+
+    delete traceRunner;
+
+    return rv;
+}
+
+/*
+    $helloVPI;
+    $CordicRoCC_C(phase,{6'b000000,funct});
+    $NVMAIN_TEST();
+    result <= _T_221;
+*/
+
+TraceMain::TraceMain( )
+{
+    outstandingRequests = 0;
+    issuedRequests = 0;
+    traceLines = 0;
+    lastTrace = 0;
+    ignoreTraceCycle = false;
+    snapshot = NULL;
+}
+
+TraceMain::~TraceMain( )
+{
+    for( size_t i = 0; i < traces.size( ); i++ )
+    {
+        delete traces[i];
+        delete nextLines[i];
+    }
+
+    if( snapshot )
+        delete snapshot;
+}
+
+/* TRACE_FILE may name several traces separated by commas. */
+bool TraceMain::OpenTraces( Config *config, std::string traceFiles )
+{
+    std::istringstream fileStream( traceFiles );
+    std::string traceFile;
+
+    while( getline( fileStream, traceFile, ',' ) )
+    {
+        if( traceFile.empty( ) )
+            continue;
+
+        GenericTraceReader *trace = NULL;
+
+        if( config->KeyExists( "TraceReader" ) )
+            trace = TraceReaderFactory::CreateNewTraceReader( 
+                    config->GetString( "TraceReader" ) );
+        else
+            trace = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
+
+        if( trace == NULL )
+            return false;
+
+        trace->SetTraceFile( traceFile );
+
+        traces.push_back( trace );
+        nextLines.push_back( new TraceLine( ) );
+
+        ReadNextLine( traces.size( ) - 1 );
+    }
+
+    if( traces.empty( ) )
+    {
+        std::cerr << "[-] traceMain: No trace file given." << std::endl;
+        return false;
+    }
+
+    if( traces.size( ) > 1 )
+    {
+        std::cout << "[+] traceMain: Merging " << traces.size( ) 
+            << " traces, thread ID is the trace number." << std::endl;
+    }
+
+    return true;
+}
+
+/* An exhausted trace keeps a NULL line. */
+bool TraceMain::ReadNextLine( size_t traceIdx )
+{
+    if( nextLines[traceIdx] == NULL )
+        return false;
+
+    if( !traces[traceIdx]->GetNextAccess( nextLines[traceIdx] ) )
+    {
+        delete nextLines[traceIdx];
+        nextLines[traceIdx] = NULL;
+
+        return false;
+    }
+
+    traceLines++;
+
+    return true;
+}
+
+ncycle_t TraceMain::LineCycle( size_t traceIdx )
+{
+    /* 
+     * If you want to ignore the cycles used in the trace file, the line is
+     * issued as soon as the memory controller accepts it.
+     */
+    return (ignoreTraceCycle) ? 0 : nextLines[traceIdx]->GetCycle( );
+}
+
+/* 
+ *  The trace with the earliest next line goes first. Ties go round robin
+ *  so that traces without usable cycles still interleave.
+ */
+int TraceMain::NextTrace( )
+{
+    int nextTrace = -1;
+
+    for( size_t i = 1; i <= traces.size( ); i++ )
+    {
+        size_t traceIdx = ( lastTrace + i ) % traces.size( );
+
+        if( nextLines[traceIdx] == NULL )
+            continue;
+
+        if( nextTrace < 0 || LineCycle( traceIdx ) < LineCycle( nextTrace ) )
+            nextTrace = static_cast<int>( traceIdx );
+    }
+
+    if( nextTrace >= 0 )
+        lastTrace = static_cast<size_t>( nextTrace );
+
+    return nextTrace;
+}
+
+/* Live stats snapshot requested via SIGUSR1 or the snapshot socket. */
+void TraceMain::CheckSnapshot( uint64_t currentCycle )
+{
+    if( snapshot->Pending( ) )
+        snapshot->Write( GetChild( )->GetTrampoline( ), GetStats( ), currentCycle,
+                         traceLines, issuedRequests );
+}
+
+void TraceMain::PrintThroughput( uint64_t simulatedCycles )
+{
+    struct timeval now;
+    struct rusage usage;
+    double seconds;
+
+    gettimeofday( &now, NULL );
+    seconds = static_cast<double>(now.tv_sec - startTime.tv_sec)
+            + static_cast<double>(now.tv_usec - startTime.tv_usec) / 1000000.0;
+
+    /* ru_maxrss is in kilobytes on Linux. */
+    getrusage( RUSAGE_SELF, &usage );
+
+    std::cout << "[+] Simulated " << simulatedCycles << " cycles and " << issuedRequests
+        << " requests in " << seconds << " seconds." << std::endl;
+
+    if( seconds > 0.0 )
+    {
+        std::cout << "[+] Host throughput: " 
+            << static_cast<double>( simulatedCycles ) / seconds << " cycles/s, "
+            << static_cast<double>( issuedRequests ) / seconds << " requests/s." 
+            << std::endl;
+    }
+
+    std::cout << "[+] Peak resident set size: " << usage.ru_maxrss / 1024 << " MB." 
+        << std::endl;
+}
+
+static void PrintUsage( )
+{
+    std::cout << "[+] Usage: nvmain CONFIG_FILE TRACE_FILE[,TRACE_FILE ...] [CYCLES] [PARAM=value ...]" 
+        << " [--checkpoint-at CYCLE] [--restore DIR]" << std::endl;
+    std::cout << "[+]        nvmain --sweep CONFIG_FILE TRACE_FILE CYCLES SWEEP_FILE [PARAM=value ...]" 
+        << " [--checkpoint-at CYCLE] [--restore DIR]" << std::endl;
+}
+
+/* Cycle counts must be plain decimal numbers, not paths or typos. */
+static bool ParseCycles( const char *text, uint64_t& cycles )
+{
+    std::string digits( text );
+
+    if( digits.empty( ) || digits.find_first_not_of( "0123456789" ) != std::string::npos )
+        return false;
+
+    cycles = strtoull( text, NULL, 10 );
+
+    return true;
+}
+
+/*
+ *  Checkpoints and sampling need the decoded trace, so these runs go
+ *  through the sweep runner as a sweep of one. The checkpoint is written
+ *  to CheckpointDir (default nvmain.ckpt) and can be restored by a sweep.
+ */
+int TraceMain::RunCheckpointed( Config *config, std::string configFile, 
+                                std::string traceFile, uint64_t simulateCycles,
+                                uint64_t checkpointCycle, std::string restoreDir )
+{
+    if( traceFile.find( ',' ) != std::string::npos )
+    {
+        std::cerr << "[-] traceMain: Checkpoints and sampling take a single trace file." 
+            << std::endl;
+        delete config;
+        return 1;
+    }
+
+    std::string runName = configFile.substr( configFile.find_last_of( '/' ) + 1 );
+    std::string checkpointDir = "nvmain.ckpt";
+    std::ofstream statStream;
+    TraceSweep sweep;
+
+    runName = runName.substr( 0, runName.rfind( ".config" ) );
+
+    if( config->KeyExists( "CheckpointDir" ) )
+        checkpointDir = config->GetString( "CheckpointDir" );
+
+    if( config->KeyExists( "StatsFile" ) )
+    {
+        statStream.open( config->GetString( "StatsFile" ).c_str(), 
+                         std::ofstream::out | std::ofstream::app );
+    }
+
+    sweep.SetCheckpoint( checkpointCycle );
+    sweep.SetRestore( restoreDir );
+
+    return sweep.RunSingle( runName, config, traceFile, simulateCycles, checkpointDir,
+                            (statStream.is_open()) ? statStream : std::cout );
+}
+
+int TraceMain::RunTrace( int argc, char *argv[] )
+{
+    uint64_t checkpointCycle = 0;
+    std::string restoreDir;
+    std::vector<char *> args;
+
+    /* Options may appear anywhere, as for --sweep; everything else is positional. */
+    for( int curArg = 0; curArg < argc; ++curArg )
+    {
+        std::string arg = argv[curArg];
+
+        if( arg == "--checkpoint-at" && curArg + 1 < argc 
+            && ParseCycles( argv[curArg + 1], checkpointCycle ) && checkpointCycle != 0 )
+        {
+            curArg++;
+        }
+        else if( arg == "--restore" && curArg + 1 < argc )
+        {
+            restoreDir = argv[++curArg];
+        }
+        else if( curArg > 0 && arg.compare( 0, 2, "--" ) == 0 )
+        {
+            std::cerr << "[-] traceMain: Unknown or incomplete option `" << arg << "'." 
+                << std::endl;
+            PrintUsage( );
+            return 1;
+        }
+        else
+        {
+            args.push_back( argv[curArg] );
+        }
+    }
+
+    argc = static_cast<int>( args.size( ) );
+    argv = args.data( );
+
+    if( argc < 3 )
+    {
+        PrintUsage( );
+        return 1;
+    }
+
+    uint64_t simulateCycles = 0;
+    int firstOverride = 3;
+
+    /* CYCLES is optional, so overrides may follow the trace file directly. */
+    if( argc > 3 && std::string( argv[3] ).find( '=' ) == std::string::npos )
+    {
+        if( !ParseCycles( argv[3], simulateCycles ) )
+        {
+            std::cerr << "[-] traceMain: CYCLES must be a number, not `" << argv[3] 
+                << "'." << std::endl;
+            PrintUsage( );
+            return 1;
+        }
+
+        firstOverride = 4;
+    }
+
+    for( int curArg = firstOverride; curArg < argc; ++curArg )
+    {
+        if( std::string( argv[curArg] ).find( '=' ) == std::string::npos )
+        {
+            std::cerr << "[-] traceMain: Expected PARAM=value, not `" << argv[curArg] 
+                << "'." << std::endl;
+            PrintUsage( );
+            return 1;
+        }
+    }
+
+    /* Print out the command line that was provided. */
+    std::cout << "[+] NVMain command line is:" << std::endl;
+    for( int curArg = 0; curArg < argc; ++curArg )
+    {
+        std::cout << "[+]" << argv[curArg] << " ";
+    }
+    std::cout << "[+]" << std::endl << std::endl;
+
+    Config *config = new Config( );
+
+    config->Read( argv[1] );
+
+    /* Allow for overriding config parameter values for trace simulations from command line. */
+    for( int curArg = firstOverride; curArg < argc; ++curArg )
+    {
+        std::string clParam, clValue, clPair;
+        
+        clPair = argv[curArg];
+        clParam = clPair.substr( 0, clPair.find_first_of("="));
+        clValue = clPair.substr( clPair.find_first_of("=") + 1, std::string::npos );
+
+        std::cout << "[+] Overriding " << clParam << " with '" << clValue << "'" << std::endl;
+
+        config->SetValue( clParam, clValue );
+    }
+
+    if( checkpointCycle != 0 || !restoreDir.empty( ) || config->KeyExists( "SamplingPeriod" ) )
+        return RunCheckpointed( config, argv[1], argv[2], simulateCycles, 
+                                checkpointCycle, restoreDir );
+
+    Stats *stats = new Stats( );
+    SimInterface *simInterface = new NullInterface( );
+    NVMain *nvmain = new NVMain( );
+    EventQueue *mainEventQueue = new EventQueue( );
+    GlobalEventQueue *globalEventQueue = new GlobalEventQueue( );
+    TagGenerator *tagGenerator = new TagGenerator( 1000 );
+    bool IgnoreData = false;
+
+    uint64_t currentCycle;
+
+    config->SetSimInterface( simInterface );
+    SetEventQueue( mainEventQueue );
+    SetGlobalEventQueue( globalEventQueue );
+    SetStats( stats );
+    SetTagGenerator( tagGenerator );
+    std::ofstream statStream;
+
+    if( config->KeyExists( "StatsFile" ) )
+    {
+        statStream.open( config->GetString( "StatsFile" ).c_str(), 
+                         std::ofstream::out | std::ofstream::app );
+    }
+
+    if( config->KeyExists( "IgnoreData" ) && config->GetString( "IgnoreData" ) == "true" )
+    {
+        IgnoreData = true;
+    }
+
+    if( config->KeyExists( "IgnoreTraceCycle" ) 
+            && config->GetString( "IgnoreTraceCycle" ) == "true" )
+    {
+        ignoreTraceCycle = true;
+    }
+
+    /*  Add any specified hooks */
+    std::vector<std::string>& hookList = config->GetHooks( );
+
+    for( size_t i = 0; i < hookList.size( ); i++ )
+    {
+        std::cout << "[+] Creating hook " << hookList[i] << std::endl;
+
+        NVMObject *hook = HookFactory::CreateHook( hookList[i] );
+        
+        if( hook != NULL )
+        {
+            AddHook( hook );
+            hook->SetParent( this );
+            hook->Init( config );
+        }
+        else
+        {
+            std::cout << "[+] Warning: Could not create a hook named `" 
+                << hookList[i] << "'." << std::endl;
+        }
+    }
+
+    AddChild( nvmain );
+    nvmain->SetParent( this );
+
+    globalEventQueue->SetFrequency( config->GetEnergy( "CPUFreq" ) * 1000000.0 );
+    globalEventQueue->AddSystem( nvmain, config );
+
+    simInterface->SetConfig( config, true );
+    nvmain->SetConfig( config, "defaultMemory", true );
+
+    std::cout << "[+] traceMain (" << (void*)(this) << ")" << std::endl;
+    nvmain->PrintHierarchy( );
+
+    snapshot = new StatsSnapshot( );
+    snapshot->SetConfig( config );
+
+    if( !OpenTraces( config, argv[2] ) )
+        return 1;
+
+    std::cout << "[+] *** Simulating " << simulateCycles << " input cycles. (";
+
+    /*
+     *  The trace cycle is assumed to be the rate that the CPU/LLC is issuing. 
+     *  Scale the simulation cycles to be the number of *memory cycles* to run.
+     */
+    simulateCycles = (uint64_t)ceil( ((double)(config->GetValue( "CPUFreq" )) 
+                    / (double)(config->GetValue( "CLK" ))) * simulateCycles ); 
+
+    std::cout << "[+]" << simulateCycles << " memory cycles) ***" << std::endl;
+
+    gettimeofday( &startTime, NULL );
+
+    currentCycle = 0;
+    while( currentCycle <= simulateCycles || simulateCycles == 0 )
+    {
+        int traceIdx = NextTrace( );
+
+        if( traceIdx < 0 )
+        {
+            /* Force all modules to drain requests. */
+            bool draining = Drain( );
+
+            std::cout << "[+] Could not read next line from trace file!" 
+                << std::endl;
+
+            /* Wait for requests to drain. */
+            while( outstandingRequests > 0 )
+            {
+                globalEventQueue->Cycle( 1 );
+              
+                currentCycle++;
+
+                /* Retry drain each cycle if it failed. */
+                if( !draining )
+                    draining = Drain( );
+
+                CheckSnapshot( currentCycle );
+            }
+
+            break;
+        }
+
+        TraceLine *tl = nextLines[traceIdx];
+        ncycle_t lineCycle = LineCycle( traceIdx );
+
+        /* 
+         * If the next operation occurs after the requested number of cycles,
+         * we can quit. 
+         */
+        if( lineCycle > simulateCycles && simulateCycles != 0 )
+        {
+            globalEventQueue->Cycle( simulateCycles - currentCycle );
+            currentCycle += simulateCycles - currentCycle;
+
+            break;
+        }
+
+        NVMainRequest *request = new NVMainRequest( );
+        
+        request->address = tl->GetAddress( );
+        request->type = tl->GetOperation( );
+        request->bulkCmd = CMD_NOP;
+        request->threadId = ( traces.size( ) > 1 ) ? static_cast<ncounter_t>( traceIdx ) 
+                                                   : tl->GetThreadId( );
+        if( !IgnoreData ) request->data = tl->GetData( );
+        if( !IgnoreData ) request->oldData = tl->GetOldData( );
+        request->status = MEM_REQUEST_INCOMPLETE;
+        request->owner = (NVMObject *)this;
+
+        if( request->type != READ && request->type != WRITE )
+            std::cout << "[+] traceMain: Unknown Operation: " << request->type 
+                << std::endl;
+
+        /* 
+         *  If the command is in the past, it can be issued. This would 
+         *  occur since the trace was probably generated with an inaccurate 
+         *  memory *  simulator, so the cycles may not match up. Otherwise, 
+         *  we need to wait.
+         */
+        if( lineCycle > currentCycle )
+        {
+            globalEventQueue->Cycle( lineCycle - currentCycle );
+            currentCycle = globalEventQueue->GetCurrentCycle( );
+
+            if( currentCycle >= simulateCycles && simulateCycles != 0 )
+            {
+                delete request;
+                break;
+            }
+        }
+
+        /* 
+         *  Wait for the memory controller to accept the next command.. 
+         *  the trace reader is "stalling" until then.
+         */
+        while( !GetChild( )->IsIssuable( request ) )
+        {
+            if( currentCycle >= simulateCycles && simulateCycles != 0 )
+                break;
+
+            globalEventQueue->Cycle( 1 );
+            currentCycle = globalEventQueue->GetCurrentCycle( );
+
+            CheckSnapshot( currentCycle );
+        }
+
+        outstandingRequests++;
+        issuedRequests++;
+        GetChild( )->IssueCommand( request );
+
+        ReadNextLine( traceIdx );
+        CheckSnapshot( currentCycle );
+
+        if( currentCycle >= simulateCycles && simulateCycles != 0 )
+            break;
+    }       
+
+    GetChild( )->CalculateStats( );
+    std::ostream& refStream = (statStream.is_open()) ? statStream : std::cout ;
+    stats->PrintAll( refStream );
+
+    std::cout << "[+] Exiting at cycle " << currentCycle << " because simCycles " 
+        << simulateCycles << " reached." << std::endl; 
+    if( outstandingRequests > 0 )
+        std::cout << "[+] Note: " << outstandingRequests << " requests still in-flight."
+                  << std::endl;
+
+    PrintThroughput( currentCycle );
+
+    /* NVMain owns the config from here on. */
+    delete nvmain;
+
+    delete globalEventQueue;
+    delete mainEventQueue;
+    delete tagGenerator;
+    delete simInterface;
+    delete stats;
+
+    return 0;
+}
+
+void TraceMain::Cycle( ncycle_t /*steps*/ )
+{
+
+}
+
+bool TraceMain::RequestComplete( NVMainRequest* request )
+{
+    /* This is the top-level module, so there are no more parents to fallback. */
+    assert( request->owner == this );
+
+    outstandingRequests--;
+
+    delete request;
+
+    return true;
+}
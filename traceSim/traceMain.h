@@ -38,11 +38,24 @@
 
 
 #include "src/NVMObject.h"
+#include "traceReader/GenericTraceReader.h"
+
+#include <vector>
+#include <sys/time.h>
 
 
 namespace NVM {
 
 
+class Config;
+class StatsSnapshot;
+
+
+/*
+ *  Replays one or more traces against a memory system. With several traces
+ *  each one is a thread: its requests get the trace's index as thread ID and
+ *  the traces are merged in cycle order.
+ */
 class TraceMain : public NVMObject
 {
   public:
@@ -57,6 +70,28 @@ class TraceMain : public NVMObject
 
   private:
     ncounter_t outstandingRequests;
+    ncounter_t issuedRequests;
+    ncounter_t traceLines;
+
+    std::vector<GenericTraceReader *> traces;
+    std::vector<TraceLine *> nextLines;
+    size_t lastTrace;
+    bool ignoreTraceCycle;
+
+    StatsSnapshot *snapshot;
+    struct timeval startTime;
+
+    int RunCheckpointed( Config *config, std::string configFile, std::string traceFile,
+                         uint64_t simulateCycles, uint64_t checkpointCycle, 
+                         std::string restoreDir );
+
+    bool OpenTraces( Config *config, std::string traceFiles );
+    bool ReadNextLine( size_t traceIdx );
+    int NextTrace( );
+    ncycle_t LineCycle( size_t traceIdx );
+
+    void CheckSnapshot( uint64_t currentCycle );
+    void PrintThroughput( uint64_t simulatedCycles );
 };
 
 
@@ -64,4 +99,3 @@ class TraceMain : public NVMObject
 
 
 #endif
-
@@ -0,0 +1,912 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include <sstream>
+#include <cmath>
+#include <stdlib.h>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "src/Config.h"
+#include "src/Checkpoint.h"
+#include "traceReader/TraceReaderFactory.h"
+#include "SimInterface/NullInterface/NullInterface.h"
+#include "Utils/HookFactory.h"
+#include "src/EventQueue.h"
+#include "NVM/nvmain.h"
+#include "traceSim/traceSweep.h"
+
+using namespace NVM;
+
+extern "C" int NVMAIN_SWEEP( int argc, char *argv[] )
+{
+    TraceSweep *sweepRunner = new TraceSweep( );
+
+    int rv = sweepRunner->RunSweep( argc, argv );
+
+    delete sweepRunner;
+
+    return rv;
+}
+
+SweepRun::SweepRun( std::string name, Config *conf, 
+                    std::vector<TraceLine *>& lines ) : trace( lines )
+{
+    runName = name;
+    config = conf;
+    exitCycle = 0;
+    outstandingRequests = 0;
+    checkpointCycle = 0;
+
+    samplingPeriod = 0;
+    samplingWindow = 0;
+    samplingWarmup = 0;
+    samplingConfidence = 95.0;
+    samplingTargetError = 0.05;
+
+    sampledWindows = 0;
+    sampledLatency = sampledLatencyError = 0.0;
+    sampledBandwidth = sampledBandwidthError = 0.0;
+}
+
+SweepRun::~SweepRun( )
+{
+    /* Run() hands the config to NVMain, which deletes it. */
+    if( config )
+        delete config;
+}
+
+std::string SweepRun::GetRunName( )
+{
+    return runName;
+}
+
+uint64_t SweepRun::GetExitCycle( )
+{
+    return exitCycle;
+}
+
+ncounter_t SweepRun::GetOutstandingRequests( )
+{
+    return outstandingRequests;
+}
+
+void SweepRun::SetCheckpoint( uint64_t cycle, std::string dir )
+{
+    checkpointCycle = cycle;
+    checkpointDir = dir;
+}
+
+void SweepRun::SetRestore( std::string dir )
+{
+    restoreDir = dir;
+}
+
+void SweepRun::SetSampling( )
+{
+    if( !config->KeyExists( "SamplingPeriod" ) )
+        return;
+
+    samplingPeriod = config->GetValueUL( "SamplingPeriod" );
+    samplingWindow = ( config->KeyExists( "SamplingWindow" ) )
+                   ? config->GetValueUL( "SamplingWindow" ) : 1000;
+    samplingWarmup = ( config->KeyExists( "SamplingWarmup" ) )
+                   ? config->GetValueUL( "SamplingWarmup" ) : samplingWindow;
+
+    if( config->KeyExists( "SamplingConfidence" ) )
+        samplingConfidence = config->GetEnergy( "SamplingConfidence" );
+    if( config->KeyExists( "SamplingTargetError" ) )
+        samplingTargetError = config->GetEnergy( "SamplingTargetError" );
+
+    if( samplingWindow == 0 || samplingPeriod < samplingWindow + samplingWarmup )
+    {
+        std::cerr << "[-] TraceSweep: SamplingPeriod must cover SamplingWarmup plus a "
+            << "nonzero SamplingWindow. Simulating " << runName << " in detail." << std::endl;
+        samplingPeriod = 0;
+        return;
+    }
+
+    StatName( "sampling" );
+    RegisterStats( );
+
+    std::cout << "[+] TraceSweep: Sampling " << runName << " every " << samplingPeriod 
+        << " trace lines: " << samplingWarmup << " warm-up and " << samplingWindow 
+        << " measured lines in detail, the rest functionally." << std::endl;
+}
+
+/* Each period starts with functional warming and ends with the window. */
+SamplePhase SweepRun::GetSamplePhase( size_t line )
+{
+    if( samplingPeriod == 0 )
+        return SAMPLE_DETAILED;
+
+    ncounter_t offset = static_cast<ncounter_t>( line ) % samplingPeriod;
+
+    if( offset < samplingPeriod - samplingWindow - samplingWarmup )
+        return SAMPLE_FUNCTIONAL;
+    else if( offset < samplingPeriod - samplingWindow )
+        return SAMPLE_WARMING;
+
+    return SAMPLE_MEASURING;
+}
+
+/*
+ *  Every window is one observation of the average latency and the
+ *  bandwidth. The confidence interval is the usual z * s / sqrt(n).
+ */
+void SweepRun::FinishSampling( )
+{
+    std::vector<double> latencies, bandwidths;
+    double clock = config->GetEnergy( "CLK" );
+    double lineBytes = static_cast<double>( config->GetValue( "BusWidth" ) 
+                     * config->GetValue( "tBURST" ) * config->GetValue( "RATE" ) ) / 8.0;
+    double z = 1.0;
+
+    if( samplingConfidence >= 99.7 )
+        z = 3.0;
+    else if( samplingConfidence >= 99.0 )
+        z = 2.576;
+    else if( samplingConfidence >= 95.0 )
+        z = 1.96;
+    else if( samplingConfidence >= 90.0 )
+        z = 1.645;
+
+    for( size_t i = 0; i < sampleWindows.size( ); i++ )
+    {
+        SampleWindow& window = sampleWindows[i];
+
+        if( window.completed == 0 || window.endCycle <= window.startCycle )
+            continue;
+
+        /* Memory cycles to ns, and bytes per memory cycle to GB/s. */
+        latencies.push_back( static_cast<double>( window.totalLatency ) 
+                             / static_cast<double>( window.completed ) * 1000.0 / clock );
+        bandwidths.push_back( static_cast<double>( window.issued ) * lineBytes * clock 
+                              / static_cast<double>( window.endCycle - window.startCycle ) 
+                              / 1000.0 );
+    }
+
+    sampledWindows = latencies.size( );
+
+    if( sampledWindows == 0 )
+    {
+        std::cout << "[+] TraceSweep: " << runName << " finished no sampling windows." 
+            << std::endl;
+        return;
+    }
+
+    double latencySum = 0.0, latencySquares = 0.0;
+    double bandwidthSum = 0.0, bandwidthSquares = 0.0;
+    double n = static_cast<double>( sampledWindows );
+
+    for( size_t i = 0; i < latencies.size( ); i++ )
+    {
+        latencySum += latencies[i];
+        latencySquares += latencies[i] * latencies[i];
+        bandwidthSum += bandwidths[i];
+        bandwidthSquares += bandwidths[i] * bandwidths[i];
+    }
+
+    sampledLatency = latencySum / n;
+    sampledBandwidth = bandwidthSum / n;
+
+    double latencyDeviation = 0.0, bandwidthDeviation = 0.0;
+
+    if( sampledWindows > 1 )
+    {
+        latencyDeviation = sqrt( std::max( 0.0, (latencySquares - n * sampledLatency 
+                                 * sampledLatency) / (n - 1.0) ) );
+        bandwidthDeviation = sqrt( std::max( 0.0, (bandwidthSquares - n * sampledBandwidth 
+                                   * sampledBandwidth) / (n - 1.0) ) );
+    }
+
+    sampledLatencyError = z * latencyDeviation / sqrt( n );
+    sampledBandwidthError = z * bandwidthDeviation / sqrt( n );
+
+    std::cout << "[+] TraceSweep: " << runName << " sampled " << sampledWindows 
+        << " windows: latency " << sampledLatency << " +/- " << sampledLatencyError 
+        << " ns, bandwidth " << sampledBandwidth << " +/- " << sampledBandwidthError 
+        << " GB/s (" << samplingConfidence << "% confidence)." << std::endl;
+
+    /* Windows needed for the target error, assuming the variance holds. */
+    if( sampledLatency > 0.0 && sampledLatencyError > samplingTargetError * sampledLatency )
+    {
+        double needed = z * latencyDeviation / ( samplingTargetError * sampledLatency );
+
+        std::cout << "[+] Note: About " << static_cast<ncounter_t>( ceil( needed * needed ) )
+            << " windows are needed for +/- " << samplingTargetError * 100.0 
+            << "% latency error." << std::endl;
+    }
+}
+
+void SweepRun::RegisterStats( )
+{
+    AddStat(sampledWindows);
+    AddUnitStat(sampledLatency, "ns");
+    AddUnitStat(sampledLatencyError, "ns");
+    AddUnitStat(sampledBandwidth, "GB/s");
+    AddUnitStat(sampledBandwidthError, "GB/s");
+}
+
+/*
+ *  Called with nothing in flight. The trace position is written first so
+ *  that a directory without one is never mistaken for a checkpoint.
+ */
+bool SweepRun::TakeCheckpoint( size_t nextLine, uint64_t currentCycle )
+{
+    if( mkdir( checkpointDir.c_str( ), 0755 ) != 0 && errno != EEXIST )
+    {
+        std::cerr << "[-] TraceSweep: Could not create checkpoint directory " 
+            << checkpointDir << std::endl;
+        return false;
+    }
+
+    CheckpointWriter marker( checkpointDir, "TracePosition", 1 );
+
+    if( !marker.IsOpen( ) )
+        return false;
+
+    marker.Write( nextLine );
+    marker.Write( trace.size( ) );
+    marker.Write( currentCycle );
+    marker.Write( GetGlobalEventQueue( )->GetCurrentCycle( ) );
+    marker.Close( );
+
+    GetEventQueue( )->CreateCheckpoint( checkpointDir, "EventQueue" );
+    CreateCheckpoint( checkpointDir );
+    GetStats( )->CreateCheckpoint( checkpointDir );
+
+    std::cout << "[+] TraceSweep: Checkpointed " << runName << " at cycle " 
+        << currentCycle << " (trace line " << nextLine << ") in " 
+        << checkpointDir << std::endl;
+
+    return true;
+}
+
+/*
+ *  Called on a freshly configured system. The event queues go first so
+ *  every object restores its timing against the checkpointed cycle, and
+ *  the stats go last so nothing restored afterwards can count twice.
+ */
+bool SweepRun::ResumeCheckpoint( size_t& nextLine, uint64_t& currentCycle )
+{
+    CheckpointReader marker( restoreDir, "TracePosition", 1 );
+
+    if( !marker.IsOpen( ) )
+        return false;
+
+    uint64_t savedLine = marker.Read( );
+    uint64_t savedTraceSize = marker.Read( );
+    uint64_t savedCycle = marker.Read( );
+    uint64_t savedGlobalCycle = marker.Read( );
+
+    if( !marker.Good( ) || savedLine > trace.size( ) )
+    {
+        std::cerr << "[-] TraceSweep: Checkpoint in " << restoreDir 
+            << " is past the end of the trace." << std::endl;
+        return false;
+    }
+
+    if( savedTraceSize != trace.size( ) )
+    {
+        std::cout << "[+] Warning: Checkpoint was taken on a trace of " 
+            << savedTraceSize << " lines, this trace has " << trace.size( ) 
+            << "." << std::endl;
+    }
+
+    GetEventQueue( )->RestoreCheckpoint( restoreDir, "EventQueue" );
+    GetGlobalEventQueue( )->SetCurrentCycle( savedGlobalCycle );
+    RestoreCheckpoint( restoreDir );
+    GetStats( )->RestoreCheckpoint( restoreDir );
+
+    nextLine = static_cast<size_t>( savedLine );
+    currentCycle = savedCycle;
+
+    std::cout << "[+] TraceSweep: Restored " << runName << " at cycle " 
+        << currentCycle << " (trace line " << nextLine << ") from " 
+        << restoreDir << std::endl;
+
+    return true;
+}
+
+/*
+ *  Replays the shared trace the same way TraceMain::RunTrace does. Trace
+ *  lines are only read, so the IgnoreTraceCycle override is applied to a
+ *  local copy of the cycle rather than written back to the line.
+ */
+void SweepRun::Run( uint64_t simulateCycles, std::ostream& statStream )
+{
+    Stats *runStats = new Stats( );
+    SimInterface *simInterface = new NullInterface( );
+    NVMain *nvmain = new NVMain( );
+    EventQueue *mainEventQueue = new EventQueue( );
+    GlobalEventQueue *globalEventQueue = new GlobalEventQueue( );
+    TagGenerator *tagGenerator = new TagGenerator( 1000 );
+    bool ignoreData = false;
+    bool ignoreTraceCycle = false;
+    uint64_t currentCycle;
+
+    config->SetSimInterface( simInterface );
+    SetEventQueue( mainEventQueue );
+    SetGlobalEventQueue( globalEventQueue );
+    SetStats( runStats );
+    SetTagGenerator( tagGenerator );
+
+    if( config->KeyExists( "IgnoreData" ) && config->GetString( "IgnoreData" ) == "true" )
+        ignoreData = true;
+
+    if( config->KeyExists( "IgnoreTraceCycle" ) 
+            && config->GetString( "IgnoreTraceCycle" ) == "true" )
+        ignoreTraceCycle = true;
+
+    /*  Add any specified hooks */
+    std::vector<std::string>& hookList = config->GetHooks( );
+
+    for( size_t i = 0; i < hookList.size( ); i++ )
+    {
+        NVMObject *hook = HookFactory::CreateHook( hookList[i] );
+        
+        if( hook != NULL )
+        {
+            AddHook( hook );
+            hook->SetParent( this );
+            hook->Init( config );
+        }
+        else
+        {
+            std::cout << "[+] Warning: Could not create a hook named `" 
+                << hookList[i] << "'." << std::endl;
+        }
+    }
+
+    AddChild( nvmain );
+    nvmain->SetParent( this );
+
+    globalEventQueue->SetFrequency( config->GetEnergy( "CPUFreq" ) * 1000000.0 );
+    globalEventQueue->AddSystem( nvmain, config );
+
+    simInterface->SetConfig( config, true );
+    nvmain->SetConfig( config, "defaultMemory", true );
+
+    /* Scale the input cycles to this configuration's memory cycles. */
+    simulateCycles = (uint64_t)ceil( ((double)(config->GetValue( "CPUFreq" )) 
+                    / (double)(config->GetValue( "CLK" ))) * simulateCycles ); 
+    uint64_t checkpointAt = (uint64_t)ceil( ((double)(config->GetValue( "CPUFreq" )) 
+                    / (double)(config->GetValue( "CLK" ))) * checkpointCycle ); 
+    bool checkpointPending = ( checkpointCycle != 0 );
+
+    size_t nextLine = 0;
+    bool measuring = false;
+
+    currentCycle = 0;
+
+    SetSampling( );
+
+    if( !restoreDir.empty( ) && !ResumeCheckpoint( nextLine, currentCycle ) )
+    {
+        std::cerr << "[-] TraceSweep: Could not restore " << runName << " from " 
+            << restoreDir << ", starting from the beginning of the trace." << std::endl;
+    }
+    while( currentCycle <= simulateCycles || simulateCycles == 0 )
+    {
+        if( nextLine == trace.size( ) )
+        {
+            if( measuring )
+            {
+                sampleWindows.back( ).endCycle = GetEventQueue( )->GetCurrentCycle( );
+                measuring = false;
+            }
+
+            /* Force all modules to drain requests. */
+            bool draining = Drain( );
+
+            /* Wait for requests to drain. */
+            while( outstandingRequests > 0 )
+            {
+                globalEventQueue->Cycle( 1 );
+              
+                currentCycle++;
+
+                /* Retry drain each cycle if it failed. */
+                if( !draining )
+                    draining = Drain( );
+            }
+
+            break;
+        }
+
+        SamplePhase phase = GetSamplePhase( nextLine );
+        TraceLine *tl = trace[nextLine++];
+        ncycle_t lineCycle = (ignoreTraceCycle) ? 0 : tl->GetCycle( );
+
+        /* 
+         * If the next operation occurs after the requested number of cycles,
+         * we can quit. 
+         */
+        if( lineCycle > simulateCycles && simulateCycles != 0 )
+        {
+            globalEventQueue->Cycle( simulateCycles - currentCycle );
+            currentCycle += simulateCycles - currentCycle;
+
+            break;
+        }
+
+        /* 
+         *  Hold this line back and let everything in flight complete, so
+         *  the checkpoint has no requests to save.
+         */
+        if( checkpointPending && lineCycle >= checkpointAt )
+        {
+            /* As at the end of the trace, controllers may stay draining. */
+            bool draining = Drain( );
+
+            /* A stalled controller never goes idle, so give up eventually. */
+            ncycle_t holdLimit = 10000000;
+
+            if( config->KeyExists( "CheckpointHoldCycles" ) )
+                holdLimit = config->GetValueUL( "CheckpointHoldCycles" );
+            else if( config->KeyExists( "DeadlockTimer" ) )
+                holdLimit = config->GetValueUL( "DeadlockTimer" );
+            ncycle_t holdStart = globalEventQueue->GetCurrentCycle( );
+
+            while( ( outstandingRequests > 0 || !GetChild( )->Idle( ) )
+                   && globalEventQueue->GetCurrentCycle( ) - holdStart < holdLimit )
+            {
+                globalEventQueue->Cycle( 1 );
+                currentCycle = globalEventQueue->GetCurrentCycle( );
+
+                if( !draining )
+                    draining = Drain( );
+            }
+
+            checkpointPending = false;
+
+            if( outstandingRequests > 0 || !GetChild( )->Idle( ) )
+            {
+                /* Carry on with this line instead of holding it back. */
+                std::cerr << "[-] TraceSweep: Skipping checkpoint of " << runName
+                    << ": " << outstandingRequests << " requests still in flight after "
+                    << holdLimit << " cycles." << std::endl;
+            }
+            else
+            {
+                nextLine--;
+                TakeCheckpoint( nextLine, currentCycle );
+
+                continue;
+            }
+        }
+
+        NVMainRequest *request = new NVMainRequest( );
+        
+        request->address = tl->GetAddress( );
+        request->type = tl->GetOperation( );
+        request->bulkCmd = CMD_NOP;
+        request->threadId = tl->GetThreadId( );
+        if( !ignoreData ) request->data = tl->GetData( );
+        if( !ignoreData ) request->oldData = tl->GetOldData( );
+        request->status = MEM_REQUEST_INCOMPLETE;
+        request->owner = (NVMObject *)this;
+
+        if( measuring && phase != SAMPLE_MEASURING )
+        {
+            sampleWindows.back( ).endCycle = GetEventQueue( )->GetCurrentCycle( );
+            measuring = false;
+        }
+
+        /* 
+         *  Functional warming updates the caches, wear and encoders without
+         *  timing. The next detailed line catches the event queue up.
+         */
+        if( phase == SAMPLE_FUNCTIONAL )
+        {
+            GetChild( )->IssueAtomic( request );
+            delete request;
+
+            continue;
+        }
+
+        if( lineCycle > currentCycle )
+        {
+            globalEventQueue->Cycle( lineCycle - currentCycle );
+            currentCycle = globalEventQueue->GetCurrentCycle( );
+
+            if( currentCycle >= simulateCycles && simulateCycles != 0 )
+            {
+                delete request;
+                break;
+            }
+        }
+
+        /* Stall the trace until the memory controller accepts the request. */
+        while( !GetChild( )->IsIssuable( request ) )
+        {
+            if( currentCycle >= simulateCycles && simulateCycles != 0 )
+                break;
+
+            globalEventQueue->Cycle( 1 );
+            currentCycle = globalEventQueue->GetCurrentCycle( );
+        }
+
+        if( phase == SAMPLE_MEASURING )
+        {
+            if( !measuring )
+            {
+                SampleWindow window;
+
+                window.startCycle = GetEventQueue( )->GetCurrentCycle( );
+                window.endCycle = window.startCycle;
+                window.issued = window.completed = window.totalLatency = 0;
+
+                sampleWindows.push_back( window );
+                measuring = true;
+            }
+
+            sampleWindows.back( ).issued++;
+            sampledRequests[request] = std::make_pair( GetEventQueue( )->GetCurrentCycle( ),
+                                                       sampleWindows.size( ) - 1 );
+        }
+
+        outstandingRequests++;
+        GetChild( )->IssueCommand( request );
+
+        if( currentCycle >= simulateCycles && simulateCycles != 0 )
+            break;
+    }       
+
+    exitCycle = currentCycle;
+
+    /* A window cut off by the cycle limit is not a full observation. */
+    if( measuring )
+        sampleWindows.pop_back( );
+
+    if( samplingPeriod != 0 )
+        FinishSampling( );
+
+    GetChild( )->CalculateStats( );
+    runStats->PrintAll( statStream );
+
+    /* NVMain owns the config from here on. */
+    delete nvmain;
+    config = NULL;
+
+    delete globalEventQueue;
+    delete mainEventQueue;
+    delete tagGenerator;
+    delete simInterface;
+    delete runStats;
+}
+
+void SweepRun::Cycle( ncycle_t /*steps*/ )
+{
+
+}
+
+bool SweepRun::RequestComplete( NVMainRequest* request )
+{
+    /* This is the top-level module, so there are no more parents to fallback. */
+    assert( request->owner == this );
+
+    outstandingRequests--;
+
+    std::map<NVMainRequest *, std::pair<ncycle_t, size_t> >::iterator it;
+
+    if( (it = sampledRequests.find( request )) != sampledRequests.end( ) )
+    {
+        if( it->second.second < sampleWindows.size( ) )
+        {
+            sampleWindows[it->second.second].completed++;
+            sampleWindows[it->second.second].totalLatency += 
+                GetEventQueue( )->GetCurrentCycle( ) - it->second.first;
+        }
+
+        sampledRequests.erase( it );
+    }
+
+    delete request;
+
+    return true;
+}
+
+TraceSweep::TraceSweep( ) : nextRun( 0 )
+{
+    simulateCycles = 0;
+    checkpointCycle = 0;
+}
+
+TraceSweep::~TraceSweep( )
+{
+    for( size_t i = 0; i < runs.size( ); i++ )
+        delete runs[i];
+
+    for( size_t i = 0; i < trace.size( ); i++ )
+        delete trace[i];
+}
+
+/*
+ *  Each non-comment line of the sweep file is one configuration: a name
+ *  followed by any number of PARAM=value overrides, e.g.
+ *
+ *      frfcfs_open   MEM_CTL=FRFCFS ClosePage=0
+ *      frfcfs_close  MEM_CTL=FRFCFS ClosePage=1
+ *
+ *  The configs are built here on the calling thread so that workers only
+ *  ever read their own copy.
+ */
+bool TraceSweep::ReadSweepFile( std::string sweepFile, Config *baseConfig )
+{
+    std::ifstream sweepStream( sweepFile.c_str( ) );
+    std::string line;
+    std::string statsDir = ".";
+
+    if( !sweepStream.is_open( ) )
+    {
+        std::cerr << "[-] TraceSweep: Could not read sweep file " 
+            << sweepFile << std::endl;
+        return false;
+    }
+
+    if( baseConfig->KeyExists( "SweepStatsDir" ) )
+        statsDir = baseConfig->GetString( "SweepStatsDir" );
+
+    while( getline( sweepStream, line ) )
+    {
+        /* Strip comments beginning with ';' as in the config files. */
+        if( line.find( ';' ) != std::string::npos )
+            line = line.substr( 0, line.find( ';' ) );
+
+        std::istringstream lineStream( line );
+        std::string runName, clPair;
+
+        if( !(lineStream >> runName) )
+            continue;
+
+        Config *runConfig = new Config( *baseConfig );
+
+        while( lineStream >> clPair )
+        {
+            if( clPair.find( '=' ) == std::string::npos )
+            {
+                std::cerr << "[-] TraceSweep: Ignoring malformed override `" 
+                    << clPair << "' for " << runName << std::endl;
+                continue;
+            }
+
+            std::string clParam = clPair.substr( 0, clPair.find_first_of( "=" ) );
+            std::string clValue = clPair.substr( clPair.find_first_of( "=" ) + 1 );
+
+            runConfig->SetValue( clParam, clValue );
+        }
+
+        runs.push_back( new SweepRun( runName, runConfig, trace ) );
+        statsFiles.push_back( statsDir + "/" + runName + ".stats" );
+    }
+
+    return true;
+}
+
+void TraceSweep::SetCheckpoint( uint64_t cycle )
+{
+    checkpointCycle = cycle;
+}
+
+void TraceSweep::SetRestore( std::string dir )
+{
+    restoreDir = dir;
+}
+
+void TraceSweep::DecodeTrace( Config *baseConfig, std::string traceFile )
+{
+    GenericTraceReader *reader = NULL;
+
+    if( baseConfig->KeyExists( "TraceReader" ) )
+        reader = TraceReaderFactory::CreateNewTraceReader( 
+                baseConfig->GetString( "TraceReader" ) );
+    else
+        reader = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
+
+    reader->SetTraceFile( traceFile );
+
+    TraceLine *tl = new TraceLine( );
+    while( reader->GetNextAccess( tl ) )
+    {
+        trace.push_back( tl );
+        tl = new TraceLine( );
+    }
+    delete tl;
+    delete reader;
+}
+
+/*
+ *  Takes ownership of config. The checkpoint, if any, is written to
+ *  checkpointDir, and the run restores from the directory set with
+ *  SetRestore( ), so checkpoints move freely between nvmain and sweeps.
+ */
+int TraceSweep::RunSingle( std::string runName, Config *config, std::string traceFile,
+                           uint64_t cycles, std::string checkpointDir, 
+                           std::ostream& statStream )
+{
+    DecodeTrace( config, traceFile );
+
+    SweepRun *run = new SweepRun( runName, config, trace );
+
+    runs.push_back( run );
+    simulateCycles = cycles;
+
+    if( checkpointCycle != 0 )
+        run->SetCheckpoint( checkpointCycle, checkpointDir );
+    if( !restoreDir.empty( ) )
+        run->SetRestore( restoreDir );
+
+    std::cout << "[+] TraceSweep: Decoded " << trace.size( ) << " trace lines from "
+        << traceFile << "." << std::endl;
+
+    run->Run( simulateCycles, statStream );
+
+    std::cout << "[+] TraceSweep: " << runName << " exited at cycle " 
+        << run->GetExitCycle( ) << "." << std::endl;
+    if( run->GetOutstandingRequests( ) > 0 )
+        std::cout << "[+] Note: " << run->GetOutstandingRequests( ) 
+            << " requests still in-flight." << std::endl;
+
+    return 0;
+}
+
+void TraceSweep::WorkerLoop( )
+{
+    size_t runIdx;
+
+    while( (runIdx = nextRun.fetch_add( 1 )) < runs.size( ) )
+    {
+        SweepRun *run = runs[runIdx];
+        std::ofstream statStream( statsFiles[runIdx].c_str( ), 
+                                  std::ofstream::out | std::ofstream::trunc );
+
+        if( !statStream.is_open( ) )
+        {
+            std::lock_guard<std::mutex> lock( printMutex );
+            std::cerr << "[-] TraceSweep: Could not open stats file " 
+                << statsFiles[runIdx] << ", skipping " << run->GetRunName( ) 
+                << std::endl;
+            continue;
+        }
+
+        if( checkpointCycle != 0 )
+        {
+            std::string ckptDir = statsFiles[runIdx];
+            ckptDir = ckptDir.substr( 0, ckptDir.rfind( ".stats" ) ) + ".ckpt";
+            run->SetCheckpoint( checkpointCycle, ckptDir );
+        }
+        if( !restoreDir.empty( ) )
+            run->SetRestore( restoreDir );
+
+        run->Run( simulateCycles, statStream );
+
+        std::lock_guard<std::mutex> lock( printMutex );
+        std::cout << "[+] TraceSweep: " << run->GetRunName( ) << " exited at cycle "
+            << run->GetExitCycle( ) << ", stats in " << statsFiles[runIdx] << std::endl;
+        if( run->GetOutstandingRequests( ) > 0 )
+            std::cout << "[+] Note: " << run->GetOutstandingRequests( ) 
+                << " requests still in-flight." << std::endl;
+    }
+}
+
+int TraceSweep::RunSweep( int argc, char *argv[] )
+{
+    Config *baseConfig = new Config( );
+    ncounter_t threads = 0;
+    std::vector<char *> args;
+
+    /* Options may appear anywhere; everything else is positional. */
+    for( int curArg = 0; curArg < argc; ++curArg )
+    {
+        std::string arg = argv[curArg];
+
+        if( arg == "--checkpoint-at" && curArg + 1 < argc )
+            checkpointCycle = strtoull( argv[++curArg], NULL, 10 );
+        else if( arg == "--restore" && curArg + 1 < argc )
+            restoreDir = argv[++curArg];
+        else
+            args.push_back( argv[curArg] );
+    }
+
+    argc = static_cast<int>( args.size( ) );
+    argv = args.data( );
+
+    if( argc < 5 )
+    {
+        std::cout << "[+] Usage: nvmain --sweep CONFIG_FILE TRACE_FILE CYCLES SWEEP_FILE [PARAM=value ...]" 
+            << " [--checkpoint-at CYCLE] [--restore DIR]" << std::endl;
+        delete baseConfig;
+        return 1;
+    }
+
+    baseConfig->Read( argv[1] );
+
+    /* Overrides on the command line apply to every configuration. */
+    for( int curArg = 5; curArg < argc; ++curArg )
+    {
+        std::string clParam, clValue, clPair;
+        
+        clPair = argv[curArg];
+        clParam = clPair.substr( 0, clPair.find_first_of("="));
+        clValue = clPair.substr( clPair.find_first_of("=") + 1, std::string::npos );
+
+        std::cout << "[+] Overriding " << clParam << " with '" << clValue << "'" << std::endl;
+
+        baseConfig->SetValue( clParam, clValue );
+    }
+
+    if( !ReadSweepFile( argv[4], baseConfig ) )
+    {
+        delete baseConfig;
+        return 1;
+    }
+
+    /* 
+     *  Decode the whole trace once. The reader comes from the base config,
+     *  so a TraceReader override in the sweep file has no effect.
+     */
+    DecodeTrace( baseConfig, argv[2] );
+
+    simulateCycles = strtoull( argv[3], NULL, 10 );
+
+    if( baseConfig->KeyExists( "SweepThreads" ) )
+        threads = baseConfig->GetValueUL( "SweepThreads" );
+    if( threads == 0 )
+        threads = std::min<ncounter_t>( runs.size( ), std::thread::hardware_concurrency( ) );
+    if( threads == 0 )
+        threads = 1;
+
+    std::cout << "[+] TraceSweep: Decoded " << trace.size( ) << " trace lines from "
+        << argv[2] << ", running " << runs.size( ) << " configurations on "
+        << threads << " threads." << std::endl;
+
+    /* The calling thread is worker 0. */
+    std::vector<std::thread> workers;
+
+    for( ncounter_t i = 1; i < threads; i++ )
+        workers.push_back( std::thread( &TraceSweep::WorkerLoop, this ) );
+
+    WorkerLoop( );
+
+    for( size_t i = 0; i < workers.size( ); i++ )
+        workers[i].join( );
+
+    delete baseConfig;
+
+    return 0;
+}
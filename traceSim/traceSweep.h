@@ -0,0 +1,169 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __TRACESIM_TRACESWEEP_H__
+#define __TRACESIM_TRACESWEEP_H__
+
+
+#include "src/NVMObject.h"
+#include "src/Config.h"
+#include "traceReader/TraceLine.h"
+
+#include <vector>
+#include <map>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+
+
+/* Entry point of the sweep runner, also reached with nvmain --sweep. */
+extern "C" int NVMAIN_SWEEP( int argc, char *argv[] );
+
+
+namespace NVM {
+
+
+/*
+ *  With SamplingPeriod set, each period of trace lines is warmed
+ *  functionally, then simulated in detail for SamplingWarmup lines and
+ *  measured for SamplingWindow lines (systematic sampling as in SMARTS).
+ */
+enum SamplePhase { SAMPLE_DETAILED, SAMPLE_FUNCTIONAL, SAMPLE_WARMING, SAMPLE_MEASURING };
+
+struct SampleWindow
+{
+    ncycle_t startCycle;
+    ncycle_t endCycle;
+    ncounter_t issued;
+    ncounter_t completed;
+    ncycle_t totalLatency;
+};
+
+
+/*
+ *  One configuration of a sweep. Each run owns its Config, Stats, event
+ *  queues and NVMain, and replays the shared trace without modifying it.
+ */
+class SweepRun : public NVMObject
+{
+  public:
+    SweepRun( std::string name, Config *conf, std::vector<TraceLine *>& lines );
+    ~SweepRun( );
+
+    void Run( uint64_t simulateCycles, std::ostream& statStream );
+
+    /* Drain and checkpoint at an input cycle, or start from a checkpoint. */
+    void SetCheckpoint( uint64_t cycle, std::string dir );
+    void SetRestore( std::string dir );
+
+    std::string GetRunName( );
+    uint64_t GetExitCycle( );
+    ncounter_t GetOutstandingRequests( );
+
+    void Cycle( ncycle_t steps );
+
+    bool RequestComplete( NVMainRequest *request );
+
+    void RegisterStats( );
+
+  private:
+    std::string runName;
+    Config *config;
+    std::vector<TraceLine *>& trace;
+    uint64_t exitCycle;
+    ncounter_t outstandingRequests;
+
+    uint64_t checkpointCycle;
+    std::string checkpointDir;
+    std::string restoreDir;
+
+    bool TakeCheckpoint( size_t nextLine, uint64_t currentCycle );
+    bool ResumeCheckpoint( size_t& nextLine, uint64_t& currentCycle );
+
+    ncounter_t samplingPeriod, samplingWindow, samplingWarmup;
+    double samplingConfidence, samplingTargetError;
+    std::vector<SampleWindow> sampleWindows;
+    /* Issue cycle and window of each measured request in flight. */
+    std::map<NVMainRequest *, std::pair<ncycle_t, size_t> > sampledRequests;
+
+    ncounter_t sampledWindows;
+    double sampledLatency, sampledLatencyError;
+    double sampledBandwidth, sampledBandwidthError;
+
+    void SetSampling( );
+    SamplePhase GetSamplePhase( size_t line );
+    void FinishSampling( );
+};
+
+
+/*
+ *  Runs one trace against many configurations. The trace is decoded once
+ *  and shared read-only by every run; runs are dealt to a pool of threads.
+ */
+class TraceSweep
+{
+  public:
+    TraceSweep( );
+    ~TraceSweep( );
+
+    int RunSweep( int argc, char *argv[] );
+
+    /* One configuration on one trace, for nvmain without --sweep. */
+    int RunSingle( std::string runName, Config *config, std::string traceFile,
+                   uint64_t cycles, std::string checkpointDir, std::ostream& statStream );
+
+    void SetCheckpoint( uint64_t cycle );
+    void SetRestore( std::string dir );
+
+  private:
+    std::vector<TraceLine *> trace;
+    std::vector<SweepRun *> runs;
+    std::vector<std::string> statsFiles;
+    uint64_t simulateCycles;
+    uint64_t checkpointCycle;
+    std::string restoreDir;
+
+    std::atomic<size_t> nextRun;
+    std::mutex printMutex;
+
+    bool ReadSweepFile( std::string sweepFile, Config *baseConfig );
+    void DecodeTrace( Config *baseConfig, std::string traceFile );
+    void WorkerLoop( );
+};
+
+
+};
+
+
+#endif